@@ -0,0 +1,674 @@
+/* Throughput benchmark of the public conversions.
+ *
+ * Each conversion runs over a buffer of colors of one input distribution for
+ * a given time, and the average time per color is reported, one line per
+ * (conversion, kernel, input) in CSV or JSON Lines format:
+ *
+ *   $ bench_hsluv [--format=csv|json] [--time=SECONDS] [--count=COLORS] [FILTER...]
+ *
+ * Only the benchmarks whose name contains any of the FILTER strings are run.
+ */
+
+/* For clock_gettime(). */
+#if !defined _WIN32  &&  !defined _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "hsluv.h"
+#include "hsluv-fixed.h"
+#include "hsluv-image.h"
+#include "hsluv-lut3d.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+
+/* The buffers of one input distribution, in all the color spaces the
+ * conversions take, plus room for the output. */
+typedef struct Input_tag Input;
+struct Input_tag {
+    const char* name;
+    size_t n;
+    double* rgb;
+    double* hsl;
+    double* hpl;
+    double* lch;
+    double* xyz;
+    double* lin;
+    float* rgbf;
+    float* hslf;
+    float* hplf;
+    unsigned char* rgba8;
+    int32_t* rgb_fixed;
+    int32_t* hsl_fixed;
+    int32_t* hpl_fixed;
+    double* out;
+    float* outf;
+    unsigned char* out8;
+    int32_t* out_fixed;
+};
+
+typedef void (*BenchFunc)(Input* in);
+
+typedef struct Bench_tag Bench;
+struct Bench_tag {
+    const char* name;
+    BenchFunc func;
+    int per_kernel;     /* Run once for each kernel (see hsluv_set_kernel()). */
+};
+
+static HsluvThreadPool* pool;
+
+
+static double
+wall_time(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double) now.QuadPart / (double) freq.QuadPart;
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+/* Deterministic so that the runs are comparable. */
+static uint32_t rng_state = 12345;
+
+static double
+rng_uniform(void)
+{
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (double) (rng_state >> 8) / 16777215.0;
+}
+
+
+/* Single-color functions. */
+#define SINGLE_BENCH(fn, type, src, dst)                                        \
+    static void                                                                 \
+    bench_##fn(Input* in)                                                       \
+    {                                                                           \
+        size_t i;                                                               \
+        for(i = 0; i < in->n; i++) {                                            \
+            const type* s = &in->src[i * 3];                                    \
+            type* d = &in->dst[i * 3];                                          \
+            fn(s[0], s[1], s[2], &d[0], &d[1], &d[2]);                          \
+        }                                                                       \
+    }
+
+SINGLE_BENCH(hsluv2rgb, double, hsl, out)
+SINGLE_BENCH(rgb2hsluv, double, rgb, out)
+SINGLE_BENCH(hpluv2rgb, double, hpl, out)
+SINGLE_BENCH(rgb2hpluv, double, rgb, out)
+SINGLE_BENCH(hsluv2rgbf, float, hslf, outf)
+SINGLE_BENCH(rgb2hsluvf, float, rgbf, outf)
+SINGLE_BENCH(hpluv2rgbf, float, hplf, outf)
+SINGLE_BENCH(rgb2hpluvf, float, rgbf, outf)
+SINGLE_BENCH(hsluv2rgb_fixed, int32_t, hsl_fixed, out_fixed)
+SINGLE_BENCH(rgb2hsluv_fixed, int32_t, rgb_fixed, out_fixed)
+SINGLE_BENCH(hpluv2rgb_fixed, int32_t, hpl_fixed, out_fixed)
+SINGLE_BENCH(rgb2hpluv_fixed, int32_t, rgb_fixed, out_fixed)
+SINGLE_BENCH(hsluv2lch, double, hsl, out)
+SINGLE_BENCH(lch2hsluv, double, lch, out)
+SINGLE_BENCH(hsluv2xyz, double, hsl, out)
+SINGLE_BENCH(xyz2hsluv, double, xyz, out)
+SINGLE_BENCH(hsluv2linrgb, double, hsl, out)
+SINGLE_BENCH(linrgb2hsluv, double, lin, out)
+SINGLE_BENCH(lch_clip_gamut, double, lch, out)
+
+/* Single-color functions taking the colors by value. */
+#define VALUE_BENCH(fn, type, in_type, out_type, src, dst, a, b, c, x, y, z)    \
+    static void                                                                 \
+    bench_##fn(Input* in)                                                       \
+    {                                                                           \
+        size_t i;                                                               \
+        for(i = 0; i < in->n; i++) {                                            \
+            const type* s = &in->src[i * 3];                                    \
+            type* d = &in->dst[i * 3];                                          \
+            in_type color;                                                      \
+            out_type ret;                                                       \
+            color.a = s[0];                                                     \
+            color.b = s[1];                                                     \
+            color.c = s[2];                                                     \
+            ret = fn(color);                                                    \
+            d[0] = ret.x;                                                       \
+            d[1] = ret.y;                                                       \
+            d[2] = ret.z;                                                       \
+        }                                                                       \
+    }
+
+VALUE_BENCH(hsluv2rgb_v, double, HsluvHsl, HsluvRgb, hsl, out, h, s, l, r, g, b)
+VALUE_BENCH(rgb2hsluv_v, double, HsluvRgb, HsluvHsl, rgb, out, r, g, b, h, s, l)
+VALUE_BENCH(hpluv2rgb_v, double, HsluvHsl, HsluvRgb, hpl, out, h, s, l, r, g, b)
+VALUE_BENCH(rgb2hpluv_v, double, HsluvRgb, HsluvHsl, rgb, out, r, g, b, h, s, l)
+VALUE_BENCH(hsluv2rgbf_v, float, HsluvHslf, HsluvRgbf, hslf, outf, h, s, l, r, g, b)
+VALUE_BENCH(rgb2hsluvf_v, float, HsluvRgbf, HsluvHslf, rgbf, outf, r, g, b, h, s, l)
+
+/* Batched functions, interleaved. */
+#define BATCH_BENCH(fn, src, dst)                                               \
+    static void                                                                 \
+    bench_##fn(Input* in)                                                       \
+    {                                                                           \
+        fn(in->src, 3, in->dst, 3, in->n);                                      \
+    }
+
+BATCH_BENCH(hsluv2rgb_n, hsl, out)
+BATCH_BENCH(rgb2hsluv_n, rgb, out)
+BATCH_BENCH(hpluv2rgb_n, hpl, out)
+BATCH_BENCH(rgb2hpluv_n, rgb, out)
+BATCH_BENCH(hsluv2rgbf_n, hslf, outf)
+BATCH_BENCH(rgb2hsluvf_n, rgbf, outf)
+BATCH_BENCH(hpluv2rgbf_n, hplf, outf)
+BATCH_BENCH(rgb2hpluvf_n, rgbf, outf)
+BATCH_BENCH(hsluv2lch_n, hsl, out)
+BATCH_BENCH(lch2hsluv_n, lch, out)
+BATCH_BENCH(hpluv2lch_n, hpl, out)
+BATCH_BENCH(lch2hpluv_n, lch, out)
+BATCH_BENCH(hsluv2xyz_n, hsl, out)
+BATCH_BENCH(xyz2hsluv_n, xyz, out)
+BATCH_BENCH(hpluv2xyz_n, hpl, out)
+BATCH_BENCH(xyz2hpluv_n, xyz, out)
+BATCH_BENCH(hsluv2linrgb_n, hsl, out)
+BATCH_BENCH(linrgb2hsluv_n, lin, out)
+BATCH_BENCH(hpluv2linrgb_n, hpl, out)
+BATCH_BENCH(linrgb2hpluv_n, lin, out)
+BATCH_BENCH(lch_clip_gamut_n, lch, out)
+
+/* Batched functions, planar. The buffers are just reinterpreted as three
+ * planes of n colors. */
+#define PLANAR_BENCH(fn, src, dst)                                              \
+    static void                                                                 \
+    bench_##fn(Input* in)                                                       \
+    {                                                                           \
+        size_t n = in->n;                                                       \
+        fn(in->src, in->src + n, in->src + 2 * n, 1,                            \
+           in->dst, in->dst + n, in->dst + 2 * n, 1, n);                        \
+    }
+
+PLANAR_BENCH(hsluv2rgb_planar_n, hsl, out)
+PLANAR_BENCH(rgb2hsluv_planar_n, rgb, out)
+PLANAR_BENCH(hpluv2rgb_planar_n, hpl, out)
+PLANAR_BENCH(rgb2hpluv_planar_n, rgb, out)
+
+/* Display P3 (see main()): the kernels reading the constants from the space
+ * instead of the immediate sRGB ones. */
+static HsluvRgbSpace p3_space;
+
+static void bench_hsluv2rgb_space_n(Input* in) { hsluv2rgb_space_n(&p3_space, in->hsl, 3, in->out, 3, in->n); }
+static void bench_rgb2hsluv_space_n(Input* in) { rgb2hsluv_space_n(&p3_space, in->rgb, 3, in->out, 3, in->n); }
+
+/* 8-bit RGB. */
+static void bench_hsluv2rgb8_n(Input* in) { hsluv2rgb8_n(in->hsl, 3, in->out8, HSLUV_FORMAT_RGBA8, in->n); }
+static void bench_rgb82hsluv_n(Input* in) { rgb82hsluv_n(in->rgba8, HSLUV_FORMAT_RGBA8, in->out, 3, in->n); }
+static void bench_hpluv2rgb8_n(Input* in) { hpluv2rgb8_n(in->hpl, 3, in->out8, HSLUV_FORMAT_RGBA8, in->n); }
+static void bench_rgb82hpluv_n(Input* in) { rgb82hpluv_n(in->rgba8, HSLUV_FORMAT_RGBA8, in->out, 3, in->n); }
+
+/* The 3D table of 33^3 nodes (see main()). */
+static HsluvLut3d* lut3d;
+
+static void bench_lut3d_rgb2hsluv_n(Input* in) { hsluv_lut3d_rgb2hsluv_n(lut3d, in->rgb, 3, in->out, 3, in->n); }
+
+/* Images of 256 pixels wide rows, on the built-in pool. */
+static void
+bench_rgb82hsluv_image(Input* in)
+{
+    rgb82hsluv_image(in->rgba8, 256 * 4, HSLUV_FORMAT_RGBA8, in->out, 256 * 3,
+                     256, in->n / 256, hsluv_thread_pool_run, pool);
+}
+
+static void
+bench_hsluv2rgb8_image(Input* in)
+{
+    hsluv2rgb8_image(in->hsl, 256 * 3, in->out8, 256 * 4, HSLUV_FORMAT_RGBA8,
+                     256, in->n / 256, hsluv_thread_pool_run, pool);
+}
+
+/* Histograms of 360 hues, 100 saturations and 100 lightnesses, without
+ * storing the HSLuv image. */
+static void
+bench_rgb82hsluv_image_stats(Input* in)
+{
+    static size_t bins[360 + 100 + 100];
+    HsluvImageStats stats;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.hue_bins = bins;
+    stats.n_hue_bins = 360;
+    stats.saturation_bins = bins + 360;
+    stats.n_saturation_bins = 100;
+    stats.lightness_bins = bins + 460;
+    stats.n_lightness_bins = 100;
+    stats.min_saturation = 1.0;
+    rgb82hsluv_image_stats(in->rgba8, 256 * 4, HSLUV_FORMAT_RGBA8, 256, in->n / 256, &stats,
+                           hsluv_thread_pool_run, pool);
+}
+
+/* One frame at a time through a pipeline of the same image size (see main()):
+ * the overhead of the pipeline over rgb82hsluv_image(). */
+static HsluvFramePipeline* frame_pipeline;
+
+static void
+bench_rgb82hsluv_frame(Input* in)
+{
+    HsluvFrame* frame = hsluv_frame_acquire(frame_pipeline, 1);
+
+    hsluv_frame_submit(frame, in->rgba8, 256 * 4, NULL, NULL);
+    hsluv_frame_wait(frame);
+    hsluv_frame_release(frame);
+}
+
+/* Edits and generators. */
+static void bench_rotate_hue_rgb_n(Input* in) { hsluv_rotate_hue_rgb_n(in->rgb, 3, in->out, 3, in->n, 30.0); }
+static void bench_set_lightness_rgb_n(Input* in) { hsluv_set_lightness_rgb_n(in->rgb, 3, in->out, 3, in->n, 50.0); }
+static void bench_scale_saturation_rgb_n(Input* in) { hsluv_scale_saturation_rgb_n(in->rgb, 3, in->out, 3, in->n, 0.5); }
+
+/* The generators ignore the input distribution: these are meant for the
+ * "gradient" input only (see main()). */
+static void
+bench_hsluv_gradient(Input* in)
+{
+    hsluv_gradient(10.0, 90.0, 30.0, 250.0, 60.0, 80.0, in->out, 3, in->n);
+}
+
+static void
+bench_hsluv_hue_sweep(Input* in)
+{
+    hsluv_hue_sweep(10.0, 360.0 / (double) in->n, 80.0, 60.0, in->out, 3, in->n);
+}
+
+
+#define BENCH(fn, per_kernel)   { #fn, bench_##fn, per_kernel }
+
+static const Bench benches[] = {
+    BENCH(hsluv2rgb, 0),
+    BENCH(rgb2hsluv, 0),
+    BENCH(hpluv2rgb, 0),
+    BENCH(rgb2hpluv, 0),
+    BENCH(hsluv2rgbf, 0),
+    BENCH(rgb2hsluvf, 0),
+    BENCH(hpluv2rgbf, 0),
+    BENCH(rgb2hpluvf, 0),
+    BENCH(hsluv2rgb_v, 0),
+    BENCH(rgb2hsluv_v, 0),
+    BENCH(hpluv2rgb_v, 0),
+    BENCH(rgb2hpluv_v, 0),
+    BENCH(hsluv2rgbf_v, 0),
+    BENCH(rgb2hsluvf_v, 0),
+    BENCH(hsluv2rgb_fixed, 0),
+    BENCH(rgb2hsluv_fixed, 0),
+    BENCH(hpluv2rgb_fixed, 0),
+    BENCH(rgb2hpluv_fixed, 0),
+    BENCH(hsluv2lch, 0),
+    BENCH(lch2hsluv, 0),
+    BENCH(hsluv2xyz, 0),
+    BENCH(xyz2hsluv, 0),
+    BENCH(hsluv2linrgb, 0),
+    BENCH(linrgb2hsluv, 0),
+    BENCH(lch_clip_gamut, 0),
+    BENCH(hsluv2rgb_n, 1),
+    BENCH(rgb2hsluv_n, 1),
+    BENCH(hpluv2rgb_n, 1),
+    BENCH(rgb2hpluv_n, 1),
+    BENCH(hsluv2rgb_planar_n, 1),
+    BENCH(rgb2hsluv_planar_n, 1),
+    BENCH(hpluv2rgb_planar_n, 1),
+    BENCH(rgb2hpluv_planar_n, 1),
+    BENCH(hsluv2rgbf_n, 1),
+    BENCH(rgb2hsluvf_n, 1),
+    BENCH(hpluv2rgbf_n, 1),
+    BENCH(rgb2hpluvf_n, 1),
+    BENCH(hsluv2rgb_space_n, 1),
+    BENCH(rgb2hsluv_space_n, 1),
+    BENCH(lut3d_rgb2hsluv_n, 1),
+    BENCH(rotate_hue_rgb_n, 1),
+    BENCH(set_lightness_rgb_n, 1),
+    BENCH(scale_saturation_rgb_n, 1),
+    BENCH(hsluv2lch_n, 0),
+    BENCH(lch2hsluv_n, 0),
+    BENCH(hpluv2lch_n, 0),
+    BENCH(lch2hpluv_n, 0),
+    BENCH(hsluv2xyz_n, 0),
+    BENCH(xyz2hsluv_n, 0),
+    BENCH(hpluv2xyz_n, 0),
+    BENCH(xyz2hpluv_n, 0),
+    BENCH(hsluv2linrgb_n, 0),
+    BENCH(linrgb2hsluv_n, 0),
+    BENCH(hpluv2linrgb_n, 0),
+    BENCH(linrgb2hpluv_n, 0),
+    BENCH(lch_clip_gamut_n, 0),
+    BENCH(hsluv2rgb8_n, 0),
+    BENCH(rgb82hsluv_n, 0),
+    BENCH(hpluv2rgb8_n, 0),
+    BENCH(rgb82hpluv_n, 0),
+    BENCH(hsluv2rgb8_image, 0),
+    BENCH(rgb82hsluv_image, 0),
+    BENCH(rgb82hsluv_image_stats, 0),
+    BENCH(rgb82hsluv_frame, 0),
+    BENCH(hsluv_gradient, 0),
+    BENCH(hsluv_hue_sweep, 0)
+};
+
+
+/* The input distributions, as RGB in [0, 1]. */
+
+static void
+gen_random(double* rgb, size_t n)
+{
+    size_t i;
+
+    for(i = 0; i < n * 3; i++)
+        rgb[i] = rng_uniform();
+}
+
+/* Smooth ramps between random colors, 256 steps each. */
+static void
+gen_gradient(double* rgb, size_t n)
+{
+    double from[3] = { 0.0, 0.0, 0.0 };
+    double to[3] = { 0.0, 0.0, 0.0 };
+    size_t i;
+    int k;
+
+    for(i = 0; i < n; i++) {
+        if(i % 256 == 0) {
+            for(k = 0; k < 3; k++) {
+                from[k] = rng_uniform();
+                to[k] = rng_uniform();
+            }
+        }
+        for(k = 0; k < 3; k++)
+            rgb[i * 3 + k] = from[k] + (to[k] - from[k]) * (double) (i % 256) / 255.0;
+    }
+}
+
+/* Grays: chroma below the threshold where the hue is taken as undefined. */
+static void
+gen_gray(double* rgb, size_t n)
+{
+    size_t i;
+
+    for(i = 0; i < n; i++)
+        rgb[i * 3] = rgb[i * 3 + 1] = rgb[i * 3 + 2] = rng_uniform();
+}
+
+/* Black and white, and colors within rounding noise of them, hitting the
+ * special cases of extreme lightness. */
+static void
+gen_extreme(double* rgb, size_t n)
+{
+    size_t i;
+    int k;
+
+    for(i = 0; i < n; i++) {
+        int white = (i & 1);
+        for(k = 0; k < 3; k++) {
+            double noise = rng_uniform() * 1e-12;
+            rgb[i * 3 + k] = (white ? 1.0 - noise : noise);
+        }
+    }
+}
+
+static const struct {
+    const char* name;
+    void (*gen)(double* rgb, size_t n);
+} inputs[] = {
+    { "random", gen_random },
+    { "gradient", gen_gradient },
+    { "gray", gen_gray },
+    { "extreme", gen_extreme }
+};
+
+static void*
+xmalloc(size_t size)
+{
+    void* ptr = malloc(size);
+
+    if(ptr == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+static int32_t
+to_fixed(double x)
+{
+    return (int32_t) (x * HSLUV_FIXED_ONE + (x >= 0.0 ? 0.5 : -0.5));
+}
+
+static void
+input_init(Input* in, const char* name, void (*gen)(double*, size_t), size_t n)
+{
+    size_t i;
+
+    in->name = name;
+    in->n = n;
+    in->rgb = (double*) xmalloc(n * 3 * sizeof(double));
+    in->hsl = (double*) xmalloc(n * 3 * sizeof(double));
+    in->hpl = (double*) xmalloc(n * 3 * sizeof(double));
+    in->lch = (double*) xmalloc(n * 3 * sizeof(double));
+    in->xyz = (double*) xmalloc(n * 3 * sizeof(double));
+    in->lin = (double*) xmalloc(n * 3 * sizeof(double));
+    in->rgbf = (float*) xmalloc(n * 3 * sizeof(float));
+    in->hslf = (float*) xmalloc(n * 3 * sizeof(float));
+    in->hplf = (float*) xmalloc(n * 3 * sizeof(float));
+    in->rgba8 = (unsigned char*) xmalloc(n * 4);
+    in->rgb_fixed = (int32_t*) xmalloc(n * 3 * sizeof(int32_t));
+    in->hsl_fixed = (int32_t*) xmalloc(n * 3 * sizeof(int32_t));
+    in->hpl_fixed = (int32_t*) xmalloc(n * 3 * sizeof(int32_t));
+    in->out = (double*) xmalloc(n * 3 * sizeof(double));
+    in->outf = (float*) xmalloc(n * 3 * sizeof(float));
+    in->out8 = (unsigned char*) xmalloc(n * 4);
+    in->out_fixed = (int32_t*) xmalloc(n * 3 * sizeof(int32_t));
+
+    gen(in->rgb, n);
+    rgb2hsluv_n(in->rgb, 3, in->hsl, 3, n);
+    rgb2hpluv_n(in->rgb, 3, in->hpl, 3, n);
+    hsluv2lch_n(in->hsl, 3, in->lch, 3, n);
+    hsluv2xyz_n(in->hsl, 3, in->xyz, 3, n);
+    hsluv2linrgb_n(in->hsl, 3, in->lin, 3, n);
+    for(i = 0; i < n * 3; i++) {
+        in->rgbf[i] = (float) in->rgb[i];
+        in->hslf[i] = (float) in->hsl[i];
+        in->hplf[i] = (float) in->hpl[i];
+        in->rgb_fixed[i] = to_fixed(in->rgb[i]);
+        in->hsl_fixed[i] = to_fixed(in->hsl[i]);
+        in->hpl_fixed[i] = to_fixed(in->hpl[i]);
+    }
+    for(i = 0; i < n; i++) {
+        in->rgba8[i * 4] = (unsigned char) (in->rgb[i * 3] * 255.0 + 0.5);
+        in->rgba8[i * 4 + 1] = (unsigned char) (in->rgb[i * 3 + 1] * 255.0 + 0.5);
+        in->rgba8[i * 4 + 2] = (unsigned char) (in->rgb[i * 3 + 2] * 255.0 + 0.5);
+        in->rgba8[i * 4 + 3] = 0xff;
+    }
+}
+
+static void
+input_fini(Input* in)
+{
+    free(in->rgb);
+    free(in->hsl);
+    free(in->hpl);
+    free(in->lch);
+    free(in->xyz);
+    free(in->lin);
+    free(in->rgbf);
+    free(in->hslf);
+    free(in->hplf);
+    free(in->rgba8);
+    free(in->rgb_fixed);
+    free(in->hsl_fixed);
+    free(in->hpl_fixed);
+    free(in->out);
+    free(in->outf);
+    free(in->out8);
+    free(in->out_fixed);
+}
+
+
+static int
+matches_filter(const char* name, int n_filters, char** filters)
+{
+    int i;
+
+    if(n_filters == 0)
+        return 1;
+    for(i = 0; i < n_filters; i++) {
+        if(strstr(name, filters[i]) != NULL)
+            return 1;
+    }
+    return 0;
+}
+
+/* Average nanoseconds per color over (at least) the given time. One call
+ * first warms up the caches and any lazily built tables. */
+static double
+measure(const Bench* bench, Input* in, double min_time)
+{
+    double start, elapsed;
+    unsigned long iters = 0;
+
+    bench->func(in);
+    start = wall_time();
+    do {
+        bench->func(in);
+        iters++;
+        elapsed = wall_time() - start;
+    } while(elapsed < min_time);
+
+    return elapsed * 1e9 / ((double) iters * (double) in->n);
+}
+
+static void
+report(int json, const char* name, const char* kernel, const Input* in, double ns)
+{
+    if(json) {
+        printf("{\"name\": \"%s\", \"kernel\": \"%s\", \"input\": \"%s\", \"colors\": %lu, "
+               "\"ns_per_color\": %.3f, \"mpixels_per_s\": %.3f}\n",
+               name, kernel, in->name, (unsigned long) in->n, ns, 1000.0 / ns);
+    } else {
+        printf("%s,%s,%s,%lu,%.3f,%.3f\n",
+               name, kernel, in->name, (unsigned long) in->n, ns, 1000.0 / ns);
+    }
+    fflush(stdout);
+}
+
+static void
+usage(const char* argv0)
+{
+    fprintf(stderr, "Usage: %s [--format=csv|json] [--time=SECONDS] [--count=COLORS] [FILTER...]\n", argv0);
+}
+
+int
+main(int argc, char** argv)
+{
+    HsluvFrameConfig frame_config;
+    int json = 0;
+    double min_time = 0.1;
+    size_t n = 65536;
+    char** filters = (char**) xmalloc((size_t) argc * sizeof(char*));
+    int n_filters = 0;
+    size_t i, j;
+    int a;
+
+    for(a = 1; a < argc; a++) {
+        if(strcmp(argv[a], "--format=csv") == 0) {
+            json = 0;
+        } else if(strcmp(argv[a], "--format=json") == 0) {
+            json = 1;
+        } else if(strncmp(argv[a], "--time=", 7) == 0) {
+            min_time = atof(argv[a] + 7);
+        } else if(strncmp(argv[a], "--count=", 8) == 0) {
+            n = (size_t) strtoul(argv[a] + 8, NULL, 10);
+            /* Whole rows of the image benchmarks. */
+            n = (n + 255) / 256 * 256;
+        } else if(argv[a][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            filters[n_filters++] = argv[a];
+        }
+    }
+    if(n == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    pool = hsluv_thread_pool_create(0);
+    if(pool == NULL) {
+        fprintf(stderr, "Cannot create the thread pool.\n");
+        return 1;
+    }
+    hsluv_rgb_space_init_std(&p3_space, HSLUV_RGB_SPACE_DISPLAY_P3);
+    memset(&frame_config, 0, sizeof(frame_config));
+    frame_config.op = HSLUV_FRAME_RGB82HSLUV;
+    frame_config.format = HSLUV_FORMAT_RGBA8;
+    frame_config.width = 256;
+    frame_config.height = n / 256;
+    frame_config.n_buffers = 2;
+    /* Not available in the builds without threads (see HSLUV_C_THREADS). */
+    frame_pipeline = hsluv_frame_pipeline_create(&frame_config);
+    if(frame_pipeline == NULL)
+        fprintf(stderr, "Cannot create the frame pipeline; skipping its benchmark.\n");
+    lut3d = hsluv_lut3d_build(33);
+    if(lut3d == NULL) {
+        fprintf(stderr, "Cannot build the 3D table.\n");
+        return 1;
+    }
+
+    if(!json)
+        printf("name,kernel,input,colors,ns_per_color,mpixels_per_s\n");
+
+    for(i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        Input in;
+
+        input_init(&in, inputs[i].name, inputs[i].gen, n);
+
+        for(j = 0; j < sizeof(benches) / sizeof(benches[0]); j++) {
+            const Bench* bench = &benches[j];
+            HsluvKernel kernel;
+
+            if(!matches_filter(bench->name, n_filters, filters))
+                continue;
+            if((bench->func == bench_hsluv_gradient  ||  bench->func == bench_hsluv_hue_sweep)
+                    &&  strcmp(in.name, "gradient") != 0)
+                continue;
+            if(bench->func == bench_rgb82hsluv_frame  &&  frame_pipeline == NULL)
+                continue;
+
+            if(!bench->per_kernel) {
+                hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+                report(json, bench->name, "auto", &in, measure(bench, &in, min_time));
+                continue;
+            }
+
+            for(kernel = HSLUV_KERNEL_SCALAR; kernel <= HSLUV_KERNEL_NEON; kernel++) {
+                if(hsluv_set_kernel(kernel) != 0)
+                    continue;
+                report(json, bench->name, hsluv_kernel_name(kernel), &in, measure(bench, &in, min_time));
+            }
+            hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+        }
+
+        input_fini(&in);
+    }
+
+    hsluv_lut3d_free(lut3d);
+    hsluv_frame_pipeline_destroy(frame_pipeline);
+    hsluv_thread_pool_destroy(pool);
+    free(filters);
+    return 0;
+}
@@ -0,0 +1,725 @@
+/* Accuracy sweep over all the 2^24 8-bit RGB colors.
+ *
+ * Each variant of the conversions (single-color double and float functions,
+ * the batched functions on each kernel, the fast trigonometry, the HPLuv
+ * lookup table, the 8-bit RGB functions, the cache and the fixed-point
+ * functions) is compared to the reference: the double precision single-color
+ * functions with the default settings. For each variant and color space, one
+ * CSV line reports:
+ *
+ *  - the maximal and mean absolute error of the conversion from RGB, per
+ *    channel (the hue only for colors whose reference saturation is at least
+ *    MIN_S, as the hue of grays is meaningless);
+ *  - the maximal and mean absolute error of the conversion back to RGB of the
+ *    reference HSLuv (or HPLuv) color;
+ *  - how many colors do not survive the round trip through the variant (both
+ *    ways, or the reference way back if the variant converts only from RGB)
+ *    and back to 8 bits;
+ *  - the CPU time per color of each direction.
+ *
+ * The colors are spread over all the CPU cores:
+ *
+ *   $ exhaustive_hsluv [--threads=N] [--step=N] [FILTER...]
+ *
+ * With --step=N, only every N-th blue value is tried. Only the variants whose
+ * name contains any of the FILTER strings are run.
+ */
+
+/* For clock_gettime(). */
+#if !defined _WIN32  &&  !defined _POSIX_C_SOURCE
+    #define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "hsluv.h"
+#include "hsluv-cache.h"
+#include "hsluv-fixed.h"
+#include "hsluv-image.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <time.h>
+#endif
+
+
+#define MIN_S       1.0
+
+/* Colors per chunk in the one-color-at-a-time wrappers below. */
+#define CHUNK       256
+
+/* Red values processed at once. The reference of each group is computed first
+ * with the default settings, then the variant runs with its own. */
+#define GROUP       16
+
+typedef enum Space_tag {
+    SPACE_HSLUV = 0,
+    SPACE_HPLUV
+} Space;
+
+static const char* space_names[] = { "hsluv", "hpluv" };
+
+/* Conversions of n colors, three doubles each, packed. The 8-bit RGB of the
+ * same colors is also given to the conversions from RGB. */
+typedef void (*ForwardFunc)(Space space, const unsigned char* rgb8, const double* rgb,
+                            double* out, size_t n);
+typedef void (*InverseFunc)(Space space, const double* in, double* rgb, size_t n);
+
+typedef struct Variant_tag Variant;
+struct Variant_tag {
+    const char* name;
+    ForwardFunc forward;
+    InverseFunc inverse;    /* NULL if the variant converts only from RGB. */
+    int per_kernel;         /* Run once for each kernel (see hsluv_set_kernel()). */
+    int hpluv_lut;          /* HPLuv only, with hpluv_lut (see HsluvHpluvLut). */
+    int hsluv_only;
+};
+
+/* Result of one task (all the colors of one red value). */
+typedef struct Stats_tag Stats;
+struct Stats_tag {
+    double max_err[3];
+    double sum_err[3];
+    size_t n_err[3];
+    double max_rgb_err;
+    double sum_rgb_err;
+    size_t n_rgb_err;
+    size_t n_roundtrip_fail;
+    double forward_time;
+    double inverse_time;
+};
+
+typedef struct Run_tag Run;
+struct Run_tag {
+    const Variant* variant;
+    Space space;
+    unsigned step;
+    size_t n;               /* Colors per task. */
+    size_t r0;              /* Red value of the 1st task of the group. */
+    double* ref;            /* Reference HSLuv (HPLuv) and RGB, per task. */
+    Stats* stats;           /* One per red value. */
+};
+
+static HsluvCache* cache;
+static HsluvHpluvLut hpluv_lut;
+
+
+static double
+wall_time(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double) now.QuadPart / (double) freq.QuadPart;
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+
+/* The reference, also used for the single-color double variants. */
+static void
+forward_double(Space space, const unsigned char* rgb8, const double* rgb, double* out, size_t n)
+{
+    size_t i;
+
+    (void) rgb8;
+    for(i = 0; i < n; i++) {
+        const double* s = &rgb[i * 3];
+        double* d = &out[i * 3];
+        if(space == SPACE_HSLUV)
+            rgb2hsluv(s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+        else
+            rgb2hpluv(s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+    }
+}
+
+static void
+inverse_double(Space space, const double* in, double* rgb, size_t n)
+{
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        const double* s = &in[i * 3];
+        double* d = &rgb[i * 3];
+        if(space == SPACE_HSLUV)
+            hsluv2rgb(s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+        else
+            hpluv2rgb(s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+    }
+}
+
+static void
+forward_fast(Space space, const unsigned char* rgb8, const double* rgb, double* out, size_t n)
+{
+    size_t i;
+
+    (void) rgb8;
+    for(i = 0; i < n; i++) {
+        const double* s = &rgb[i * 3];
+        double* d = &out[i * 3];
+        if(space == SPACE_HSLUV)
+            rgb2hsluv_fast(s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+        else
+            rgb2hpluv_fast(s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+    }
+}
+
+static void
+inverse_fast(Space space, const double* in, double* rgb, size_t n)
+{
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        const double* s = &in[i * 3];
+        double* d = &rgb[i * 3];
+        if(space == SPACE_HSLUV)
+            hsluv2rgb_fast(s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+        else
+            hpluv2rgb_fast(s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+    }
+}
+
+static void
+forward_lut(Space space, const unsigned char* rgb8, const double* rgb, double* out, size_t n)
+{
+    size_t i;
+
+    (void) space;
+    (void) rgb8;
+    for(i = 0; i < n; i++) {
+        const double* s = &rgb[i * 3];
+        double* d = &out[i * 3];
+        rgb2hpluv_lut(&hpluv_lut, s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+    }
+}
+
+static void
+inverse_lut(Space space, const double* in, double* rgb, size_t n)
+{
+    size_t i;
+
+    (void) space;
+    for(i = 0; i < n; i++) {
+        const double* s = &in[i * 3];
+        double* d = &rgb[i * 3];
+        hpluv2rgb_lut(&hpluv_lut, s[0], s[1], s[2], &d[0], &d[1], &d[2]);
+    }
+}
+
+static void
+forward_double_n(Space space, const unsigned char* rgb8, const double* rgb, double* out, size_t n)
+{
+    (void) rgb8;
+    if(space == SPACE_HSLUV)
+        rgb2hsluv_n(rgb, 3, out, 3, n);
+    else
+        rgb2hpluv_n(rgb, 3, out, 3, n);
+}
+
+static void
+inverse_double_n(Space space, const double* in, double* rgb, size_t n)
+{
+    if(space == SPACE_HSLUV)
+        hsluv2rgb_n(in, 3, rgb, 3, n);
+    else
+        hpluv2rgb_n(in, 3, rgb, 3, n);
+}
+
+static void
+forward_float(Space space, const unsigned char* rgb8, const double* rgb, double* out, size_t n)
+{
+    size_t i;
+
+    (void) rgb8;
+    for(i = 0; i < n; i++) {
+        const double* s = &rgb[i * 3];
+        double* d = &out[i * 3];
+        float h, sat, l;
+        if(space == SPACE_HSLUV)
+            rgb2hsluvf((float) s[0], (float) s[1], (float) s[2], &h, &sat, &l);
+        else
+            rgb2hpluvf((float) s[0], (float) s[1], (float) s[2], &h, &sat, &l);
+        d[0] = h;
+        d[1] = sat;
+        d[2] = l;
+    }
+}
+
+static void
+inverse_float(Space space, const double* in, double* rgb, size_t n)
+{
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        const double* s = &in[i * 3];
+        double* d = &rgb[i * 3];
+        float r, g, b;
+        if(space == SPACE_HSLUV)
+            hsluv2rgbf((float) s[0], (float) s[1], (float) s[2], &r, &g, &b);
+        else
+            hpluv2rgbf((float) s[0], (float) s[1], (float) s[2], &r, &g, &b);
+        d[0] = r;
+        d[1] = g;
+        d[2] = b;
+    }
+}
+
+static void
+forward_float_n(Space space, const unsigned char* rgb8, const double* rgb, double* out, size_t n)
+{
+    float tmp_in[CHUNK * 3], tmp_out[CHUNK * 3];
+    size_t i, j, len;
+
+    (void) rgb8;
+    for(i = 0; i < n; i += len) {
+        len = (n - i < CHUNK ? n - i : CHUNK);
+        for(j = 0; j < len * 3; j++)
+            tmp_in[j] = (float) rgb[i * 3 + j];
+        if(space == SPACE_HSLUV)
+            rgb2hsluvf_n(tmp_in, 3, tmp_out, 3, len);
+        else
+            rgb2hpluvf_n(tmp_in, 3, tmp_out, 3, len);
+        for(j = 0; j < len * 3; j++)
+            out[i * 3 + j] = tmp_out[j];
+    }
+}
+
+static void
+inverse_float_n(Space space, const double* in, double* rgb, size_t n)
+{
+    float tmp_in[CHUNK * 3], tmp_out[CHUNK * 3];
+    size_t i, j, len;
+
+    for(i = 0; i < n; i += len) {
+        len = (n - i < CHUNK ? n - i : CHUNK);
+        for(j = 0; j < len * 3; j++)
+            tmp_in[j] = (float) in[i * 3 + j];
+        if(space == SPACE_HSLUV)
+            hsluv2rgbf_n(tmp_in, 3, tmp_out, 3, len);
+        else
+            hpluv2rgbf_n(tmp_in, 3, tmp_out, 3, len);
+        for(j = 0; j < len * 3; j++)
+            rgb[i * 3 + j] = tmp_out[j];
+    }
+}
+
+static void
+forward_rgb8(Space space, const unsigned char* rgb8, const double* rgb, double* out, size_t n)
+{
+    (void) rgb;
+    if(space == SPACE_HSLUV)
+        rgb82hsluv_n(rgb8, HSLUV_FORMAT_RGB8, out, 3, n);
+    else
+        rgb82hpluv_n(rgb8, HSLUV_FORMAT_RGB8, out, 3, n);
+}
+
+static void
+inverse_rgb8(Space space, const double* in, double* rgb, size_t n)
+{
+    unsigned char tmp[CHUNK * 3];
+    size_t i, j, len;
+
+    for(i = 0; i < n; i += len) {
+        len = (n - i < CHUNK ? n - i : CHUNK);
+        if(space == SPACE_HSLUV)
+            hsluv2rgb8_n(in + i * 3, 3, tmp, HSLUV_FORMAT_RGB8, len);
+        else
+            hpluv2rgb8_n(in + i * 3, 3, tmp, HSLUV_FORMAT_RGB8, len);
+        for(j = 0; j < len * 3; j++)
+            rgb[i * 3 + j] = tmp[j] / 255.0;
+    }
+}
+
+static void
+forward_cache(Space space, const unsigned char* rgb8, const double* rgb, double* out, size_t n)
+{
+    (void) space;
+    (void) rgb;
+    hsluv_cache_rgb82hsluv_n(cache, rgb8, HSLUV_FORMAT_RGB8, out, 3, n);
+}
+
+static int32_t
+to_fixed(double x)
+{
+    return (int32_t) floor(x * HSLUV_FIXED_ONE + 0.5);
+}
+
+static void
+forward_fixed(Space space, const unsigned char* rgb8, const double* rgb, double* out, size_t n)
+{
+    size_t i;
+
+    (void) rgb8;
+    for(i = 0; i < n; i++) {
+        const double* s = &rgb[i * 3];
+        double* d = &out[i * 3];
+        int32_t h, sat, l;
+        if(space == SPACE_HSLUV)
+            rgb2hsluv_fixed(to_fixed(s[0]), to_fixed(s[1]), to_fixed(s[2]), &h, &sat, &l);
+        else
+            rgb2hpluv_fixed(to_fixed(s[0]), to_fixed(s[1]), to_fixed(s[2]), &h, &sat, &l);
+        d[0] = (double) h / HSLUV_FIXED_ONE;
+        d[1] = (double) sat / HSLUV_FIXED_ONE;
+        d[2] = (double) l / HSLUV_FIXED_ONE;
+    }
+}
+
+static void
+inverse_fixed(Space space, const double* in, double* rgb, size_t n)
+{
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        const double* s = &in[i * 3];
+        double* d = &rgb[i * 3];
+        int32_t r, g, b;
+        if(space == SPACE_HSLUV)
+            hsluv2rgb_fixed(to_fixed(s[0]), to_fixed(s[1]), to_fixed(s[2]), &r, &g, &b);
+        else
+            hpluv2rgb_fixed(to_fixed(s[0]), to_fixed(s[1]), to_fixed(s[2]), &r, &g, &b);
+        d[0] = (double) r / HSLUV_FIXED_ONE;
+        d[1] = (double) g / HSLUV_FIXED_ONE;
+        d[2] = (double) b / HSLUV_FIXED_ONE;
+    }
+}
+
+static const Variant variants[] = {
+    /*  name            forward             inverse             kernel lut hsluv_only */
+    { "double",         forward_double,     inverse_double,     0, 0, 0 },
+    { "double_n",       forward_double_n,   inverse_double_n,   1, 0, 0 },
+    { "fast_trig",      forward_fast,       inverse_fast,       0, 0, 0 },
+    { "hpluv_lut",      forward_lut,        inverse_lut,        0, 1, 0 },
+    { "float",          forward_float,      inverse_float,      0, 0, 0 },
+    { "float_n",        forward_float_n,    inverse_float_n,    1, 0, 0 },
+    { "rgb8_n",         forward_rgb8,       inverse_rgb8,       0, 0, 0 },
+    { "cache",          forward_cache,      NULL,               0, 0, 1 },
+    { "fixed",          forward_fixed,      inverse_fixed,      0, 0, 0 }
+};
+
+
+static unsigned char
+quantize(double x)
+{
+    if(x <= 0.0)
+        return 0;
+    if(x >= 1.0)
+        return 255;
+    return (unsigned char) (x * 255.0 + 0.5);
+}
+
+static void
+stats_add(double* max, double* sum, size_t* count, double err)
+{
+    if(err > *max)
+        *max = err;
+    *sum += err;
+    (*count)++;
+}
+
+/* All the colors of the given red value, in 8 bits and in doubles. */
+static void
+gen_colors(size_t r, unsigned step, unsigned char* rgb8, double* rgb)
+{
+    size_t i = 0;
+    size_t g, b;
+    int k;
+
+    for(g = 0; g < 256; g++) {
+        for(b = 0; b < 256; b += step) {
+            rgb8[i * 3] = (unsigned char) r;
+            rgb8[i * 3 + 1] = (unsigned char) g;
+            rgb8[i * 3 + 2] = (unsigned char) b;
+            for(k = 0; k < 3; k++)
+                rgb[i * 3 + k] = rgb8[i * 3 + k] / 255.0;
+            i++;
+        }
+    }
+}
+
+static void*
+xmalloc(size_t size)
+{
+    void* ptr = malloc(size);
+
+    if(ptr == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    return ptr;
+}
+
+static void
+ref_task(void* task_data, size_t i)
+{
+    const Run* run = (const Run*) task_data;
+    size_t n = run->n;
+    double* ref = run->ref + i * n * 6;
+    unsigned char* rgb8 = (unsigned char*) xmalloc(n * 3);
+    double* rgb = (double*) xmalloc(n * 3 * sizeof(double));
+
+    gen_colors(run->r0 + i, run->step, rgb8, rgb);
+    forward_double(run->space, rgb8, rgb, ref, n);
+    inverse_double(run->space, ref, ref + n * 3, n);
+
+    free(rgb);
+    free(rgb8);
+}
+
+static void
+run_task(void* task_data, size_t i)
+{
+    const Run* run = (const Run*) task_data;
+    const Variant* variant = run->variant;
+    Stats* stats = &run->stats[run->r0 + i];
+    size_t n = run->n;
+    const double* ref = run->ref + i * n * 6;
+    const double* ref_rgb = ref + n * 3;
+    unsigned char* rgb8;
+    double* buf;
+    double* rgb;
+    double* fwd;
+    double* inv;
+    double* back;
+    double t0;
+    int k;
+
+    rgb8 = (unsigned char*) xmalloc(n * 3);
+    buf = (double*) xmalloc(n * 3 * 4 * sizeof(double));
+    rgb = buf;
+    fwd = buf + n * 3;
+    inv = buf + n * 6;
+    back = buf + n * 9;
+
+    gen_colors(run->r0 + i, run->step, rgb8, rgb);
+
+    t0 = wall_time();
+    variant->forward(run->space, rgb8, rgb, fwd, n);
+    stats->forward_time = wall_time() - t0;
+
+    if(variant->inverse != NULL) {
+        t0 = wall_time();
+        variant->inverse(run->space, ref, inv, n);
+        stats->inverse_time = wall_time() - t0;
+        variant->inverse(run->space, fwd, back, n);
+    } else {
+        inverse_double(run->space, fwd, back, n);
+    }
+
+    for(i = 0; i < n; i++) {
+        double dh = fabs(fwd[i * 3] - ref[i * 3]);
+
+        if(dh > 180.0)
+            dh = 360.0 - dh;
+        if(ref[i * 3 + 1] >= MIN_S)
+            stats_add(&stats->max_err[0], &stats->sum_err[0], &stats->n_err[0], dh);
+        for(k = 1; k < 3; k++) {
+            stats_add(&stats->max_err[k], &stats->sum_err[k], &stats->n_err[k],
+                      fabs(fwd[i * 3 + k] - ref[i * 3 + k]));
+        }
+
+        for(k = 0; k < 3; k++) {
+            if(variant->inverse != NULL) {
+                stats_add(&stats->max_rgb_err, &stats->sum_rgb_err, &stats->n_rgb_err,
+                          fabs(inv[i * 3 + k] - ref_rgb[i * 3 + k]));
+            }
+        }
+        for(k = 0; k < 3; k++) {
+            if(quantize(back[i * 3 + k]) != rgb8[i * 3 + k]) {
+                stats->n_roundtrip_fail++;
+                break;
+            }
+        }
+    }
+
+    free(buf);
+    free(rgb8);
+}
+
+static void
+report(const Variant* variant, const char* kernel, Space space, const Stats* stats,
+       size_t n_tasks, size_t n_colors, double wall)
+{
+    Stats total;
+    size_t i;
+    int k;
+
+    memset(&total, 0, sizeof(total));
+    for(i = 0; i < n_tasks; i++) {
+        for(k = 0; k < 3; k++) {
+            if(stats[i].max_err[k] > total.max_err[k])
+                total.max_err[k] = stats[i].max_err[k];
+            total.sum_err[k] += stats[i].sum_err[k];
+            total.n_err[k] += stats[i].n_err[k];
+        }
+        if(stats[i].max_rgb_err > total.max_rgb_err)
+            total.max_rgb_err = stats[i].max_rgb_err;
+        total.sum_rgb_err += stats[i].sum_rgb_err;
+        total.n_rgb_err += stats[i].n_rgb_err;
+        total.n_roundtrip_fail += stats[i].n_roundtrip_fail;
+        total.forward_time += stats[i].forward_time;
+        total.inverse_time += stats[i].inverse_time;
+    }
+
+    printf("%s,%s,%s,%lu", variant->name, kernel, space_names[space], (unsigned long) n_colors);
+    for(k = 0; k < 3; k++)
+        printf(",%.3g", total.max_err[k]);
+    for(k = 0; k < 3; k++)
+        printf(",%.3g", total.n_err[k] > 0 ? total.sum_err[k] / total.n_err[k] : 0.0);
+    if(variant->inverse != NULL) {
+        printf(",%.3g,%.3g", total.max_rgb_err,
+               total.n_rgb_err > 0 ? total.sum_rgb_err / total.n_rgb_err : 0.0);
+    } else {
+        printf(",,");
+    }
+    printf(",%lu,%.2f", (unsigned long) total.n_roundtrip_fail,
+           total.forward_time * 1e9 / n_colors);
+    if(variant->inverse != NULL)
+        printf(",%.2f", total.inverse_time * 1e9 / n_colors);
+    else
+        printf(",");
+    printf(",%.2f\n", wall);
+    fflush(stdout);
+}
+
+static void
+run_variant(HsluvThreadPool* pool, const Variant* variant, HsluvKernel kernel,
+            Space space, unsigned step)
+{
+    Stats stats[256];
+    Run run;
+    double t0;
+
+    memset(stats, 0, sizeof(stats));
+    run.variant = variant;
+    run.space = space;
+    run.step = step;
+    run.n = 256 * ((256 + step - 1) / step);
+    run.ref = (double*) xmalloc(GROUP * run.n * 6 * sizeof(double));
+    run.stats = stats;
+
+    t0 = wall_time();
+    for(run.r0 = 0; run.r0 < 256; run.r0 += GROUP) {
+        hsluv_thread_pool_run(ref_task, &run, GROUP, pool);
+
+        hsluv_set_kernel(kernel);
+        hsluv_thread_pool_run(run_task, &run, GROUP, pool);
+        hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+    }
+
+    report(variant, (variant->per_kernel ? hsluv_kernel_name(kernel) : "auto"), space,
+           stats, 256, 256 * run.n, wall_time() - t0);
+    free(run.ref);
+}
+
+static int
+matches_filter(const char* name, int n_filters, char** filters)
+{
+    int i;
+
+    if(n_filters == 0)
+        return 1;
+    for(i = 0; i < n_filters; i++) {
+        if(strstr(name, filters[i]) != NULL)
+            return 1;
+    }
+    return 0;
+}
+
+static void
+usage(const char* argv0)
+{
+    fprintf(stderr, "Usage: %s [--threads=N] [--step=N] [FILTER...]\n", argv0);
+}
+
+int
+main(int argc, char** argv)
+{
+    unsigned n_threads = 0;
+    unsigned step = 1;
+    char** filters;
+    int n_filters = 0;
+    HsluvThreadPool* pool;
+    size_t i;
+    int a;
+
+    filters = (char**) malloc((size_t) argc * sizeof(char*));
+    if(filters == NULL)
+        return 1;
+    for(a = 1; a < argc; a++) {
+        if(strncmp(argv[a], "--threads=", 10) == 0) {
+            n_threads = (unsigned) strtoul(argv[a] + 10, NULL, 10);
+        } else if(strncmp(argv[a], "--step=", 7) == 0) {
+            step = (unsigned) strtoul(argv[a] + 7, NULL, 10);
+        } else if(argv[a][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            filters[n_filters++] = argv[a];
+        }
+    }
+    if(step < 1  ||  step > 256) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    hsluv_hpluv_lut_init(&hpluv_lut);
+    pool = hsluv_thread_pool_create(n_threads);
+    if(pool == NULL) {
+        fprintf(stderr, "Cannot create the thread pool.\n");
+        return 1;
+    }
+
+    printf("variant,kernel,space,colors,max_err_h,max_err_s,max_err_l,"
+           "mean_err_h,mean_err_s,mean_err_l,max_err_rgb,mean_err_rgb,"
+           "roundtrip_fail,forward_ns,inverse_ns,wall_s\n");
+
+    for(i = 0; i < sizeof(variants) / sizeof(variants[0]); i++) {
+        const Variant* variant = &variants[i];
+        Space space;
+
+        if(!matches_filter(variant->name, n_filters, filters))
+            continue;
+
+        if(variant->forward == forward_cache  &&  cache == NULL) {
+            cache = hsluv_cache_build();
+            if(cache == NULL) {
+                fprintf(stderr, "Cannot build the cache.\n");
+                continue;
+            }
+        }
+
+        for(space = SPACE_HSLUV; space <= SPACE_HPLUV; space++) {
+            HsluvKernel kernel;
+
+            if(space == SPACE_HPLUV  &&  variant->hsluv_only)
+                continue;
+            if(space == SPACE_HSLUV  &&  variant->hpluv_lut)
+                continue;
+
+            if(!variant->per_kernel) {
+                run_variant(pool, variant, HSLUV_KERNEL_AUTO, space, step);
+                continue;
+            }
+            for(kernel = HSLUV_KERNEL_SCALAR; kernel <= HSLUV_KERNEL_NEON; kernel++) {
+                if(hsluv_kernel_available(kernel))
+                    run_variant(pool, variant, kernel, space, step);
+            }
+        }
+    }
+
+    hsluv_cache_free(cache);
+    hsluv_thread_pool_destroy(pool);
+    free(filters);
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* AVX2 kernels: 4 doubles per vector. */
+
+#include "hsluv-internal.h"
+
+#ifdef HSLUV_HAVE_AVX2
+
+#include <immintrin.h>
+
+
+typedef __m256d vr;
+typedef __m256d vm;
+
+#define SIMD_FLOAT              0
+#define VR_WIDTH                4
+#define SIMD_NAME(fn)           hsluv_avx2_##fn
+
+static inline vr vr_set(double x)               { return _mm256_set1_pd(x); }
+static inline vr vr_loadu(const double* p)      { return _mm256_loadu_pd(p); }
+static inline void vr_storeu(double* p, vr x)   { _mm256_storeu_pd(p, x); }
+static inline vr vr_add(vr x, vr y)             { return _mm256_add_pd(x, y); }
+static inline vr vr_sub(vr x, vr y)             { return _mm256_sub_pd(x, y); }
+static inline vr vr_mul(vr x, vr y)             { return _mm256_mul_pd(x, y); }
+static inline vr vr_div(vr x, vr y)             { return _mm256_div_pd(x, y); }
+#ifdef __FMA__
+static inline vr vr_fma(vr x, vr y, vr z)       { return _mm256_fmadd_pd(x, y, z); }
+#else
+static inline vr vr_fma(vr x, vr y, vr z)       { return _mm256_add_pd(_mm256_mul_pd(x, y), z); }
+#endif
+static inline vr vr_sqrt(vr x)                  { return _mm256_sqrt_pd(x); }
+static inline vr vr_min(vr x, vr y)             { return _mm256_min_pd(x, y); }
+static inline vr vr_max(vr x, vr y)             { return _mm256_max_pd(x, y); }
+static inline vr vr_round(vr x)                 { return _mm256_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+static inline vr vr_floor(vr x)                 { return _mm256_floor_pd(x); }
+static inline vm vr_lt(vr x, vr y)              { return _mm256_cmp_pd(x, y, _CMP_LT_OQ); }
+static inline vm vr_le(vr x, vr y)              { return _mm256_cmp_pd(x, y, _CMP_LE_OQ); }
+static inline vm vr_gt(vr x, vr y)              { return _mm256_cmp_pd(x, y, _CMP_GT_OQ); }
+static inline vm vr_ge(vr x, vr y)              { return _mm256_cmp_pd(x, y, _CMP_GE_OQ); }
+static inline vr vr_sel(vm mask, vr x, vr y)    { return _mm256_blendv_pd(y, x, mask); }
+static inline vm vm_and(vm x, vm y)             { return _mm256_and_pd(x, y); }
+static inline vm vm_or(vm x, vm y)              { return _mm256_or_pd(x, y); }
+static inline int vm_any(vm x)                  { return _mm256_movemask_pd(x) != 0; }
+
+/* Unbiased exponent of positive normal x, as a double. */
+static inline vr
+vr_exponent(vr x)
+{
+    __m256i e = _mm256_srli_epi64(_mm256_castpd_si256(x), 52);
+    __m256d magic = _mm256_castsi256_pd(_mm256_or_si256(e, _mm256_set1_epi64x(0x4330000000000000LL)));
+    return _mm256_sub_pd(magic, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+}
+
+/* Mantissa of positive x, scaled into [1, 2). */
+static inline vr
+vr_mantissa(vr x)
+{
+    __m256i bits = _mm256_and_si256(_mm256_castpd_si256(x), _mm256_set1_epi64x(0x000fffffffffffffLL));
+    return _mm256_castsi256_pd(_mm256_or_si256(bits, _mm256_set1_epi64x(0x3ff0000000000000LL)));
+}
+
+/* x * 2^k for integral k. */
+static inline vr
+vr_ldexp(vr x, vr k)
+{
+    __m256d biased = _mm256_add_pd(_mm256_min_pd(_mm256_max_pd(k, _mm256_set1_pd(-1022.0)), _mm256_set1_pd(1023.0)),
+                                   _mm256_set1_pd(4503599627370496.0 + 1023.0));
+    __m256i bits = _mm256_slli_epi64(_mm256_castpd_si256(biased), 52);
+    return _mm256_mul_pd(x, _mm256_castsi256_pd(bits));
+}
+
+#include "hsluv-simd.h"
+
+#else
+
+/* ISO C forbids an empty translation unit. */
+typedef int hsluv_avx2_unused;
+
+#endif
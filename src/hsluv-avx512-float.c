@@ -0,0 +1,102 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* AVX-512 single precision kernels: 16 floats per vector. Only AVX-512F is
+ * needed. */
+
+#include "hsluv-internal.h"
+
+#ifdef HSLUV_HAVE_AVX512
+
+#include <immintrin.h>
+
+
+typedef __m512 vr;
+typedef __mmask16 vm;
+
+#define SIMD_FLOAT              1
+#define VR_WIDTH                16
+#define SIMD_NAME(fn)           hsluv_avx512_float_##fn
+
+static inline vr vr_set(double x)               { return _mm512_set1_ps((float) x); }
+static inline vr vr_loadu(const float* p)       { return _mm512_loadu_ps(p); }
+static inline void vr_storeu(float* p, vr x)    { _mm512_storeu_ps(p, x); }
+static inline vr vr_add(vr x, vr y)             { return _mm512_add_ps(x, y); }
+static inline vr vr_sub(vr x, vr y)             { return _mm512_sub_ps(x, y); }
+static inline vr vr_mul(vr x, vr y)             { return _mm512_mul_ps(x, y); }
+static inline vr vr_div(vr x, vr y)             { return _mm512_div_ps(x, y); }
+static inline vr vr_fma(vr x, vr y, vr z)       { return _mm512_fmadd_ps(x, y, z); }
+static inline vr vr_sqrt(vr x)                  { return _mm512_sqrt_ps(x); }
+static inline vr vr_min(vr x, vr y)             { return _mm512_min_ps(x, y); }
+static inline vr vr_max(vr x, vr y)             { return _mm512_max_ps(x, y); }
+static inline vr vr_round(vr x)                 { return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+static inline vr vr_floor(vr x)                 { return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+static inline vm vr_lt(vr x, vr y)              { return _mm512_cmp_ps_mask(x, y, _CMP_LT_OQ); }
+static inline vm vr_le(vr x, vr y)              { return _mm512_cmp_ps_mask(x, y, _CMP_LE_OQ); }
+static inline vm vr_gt(vr x, vr y)              { return _mm512_cmp_ps_mask(x, y, _CMP_GT_OQ); }
+static inline vm vr_ge(vr x, vr y)              { return _mm512_cmp_ps_mask(x, y, _CMP_GE_OQ); }
+static inline vr vr_sel(vm mask, vr x, vr y)    { return _mm512_mask_blend_ps(mask, y, x); }
+static inline vm vm_and(vm x, vm y)             { return (vm)(x & y); }
+static inline vm vm_or(vm x, vm y)              { return (vm)(x | y); }
+static inline int vm_any(vm x)                  { return x != 0; }
+
+/* Unbiased exponent of positive normal x, as a float. */
+static inline vr
+vr_exponent(vr x)
+{
+    __m512i e = _mm512_srli_epi32(_mm512_castps_si512(x), 23);
+    __m512 magic = _mm512_castsi512_ps(_mm512_or_si512(e, _mm512_set1_epi32(0x4b000000)));
+    return _mm512_sub_ps(magic, _mm512_set1_ps(8388608.0f + 127.0f));
+}
+
+/* Mantissa of positive x, scaled into [1, 2). */
+static inline vr
+vr_mantissa(vr x)
+{
+    __m512i bits = _mm512_and_si512(_mm512_castps_si512(x), _mm512_set1_epi32(0x007fffff));
+    return _mm512_castsi512_ps(_mm512_or_si512(bits, _mm512_set1_epi32(0x3f800000)));
+}
+
+/* x * 2^k for integral k. */
+static inline vr
+vr_ldexp(vr x, vr k)
+{
+    __m512 biased = _mm512_add_ps(_mm512_min_ps(_mm512_max_ps(k, _mm512_set1_ps(-126.0f)), _mm512_set1_ps(127.0f)),
+                                  _mm512_set1_ps(8388608.0f + 127.0f));
+    __m512i bits = _mm512_slli_epi32(_mm512_castps_si512(biased), 23);
+    return _mm512_mul_ps(x, _mm512_castsi512_ps(bits));
+}
+
+#include "hsluv-simd.h"
+
+#else
+
+/* ISO C forbids an empty translation unit. */
+typedef int hsluv_avx512_float_unused;
+
+#endif
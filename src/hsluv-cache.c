@@ -0,0 +1,322 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* For wall_time(), and the POSIX API of mmap() and friends (or <windows.h>). */
+#define HSLUV_WALL_TIME
+#include "hsluv-internal.h"
+#include "hsluv-cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+#define CACHE_COLORS        (256 * 256 * 256)
+#define CACHE_TABLE_SIZE    ((size_t) CACHE_COLORS * 3 * sizeof(uint16_t))
+
+/* The cache file is this header followed by the table. The header is padded
+ * to 64 bytes so that the table in a mapped file is well aligned. (Version 1
+ * had a 72-byte header.) */
+#define CACHE_MAGIC         "HSLuvC24"
+#define CACHE_VERSION       2
+#define CACHE_BYTE_ORDER    0x01020304u
+
+typedef struct CacheFileHeader_tag CacheFileHeader;
+struct CacheFileHeader_tag {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t entry_size;
+    uint32_t reserved[11];
+};
+
+/* Fails to compile if the header is not 64 bytes. */
+typedef char CacheFileHeaderSizeCheck[sizeof(CacheFileHeader) == 64 ? 1 : -1];
+
+#define CACHE_FILE_SIZE     (sizeof(CacheFileHeader) + CACHE_TABLE_SIZE)
+
+struct HsluvCache_tag {
+    const uint16_t* table;
+    void* storage;          /* malloc'ed table, or the whole mapped file. */
+    size_t footprint;
+    double build_time;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+    int is_mapped;
+};
+
+
+static uint16_t
+quantize16(double val, double max_val)
+{
+    return (uint16_t) (val / max_val * 65535.0 + 0.5);
+}
+
+static void
+init_header(CacheFileHeader* header)
+{
+    memset(header, 0, sizeof(CacheFileHeader));
+    memcpy(header->magic, CACHE_MAGIC, sizeof(header->magic));
+    header->version = CACHE_VERSION;
+    header->byte_order = CACHE_BYTE_ORDER;
+    header->entry_size = 3 * sizeof(uint16_t);
+}
+
+HsluvCache*
+hsluv_cache_build(void)
+{
+    HsluvCache* cache;
+    uint16_t* table;
+    unsigned char row[256 * 3];
+    double hsl[256 * 3];
+    double start = wall_time();
+    int r, g, b;
+
+    cache = (HsluvCache*) malloc(sizeof(HsluvCache));
+    if(cache == NULL)
+        return NULL;
+    table = (uint16_t*) malloc(CACHE_TABLE_SIZE);
+    if(table == NULL) {
+        free(cache);
+        return NULL;
+    }
+
+    /* One row of all the blues at a time. */
+    for(b = 0; b < 256; b++)
+        row[b * 3 + 2] = (unsigned char) b;
+
+    for(r = 0; r < 256; r++) {
+        for(g = 0; g < 256; g++) {
+            uint16_t* entry = table + (((size_t) r << 16) | ((size_t) g << 8)) * 3;
+
+            for(b = 0; b < 256; b++) {
+                row[b * 3] = (unsigned char) r;
+                row[b * 3 + 1] = (unsigned char) g;
+            }
+
+            rgb82hsluv_n(row, HSLUV_FORMAT_RGB8, hsl, 3, 256);
+
+            for(b = 0; b < 256 * 3; b += 3) {
+                entry[b] = quantize16(hsl[b], 360.0);
+                entry[b + 1] = quantize16(hsl[b + 1], 100.0);
+                entry[b + 2] = quantize16(hsl[b + 2], 100.0);
+            }
+        }
+    }
+
+    memset(cache, 0, sizeof(HsluvCache));
+    cache->table = table;
+    cache->storage = table;
+    cache->footprint = CACHE_TABLE_SIZE;
+    cache->build_time = wall_time() - start;
+    return cache;
+}
+
+HsluvCache*
+hsluv_cache_load(const char* path)
+{
+    HsluvCache* cache;
+    const CacheFileHeader* header;
+    CacheFileHeader expected;
+    void* data;
+
+    cache = (HsluvCache*) malloc(sizeof(HsluvCache));
+    if(cache == NULL)
+        return NULL;
+    memset(cache, 0, sizeof(HsluvCache));
+
+#ifdef _WIN32
+    {
+        LARGE_INTEGER size;
+
+        cache->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(cache->file == INVALID_HANDLE_VALUE)
+            goto err_file;
+        if(!GetFileSizeEx(cache->file, &size)  ||  (ULONGLONG) size.QuadPart != CACHE_FILE_SIZE)
+            goto err_mapping;
+        cache->mapping = CreateFileMappingA(cache->file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if(cache->mapping == NULL)
+            goto err_mapping;
+        data = MapViewOfFile(cache->mapping, FILE_MAP_READ, 0, 0, 0);
+        if(data == NULL)
+            goto err_view;
+    }
+#else
+    {
+        struct stat st;
+        int fd;
+
+        fd = open(path, O_RDONLY);
+        if(fd < 0)
+            goto err_file;
+        if(fstat(fd, &st) != 0  ||  (size_t) st.st_size != CACHE_FILE_SIZE) {
+            close(fd);
+            goto err_file;
+        }
+        data = mmap(NULL, CACHE_FILE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+        /* The mapping stays valid after closing the file. */
+        close(fd);
+        if(data == MAP_FAILED)
+            goto err_file;
+    }
+#endif
+
+    header = (const CacheFileHeader*) data;
+    init_header(&expected);
+    if(memcmp(header, &expected, sizeof(CacheFileHeader)) != 0)
+        goto err_header;
+
+    cache->table = (const uint16_t*) (header + 1);
+    cache->storage = data;
+    cache->footprint = CACHE_FILE_SIZE;
+    cache->build_time = 0.0;
+    cache->is_mapped = 1;
+    return cache;
+
+err_header:
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+err_view:
+    CloseHandle(cache->mapping);
+err_mapping:
+    CloseHandle(cache->file);
+#else
+    munmap(data, CACHE_FILE_SIZE);
+#endif
+err_file:
+    free(cache);
+    return NULL;
+}
+
+int
+hsluv_cache_save(const HsluvCache* cache, const char* path)
+{
+    CacheFileHeader header;
+    FILE* f;
+    int ret = 0;
+
+    f = fopen(path, "wb");
+    if(f == NULL)
+        return -1;
+
+    init_header(&header);
+    if(fwrite(&header, sizeof(CacheFileHeader), 1, f) != 1  ||
+       fwrite(cache->table, CACHE_TABLE_SIZE, 1, f) != 1)
+        ret = -1;
+
+    if(fclose(f) != 0)
+        ret = -1;
+    return ret;
+}
+
+void
+hsluv_cache_free(HsluvCache* cache)
+{
+    if(cache == NULL)
+        return;
+
+    if(cache->is_mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(cache->storage);
+        CloseHandle(cache->mapping);
+        CloseHandle(cache->file);
+#else
+        munmap(cache->storage, CACHE_FILE_SIZE);
+#endif
+    } else {
+        free(cache->storage);
+    }
+
+    free(cache);
+}
+
+size_t
+hsluv_cache_footprint(const HsluvCache* cache)
+{
+    return cache->footprint;
+}
+
+double
+hsluv_cache_build_time(const HsluvCache* cache)
+{
+    return cache->build_time;
+}
+
+void
+hsluv_cache_get(const HsluvCache* cache, unsigned char r, unsigned char g, unsigned char b,
+                double* ph, double* ps, double* pl)
+{
+    const uint16_t* entry = cache->table + (((size_t) r << 16) | ((size_t) g << 8) | b) * 3;
+
+    *ph = entry[0] * (360.0 / 65535.0);
+    *ps = entry[1] * (100.0 / 65535.0);
+    *pl = entry[2] * (100.0 / 65535.0);
+}
+
+void
+hsluv_cache_rgb82hsluv_n(const HsluvCache* cache, const unsigned char* in, HsluvFormat format,
+                         double* out, size_t out_stride, size_t n)
+{
+    const Rgb8Format* fmt = rgb8_format(format);
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        const unsigned char* pixel = in + i * fmt->size;
+
+        hsluv_cache_get(cache, pixel[fmt->r], pixel[fmt->g], pixel[fmt->b],
+                        &out[i * out_stride], &out[i * out_stride + 1], &out[i * out_stride + 2]);
+    }
+}
+
+void
+hsluv_cache_rgb82hsluv16_n(const HsluvCache* cache, const unsigned char* in, HsluvFormat format,
+                           uint16_t* out, size_t out_stride, size_t n)
+{
+    const Rgb8Format* fmt = rgb8_format(format);
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        const unsigned char* pixel = in + i * fmt->size;
+        const uint16_t* entry = cache->table +
+                (((size_t) pixel[fmt->r] << 16) | ((size_t) pixel[fmt->g] << 8) | pixel[fmt->b]) * 3;
+
+        out[i * out_stride] = entry[0];
+        out[i * out_stride + 1] = entry[1];
+        out[i * out_stride + 2] = entry[2];
+    }
+}
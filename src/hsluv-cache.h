@@ -0,0 +1,149 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_CACHE_H
+#define HSLUV_CACHE_H
+
+#include "hsluv.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Precomputed RGB to HSLuv conversion of all the 2^24 8-bit RGB colors.
+ *
+ * The cache turns rgb82hsluv_n() into one table load per pixel. Each entry
+ * holds the HSLuv color quantized to three 16-bit values:
+ *
+ *  - H16 = round(h / 360.0 * 65535.0)
+ *  - S16 = round(s / 100.0 * 65535.0)
+ *  - L16 = round(l / 100.0 * 65535.0)
+ *
+ * So the cached values are off by at most 0.0028 in hue and by 0.00077 in
+ * saturation and lightness (on top of the error of rgb82hsluv_n(), which the
+ * cache is built with).
+ *
+ * The table takes 96 MiB (see hsluv_cache_footprint()) and building it takes
+ * (depending on the machine) about a second or two of CPU time. To share the
+ * cost, build it once, save it with hsluv_cache_save(), and let each process
+ * map the file into its memory with hsluv_cache_load(). The mapping is
+ * read-only and shared, so all the processes use the same physical memory.
+ *
+ * The lookups do not modify the cache, so one cache may be used by many
+ * threads at once.
+ */
+typedef struct HsluvCache_tag HsluvCache;
+
+/**
+ * Build the cache in memory.
+ *
+ * @return The cache, or NULL if out of memory.
+ */
+HsluvCache* hsluv_cache_build(void);
+
+/**
+ * Map a cache file saved by hsluv_cache_save() into memory.
+ *
+ * The file must have been saved on a machine of the same byte order.
+ *
+ * @param path Path to the file.
+ * @return The cache, or NULL if the file cannot be mapped or is not a valid
+ * cache file.
+ */
+HsluvCache* hsluv_cache_load(const char* path);
+
+/**
+ * Save the cache into a file.
+ *
+ * @param cache The cache.
+ * @param path Path to the file. It is overwritten if it exists.
+ * @return 0 on success, -1 on failure.
+ */
+int hsluv_cache_save(const HsluvCache* cache, const char* path);
+
+/**
+ * Destroy the cache (or unmap it if loaded by hsluv_cache_load()).
+ *
+ * @param cache The cache.
+ */
+void hsluv_cache_free(HsluvCache* cache);
+
+/**
+ * Get the memory footprint of the cache.
+ *
+ * @param cache The cache.
+ * @return Size of the table in bytes. For a loaded cache, this is the size of
+ * the mapping, which the processes mapping the same file share.
+ */
+size_t hsluv_cache_footprint(const HsluvCache* cache);
+
+/**
+ * Get how long building the cache took.
+ *
+ * @param cache The cache.
+ * @return The wall time of hsluv_cache_build() in seconds, or 0.0 if the cache
+ * has been loaded by hsluv_cache_load().
+ */
+double hsluv_cache_build_time(const HsluvCache* cache);
+
+/**
+ * Look up the HSLuv color of an 8-bit RGB color.
+ *
+ * @param cache The cache.
+ * @param r Red component.
+ * @param g Green component.
+ * @param b Blue component.
+ * @param[out] ph Hue. Between 0.0 and 360.0.
+ * @param[out] ps Saturation. Between 0.0 and 100.0.
+ * @param[out] pl Lightness. Between 0.0 and 100.0.
+ */
+void hsluv_cache_get(const HsluvCache* cache, unsigned char r, unsigned char g, unsigned char b,
+                     double* ph, double* ps, double* pl);
+
+/**
+ * Convert 8-bit RGB pixels to HSLuv by looking them up in the cache.
+ *
+ * These are the cached counterparts of rgb82hsluv_n(). The @c 16 variant
+ * stores the quantized values as they are in the cache (see HsluvCache).
+ */
+void hsluv_cache_rgb82hsluv_n(const HsluvCache* cache, const unsigned char* in, HsluvFormat format,
+                              double* out, size_t out_stride, size_t n);
+void hsluv_cache_rgb82hsluv16_n(const HsluvCache* cache, const unsigned char* in, HsluvFormat format,
+                                uint16_t* out, size_t out_stride, size_t n);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HSLUV_CACHE_H */
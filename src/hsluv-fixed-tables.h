@@ -0,0 +1,235 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_FIXED_TABLES_H
+#define HSLUV_FIXED_TABLES_H
+
+/* This header is private to the fixed-point library (see hsluv-fixed.c).
+ *
+ * All the values are in the Q4.28 format, i.e. scaled by 2^28 and rounded to
+ * the nearest integer. */
+
+
+/* to_linear(i / 1024.0) of hsluv.c, for linear interpolation between the
+ * samples. (The interpolation error is below 4e-7.) */
+static const int32_t fixed_to_linear[1025] = {
+    0, 20290, 40580, 60869, 81159, 101449, 121739, 142028,
+    162318, 182608, 202898, 223188, 243477, 263767, 284057, 304347,
+    324637, 344926, 365216, 385506, 405796, 426085, 446375, 466665,
+    486955, 507245, 527534, 547824, 568114, 588404, 608693, 628983,
+    649273, 669563, 689853, 710142, 730432, 750722, 771012, 791302,
+    811591, 831881, 852422, 873378, 894631, 916184, 938036, 960189,
+    982644, 1005403, 1028466, 1051835, 1075511, 1099495, 1123788, 1148391,
+    1173306, 1198533, 1224073, 1249929, 1276100, 1302588, 1329394, 1356519,
+    1383964, 1411731, 1439819, 1468231, 1496968, 1526030, 1555418, 1585134,
+    1615178, 1645553, 1676257, 1707293, 1738662, 1770365, 1802402, 1834775,
+    1867485, 1900532, 1933918, 1967643, 2001710, 2036117, 2070868, 2105961,
+    2141400, 2177183, 2213314, 2249791, 2286617, 2323792, 2361317, 2399194,
+    2437422, 2476003, 2514939, 2554229, 2593875, 2633877, 2674237, 2714956,
+    2756034, 2797472, 2839272, 2881433, 2923958, 2966846, 3010099, 3053718,
+    3097703, 3142056, 3186777, 3231867, 3277327, 3323157, 3369360, 3415935,
+    3462883, 3510206, 3557904, 3605978, 3654428, 3703256, 3752463, 3802049,
+    3852015, 3902362, 3953091, 4004203, 4055697, 4107577, 4159841, 4212491,
+    4265528, 4318952, 4372764, 4426966, 4481558, 4536540, 4591914, 4647680,
+    4703839, 4760392, 4817339, 4874682, 4932422, 4990558, 5049092, 5108024,
+    5167356, 5227088, 5287221, 5347755, 5408692, 5470032, 5531776, 5593924,
+    5656478, 5719438, 5782805, 5846579, 5910762, 5975354, 6040356, 6105769,
+    6171593, 6237829, 6304478, 6371540, 6439017, 6506909, 6575216, 6643940,
+    6713081, 6782641, 6852618, 6923015, 6993832, 7065070, 7136730, 7208811,
+    7281316, 7354244, 7427597, 7501374, 7575577, 7650207, 7725264, 7800748,
+    7876661, 7953003, 8029775, 8106978, 8184612, 8262678, 8341177, 8420108,
+    8499474, 8579275, 8659511, 8740183, 8821291, 8902837, 8984821, 9067244,
+    9150106, 9233409, 9317151, 9401336, 9485962, 9571031, 9656544, 9742500,
+    9828901, 9915748, 10003040, 10090779, 10178966, 10267600, 10356683, 10446215,
+    10536197, 10626630, 10717513, 10808849, 10900637, 10992878, 11085572, 11178722,
+    11272326, 11366385, 11460901, 11555874, 11651304, 11747193, 11843540, 11940347,
+    12037614, 12135341, 12233529, 12332180, 12431293, 12530869, 12630908, 12731413,
+    12832382, 12933816, 13035717, 13138085, 13240920, 13344223, 13447994, 13552235,
+    13656946, 13762127, 13867779, 13973903, 14080499, 14187568, 14295110, 14403126,
+    14511617, 14620583, 14730025, 14839944, 14950339, 15061212, 15172563, 15284392,
+    15396702, 15509491, 15622760, 15736511, 15850743, 15965458, 16080655, 16196336,
+    16312501, 16429150, 16546285, 16663905, 16782011, 16900605, 17019686, 17139255,
+    17259312, 17379859, 17500895, 17622421, 17744439, 17866948, 17989948, 18113442,
+    18237428, 18361908, 18486883, 18612352, 18738316, 18864776, 18991733, 19119187,
+    19247138, 19375588, 19504536, 19633983, 19763930, 19894378, 20025326, 20156776,
+    20288727, 20421181, 20554139, 20687599, 20821564, 20956034, 21091009, 21226490,
+    21362477, 21498970, 21635972, 21773481, 21911498, 22050025, 22189061, 22328607,
+    22468664, 22609232, 22750311, 22891903, 23034007, 23176625, 23319757, 23463402,
+    23607563, 23752239, 23897431, 24043139, 24189364, 24336107, 24483367, 24631147,
+    24779445, 24928262, 25077600, 25227458, 25377838, 25528739, 25680162, 25832108,
+    25984577, 26137569, 26291086, 26445127, 26599694, 26754786, 26910405, 27066550,
+    27223223, 27380423, 27538152, 27696409, 27855196, 28014512, 28174359, 28334736,
+    28495645, 28657085, 28819058, 28981563, 29144602, 29308175, 29472281, 29636923,
+    29802100, 29967812, 30134061, 30300847, 30468170, 30636031, 30804429, 30973367,
+    31142844, 31312860, 31483417, 31654515, 31826153, 31998333, 32171056, 32344321,
+    32518129, 32692481, 32867377, 33042817, 33218803, 33395334, 33572411, 33750035,
+    33928205, 34106923, 34286190, 34466004, 34646367, 34827280, 35008743, 35190756,
+    35373320, 35556435, 35740101, 35924321, 36109092, 36294417, 36480296, 36666729,
+    36853716, 37041258, 37229356, 37418010, 37607221, 37796988, 37987313, 38178196,
+    38369637, 38561637, 38754196, 38947315, 39140994, 39335234, 39530034, 39725397,
+    39921321, 40117808, 40314858, 40512472, 40710649, 40909391, 41108698, 41308569,
+    41509007, 41710011, 41911581, 42113718, 42316423, 42519696, 42723538, 42927948,
+    43132928, 43338477, 43544597, 43751288, 43958549, 44166383, 44374788, 44583766,
+    44793317, 45003441, 45214140, 45425412, 45637259, 45849682, 46062680, 46276254,
+    46490405, 46705132, 46920438, 47136320, 47352782, 47569822, 47787441, 48005640,
+    48224419, 48443778, 48663719, 48884241, 49105344, 49327030, 49549299, 49772151,
+    49995586, 50219605, 50444209, 50669398, 50895172, 51121531, 51348477, 51576010,
+    51804129, 52032837, 52262132, 52492015, 52722487, 52953548, 53185199, 53417440,
+    53650272, 53883694, 54117708, 54352314, 54587511, 54823302, 55059685, 55296662,
+    55534233, 55772398, 56011158, 56250513, 56490464, 56731011, 56972154, 57213894,
+    57456231, 57699166, 57942699, 58186831, 58431562, 58676892, 58922822, 59169352,
+    59416483, 59664214, 59912548, 60161483, 60411020, 60661161, 60911904, 61163251,
+    61415202, 61667757, 61920917, 62174682, 62429053, 62684030, 62939614, 63195804,
+    63452602, 63710007, 63968020, 64226642, 64485873, 64745713, 65006162, 65267222,
+    65528893, 65791174, 66054067, 66317571, 66581688, 66846417, 67111760, 67377715,
+    67644285, 67911468, 68179266, 68447680, 68716708, 68986353, 69256613, 69527491,
+    69798985, 70071097, 70343826, 70617174, 70891140, 71165725, 71440930, 71716755,
+    71993199, 72270265, 72547951, 72826259, 73105188, 73384740, 73664915, 73945712,
+    74227133, 74509177, 74791846, 75075139, 75359057, 75643601, 75928770, 76214565,
+    76500987, 76788036, 77075712, 77364016, 77652948, 77942509, 78232698, 78523517,
+    78814965, 79107043, 79399752, 79693091, 79987062, 80281664, 80576899, 80872765,
+    81169265, 81466397, 81764163, 82062563, 82361598, 82661267, 82961571, 83262510,
+    83564086, 83866297, 84169145, 84472630, 84776753, 85081513, 85386912, 85692948,
+    85999624, 86306939, 86614894, 86923489, 87232724, 87542600, 87853117, 88164275,
+    88476076, 88788519, 89101604, 89415333, 89729705, 90044721, 90360381, 90676685,
+    90993635, 91311229, 91629470, 91948356, 92267889, 92588069, 92908896, 93230371,
+    93552493, 93875264, 94198683, 94522752, 94847470, 95172837, 95498855, 95825524,
+    96152843, 96480814, 96809436, 97138710, 97468636, 97799216, 98130448, 98462334,
+    98794874, 99128068, 99461917, 99796420, 100131579, 100467393, 100803864, 101140991,
+    101478775, 101817216, 102156314, 102496071, 102836485, 103177558, 103519291, 103861682,
+    104204733, 104548444, 104892816, 105237849, 105583542, 105929897, 106276914, 106624593,
+    106972935, 107321940, 107671608, 108021940, 108372935, 108724595, 109076920, 109429910,
+    109783566, 110137887, 110492874, 110848528, 111204849, 111561837, 111919493, 112277817,
+    112636809, 112996469, 113356799, 113717798, 114079467, 114441806, 114804815, 115168495,
+    115532847, 115897870, 116263564, 116629931, 116996971, 117364683, 117733069, 118102128,
+    118471861, 118842269, 119213351, 119585108, 119957541, 120330650, 120704434, 121078895,
+    121454033, 121829847, 122206340, 122583510, 122961358, 123339885, 123719091, 124098975,
+    124479540, 124860784, 125242709, 125625314, 126008600, 126392568, 126777217, 127162548,
+    127548561, 127935257, 128322636, 128710699, 129099445, 129488875, 129878990, 130269789,
+    130661274, 131053444, 131446299, 131839841, 132234069, 132628984, 133024586, 133420876,
+    133817853, 134215519, 134613873, 135012916, 135412648, 135813069, 136214181, 136615982,
+    137018475, 137421658, 137825532, 138230098, 138635355, 139041305, 139447948, 139855283,
+    140263312, 140672034, 141081450, 141491560, 141902365, 142313865, 142726060, 143138951,
+    143552537, 143966820, 144381799, 144797476, 145213849, 145630921, 146048690, 146467157,
+    146886323, 147306188, 147726752, 148148016, 148569980, 148992644, 149416008, 149840074,
+    150264840, 150690309, 151116479, 151543351, 151970926, 152399204, 152828185, 153257870,
+    153688258, 154119351, 154551149, 154983651, 155416858, 155850771, 156285390, 156720715,
+    157156747, 157593485, 158030930, 158469084, 158907944, 159347513, 159787791, 160228777,
+    160670473, 161112877, 161555992, 161999817, 162444352, 162889598, 163335555, 163782223,
+    164229604, 164677696, 165126500, 165576018, 166026248, 166477191, 166928849, 167381220,
+    167834305, 168288106, 168742621, 169197851, 169653797, 170110459, 170567837, 171025932,
+    171484744, 171944272, 172404519, 172865483, 173327165, 173789566, 174252686, 174716524,
+    175181082, 175646360, 176112358, 176579077, 177046516, 177514676, 177983557, 178453160,
+    178923485, 179394533, 179866302, 180338795, 180812011, 181285951, 181760615, 182236002,
+    182712114, 183188952, 183666514, 184144801, 184623815, 185103554, 185584020, 186065212,
+    186547132, 187029779, 187513153, 187997256, 188482087, 188967646, 189453934, 189940952,
+    190428699, 190917176, 191406383, 191896320, 192386988, 192878387, 193370518, 193863380,
+    194356975, 194851301, 195346361, 195842153, 196338678, 196835937, 197333930, 197832657,
+    198332119, 198832315, 199333247, 199834914, 200337316, 200840455, 201344330, 201848942,
+    202354290, 202860376, 203367199, 203874761, 204383060, 204892098, 205401875, 205912391,
+    206423646, 206935641, 207448376, 207961851, 208476067, 208991024, 209506722, 210023161,
+    210540343, 211058266, 211576932, 212096341, 212616493, 213137388, 213659027, 214181410,
+    214704537, 215228409, 215753025, 216278387, 216804494, 217331347, 217858947, 218387292,
+    218916384, 219446223, 219976810, 220508144, 221040226, 221573056, 222106635, 222640962,
+    223176038, 223711864, 224248440, 224785766, 225323841, 225862668, 226402245, 226942574,
+    227483654, 228025486, 228568069, 229111406, 229655495, 230200337, 230745932, 231292280,
+    231839383, 232387240, 232935851, 233485217, 234035338, 234586215, 235137847, 235690235,
+    236243379, 236797280, 237351937, 237907352, 238463524, 239020454, 239578142, 240136588,
+    240695793, 241255756, 241816479, 242377961, 242940203, 243503206, 244066968, 244631491,
+    245196775, 245762821, 246329628, 246897196, 247465527, 248034620, 248604476, 249175095,
+    249746477, 250318623, 250891533, 251465206, 252039644, 252614847, 253190815, 253767549,
+    254345048, 254923312, 255502343, 256082141, 256662705, 257244036, 257826135, 258409001,
+    258992636, 259577038, 260162209, 260748149, 261334857, 261922336, 262510583, 263099601,
+    263689389, 264279948, 264871277, 265463377, 266056249, 266649893, 267244308, 267839496,
+    268435456,
+};
+
+/* Cube root of (64 + i) / 512.0, i.e. samples over [1/8, 1], which is all
+ * the table needs to hold after the argument is scaled by a power of 8. */
+static const int32_t fixed_cbrt[449] = {
+    134217728, 134913169, 135601513, 136282940, 136957619, 137625715, 138287387, 138942788,
+    139592062, 140235353, 140872795, 141504520, 142130654, 142751320, 143366635, 143976713,
+    144581665, 145181595, 145776609, 146366804, 146952277, 147533122, 148109429, 148681286,
+    149248777, 149811986, 150370991, 150925870, 151476700, 152023552, 152566497, 153105606,
+    153640945, 154172579, 154700571, 155224984, 155745877, 156263309, 156777337, 157288016,
+    157795400, 158299542, 158800493, 159298304, 159793022, 160284696, 160773372, 161259095,
+    161741909, 162221859, 162698984, 163173328, 163644930, 164113829, 164580064, 165043672,
+    165504691, 165963155, 166419100, 166872560, 167323569, 167772160, 168218365, 168662215,
+    169103741, 169542973, 169979942, 170414675, 170847201, 171277549, 171705744, 172131815,
+    172555787, 172977685, 173397535, 173815362, 174231190, 174645043, 175056943, 175466914,
+    175874978, 176281157, 176685473, 177087947, 177488600, 177887452, 178284523, 178679834,
+    179073403, 179465250, 179855393, 180243851, 180630642, 181015783, 181399292, 181781186,
+    182161483, 182540198, 182917348, 183292949, 183667018, 184039568, 184410617, 184780178,
+    185148267, 185514899, 185880086, 186243845, 186606188, 186967129, 187326682, 187684860,
+    188041676, 188397144, 188751274, 189104081, 189455577, 189805773, 190154681, 190502314,
+    190848682, 191193798, 191537673, 191880317, 192221742, 192561958, 192900976, 193238807,
+    193575461, 193910947, 194245277, 194578460, 194910506, 195241424, 195571225, 195899916,
+    196227509, 196554011, 196879432, 197203781, 197527067, 197849297, 198170482, 198490628,
+    198809746, 199127842, 199444925, 199761003, 200076084, 200390176, 200703286, 201015422,
+    201326592, 201636803, 201946062, 202254377, 202561755, 202868203, 203173728, 203478337,
+    203782036, 204084833, 204386734, 204687746, 204987875, 205287128, 205585511, 205883030,
+    206179692, 206475503, 206770468, 207064594, 207357887, 207650353, 207941997, 208232825,
+    208522844, 208812057, 209100472, 209388094, 209674927, 209960978, 210246251, 210530752,
+    210814487, 211097460, 211379676, 211661141, 211941859, 212221835, 212501075, 212779582,
+    213057363, 213334421, 213610761, 213886388, 214161306, 214435521, 214709036, 214981856,
+    215253985, 215525428, 215796189, 216066272, 216335682, 216604422, 216872497, 217139911,
+    217406668, 217672772, 217938227, 218203036, 218467205, 218730736, 218993634, 219255902,
+    219517544, 219778564, 220038965, 220298752, 220557927, 220816495, 221074458, 221331821,
+    221588587, 221844759, 222100340, 222355335, 222609747, 222863578, 223116832, 223369513,
+    223621623, 223873166, 224124145, 224374563, 224624424, 224873730, 225122484, 225370690,
+    225618350, 225865468, 226112046, 226358088, 226603596, 226848573, 227093022, 227336946,
+    227580348, 227823230, 228065595, 228307446, 228548786, 228789618, 229029943, 229269765,
+    229509086, 229747910, 229986238, 230224073, 230461417, 230698274, 230934645, 231170534,
+    231405942, 231640872, 231875326, 232109308, 232342818, 232575860, 232808436, 233040549,
+    233272199, 233503391, 233734126, 233964406, 234194233, 234423611, 234652540, 234881024,
+    235109064, 235336662, 235563822, 235790543, 236016830, 236242684, 236468106, 236693100,
+    236917666, 237141808, 237365527, 237588825, 237811704, 238034166, 238256213, 238477846,
+    238699069, 238919882, 239140288, 239360289, 239579885, 239799080, 240017875, 240236272,
+    240454272, 240671878, 240889091, 241105913, 241322346, 241538391, 241754050, 241969326,
+    242184219, 242398731, 242612864, 242826620, 243040000, 243253007, 243465640, 243677904,
+    243889797, 244101324, 244312484, 244523280, 244733714, 244943785, 245153498, 245362852,
+    245571849, 245780492, 245988780, 246196717, 246404303, 246611539, 246818428, 247024971,
+    247231169, 247437023, 247642536, 247847708, 248052541, 248257036, 248461195, 248665019,
+    248868509, 249071667, 249274494, 249476992, 249679161, 249881004, 250082521, 250283714,
+    250484584, 250685132, 250885360, 251085268, 251284859, 251484134, 251683093, 251881738,
+    252080070, 252278090, 252475801, 252673202, 252870295, 253067081, 253263562, 253459738,
+    253655611, 253851182, 254046452, 254241423, 254436095, 254630469, 254824548, 255018331,
+    255211819, 255405015, 255597920, 255790533, 255982857, 256174892, 256366640, 256558101,
+    256749277, 256940169, 257130777, 257321104, 257511149, 257700914, 257890400, 258079608,
+    258268539, 258457194, 258645574, 258833680, 259021513, 259209074, 259396364, 259583383,
+    259770134, 259956617, 260142832, 260328781, 260514465, 260699885, 260885041, 261069935,
+    261254567, 261438939, 261623051, 261806904, 261990499, 262173838, 262356920, 262539747,
+    262722320, 262904640, 263086707, 263268522, 263450086, 263631401, 263812467, 263993284,
+    264173854, 264354178, 264534255, 264714088, 264893677, 265073023, 265252127, 265430989,
+    265609610, 265787991, 265966133, 266144037, 266321703, 266499133, 266676326, 266853285,
+    267030009, 267206499, 267382757, 267558783, 267734577, 267910141, 268085475, 268260579,
+    268435456,
+};
+
+
+#endif  /* HSLUV_FIXED_TABLES_H */
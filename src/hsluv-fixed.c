@@ -0,0 +1,549 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "hsluv-fixed.h"
+#include "hsluv-fixed-tables.h"
+
+
+/* This is the pipeline of hsluv.c (see there for the formulas) rewritten with
+ * integers. Besides the public Q16.16 format, it uses:
+ *  - Q16 (16 fractional bits) for lightness, chroma and the u, v coordinates,
+ *    i.e. same as the public values;
+ *  - Q28 (28 fractional bits) for all the values around 1.0 (XYZ, linear RGB,
+ *    the variables of the bounds);
+ *  - Q30 (30 fractional bits) for the sine and cosine.
+ *
+ * Products are computed in 64 bits and shifted back with rounding. (Right
+ * shift of a negative number is assumed to be arithmetic, as it is with all
+ * the relevant compilers.)
+ *
+ * The macros below convert compile-time constants. They are evaluated by the
+ * compiler, so no floating point code makes it into the library. */
+
+#define Q16(x)      ((int64_t) ((x) * 65536.0 + ((x) >= 0.0 ? 0.5 : -0.5)))
+#define Q28(x)      ((int64_t) ((x) * 268435456.0 + ((x) >= 0.0 ? 0.5 : -0.5)))
+#define Q30(x)      ((int64_t) ((x) * 1073741824.0 + ((x) >= 0.0 ? 0.5 : -0.5)))
+
+#define ONE16       ((int64_t) 1 << 16)
+#define ONE28       ((int64_t) 1 << 28)
+#define ONE30       ((int64_t) 1 << 30)
+
+/* Left shift of a possibly negative number. */
+#define SHL(x, n)   ((x) * ((int64_t) 1 << (n)))
+
+#define CLAMP(val, min_val, max_val)        \
+    ((val) < (min_val) ? (min_val) : ((val) > (max_val) ? (max_val) : (val)))
+
+/* White, black and grays: thresholds where the hue or the saturation are taken
+ * as undefined. These are coarser than in hsluv.c, to be above the rounding
+ * noise of the fixed-point pipeline. */
+#define WHITE_L     (100 * ONE16 - 66)      /* 99.999 */
+#define BLACK_L     66                      /* 0.001 */
+#define GRAY_C      66                      /* 0.001 */
+
+
+/* for RGB */
+static const int64_t m[3][3] = {
+    { Q28( 3.24096994190452134377), Q28(-1.53738317757009345794), Q28(-0.49861076029300328366) },
+    { Q28(-0.96924363628087982613), Q28( 1.87596750150772066772), Q28( 0.04155505740717561247) },
+    { Q28( 0.05563007969699360846), Q28(-0.20397695888897656435), Q28( 1.05697151424287856072) }
+};
+
+static const int64_t m_inv[3][3] = {
+    { Q28( 0.41239079926595948129), Q28( 0.35758433938387796373), Q28( 0.18048078840183428751) },
+    { Q28( 0.21263900587151035754), Q28( 0.71516867876775592746), Q28( 0.07219231536073371500) },
+    { Q28( 0.01933081871559185069), Q28( 0.11919477979462598791), Q28( 0.95053215224966058086) }
+};
+
+/* for XYZ */
+static const int64_t ref_u = Q28(0.19783000664283680764);
+static const int64_t ref_v = Q28(0.46831999493879100370);
+
+/* kappa = 24389 / 27, epsilon = 216 / 24389 */
+static const int64_t epsilon = Q28(0.00885645167903563082);
+
+/* Coefficients of the bounds (see get_bounds() in hsluv.c), divided by
+ * 126452 to get them to the Q28 range:
+ *   top1 = K1 * sub2
+ *   top2 = (K2 * sub2 - K6 * t) * l
+ *   bottom = K3 * sub2 + t */
+#define K1(m1, m2, m3)  Q28((284517.0 * (m1) - 94839.0 * (m3)) / 126452.0)
+#define K2(m1, m2, m3)  Q28((838422.0 * (m3) + 769860.0 * (m2) + 731718.0 * (m1)) / 126452.0)
+#define K3(m1, m2, m3)  Q28((632260.0 * (m3) - 126452.0 * (m2)) / 126452.0)
+#define K(k, row)       k(row)
+
+#define M0  3.24096994190452134377, -1.53738317757009345794, -0.49861076029300328366
+#define M1  -0.96924363628087982613, 1.87596750150772066772, 0.04155505740717561247
+#define M2  0.05563007969699360846, -0.20397695888897656435, 1.05697151424287856072
+
+static const int64_t k1[3] = { K(K1, M0), K(K1, M1), K(K1, M2) };
+static const int64_t k2[3] = { K(K2, M0), K(K2, M1), K(K2, M2) };
+static const int64_t k3[3] = { K(K3, M0), K(K3, M1), K(K3, M2) };
+static const int64_t k6 = Q28(769860.0 / 126452.0);
+
+
+static int64_t
+mul_shift(int64_t a, int64_t b, int shift)
+{
+    return (a * b + ((int64_t) 1 << (shift - 1))) >> shift;
+}
+
+/* Division rounded to the nearest integer. */
+static int64_t
+div_round(int64_t num, int64_t den)
+{
+    if((num < 0) != (den < 0))
+        return (num - den / 2) / den;
+    else
+        return (num + den / 2) / den;
+}
+
+static uint64_t
+isqrt(uint64_t x)
+{
+    uint64_t res = 0;
+    uint64_t bit = (uint64_t) 1 << 62;
+
+    while(bit > x)
+        bit >>= 2;
+
+    while(bit != 0) {
+        if(x >= res + bit) {
+            x -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return res;
+}
+
+/* Cube root of a non-negative Q28 number. */
+static int64_t
+cbrt_q28(int64_t x)
+{
+    int e = 0;
+    int64_t y, y2;
+    int i;
+
+    if(x <= 0)
+        return 0;
+
+    /* Scale to [1/8, 1) by powers of 8; the root then scales by powers of 2. */
+    while(x < ONE28 / 8) {
+        x *= 8;
+        e++;
+    }
+    while(x >= ONE28) {
+        x /= 8;
+        e--;
+    }
+
+    /* Initial estimate from the table... */
+    i = (int) (x >> 19) - 64;
+    y = fixed_cbrt[i] + (((fixed_cbrt[i + 1] - fixed_cbrt[i]) * (x & 0x7ffff)) >> 19);
+
+    /* ...and one Newton step. */
+    y2 = mul_shift(y, y, 28);
+    y = (2 * y + div_round(SHL(x, 28), y2)) / 3;
+
+    if(e > 0)
+        return (y + ((int64_t) 1 << (e - 1))) >> e;
+    else
+        return SHL(y, -e);
+}
+
+static int64_t
+to_linear(int64_t c)
+{
+    int i;
+
+    c = CLAMP(c, 0, ONE16);
+    if(c == ONE16)
+        return fixed_to_linear[1024];
+
+    i = (int) (c >> 6);
+    return fixed_to_linear[i] + (((fixed_to_linear[i + 1] - fixed_to_linear[i]) * (c & 63)) >> 6);
+}
+
+/* from_linear() of hsluv.c, with c^(1/2.4) = c^(5/12) = cbrt(c) * cbrt(c)^(1/4).
+ * Takes Q28, returns Q16. */
+static int64_t
+from_linear(int64_t c)
+{
+    int64_t r, r4;
+
+    c = CLAMP(c, 0, ONE28);
+    if(c <= Q28(0.0031308))
+        return mul_shift(c, Q16(12.92), 28);
+
+    r = cbrt_q28(c);
+    r4 = (int64_t) isqrt((uint64_t) isqrt((uint64_t) r << 28) << 28);
+    return mul_shift(mul_shift(r, r4, 28), Q16(1.055), 28) - Q16(0.055);
+}
+
+/* Sine and cosine (Q30) of an angle in degrees (Q16). */
+static void
+sincos_q30(int64_t h, int64_t* ps, int64_t* pc)
+{
+    int64_t q, x, x2, s, c;
+
+    /* Reduce to the nearest multiple of 90 degrees. */
+    q = (h + 45 * ONE16) / (90 * ONE16);
+    if(h + 45 * ONE16 < 0  &&  (h + 45 * ONE16) % (90 * ONE16) != 0)
+        q--;
+    x = mul_shift(h - q * 90 * ONE16, Q30(0.01745329251994329577), 16);  /* (pi / 180.0) */
+    x2 = mul_shift(x, x, 30);
+
+    /* Taylor series; the error is below 2e-9 for |x| <= pi / 4. */
+    s = Q30(1.0 / 362880.0);
+    s = Q30(-1.0 / 5040.0) + mul_shift(x2, s, 30);
+    s = Q30(1.0 / 120.0) + mul_shift(x2, s, 30);
+    s = Q30(-1.0 / 6.0) + mul_shift(x2, s, 30);
+    s = x + mul_shift(mul_shift(x, x2, 30), s, 30);
+
+    c = Q30(-1.0 / 3628800.0);
+    c = Q30(1.0 / 40320.0) + mul_shift(x2, c, 30);
+    c = Q30(-1.0 / 720.0) + mul_shift(x2, c, 30);
+    c = Q30(1.0 / 24.0) + mul_shift(x2, c, 30);
+    c = Q30(-1.0 / 2.0) + mul_shift(x2, c, 30);
+    c = ONE30 + mul_shift(x2, c, 30);
+
+    switch((int) (((q % 4) + 4) % 4)) {
+        case 0:     *ps = s;  *pc = c;  break;
+        case 1:     *ps = c;  *pc = -s; break;
+        case 2:     *ps = -s; *pc = -c; break;
+        default:    *ps = -c; *pc = s;  break;
+    }
+}
+
+/* atan2(v, u) in degrees (Q16), in the range [0, 360). */
+static int64_t
+atan2_q16(int64_t v, int64_t u)
+{
+    int64_t au = (u < 0 ? -u : u);
+    int64_t av = (v < 0 ? -v : v);
+    int swapped = (av > au);
+    int64_t t, t2, p, a = 0;
+
+    if(au == 0  &&  av == 0)
+        return 0;
+
+    t = (swapped ? div_round(SHL(au, 30), av) : div_round(SHL(av, 30), au));
+
+    /* Reduce to [0, tan(pi/8)] with atan(t) = pi/4 + atan((t - 1) / (t + 1)),
+     * and use the minimax polynomial of Cephes' atanf(). */
+    if(t > Q30(0.4142135623730950488)) {
+        t = div_round(SHL(t - ONE30, 30), t + ONE30);
+        a = 45 * ONE16;
+    }
+    t2 = mul_shift(t, t, 30);
+    p = Q30(8.05374449538e-2);
+    p = Q30(-1.38776856032e-1) + mul_shift(t2, p, 30);
+    p = Q30(1.99777106478e-1) + mul_shift(t2, p, 30);
+    p = Q30(-3.33329491539e-1) + mul_shift(t2, p, 30);
+    t = t + mul_shift(mul_shift(t, t2, 30), p, 30);
+    a += mul_shift(t, Q16(57.29577951308232087680), 30);  /* (180 / pi) */
+
+    if(swapped)
+        a = 90 * ONE16 - a;
+    if(u < 0)
+        a = 180 * ONE16 - a;
+    if(v < 0)
+        a = 360 * ONE16 - a;
+    return (a >= 360 * ONE16 ? a - 360 * ONE16 : a);
+}
+
+
+/* Bounds of the RGB gamut for a lightness, with the variables of get_bounds()
+ * in hsluv.c. */
+typedef struct FixedBounds_tag FixedBounds;
+struct FixedBounds_tag {
+    int64_t l;          /* Q16 */
+    int64_t sub2;       /* Q28 */
+};
+
+static void
+get_bounds(int64_t l, FixedBounds* bounds)
+{
+    bounds->l = l;
+    if(l > 8 * ONE16) {
+        /* ((l + 16) / 116)^3 */
+        int64_t t = div_round(SHL(l + 16 * ONE16, 12), 116);
+        bounds->sub2 = mul_shift(mul_shift(t, t, 28), t, 28);
+    } else {
+        /* l / kappa */
+        bounds->sub2 = div_round(SHL(l, 12) * 27, 24389);
+    }
+}
+
+/* Note the line (t, channel) of the bounds is v = (top1 / bottom) * u + (top2 / bottom),
+ * so the ray at hue h hits it at distance top2 / (bottom * sin(h) - top1 * cos(h)),
+ * and its distance from the pole is |top2| / sqrt(bottom^2 + top1^2). */
+
+static int64_t
+max_chroma_for_bounds(const FixedBounds* bounds, int64_t sin_h, int64_t cos_h)
+{
+    int64_t min_len = INT64_MAX;
+    int channel, t;
+
+    for(channel = 0; channel < 3; channel++) {
+        for(t = 0; t < 2; t++) {
+            int64_t top1 = mul_shift(k1[channel], bounds->sub2, 28);
+            int64_t top2 = mul_shift(k2[channel], bounds->sub2, 28) - t * k6;
+            int64_t bottom = mul_shift(k3[channel], bounds->sub2, 28) + t * ONE28;
+            int64_t den = mul_shift(bottom, sin_h, 30) - mul_shift(top1, cos_h, 30);
+            int64_t len;
+
+            if(den == 0)
+                continue;
+            len = div_round(bounds->l * top2, den);
+            if(len >= 0  &&  len < min_len)
+                min_len = len;
+        }
+    }
+
+    return min_len;
+}
+
+static int64_t
+max_safe_chroma_for_bounds(const FixedBounds* bounds)
+{
+    int64_t min_len = INT64_MAX;
+    int channel, t;
+
+    for(channel = 0; channel < 3; channel++) {
+        for(t = 0; t < 2; t++) {
+            int64_t top1 = mul_shift(k1[channel], bounds->sub2, 28);
+            int64_t top2 = mul_shift(k2[channel], bounds->sub2, 28) - t * k6;
+            int64_t bottom = mul_shift(k3[channel], bounds->sub2, 28) + t * ONE28;
+            int shift = 0;
+            int64_t hypot;
+            int64_t len;
+
+            if(top1 < 0)
+                top1 = -top1;
+            if(bottom < 0)
+                bottom = -bottom;
+            if(top2 < 0)
+                top2 = -top2;
+
+            /* Keep the squares below 2^63. */
+            while(top1 >= ((int64_t) 1 << 31)  ||  bottom >= ((int64_t) 1 << 31)) {
+                top1 >>= 1;
+                bottom >>= 1;
+                shift++;
+            }
+            hypot = (int64_t) isqrt((uint64_t) (top1 * top1 + bottom * bottom)) << shift;
+            if(hypot == 0)
+                continue;
+
+            len = div_round(bounds->l * top2, hypot);
+            if(len < min_len)
+                min_len = len;
+        }
+    }
+
+    return min_len;
+}
+
+
+static void
+lch2rgb(int64_t l, int64_t c, int64_t sin_h, int64_t cos_h, int32_t* pr, int32_t* pg, int32_t* pb)
+{
+    int64_t u, v, var_u, var_v, x, y, z;
+    int64_t rgb[3];
+    int i;
+
+    if(l <= BLACK_L) {
+        *pr = *pg = *pb = 0;
+        return;
+    }
+
+    /* lch2luv */
+    u = mul_shift(c, cos_h, 30);
+    v = mul_shift(c, sin_h, 30);
+
+    /* luv2xyz */
+    var_u = div_round(SHL(u, 28), 13 * l) + ref_u;
+    var_v = div_round(SHL(v, 28), 13 * l) + ref_v;
+    if(l <= 8 * ONE16) {
+        y = div_round(SHL(l, 12) * 27, 24389);
+    } else {
+        int64_t t = div_round(SHL(l + 16 * ONE16, 12), 116);
+        y = mul_shift(mul_shift(t, t, 28), t, 28);
+    }
+    if(var_v <= 0)
+        var_v = 1;
+    x = div_round(9 * y * var_u, 4 * var_v);
+    z = div_round(y * (12 * ONE28 - 3 * var_u - 20 * var_v), 4 * var_v);
+
+    /* xyz2rgb */
+    for(i = 0; i < 3; i++) {
+        int64_t lin = (m[i][0] * x + m[i][1] * y + m[i][2] * z + ((int64_t) 1 << 27)) >> 28;
+        rgb[i] = CLAMP(from_linear(lin), 0, ONE16);
+    }
+
+    *pr = (int32_t) rgb[0];
+    *pg = (int32_t) rgb[1];
+    *pb = (int32_t) rgb[2];
+}
+
+/* RGB (Q16) to LCh (Q16), plus the sine and cosine (Q30) of the hue. */
+static void
+rgb2lch(int64_t r, int64_t g, int64_t b, int64_t* pl, int64_t* pc, int64_t* ph,
+        int64_t* psin, int64_t* pcos)
+{
+    int64_t lin[3];
+    int64_t x, y, z, den, l, u, v, c;
+
+    /* rgb2xyz */
+    lin[0] = to_linear(r);
+    lin[1] = to_linear(g);
+    lin[2] = to_linear(b);
+    x = (m_inv[0][0] * lin[0] + m_inv[0][1] * lin[1] + m_inv[0][2] * lin[2] + ((int64_t) 1 << 27)) >> 28;
+    y = (m_inv[1][0] * lin[0] + m_inv[1][1] * lin[1] + m_inv[1][2] * lin[2] + ((int64_t) 1 << 27)) >> 28;
+    z = (m_inv[2][0] * lin[0] + m_inv[2][1] * lin[1] + m_inv[2][2] * lin[2] + ((int64_t) 1 << 27)) >> 28;
+
+    /* xyz2luv */
+    if(y <= epsilon)
+        l = div_round(y * 24389, 27 * 4096);
+    else
+        l = div_round(116 * cbrt_q28(y), 4096) - 16 * ONE16;
+
+    den = x + 15 * y + 3 * z;
+    if(l <= BLACK_L  ||  den <= 0) {
+        u = 0;
+        v = 0;
+    } else {
+        int64_t var_u = div_round(SHL(4 * x, 28), den);
+        int64_t var_v = div_round(SHL(9 * y, 28), den);
+        u = mul_shift(13 * l, var_u - ref_u, 28);
+        v = mul_shift(13 * l, var_v - ref_v, 28);
+    }
+
+    /* luv2lch */
+    c = (int64_t) isqrt((uint64_t) (u * u + v * v));
+    *pl = l;
+    *pc = c;
+    if(c < GRAY_C) {
+        *ph = 0;
+        *psin = 0;
+        *pcos = ONE30;
+    } else {
+        *ph = atan2_q16(v, u);
+        *psin = div_round(SHL(v, 30), c);
+        *pcos = div_round(SHL(u, 30), c);
+    }
+}
+
+
+void
+hsluv2rgb_fixed(int32_t h, int32_t s, int32_t l, int32_t* pr, int32_t* pg, int32_t* pb)
+{
+    FixedBounds bounds;
+    int64_t sin_h, cos_h, c;
+
+    sincos_q30(h, &sin_h, &cos_h);
+    if(l > WHITE_L  ||  l < BLACK_L) {
+        c = 0;
+    } else {
+        get_bounds(l, &bounds);
+        c = div_round(max_chroma_for_bounds(&bounds, sin_h, cos_h) * s, 100 * ONE16);
+    }
+
+    lch2rgb(l, c, sin_h, cos_h, pr, pg, pb);
+}
+
+void
+hpluv2rgb_fixed(int32_t h, int32_t s, int32_t l, int32_t* pr, int32_t* pg, int32_t* pb)
+{
+    FixedBounds bounds;
+    int64_t sin_h, cos_h, c;
+
+    sincos_q30(h, &sin_h, &cos_h);
+    if(l > WHITE_L  ||  l < BLACK_L) {
+        c = 0;
+    } else {
+        get_bounds(l, &bounds);
+        c = div_round(max_safe_chroma_for_bounds(&bounds) * s, 100 * ONE16);
+    }
+
+    lch2rgb(l, c, sin_h, cos_h, pr, pg, pb);
+}
+
+void
+rgb2hsluv_fixed(int32_t r, int32_t g, int32_t b, int32_t* ph, int32_t* ps, int32_t* pl)
+{
+    FixedBounds bounds;
+    int64_t l, c, h, sin_h, cos_h, s;
+
+    rgb2lch(r, g, b, &l, &c, &h, &sin_h, &cos_h);
+
+    if(l > WHITE_L  ||  l < BLACK_L) {
+        s = 0;
+    } else {
+        int64_t max_c;
+
+        get_bounds(l, &bounds);
+        max_c = max_chroma_for_bounds(&bounds, sin_h, cos_h);
+        s = (max_c > 0 ? div_round(c * 100 * ONE16, max_c) : 0);
+    }
+
+    *ph = (int32_t) CLAMP(h, 0, 360 * ONE16);
+    *ps = (int32_t) CLAMP(s, 0, 100 * ONE16);
+    *pl = (int32_t) CLAMP(l, 0, 100 * ONE16);
+}
+
+int
+rgb2hpluv_fixed(int32_t r, int32_t g, int32_t b, int32_t* ph, int32_t* ps, int32_t* pl)
+{
+    FixedBounds bounds;
+    int64_t l, c, h, sin_h, cos_h, s;
+
+    rgb2lch(r, g, b, &l, &c, &h, &sin_h, &cos_h);
+
+    if(l > WHITE_L  ||  l < BLACK_L) {
+        s = 0;
+    } else {
+        int64_t max_c;
+
+        get_bounds(l, &bounds);
+        max_c = max_safe_chroma_for_bounds(&bounds);
+        s = (max_c > 0 ? div_round(c * 100 * ONE16, max_c) : 0);
+    }
+
+    /* Do NOT clamp the saturation (see rgb2hpluv()). */
+    *ph = (int32_t) CLAMP(h, 0, 360 * ONE16);
+    *ps = (int32_t) CLAMP(s, INT32_MIN, INT32_MAX);
+    *pl = (int32_t) CLAMP(l, 0, 100 * ONE16);
+
+    return (0 <= s  &&  s <= 100 * ONE16) ? 0 : -1;
+}
@@ -0,0 +1,84 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_FIXED_H
+#define HSLUV_FIXED_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Fixed-point conversions.
+ *
+ * These are counterparts of the functions in hsluv.h which use integer
+ * arithmetic only, for targets without a floating point unit. They live in
+ * a library of their own (@c hsluv-c-fixed) which does not need the math
+ * library.
+ *
+ * All the values are in the Q16.16 fixed-point format, i.e. real values
+ * multiplied by 65536 (@c HSLUV_FIXED_ONE). The ranges are the same as for
+ * the double precision functions, e.g. hue between 0 and 360 * 65536 and RGB
+ * components between 0 and 65536. Internally, the conversions work with 28
+ * fractional bits and 64-bit intermediate products.
+ *
+ * The sRGB transfer curve is linearized by a table with linear interpolation
+ * and the inverse one is computed from the cube root. The cube root takes its
+ * initial estimate from a table and refines it by one Newton step.
+ *
+ * Measured against the test snapshot (i.e. the reference double precision
+ * results of all the 4096 colors with 4-bit channels), the maximal absolute
+ * error is:
+ *  - RGB channels: 5e-5 (i.e. about 0.01 of an 8-bit unit).
+ *  - HSLuv: hue 0.006, saturation 0.005, lightness 0.001.
+ *  - HPLuv: hue 0.006, saturation 0.02 (out of values up to about 500 for
+ *    colors outside of HPLuv), lightness 0.001.
+ * Most of it comes from rounding the inputs to 16 fractional bits: one unit
+ * of an RGB input moves the lightness by up to 0.001.
+ *
+ * The hue error grows for colors close to grays, where the hue is ill-defined
+ * (the numbers above hold for chroma above 0.01). Colors with chroma below
+ * 0.001 are treated as grays, and colors with lightness above 99.999 or below
+ * 0.001 as white or black.
+ */
+#define HSLUV_FIXED_ONE     65536
+
+void hsluv2rgb_fixed(int32_t h, int32_t s, int32_t l, int32_t* pr, int32_t* pg, int32_t* pb);
+void rgb2hsluv_fixed(int32_t r, int32_t g, int32_t b, int32_t* ph, int32_t* ps, int32_t* pl);
+void hpluv2rgb_fixed(int32_t h, int32_t s, int32_t l, int32_t* pr, int32_t* pg, int32_t* pb);
+int rgb2hpluv_fixed(int32_t r, int32_t g, int32_t b, int32_t* ph, int32_t* ps, int32_t* pl);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HSLUV_FIXED_H */
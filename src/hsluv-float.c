@@ -0,0 +1,229 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* Portable single precision conversions. This instantiates the kernel
+ * template of hsluv-simd.h with "vectors" of one float: it serves both as the
+ * scalar float kernel for the batched functions and as the implementation of
+ * the single-color float functions. */
+
+#include "hsluv.h"
+#include "hsluv-internal.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+
+typedef float vr;
+typedef int vm;
+
+#define SIMD_FLOAT              1
+#define VR_WIDTH                1
+#define SIMD_NAME(fn)           hsluv_scalar_float_##fn
+
+static inline vr vr_set(double x)               { return (float) x; }
+static inline vr vr_loadu(const float* p)       { return *p; }
+static inline void vr_storeu(float* p, vr x)    { *p = x; }
+static inline vr vr_add(vr x, vr y)             { return x + y; }
+static inline vr vr_sub(vr x, vr y)             { return x - y; }
+static inline vr vr_mul(vr x, vr y)             { return x * y; }
+static inline vr vr_div(vr x, vr y)             { return x / y; }
+static inline vr vr_fma(vr x, vr y, vr z)       { return x * y + z; }
+static inline vr vr_sqrt(vr x)                  { return sqrtf(x); }
+static inline vr vr_min(vr x, vr y)             { return (x < y) ? x : y; }
+static inline vr vr_max(vr x, vr y)             { return (x > y) ? x : y; }
+static inline vm vr_lt(vr x, vr y)              { return x < y; }
+static inline vm vr_le(vr x, vr y)              { return x <= y; }
+static inline vm vr_gt(vr x, vr y)              { return x > y; }
+static inline vm vr_ge(vr x, vr y)              { return x >= y; }
+static inline vr vr_sel(vm mask, vr x, vr y)    { return mask ? x : y; }
+static inline vm vm_and(vm x, vm y)             { return x && y; }
+static inline vm vm_or(vm x, vm y)              { return x || y; }
+static inline int vm_any(vm x)                  { return x; }
+
+/* floorf() is often a libm call; truncation to an integer is not. Floats of
+ * magnitude 2^23 and above are integral already. */
+static inline vr
+vr_floor(vr x)
+{
+    long i;
+
+    if(!(x > -8388608.0f  &&  x < 8388608.0f))
+        return x;
+    i = (long) x;
+    return (float) (x < (float) i ? i - 1 : i);
+}
+
+static inline vr
+vr_round(vr x)
+{
+    return vr_floor(x + 0.5f);
+}
+
+static inline uint32_t
+float_bits(float x)
+{
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+static inline float
+bits_float(uint32_t bits)
+{
+    float x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+/* Unbiased exponent of positive normal x, as a float. */
+static inline vr
+vr_exponent(vr x)
+{
+    return (float) ((int) (float_bits(x) >> 23) - 127);
+}
+
+/* Mantissa of positive x, scaled into [1, 2). */
+static inline vr
+vr_mantissa(vr x)
+{
+    return bits_float((float_bits(x) & 0x007fffffu) | 0x3f800000u);
+}
+
+/* x * 2^k for integral k. */
+static inline vr
+vr_ldexp(vr x, vr k)
+{
+    int e = (int) vr_min(vr_max(k, -126.0f), 127.0f);
+    return x * bits_float((uint32_t) (e + 127) << 23);
+}
+
+#include "hsluv-simd.h"
+
+
+HsluvRgbf
+hsluv2rgbf_v(HsluvHslf hsl)
+{
+    vr a = hsl.h, b = hsl.s, c = hsl.l;
+    HsluvRgbf rgb;
+
+    vhsluv2rgb(&srgb_space, &a, &b, &c, NULL);
+
+    rgb.r = a;
+    rgb.g = b;
+    rgb.b = c;
+    return rgb;
+}
+
+HsluvRgbf
+hpluv2rgbf_v(HsluvHslf hpl)
+{
+    vr a = hpl.h, b = hpl.s, c = hpl.l;
+    HsluvRgbf rgb;
+
+    vhpluv2rgb(&srgb_space, &a, &b, &c);
+
+    rgb.r = a;
+    rgb.g = b;
+    rgb.b = c;
+    return rgb;
+}
+
+HsluvHslf
+rgb2hsluvf_v(HsluvRgbf rgb)
+{
+    vr x = rgb.r, y = rgb.g, z = rgb.b;
+    HsluvHslf hsl;
+
+    vrgb2hsluv(&srgb_space, &x, &y, &z, NULL);
+
+    hsl.h = x;
+    hsl.s = y;
+    hsl.l = z;
+    return hsl;
+}
+
+HsluvHslf
+rgb2hpluvf_v(HsluvRgbf rgb)
+{
+    vr x = rgb.r, y = rgb.g, z = rgb.b;
+    HsluvHslf hpl;
+
+    vrgb2hpluv(&srgb_space, &x, &y, &z);
+
+    hpl.h = x;
+    hpl.s = y;
+    hpl.l = z;
+    return hpl;
+}
+
+void
+hsluv2rgbf(float h, float s, float l, float* pr, float* pg, float* pb)
+{
+    HsluvHslf hsl = { h, s, l };
+    HsluvRgbf rgb = hsluv2rgbf_v(hsl);
+
+    *pr = rgb.r;
+    *pg = rgb.g;
+    *pb = rgb.b;
+}
+
+void
+hpluv2rgbf(float h, float s, float l, float* pr, float* pg, float* pb)
+{
+    HsluvHslf hpl = { h, s, l };
+    HsluvRgbf rgb = hpluv2rgbf_v(hpl);
+
+    *pr = rgb.r;
+    *pg = rgb.g;
+    *pb = rgb.b;
+}
+
+void
+rgb2hsluvf(float r, float g, float b, float* ph, float* ps, float* pl)
+{
+    HsluvRgbf rgb = { r, g, b };
+    HsluvHslf hsl = rgb2hsluvf_v(rgb);
+
+    *ph = hsl.h;
+    *ps = hsl.s;
+    *pl = hsl.l;
+}
+
+int
+rgb2hpluvf(float r, float g, float b, float* ph, float* ps, float* pl)
+{
+    HsluvRgbf rgb = { r, g, b };
+    HsluvHslf hpl = rgb2hpluvf_v(rgb);
+
+    *ph = hpl.h;
+    *ps = hpl.s;
+    *pl = hpl.l;
+
+    return (hpl.s < 0.0f  ||  hpl.s > 100.0f) ? -1 : 0;
+}
@@ -0,0 +1,1268 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* For pthread_setaffinity_np() on Linux. (HSLUV_WALL_TIME also gives us the
+ * POSIX API of sysconf() and the threads.) */
+#if defined __linux__  &&  !defined _GNU_SOURCE
+    #define _GNU_SOURCE
+#endif
+
+#define HSLUV_WALL_TIME
+#include "hsluv-internal.h"
+#include "hsluv-image.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined _WIN32
+    #include <process.h>
+#else
+    #ifndef HSLUV_NO_THREADS
+        #include <pthread.h>
+    #endif
+    #include <unistd.h>
+#endif
+
+
+#ifndef HSLUV_IMAGE_TILE_PIXELS
+    #define HSLUV_IMAGE_TILE_PIXELS     4096
+#endif
+
+
+/* Without threads (see HSLUV_C_THREADS in CMakeLists.txt), no thread can be
+ * started: the pools have only the calling thread, and no frame pipeline can
+ * be created. The locks are then never contended and do nothing. */
+#if defined HSLUV_NO_THREADS
+    typedef int Thread;
+    typedef void* (*ThreadProc)(void*);
+    typedef int Mutex;
+    typedef int Cond;
+
+    #define mutex_init(m)           (*(m) = 0)
+    #define mutex_destroy(m)        ((void) (m))
+    #define mutex_lock(m)           ((void) (m))
+    #define mutex_unlock(m)         ((void) (m))
+    #define cond_init(c)            (*(c) = 0)
+    #define cond_destroy(c)         ((void) (c))
+    #define cond_wait(c, m)         ((void) (c), (void) (m))
+    #define cond_broadcast(c)       ((void) (c))
+#elif defined _WIN32
+    typedef HANDLE Thread;
+    typedef unsigned (__stdcall *ThreadProc)(void*);
+    typedef CRITICAL_SECTION Mutex;
+    typedef CONDITION_VARIABLE Cond;
+
+    #define mutex_init(m)           (InitializeCriticalSection(m), 0)
+    #define mutex_destroy(m)        DeleteCriticalSection(m)
+    #define mutex_lock(m)           EnterCriticalSection(m)
+    #define mutex_unlock(m)         LeaveCriticalSection(m)
+    #define cond_init(c)            (InitializeConditionVariable(c), 0)
+    #define cond_destroy(c)         do { } while(0)
+    #define cond_wait(c, m)         SleepConditionVariableCS((c), (m), INFINITE)
+    #define cond_broadcast(c)       WakeAllConditionVariable(c)
+#else
+    typedef pthread_t Thread;
+    typedef void* (*ThreadProc)(void*);
+    typedef pthread_mutex_t Mutex;
+    typedef pthread_cond_t Cond;
+
+    #define mutex_init(m)           pthread_mutex_init((m), NULL)
+    #define mutex_destroy(m)        pthread_mutex_destroy(m)
+    #define mutex_lock(m)           pthread_mutex_lock(m)
+    #define mutex_unlock(m)         pthread_mutex_unlock(m)
+    #define cond_init(c)            pthread_cond_init((c), NULL)
+    #define cond_destroy(c)         pthread_cond_destroy(c)
+    #define cond_wait(c, m)         pthread_cond_wait((c), (m))
+    #define cond_broadcast(c)       pthread_cond_broadcast(c)
+#endif
+
+struct HsluvThreadPool_tag {
+    Thread* workers;
+    unsigned n_workers;     /* Not counting the thread calling hsluv_thread_pool_run(). */
+
+    Mutex run_lock;         /* Serializes hsluv_thread_pool_run(). */
+    Mutex lock;             /* Protects all the members below. */
+    Cond work_cond;         /* Signals a new job (or quit). */
+    Cond done_cond;         /* Signals the last task of the job is done. */
+
+    /* The current job. */
+    HsluvTaskFunc task;
+    void* task_data;
+    size_t n;
+    size_t next;
+    size_t n_done;
+
+    unsigned generation;    /* Incremented for each job. */
+    int quit;
+};
+
+static unsigned
+cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+    return (unsigned) info.dwNumberOfProcessors;
+#elif defined _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0 ? (unsigned) n : 1);
+#else
+    return 1;
+#endif
+}
+
+/* Work on the tasks of the current job until there is none left. Called and
+ * returns with the lock held. */
+static void
+pool_work(HsluvThreadPool* pool)
+{
+    while(pool->next < pool->n) {
+        size_t i = pool->next++;
+
+        mutex_unlock(&pool->lock);
+        pool->task(pool->task_data, i);
+        mutex_lock(&pool->lock);
+
+        pool->n_done++;
+        if(pool->n_done == pool->n)
+            cond_broadcast(&pool->done_cond);
+    }
+}
+
+static void
+pool_worker(HsluvThreadPool* pool)
+{
+    unsigned generation;
+
+    mutex_lock(&pool->lock);
+    generation = pool->generation;
+    while(1) {
+        while(!pool->quit  &&  pool->generation == generation)
+            cond_wait(&pool->work_cond, &pool->lock);
+        if(pool->quit)
+            break;
+
+        generation = pool->generation;
+        pool_work(pool);
+    }
+    mutex_unlock(&pool->lock);
+}
+
+#if defined _WIN32  &&  !defined HSLUV_NO_THREADS
+static unsigned __stdcall
+pool_worker_proc(void* arg)
+{
+    pool_worker((HsluvThreadPool*) arg);
+    return 0;
+}
+#else
+static void*
+pool_worker_proc(void* arg)
+{
+    pool_worker((HsluvThreadPool*) arg);
+    return NULL;
+}
+#endif
+
+static int
+thread_start(Thread* thread, ThreadProc proc, void* arg)
+{
+#if defined HSLUV_NO_THREADS
+    (void) thread;
+    (void) proc;
+    (void) arg;
+    return -1;
+#elif defined _WIN32
+    *thread = (HANDLE) _beginthreadex(NULL, 0, proc, arg, 0, NULL);
+    return (*thread != NULL ? 0 : -1);
+#else
+    return (pthread_create(thread, NULL, proc, arg) == 0 ? 0 : -1);
+#endif
+}
+
+/* Pin the thread to the CPU (modulo the number of CPUs). This is only a hint:
+ * it is silently ignored where not supported. */
+static void
+thread_pin(Thread thread, unsigned cpu)
+{
+    cpu %= cpu_count();
+#if defined HSLUV_NO_THREADS
+    (void) thread;
+#elif defined _WIN32
+    if(cpu < 8 * sizeof(DWORD_PTR))
+        SetThreadAffinityMask(thread, (DWORD_PTR) 1 << cpu);
+#elif defined __linux__  &&  !defined __ANDROID__  &&  defined CPU_SET
+    {
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(thread, sizeof(set), &set);
+    }
+#else
+    (void) thread;
+#endif
+}
+
+static void
+thread_join(Thread thread)
+{
+#if defined HSLUV_NO_THREADS
+    (void) thread;
+#elif defined _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+static void
+pool_stop_workers(HsluvThreadPool* pool, unsigned n)
+{
+    unsigned i;
+
+    mutex_lock(&pool->lock);
+    pool->quit = 1;
+    cond_broadcast(&pool->work_cond);
+    mutex_unlock(&pool->lock);
+
+    for(i = 0; i < n; i++)
+        thread_join(pool->workers[i]);
+}
+
+/* If pin is non-zero, the workers are pinned to the CPUs following
+ * first_cpu, which is left for the thread calling hsluv_thread_pool_run(). */
+static HsluvThreadPool*
+pool_create(unsigned n_threads, int pin, unsigned first_cpu)
+{
+    HsluvThreadPool* pool;
+    unsigned i;
+
+#ifdef HSLUV_NO_THREADS
+    n_threads = 1;
+#else
+    if(n_threads == 0)
+        n_threads = cpu_count();
+#endif
+
+    pool = (HsluvThreadPool*) calloc(1, sizeof(HsluvThreadPool));
+    if(pool == NULL)
+        return NULL;
+    pool->n_workers = n_threads - 1;
+    if(pool->n_workers > 0) {
+        pool->workers = (Thread*) malloc(pool->n_workers * sizeof(Thread));
+        if(pool->workers == NULL) {
+            free(pool);
+            return NULL;
+        }
+    }
+
+    if(mutex_init(&pool->run_lock) != 0)
+        goto err_run_lock;
+    if(mutex_init(&pool->lock) != 0)
+        goto err_lock;
+    if(cond_init(&pool->work_cond) != 0)
+        goto err_work_cond;
+    if(cond_init(&pool->done_cond) != 0)
+        goto err_done_cond;
+
+    for(i = 0; i < pool->n_workers; i++) {
+        if(thread_start(&pool->workers[i], pool_worker_proc, pool) != 0) {
+            pool_stop_workers(pool, i);
+            goto err_workers;
+        }
+        if(pin)
+            thread_pin(pool->workers[i], first_cpu + 1 + i);
+    }
+
+    return pool;
+
+err_workers:
+    cond_destroy(&pool->done_cond);
+err_done_cond:
+    cond_destroy(&pool->work_cond);
+err_work_cond:
+    mutex_destroy(&pool->lock);
+err_lock:
+    mutex_destroy(&pool->run_lock);
+err_run_lock:
+    free(pool->workers);
+    free(pool);
+    return NULL;
+}
+
+HsluvThreadPool*
+hsluv_thread_pool_create(unsigned n_threads)
+{
+    return pool_create(n_threads, 0, 0);
+}
+
+void
+hsluv_thread_pool_destroy(HsluvThreadPool* pool)
+{
+    if(pool == NULL)
+        return;
+
+    pool_stop_workers(pool, pool->n_workers);
+    cond_destroy(&pool->done_cond);
+    cond_destroy(&pool->work_cond);
+    mutex_destroy(&pool->lock);
+    mutex_destroy(&pool->run_lock);
+    free(pool->workers);
+    free(pool);
+}
+
+unsigned
+hsluv_thread_pool_size(const HsluvThreadPool* pool)
+{
+    return pool->n_workers + 1;
+}
+
+void
+hsluv_thread_pool_run(HsluvTaskFunc task, void* task_data, size_t n, void* user_data)
+{
+    HsluvThreadPool* pool = (HsluvThreadPool*) user_data;
+    size_t i;
+
+    if(n == 0)
+        return;
+    if(n == 1  ||  pool->n_workers == 0) {
+        for(i = 0; i < n; i++)
+            task(task_data, i);
+        return;
+    }
+
+    mutex_lock(&pool->run_lock);
+    mutex_lock(&pool->lock);
+
+    pool->task = task;
+    pool->task_data = task_data;
+    pool->n = n;
+    pool->next = 0;
+    pool->n_done = 0;
+    pool->generation++;
+    cond_broadcast(&pool->work_cond);
+
+    pool_work(pool);
+    while(pool->n_done < pool->n)
+        cond_wait(&pool->done_cond, &pool->lock);
+
+    pool->task = NULL;
+    pool->task_data = NULL;
+    pool->n = 0;
+    pool->next = 0;
+
+    mutex_unlock(&pool->lock);
+    mutex_unlock(&pool->run_lock);
+}
+
+
+typedef void (*ToRgb8Func)(const double* in, size_t in_stride, unsigned char* out,
+                           HsluvFormat format, size_t n);
+typedef int (*FromRgb8Func)(const unsigned char* in, HsluvFormat format, double* out,
+                            size_t out_stride, size_t n);
+
+typedef struct ImageJob_tag ImageJob;
+struct ImageJob_tag {
+    ToRgb8Func to_rgb8;         /* Exactly one of these is set. */
+    FromRgb8Func from_rgb8;
+
+    double* hsl;
+    size_t hsl_stride;
+    unsigned char* rgb;
+    size_t rgb_stride;
+    HsluvFormat format;
+    size_t width;
+    size_t height;
+
+    /* Tiling: each tile spans tile_w pixels of tile_h rows. */
+    size_t tile_w;
+    size_t tile_h;
+    size_t tiles_per_row;
+
+    /* Tiles returning non-zero from from_rgb8 (when run in parallel), or the
+     * non-zero return value itself (when run serially). */
+    unsigned char* tile_failed;
+    int ret;
+
+    /* Preallocated tile_failed of image_tiling() bytes, or NULL. */
+    unsigned char* scratch;
+};
+
+static void
+image_tile(void* task_data, size_t i)
+{
+    ImageJob* job = (ImageJob*) task_data;
+    size_t pixel_size = rgb8_format(job->format)->size;
+    size_t x0 = (i % job->tiles_per_row) * job->tile_w;
+    size_t y0 = (i / job->tiles_per_row) * job->tile_h;
+    size_t w = job->width - x0;
+    size_t h = job->height - y0;
+    size_t y;
+    int ret = 0;
+
+    if(w > job->tile_w)
+        w = job->tile_w;
+    if(h > job->tile_h)
+        h = job->tile_h;
+
+    /* If the rows follow each other with no padding, do them in one call. */
+    if(w == job->width  &&  job->hsl_stride == 3 * w  &&  job->rgb_stride == pixel_size * w) {
+        w *= h;
+        h = 1;
+    }
+
+    for(y = y0; y < y0 + h; y++) {
+        double* hsl = job->hsl + y * job->hsl_stride + x0 * 3;
+        unsigned char* rgb = job->rgb + y * job->rgb_stride + x0 * pixel_size;
+
+        if(job->to_rgb8 != NULL) {
+            job->to_rgb8(hsl, 3, rgb, job->format, w);
+        } else {
+            if(job->from_rgb8(rgb, job->format, hsl, 3, w) != 0)
+                ret = -1;
+        }
+    }
+
+    if(ret != 0) {
+        if(job->tile_failed != NULL)
+            job->tile_failed[i] = 1;
+        else
+            job->ret = ret;
+    }
+}
+
+/* Split the image into tiles. Returns their count. */
+static size_t
+image_tiling(ImageJob* job)
+{
+    if(job->width == 0  ||  job->height == 0)
+        return 0;
+
+    if(job->width >= HSLUV_IMAGE_TILE_PIXELS) {
+        job->tile_w = HSLUV_IMAGE_TILE_PIXELS;
+        job->tile_h = 1;
+    } else {
+        job->tile_w = job->width;
+        job->tile_h = HSLUV_IMAGE_TILE_PIXELS / job->width;
+    }
+    job->tiles_per_row = (job->width + job->tile_w - 1) / job->tile_w;
+    return job->tiles_per_row * ((job->height + job->tile_h - 1) / job->tile_h);
+}
+
+static int
+image_run(ImageJob* job, HsluvParallelFunc parallel, void* parallel_data)
+{
+    size_t n_tiles;
+    size_t i;
+
+    n_tiles = image_tiling(job);
+    if(n_tiles == 0)
+        return 0;
+
+    job->tile_failed = NULL;
+    job->ret = 0;
+    if(parallel != NULL  &&  job->from_rgb8 != NULL) {
+        if(job->scratch != NULL) {
+            job->tile_failed = job->scratch;
+            memset(job->tile_failed, 0, n_tiles);
+        } else {
+            job->tile_failed = (unsigned char*) calloc(n_tiles, 1);
+            /* Out of memory: fall back to the serial conversion. */
+            if(job->tile_failed == NULL)
+                parallel = NULL;
+        }
+    }
+
+    if(parallel != NULL) {
+        parallel(image_tile, job, n_tiles, parallel_data);
+    } else {
+        for(i = 0; i < n_tiles; i++)
+            image_tile(job, i);
+    }
+
+    if(job->tile_failed != NULL) {
+        for(i = 0; i < n_tiles; i++) {
+            if(job->tile_failed[i]) {
+                job->ret = -1;
+                break;
+            }
+        }
+        if(job->tile_failed != job->scratch)
+            free(job->tile_failed);
+    }
+
+    return job->ret;
+}
+
+static int
+rgb82hsluv_n_ret(const unsigned char* in, HsluvFormat format, double* out, size_t out_stride, size_t n)
+{
+    rgb82hsluv_n(in, format, out, out_stride, n);
+    return 0;
+}
+
+static void
+to_rgb8_image(ToRgb8Func func, const double* hsl, size_t hsl_stride,
+              unsigned char* rgb, size_t rgb_stride, HsluvFormat format,
+              size_t width, size_t height, HsluvParallelFunc parallel, void* parallel_data)
+{
+    ImageJob job;
+
+    job.to_rgb8 = func;
+    job.from_rgb8 = NULL;
+    job.hsl = (double*) hsl;
+    job.hsl_stride = hsl_stride;
+    job.rgb = rgb;
+    job.rgb_stride = rgb_stride;
+    job.format = format;
+    job.width = width;
+    job.height = height;
+    job.scratch = NULL;
+    image_run(&job, parallel, parallel_data);
+}
+
+static int
+from_rgb8_image(FromRgb8Func func, const unsigned char* rgb, size_t rgb_stride, HsluvFormat format,
+                double* hsl, size_t hsl_stride, size_t width, size_t height,
+                HsluvParallelFunc parallel, void* parallel_data)
+{
+    ImageJob job;
+
+    job.to_rgb8 = NULL;
+    job.from_rgb8 = func;
+    job.hsl = hsl;
+    job.hsl_stride = hsl_stride;
+    job.rgb = (unsigned char*) rgb;
+    job.rgb_stride = rgb_stride;
+    job.format = format;
+    job.width = width;
+    job.height = height;
+    job.scratch = NULL;
+    return image_run(&job, parallel, parallel_data);
+}
+
+void
+hsluv2rgb8_image(const double* hsl, size_t hsl_stride, unsigned char* rgb, size_t rgb_stride,
+                 HsluvFormat format, size_t width, size_t height,
+                 HsluvParallelFunc parallel, void* parallel_data)
+{
+    to_rgb8_image(hsluv2rgb8_n, hsl, hsl_stride, rgb, rgb_stride, format,
+                  width, height, parallel, parallel_data);
+}
+
+void
+rgb82hsluv_image(const unsigned char* rgb, size_t rgb_stride, HsluvFormat format,
+                 double* hsl, size_t hsl_stride, size_t width, size_t height,
+                 HsluvParallelFunc parallel, void* parallel_data)
+{
+    from_rgb8_image(rgb82hsluv_n_ret, rgb, rgb_stride, format, hsl, hsl_stride,
+                    width, height, parallel, parallel_data);
+}
+
+void
+hpluv2rgb8_image(const double* hsl, size_t hsl_stride, unsigned char* rgb, size_t rgb_stride,
+                 HsluvFormat format, size_t width, size_t height,
+                 HsluvParallelFunc parallel, void* parallel_data)
+{
+    to_rgb8_image(hpluv2rgb8_n, hsl, hsl_stride, rgb, rgb_stride, format,
+                  width, height, parallel, parallel_data);
+}
+
+int
+rgb82hpluv_image(const unsigned char* rgb, size_t rgb_stride, HsluvFormat format,
+                 double* hsl, size_t hsl_stride, size_t width, size_t height,
+                 HsluvParallelFunc parallel, void* parallel_data)
+{
+    return from_rgb8_image(rgb82hpluv_n, rgb, rgb_stride, format, hsl, hsl_stride,
+                           width, height, parallel, parallel_data);
+}
+
+
+/* Pixels converted at once by the statistics, into a buffer on the stack. */
+#define STATS_BLOCK_PIXELS      256
+
+/* Max. number of the parts of an image, each with its own histograms. */
+#define STATS_MAX_PARTS         64
+
+/* Statistics of a part of the image. The moments are kept as the means and
+ * the sums of the squared deviations from them, which merge robustly (see
+ * moments_merge()). */
+typedef struct StatsPart_tag StatsPart;
+struct StatsPart_tag {
+    size_t* hue_bins;
+    size_t* saturation_bins;
+    size_t* lightness_bins;
+
+    size_t n;
+    double mean_s;
+    double m2_s;
+    double mean_l;
+    double m2_l;
+
+    size_t n_chromatic;
+    double sum_cos;
+    double sum_sin;
+};
+
+/* Merge the moments of n_b values into those of n_a values (Chan et al.). */
+static void
+moments_merge(size_t n_a, double* mean_a, double* m2_a, size_t n_b, double mean_b, double m2_b)
+{
+    double n = (double) (n_a + n_b);
+    double delta = mean_b - *mean_a;
+
+    if(n_b == 0)
+        return;
+    *mean_a += delta * ((double) n_b / n);
+    *m2_a += m2_b + delta * delta * ((double) n_a * (double) n_b / n);
+}
+
+static size_t
+bin_index(double val, double range, unsigned n_bins)
+{
+    double x = val * ((double) n_bins / range);
+    size_t i = (x > 0.0 ? (size_t) x : 0);
+
+    return (i < n_bins ? i : n_bins - 1);
+}
+
+static void
+stats_block(StatsPart* part, const HsluvImageStats* stats, const double* hsl, size_t n)
+{
+    double sum_s = 0.0, sum_l = 0.0;
+    double mean_s, mean_l;
+    double m2_s = 0.0, m2_l = 0.0;
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        double h = hsl[i * 3];
+        double s = hsl[i * 3 + 1];
+        double l = hsl[i * 3 + 2];
+
+        if(part->saturation_bins != NULL)
+            part->saturation_bins[bin_index(s, 100.0, stats->n_saturation_bins)]++;
+        if(part->lightness_bins != NULL)
+            part->lightness_bins[bin_index(l, 100.0, stats->n_lightness_bins)]++;
+        if(s >= stats->min_saturation) {
+            double hrad = h * 0.01745329251994329577;  /* (pi / 180.0) */
+
+            if(part->hue_bins != NULL)
+                part->hue_bins[bin_index(h, 360.0, stats->n_hue_bins)]++;
+            part->n_chromatic++;
+            part->sum_cos += cos(hrad);
+            part->sum_sin += sin(hrad);
+        }
+        sum_s += s;
+        sum_l += l;
+    }
+
+    /* The moments of the block, merged into those of the part. */
+    mean_s = sum_s / (double) n;
+    mean_l = sum_l / (double) n;
+    for(i = 0; i < n; i++) {
+        double ds = hsl[i * 3 + 1] - mean_s;
+        double dl = hsl[i * 3 + 2] - mean_l;
+
+        m2_s += ds * ds;
+        m2_l += dl * dl;
+    }
+    moments_merge(part->n, &part->mean_s, &part->m2_s, n, mean_s, m2_s);
+    moments_merge(part->n, &part->mean_l, &part->m2_l, n, mean_l, m2_l);
+    part->n += n;
+}
+
+/* Set up one part filling the histograms of the caller. */
+static void
+stats_init(HsluvImageStats* stats, StatsPart* part)
+{
+    memset(part, 0, sizeof(StatsPart));
+    if(stats->n_hue_bins == 0)
+        stats->hue_bins = NULL;
+    if(stats->n_saturation_bins == 0)
+        stats->saturation_bins = NULL;
+    if(stats->n_lightness_bins == 0)
+        stats->lightness_bins = NULL;
+
+    part->hue_bins = stats->hue_bins;
+    part->saturation_bins = stats->saturation_bins;
+    part->lightness_bins = stats->lightness_bins;
+    if(part->hue_bins != NULL)
+        memset(part->hue_bins, 0, stats->n_hue_bins * sizeof(size_t));
+    if(part->saturation_bins != NULL)
+        memset(part->saturation_bins, 0, stats->n_saturation_bins * sizeof(size_t));
+    if(part->lightness_bins != NULL)
+        memset(part->lightness_bins, 0, stats->n_lightness_bins * sizeof(size_t));
+}
+
+static void
+bins_add(size_t* dst, const size_t* src, unsigned n_bins)
+{
+    unsigned i;
+
+    if(dst != NULL  &&  dst != src) {
+        for(i = 0; i < n_bins; i++)
+            dst[i] += src[i];
+    }
+}
+
+/* Merge the parts into the histograms and moments of the caller. */
+static void
+stats_finish(HsluvImageStats* stats, const StatsPart* parts, size_t n_parts)
+{
+    StatsPart total;
+    size_t i;
+
+    memset(&total, 0, sizeof(StatsPart));
+    for(i = 0; i < n_parts; i++) {
+        const StatsPart* part = &parts[i];
+
+        bins_add(stats->hue_bins, part->hue_bins, stats->n_hue_bins);
+        bins_add(stats->saturation_bins, part->saturation_bins, stats->n_saturation_bins);
+        bins_add(stats->lightness_bins, part->lightness_bins, stats->n_lightness_bins);
+
+        moments_merge(total.n, &total.mean_s, &total.m2_s, part->n, part->mean_s, part->m2_s);
+        moments_merge(total.n, &total.mean_l, &total.m2_l, part->n, part->mean_l, part->m2_l);
+        total.n += part->n;
+        total.n_chromatic += part->n_chromatic;
+        total.sum_cos += part->sum_cos;
+        total.sum_sin += part->sum_sin;
+    }
+
+    stats->n = total.n;
+    stats->mean_saturation = total.mean_s;
+    stats->mean_lightness = total.mean_l;
+    stats->var_saturation = (total.n > 0 ? total.m2_s / (double) total.n : 0.0);
+    stats->var_lightness = (total.n > 0 ? total.m2_l / (double) total.n : 0.0);
+    stats->n_chromatic = total.n_chromatic;
+    stats->mean_hue = 0.0;
+    stats->hue_concentration = 0.0;
+    if(total.n_chromatic > 0) {
+        double h = atan2(total.sum_sin, total.sum_cos) * 57.29577951308232087680;  /* (180.0 / pi) */
+
+        stats->mean_hue = (h < 0.0 ? h + 360.0 : h);
+        stats->hue_concentration = sqrt(total.sum_cos * total.sum_cos + total.sum_sin * total.sum_sin)
+                                   / (double) total.n_chromatic;
+    }
+}
+
+typedef struct StatsJob_tag StatsJob;
+struct StatsJob_tag {
+    const unsigned char* rgb;
+    size_t rgb_stride;
+    HsluvFormat format;
+    size_t width;
+    size_t n;                   /* width * height */
+
+    const HsluvImageStats* stats;
+    StatsPart* parts;
+    size_t n_parts;
+};
+
+/* Accumulate the pixels [n * i / n_parts, n * (i + 1) / n_parts) into the
+ * part i. */
+static void
+stats_task(void* task_data, size_t i)
+{
+    StatsJob* job = (StatsJob*) task_data;
+    size_t pixel_size = rgb8_format(job->format)->size;
+    size_t pos = job->n / job->n_parts * i + job->n % job->n_parts * i / job->n_parts;
+    size_t end = job->n / job->n_parts * (i + 1) + job->n % job->n_parts * (i + 1) / job->n_parts;
+    double hsl[STATS_BLOCK_PIXELS * 3];
+
+    while(pos < end) {
+        size_t x = pos % job->width;
+        size_t y = pos / job->width;
+        size_t k = end - pos;
+
+        if(k > job->width - x)
+            k = job->width - x;
+        if(k > STATS_BLOCK_PIXELS)
+            k = STATS_BLOCK_PIXELS;
+
+        rgb82hsluv_n(job->rgb + y * job->rgb_stride + x * pixel_size, job->format, hsl, 3, k);
+        stats_block(&job->parts[i], job->stats, hsl, k);
+        pos += k;
+    }
+}
+
+void
+rgb82hsluv_image_stats(const unsigned char* rgb, size_t rgb_stride, HsluvFormat format,
+                       size_t width, size_t height, HsluvImageStats* stats,
+                       HsluvParallelFunc parallel, void* parallel_data)
+{
+    StatsPart single;
+    StatsPart* parts = &single;
+    size_t* bins = NULL;
+    StatsJob job;
+    size_t i;
+
+    stats_init(stats, &single);
+
+    job.rgb = rgb;
+    job.rgb_stride = rgb_stride;
+    job.format = format;
+    job.width = width;
+    job.n = width * height;
+    job.stats = stats;
+    job.n_parts = (job.n + HSLUV_IMAGE_TILE_PIXELS - 1) / HSLUV_IMAGE_TILE_PIXELS;
+    if(job.n_parts > STATS_MAX_PARTS)
+        job.n_parts = STATS_MAX_PARTS;
+    if(parallel == NULL  ||  job.n_parts < 2)
+        job.n_parts = 1;
+
+    if(job.n_parts > 1) {
+        size_t n_bins = (size_t) stats->n_hue_bins * (stats->hue_bins != NULL) +
+                        (size_t) stats->n_saturation_bins * (stats->saturation_bins != NULL) +
+                        (size_t) stats->n_lightness_bins * (stats->lightness_bins != NULL);
+
+        parts = (StatsPart*) calloc(job.n_parts, sizeof(StatsPart));
+        if(n_bins > 0  &&  parts != NULL)
+            bins = (size_t*) calloc(job.n_parts * n_bins, sizeof(size_t));
+        if(parts == NULL  ||  (n_bins > 0  &&  bins == NULL)) {
+            /* Out of memory: fall back to the serial analysis. */
+            free(parts);
+            parts = &single;
+            job.n_parts = 1;
+        } else {
+            size_t* next = bins;
+
+            for(i = 0; i < job.n_parts; i++) {
+                if(stats->hue_bins != NULL) {
+                    parts[i].hue_bins = next;
+                    next += stats->n_hue_bins;
+                }
+                if(stats->saturation_bins != NULL) {
+                    parts[i].saturation_bins = next;
+                    next += stats->n_saturation_bins;
+                }
+                if(stats->lightness_bins != NULL) {
+                    parts[i].lightness_bins = next;
+                    next += stats->n_lightness_bins;
+                }
+            }
+        }
+    }
+    job.parts = parts;
+
+    if(job.n > 0) {
+        if(job.n_parts > 1)
+            parallel(stats_task, &job, job.n_parts, parallel_data);
+        else
+            stats_task(&job, 0);
+    }
+
+    stats_finish(stats, parts, job.n_parts);
+    if(parts != &single) {
+        free(bins);
+        free(parts);
+    }
+}
+
+void
+rgb2hsluv_stats_n(const double* rgb, size_t rgb_stride, size_t n, HsluvImageStats* stats)
+{
+    StatsPart part;
+    double hsl[STATS_BLOCK_PIXELS * 3];
+    size_t pos, k;
+
+    stats_init(stats, &part);
+    for(pos = 0; pos < n; pos += k) {
+        k = (n - pos < STATS_BLOCK_PIXELS ? n - pos : STATS_BLOCK_PIXELS);
+        rgb2hsluv_n(rgb + pos * rgb_stride, rgb_stride, hsl, 3, k);
+        stats_block(&part, stats, hsl, k);
+    }
+    stats_finish(stats, &part, 1);
+}
+
+typedef enum FrameState_tag {
+    FRAME_FREE = 0,
+    FRAME_ACQUIRED,
+    FRAME_QUEUED,
+    FRAME_CONVERTING,
+    FRAME_DONE
+} FrameState;
+
+struct HsluvFrame_tag {
+    HsluvFramePipeline* pipeline;
+    void* data;                 /* The output buffer. */
+
+    /* The submission. */
+    const void* in;
+    size_t in_stride;
+    HsluvFrameCallback callback;
+    void* user_data;
+
+    FrameState state;
+    int in_callback;            /* The frame cannot be acquired until the callback returns. */
+    int status;
+    double submit_time;
+    double start_time;
+    double done_time;
+};
+
+struct HsluvFramePipeline_tag {
+    HsluvFrameConfig config;
+    size_t out_stride;          /* In bytes or doubles (see hsluv_frame_data()). */
+
+    HsluvThreadPool* pool;
+    Thread driver;
+    unsigned char* tile_failed; /* Scratch of image_run(). */
+
+    HsluvFrame* frames;
+    void* buffers;              /* The output buffers of all the frames. */
+
+    Mutex lock;                 /* Protects the states of the frames and all the members below. */
+    Cond cond;                  /* Signals any change of the state of a frame (or quit). */
+
+    /* The submitted frames, in a ring buffer of n_buffers slots. */
+    HsluvFrame** queue;
+    unsigned queue_head;
+    unsigned queue_len;
+    int quit;
+
+    size_t n_done;
+    double sum_latency;
+    double max_latency;
+};
+
+static int
+frame_convert(HsluvFramePipeline* pipeline, HsluvFrame* frame)
+{
+    const HsluvFrameConfig* config = &pipeline->config;
+    ImageJob job;
+
+    job.to_rgb8 = NULL;
+    job.from_rgb8 = NULL;
+    switch(config->op) {
+        case HSLUV_FRAME_RGB82HSLUV:    job.from_rgb8 = rgb82hsluv_n_ret; break;
+        case HSLUV_FRAME_RGB82HPLUV:    job.from_rgb8 = rgb82hpluv_n; break;
+        case HSLUV_FRAME_HSLUV2RGB8:    job.to_rgb8 = hsluv2rgb8_n; break;
+        case HSLUV_FRAME_HPLUV2RGB8:    job.to_rgb8 = hpluv2rgb8_n; break;
+    }
+
+    if(job.from_rgb8 != NULL) {
+        job.rgb = (unsigned char*) frame->in;
+        job.rgb_stride = frame->in_stride;
+        job.hsl = (double*) frame->data;
+        job.hsl_stride = pipeline->out_stride;
+    } else {
+        job.hsl = (double*) frame->in;
+        job.hsl_stride = frame->in_stride;
+        job.rgb = (unsigned char*) frame->data;
+        job.rgb_stride = pipeline->out_stride;
+    }
+    job.format = config->format;
+    job.width = config->width;
+    job.height = config->height;
+    job.scratch = pipeline->tile_failed;
+    return image_run(&job, hsluv_thread_pool_run, pipeline->pool);
+}
+
+static void
+pipeline_driver(HsluvFramePipeline* pipeline)
+{
+    mutex_lock(&pipeline->lock);
+    while(1) {
+        HsluvFrame* frame;
+        double latency;
+        int status;
+
+        while(pipeline->queue_len == 0  &&  !pipeline->quit)
+            cond_wait(&pipeline->cond, &pipeline->lock);
+        /* On quit, the queue is drained first. */
+        if(pipeline->queue_len == 0)
+            break;
+
+        frame = pipeline->queue[pipeline->queue_head];
+        pipeline->queue_head = (pipeline->queue_head + 1) % pipeline->config.n_buffers;
+        pipeline->queue_len--;
+        frame->state = FRAME_CONVERTING;
+        frame->start_time = wall_time();
+        mutex_unlock(&pipeline->lock);
+
+        status = frame_convert(pipeline, frame);
+
+        mutex_lock(&pipeline->lock);
+        frame->status = status;
+        frame->done_time = wall_time();
+        frame->state = FRAME_DONE;
+        latency = frame->done_time - frame->submit_time;
+        pipeline->n_done++;
+        pipeline->sum_latency += latency;
+        if(latency > pipeline->max_latency)
+            pipeline->max_latency = latency;
+        cond_broadcast(&pipeline->cond);
+
+        if(frame->callback != NULL) {
+            frame->in_callback = 1;
+            mutex_unlock(&pipeline->lock);
+            frame->callback(frame, frame->user_data);
+            mutex_lock(&pipeline->lock);
+            frame->in_callback = 0;
+            cond_broadcast(&pipeline->cond);
+        }
+    }
+    mutex_unlock(&pipeline->lock);
+}
+
+#if defined _WIN32  &&  !defined HSLUV_NO_THREADS
+static unsigned __stdcall
+pipeline_driver_proc(void* arg)
+{
+    pipeline_driver((HsluvFramePipeline*) arg);
+    return 0;
+}
+#else
+static void*
+pipeline_driver_proc(void* arg)
+{
+    pipeline_driver((HsluvFramePipeline*) arg);
+    return NULL;
+}
+#endif
+
+HsluvFramePipeline*
+hsluv_frame_pipeline_create(const HsluvFrameConfig* config)
+{
+    HsluvFramePipeline* pipeline;
+    ImageJob job;
+    size_t elem_size;
+    size_t frame_size;
+    unsigned i;
+
+    if((unsigned) config->op > HSLUV_FRAME_HPLUV2RGB8  ||  !rgb8_format_valid(config->format))
+        return NULL;
+    if(config->width == 0  ||  config->height == 0  ||  config->n_buffers == 0)
+        return NULL;
+
+    pipeline = (HsluvFramePipeline*) calloc(1, sizeof(HsluvFramePipeline));
+    if(pipeline == NULL)
+        return NULL;
+    pipeline->config = *config;
+    if(pipeline->config.n_threads == 0)
+        pipeline->config.n_threads = cpu_count();
+
+    if(config->op == HSLUV_FRAME_RGB82HSLUV  ||  config->op == HSLUV_FRAME_RGB82HPLUV) {
+        elem_size = sizeof(double);
+        pipeline->out_stride = 3 * config->width;
+    } else {
+        elem_size = 1;
+        pipeline->out_stride = rgb8_format(config->format)->size * config->width;
+    }
+    if(config->height > ((size_t) -1) / config->n_buffers / elem_size / pipeline->out_stride)
+        goto err_buffers;
+    frame_size = pipeline->out_stride * config->height * elem_size;
+
+    job.width = config->width;
+    job.height = config->height;
+    pipeline->tile_failed = (unsigned char*) malloc(image_tiling(&job));
+    pipeline->frames = (HsluvFrame*) calloc(config->n_buffers, sizeof(HsluvFrame));
+    pipeline->queue = (HsluvFrame**) malloc(config->n_buffers * sizeof(HsluvFrame*));
+    pipeline->buffers = malloc(config->n_buffers * frame_size);
+    if(pipeline->tile_failed == NULL  ||  pipeline->frames == NULL  ||
+       pipeline->queue == NULL  ||  pipeline->buffers == NULL)
+        goto err_buffers;
+    /* Opaque alpha once and for all (see hsluv_frame_data()); the conversions
+     * overwrite the rest. */
+    if(elem_size == 1)
+        memset(pipeline->buffers, 0xff, config->n_buffers * frame_size);
+    for(i = 0; i < config->n_buffers; i++) {
+        pipeline->frames[i].pipeline = pipeline;
+        pipeline->frames[i].data = (unsigned char*) pipeline->buffers + i * frame_size;
+    }
+
+    pipeline->pool = pool_create(pipeline->config.n_threads, config->pin_threads, config->first_cpu);
+    if(pipeline->pool == NULL)
+        goto err_buffers;
+    if(mutex_init(&pipeline->lock) != 0)
+        goto err_lock;
+    if(cond_init(&pipeline->cond) != 0)
+        goto err_cond;
+    if(thread_start(&pipeline->driver, pipeline_driver_proc, pipeline) != 0)
+        goto err_driver;
+    if(config->pin_threads)
+        thread_pin(pipeline->driver, config->first_cpu);
+
+    return pipeline;
+
+err_driver:
+    cond_destroy(&pipeline->cond);
+err_cond:
+    mutex_destroy(&pipeline->lock);
+err_lock:
+    hsluv_thread_pool_destroy(pipeline->pool);
+err_buffers:
+    free(pipeline->buffers);
+    free(pipeline->queue);
+    free(pipeline->frames);
+    free(pipeline->tile_failed);
+    free(pipeline);
+    return NULL;
+}
+
+void
+hsluv_frame_pipeline_destroy(HsluvFramePipeline* pipeline)
+{
+    if(pipeline == NULL)
+        return;
+
+    mutex_lock(&pipeline->lock);
+    pipeline->quit = 1;
+    cond_broadcast(&pipeline->cond);
+    mutex_unlock(&pipeline->lock);
+    thread_join(pipeline->driver);
+
+    cond_destroy(&pipeline->cond);
+    mutex_destroy(&pipeline->lock);
+    hsluv_thread_pool_destroy(pipeline->pool);
+    free(pipeline->buffers);
+    free(pipeline->queue);
+    free(pipeline->frames);
+    free(pipeline->tile_failed);
+    free(pipeline);
+}
+
+HsluvFrame*
+hsluv_frame_acquire(HsluvFramePipeline* pipeline, int wait)
+{
+    HsluvFrame* frame = NULL;
+    unsigned i;
+
+    mutex_lock(&pipeline->lock);
+    while(1) {
+        for(i = 0; i < pipeline->config.n_buffers; i++) {
+            if(pipeline->frames[i].state == FRAME_FREE  &&  !pipeline->frames[i].in_callback) {
+                frame = &pipeline->frames[i];
+                frame->state = FRAME_ACQUIRED;
+                break;
+            }
+        }
+        if(frame != NULL  ||  !wait)
+            break;
+        cond_wait(&pipeline->cond, &pipeline->lock);
+    }
+    mutex_unlock(&pipeline->lock);
+
+    return frame;
+}
+
+int
+hsluv_frame_submit(HsluvFrame* frame, const void* in, size_t in_stride,
+                   HsluvFrameCallback callback, void* user_data)
+{
+    HsluvFramePipeline* pipeline = frame->pipeline;
+    int ret = -1;
+
+    mutex_lock(&pipeline->lock);
+    if(frame->state == FRAME_ACQUIRED) {
+        frame->in = in;
+        frame->in_stride = in_stride;
+        frame->callback = callback;
+        frame->user_data = user_data;
+        frame->status = 0;
+        frame->submit_time = wall_time();
+        frame->state = FRAME_QUEUED;
+
+        /* There are never more frames in the queue than in the pool. */
+        pipeline->queue[(pipeline->queue_head + pipeline->queue_len) % pipeline->config.n_buffers] = frame;
+        pipeline->queue_len++;
+        cond_broadcast(&pipeline->cond);
+        ret = 0;
+    }
+    mutex_unlock(&pipeline->lock);
+
+    return ret;
+}
+
+int
+hsluv_frame_wait(HsluvFrame* frame)
+{
+    HsluvFramePipeline* pipeline = frame->pipeline;
+    int status;
+
+    mutex_lock(&pipeline->lock);
+    while(frame->state == FRAME_QUEUED  ||  frame->state == FRAME_CONVERTING)
+        cond_wait(&pipeline->cond, &pipeline->lock);
+    status = frame->status;
+    mutex_unlock(&pipeline->lock);
+
+    return status;
+}
+
+int
+hsluv_frame_release(HsluvFrame* frame)
+{
+    HsluvFramePipeline* pipeline = frame->pipeline;
+    int ret = -1;
+
+    mutex_lock(&pipeline->lock);
+    if(frame->state == FRAME_ACQUIRED  ||  frame->state == FRAME_DONE) {
+        frame->state = FRAME_FREE;
+        cond_broadcast(&pipeline->cond);
+        ret = 0;
+    }
+    mutex_unlock(&pipeline->lock);
+
+    return ret;
+}
+
+void*
+hsluv_frame_data(const HsluvFrame* frame, size_t* stride)
+{
+    if(stride != NULL)
+        *stride = frame->pipeline->out_stride;
+    return frame->data;
+}
+
+int
+hsluv_frame_status(const HsluvFrame* frame)
+{
+    return frame->status;
+}
+
+void
+hsluv_frame_timing(const HsluvFrame* frame, HsluvFrameTiming* timing)
+{
+    timing->queue_time = frame->start_time - frame->submit_time;
+    timing->convert_time = frame->done_time - frame->start_time;
+    timing->latency = frame->done_time - frame->submit_time;
+}
+
+void
+hsluv_frame_pipeline_stats(HsluvFramePipeline* pipeline, HsluvFramePipelineStats* stats)
+{
+    mutex_lock(&pipeline->lock);
+    stats->n_frames = pipeline->n_done;
+    stats->mean_latency = (pipeline->n_done > 0 ? pipeline->sum_latency / (double) pipeline->n_done : 0.0);
+    stats->max_latency = pipeline->max_latency;
+    mutex_unlock(&pipeline->lock);
+}
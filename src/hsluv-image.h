@@ -0,0 +1,392 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_IMAGE_H
+#define HSLUV_IMAGE_H
+
+#include "hsluv.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Parallel execution of tasks.
+ *
+ * The image conversions below split the image into tiles and hand them to a
+ * function of the @c HsluvParallelFunc type, which must call
+ * <tt>task(task_data, i)</tt> once for each @c i in <tt>[0, n)</tt>, in any
+ * order and from any threads, and return only after all the calls have
+ * returned. The tasks are independent of each other.
+ *
+ * Application may plug its own scheduler this way, or use the built-in pool:
+ * pass hsluv_thread_pool_run() as the function and the pool as its
+ * @c user_data.
+ */
+typedef void (*HsluvTaskFunc)(void* task_data, size_t i);
+typedef void (*HsluvParallelFunc)(HsluvTaskFunc task, void* task_data, size_t n, void* user_data);
+
+/**
+ * Built-in pool of worker threads.
+ *
+ * The threads are started by hsluv_thread_pool_create() and sleep while
+ * there is no work. A pool runs one hsluv_thread_pool_run() at a time;
+ * concurrent calls from multiple threads are serialized.
+ */
+typedef struct HsluvThreadPool_tag HsluvThreadPool;
+
+/**
+ * Create a thread pool.
+ *
+ * @param n_threads Number of threads working on the tasks, including the one
+ * calling hsluv_thread_pool_run(). Zero means one per CPU core. Always one
+ * in the builds without threads (see @c HSLUV_NO_THREADS in README.md).
+ * @return The pool, or NULL if the threads cannot be created.
+ */
+HsluvThreadPool* hsluv_thread_pool_create(unsigned n_threads);
+
+/**
+ * Stop the threads and destroy the pool.
+ *
+ * @param pool The pool. May be NULL.
+ */
+void hsluv_thread_pool_destroy(HsluvThreadPool* pool);
+
+/**
+ * Get the number of threads of the pool, including the calling one.
+ *
+ * @param pool The pool.
+ * @return The number of threads.
+ */
+unsigned hsluv_thread_pool_size(const HsluvThreadPool* pool);
+
+/**
+ * Run the tasks on the pool and wait until they all finish. The calling
+ * thread works on the tasks too.
+ *
+ * This is a @c HsluvParallelFunc with the pool as @c user_data.
+ */
+void hsluv_thread_pool_run(HsluvTaskFunc task, void* task_data, size_t n, void* pool);
+
+
+/**
+ * Image conversions.
+ *
+ * These convert a whole image of @c width times @c height pixels between
+ * 8-bit RGB pixels of the given format and HSLuv or HPLuv colors stored as
+ * three consecutive doubles, i.e. they are 2D variants of hsluv2rgb8_n() and
+ * the like.
+ *
+ * The row strides are the distances between the starts of two consecutive
+ * rows: @c rgb_stride is measured in bytes, @c hsl_stride in doubles (use
+ * <tt>3 * width</tt> for tightly packed rows).
+ *
+ * The image is split into tiles of up to 4096 pixels, so that the doubles of
+ * each tile fit into a per-core cache, and the tiles are converted by the
+ * given @c parallel function (see @c HsluvParallelFunc). If it is NULL, all
+ * the tiles are converted in the calling thread. (The tile size can be
+ * changed by defining @c HSLUV_IMAGE_TILE_PIXELS when building the library.)
+ *
+ * The conversions use the batched functions of hsluv.h, so the same kernel
+ * (see hsluv_set_kernel()) and the same global settings apply.
+ *
+ * rgb82hpluv_image() returns 0 if all the pixels are representable in the
+ * HPLuv color space, -1 otherwise (see rgb2hpluv()).
+ */
+void hsluv2rgb8_image(const double* hsl, size_t hsl_stride, unsigned char* rgb, size_t rgb_stride,
+                      HsluvFormat format, size_t width, size_t height,
+                      HsluvParallelFunc parallel, void* parallel_data);
+void rgb82hsluv_image(const unsigned char* rgb, size_t rgb_stride, HsluvFormat format,
+                      double* hsl, size_t hsl_stride, size_t width, size_t height,
+                      HsluvParallelFunc parallel, void* parallel_data);
+void hpluv2rgb8_image(const double* hsl, size_t hsl_stride, unsigned char* rgb, size_t rgb_stride,
+                      HsluvFormat format, size_t width, size_t height,
+                      HsluvParallelFunc parallel, void* parallel_data);
+int rgb82hpluv_image(const unsigned char* rgb, size_t rgb_stride, HsluvFormat format,
+                     double* hsl, size_t hsl_stride, size_t width, size_t height,
+                     HsluvParallelFunc parallel, void* parallel_data);
+
+
+
+/**
+ * Statistics of an image in HSLuv.
+ *
+ * The caller sets the histograms to compute (each may be NULL) and the
+ * threshold of saturation of the hue statistics; the functions below fill
+ * in the rest. The histograms split the ranges into bins of equal widths:
+ * bin @c i of @c n_hue_bins counts the hues in
+ * <tt>[i * 360.0 / n_hue_bins, (i + 1) * 360.0 / n_hue_bins)</tt>, and the
+ * same for the saturation and the lightness in <tt>[0, 100]</tt> (the last
+ * bins include 100.0).
+ *
+ * The hue is meaningless for grays and unstable for nearly gray colors, so
+ * only the colors of saturation @c min_saturation or more count into the hue
+ * histogram and the hue moments. Being an angle, the hue has a circular
+ * mean: the direction of the mean of the unit vectors of the hues, whose
+ * length (between 0.0 for uniformly spread hues and 1.0 for a single hue)
+ * measures how concentrated the hues are.
+ */
+typedef struct HsluvImageStats_tag HsluvImageStats;
+struct HsluvImageStats_tag {
+    /* Set by the caller. */
+    size_t* hue_bins;           /**< Hue histogram of @c n_hue_bins counts, or NULL. */
+    unsigned n_hue_bins;
+    size_t* saturation_bins;    /**< Saturation histogram, or NULL. */
+    unsigned n_saturation_bins;
+    size_t* lightness_bins;     /**< Lightness histogram, or NULL. */
+    unsigned n_lightness_bins;
+    double min_saturation;      /**< Threshold of the hue statistics. */
+
+    /* Results. */
+    size_t n;                   /**< Number of the pixels. */
+    double mean_saturation;
+    double var_saturation;      /**< Population variance. */
+    double mean_lightness;
+    double var_lightness;
+    size_t n_chromatic;         /**< Number of the pixels of saturation @c min_saturation or more. */
+    double mean_hue;            /**< Circular mean of the hues. Between 0.0 and 360.0; 0.0 if undefined. */
+    double hue_concentration;   /**< Length of the mean unit vector of the hues. */
+};
+
+/**
+ * Compute the statistics of an image in HSLuv.
+ *
+ * These are fused analyses: the pixels are converted (by the batched
+ * functions of hsluv.h, so the same kernel applies) in small blocks which
+ * are accumulated right away, so the HSLuv image is never stored. For an
+ * 8-bit image, the pixels are split into up to 64 parts converted by the
+ * given @c parallel function (see @c HsluvParallelFunc), each into its own
+ * histograms and moments, which are merged at the end.
+ *
+ * rgb82hsluv_image_stats() takes an image as rgb82hsluv_image() does (with
+ * @c parallel NULL to run in the calling thread), rgb2hsluv_stats_n() takes
+ * @c n colors laid out as in rgb2hsluv_n() and runs in the calling thread.
+ */
+void rgb82hsluv_image_stats(const unsigned char* rgb, size_t rgb_stride, HsluvFormat format,
+                            size_t width, size_t height, HsluvImageStats* stats,
+                            HsluvParallelFunc parallel, void* parallel_data);
+void rgb2hsluv_stats_n(const double* rgb, size_t rgb_stride, size_t n, HsluvImageStats* stats);
+
+
+/**
+ * Pipeline of video frames.
+ *
+ * The pipeline converts a stream of frames of the same size and format in
+ * the background (with rgb82hsluv_image() or the like), so that the
+ * application may produce or consume one frame while the next ones are being
+ * converted. It owns a pool of @c n_buffers frames, allocated once by
+ * hsluv_frame_pipeline_create(); each frame goes through these steps:
+ *
+ * -# hsluv_frame_acquire() takes a free frame from the pool;
+ * -# hsluv_frame_submit() queues it for conversion, along with the input
+ *    image and a completion callback;
+ * -# the frames are converted one at a time, in the order of submission, by
+ *    a driver thread and the workers of the pipeline, into the output buffer
+ *    of the frame (see hsluv_frame_data()); then the callback is called (in
+ *    the driver thread), and hsluv_frame_wait() returns;
+ * -# hsluv_frame_release() returns the frame into the pool.
+ *
+ * So there is no allocation per frame, and the pool bounds the number of
+ * frames in flight and thus the latency: when all the frames are taken,
+ * hsluv_frame_acquire() waits for a release. Two frames are enough to convert
+ * frame N + 1 while frame N is being consumed; more absorb the jitter of the
+ * producer or the consumer.
+ *
+ * All the functions may be called from any threads.
+ */
+typedef struct HsluvFramePipeline_tag HsluvFramePipeline;
+typedef struct HsluvFrame_tag HsluvFrame;
+
+/**
+ * Conversions of a pipeline.
+ */
+typedef enum HsluvFrameOp_tag {
+    HSLUV_FRAME_RGB82HSLUV = 0, /**< rgb82hsluv_image() */
+    HSLUV_FRAME_RGB82HPLUV,     /**< rgb82hpluv_image() */
+    HSLUV_FRAME_HSLUV2RGB8,     /**< hsluv2rgb8_image() */
+    HSLUV_FRAME_HPLUV2RGB8      /**< hpluv2rgb8_image() */
+} HsluvFrameOp;
+
+/**
+ * Settings of a pipeline.
+ */
+typedef struct HsluvFrameConfig_tag HsluvFrameConfig;
+struct HsluvFrameConfig_tag {
+    HsluvFrameOp op;        /**< The conversion. */
+    HsluvFormat format;     /**< Format of the 8-bit RGB side. */
+    size_t width;           /**< Size of the frames in pixels. */
+    size_t height;
+    unsigned n_buffers;     /**< Number of frames of the pool. At least 1. */
+    unsigned n_threads;     /**< Threads converting a frame, including the driver. Zero means one per CPU core. */
+    int pin_threads;        /**< Non-zero to pin the driver and the workers to consecutive CPUs (where supported). */
+    unsigned first_cpu;     /**< The CPU of the driver when pinned. */
+};
+
+/**
+ * Create a pipeline.
+ *
+ * @param config The settings.
+ * @return The pipeline, or NULL if out of memory, if the threads cannot be
+ * created (always in the builds without threads) or if the settings are
+ * invalid.
+ */
+HsluvFramePipeline* hsluv_frame_pipeline_create(const HsluvFrameConfig* config);
+
+/**
+ * Destroy a pipeline.
+ *
+ * The frames already submitted are converted (and their callbacks called)
+ * first. All the frames, including those not released, are then freed.
+ *
+ * @param pipeline The pipeline. May be NULL.
+ */
+void hsluv_frame_pipeline_destroy(HsluvFramePipeline* pipeline);
+
+/**
+ * Take a free frame from the pool.
+ *
+ * @param pipeline The pipeline.
+ * @param wait If non-zero and all the frames are taken, wait until one is
+ * released.
+ * @return The frame, or NULL if no frame is free (and @c wait is zero).
+ */
+HsluvFrame* hsluv_frame_acquire(HsluvFramePipeline* pipeline, int wait);
+
+/**
+ * Completion callback of a frame.
+ *
+ * It is called in the driver thread, so it delays the conversion of the next
+ * frames and should return quickly. It may call hsluv_frame_release().
+ */
+typedef void (*HsluvFrameCallback)(HsluvFrame* frame, void* user_data);
+
+/**
+ * Queue a frame for conversion.
+ *
+ * The input is an image of the size and the format of the pipeline, laid
+ * out as in the image conversions above: RGB pixels with @c in_stride in
+ * bytes, or HSLuv/HPLuv doubles with @c in_stride in doubles. It must stay
+ * unchanged until the conversion is done.
+ *
+ * @param frame The frame, as returned by hsluv_frame_acquire().
+ * @param in The input image.
+ * @param in_stride The row stride of the input image.
+ * @param callback Called when the frame is converted. May be NULL.
+ * @param user_data Passed to @c callback.
+ * @return 0 on success, -1 if the frame is not acquired or already submitted.
+ */
+int hsluv_frame_submit(HsluvFrame* frame, const void* in, size_t in_stride,
+                       HsluvFrameCallback callback, void* user_data);
+
+/**
+ * Wait until a submitted frame is converted.
+ *
+ * @param frame The frame.
+ * @return The result of the conversion (see hsluv_frame_status()).
+ */
+int hsluv_frame_wait(HsluvFrame* frame);
+
+/**
+ * Return a frame into the pool.
+ *
+ * A frame may be released after its conversion is done, or before it is
+ * submitted.
+ *
+ * @param frame The frame.
+ * @return 0 on success, -1 if the frame is queued or being converted.
+ */
+int hsluv_frame_release(HsluvFrame* frame);
+
+/**
+ * Get the output buffer of a frame.
+ *
+ * The output image has the size and the format of the pipeline, with
+ * tightly packed rows: @c stride is <tt>3 * width</tt> doubles for
+ * HSLuv/HPLuv, or @c width pixels (in bytes) for RGB. The conversions leave
+ * the alpha bytes of RGBA8 and BGRA8 untouched (see hsluv2rgb8_n()), so the
+ * pipeline sets them to 255 (opaque) when it allocates the frames.
+ *
+ * @param frame The frame.
+ * @param[out] stride The row stride. May be NULL.
+ * @return The buffer.
+ */
+void* hsluv_frame_data(const HsluvFrame* frame, size_t* stride);
+
+/**
+ * Get the result of the conversion of a frame.
+ *
+ * @param frame The frame, after its conversion is done.
+ * @return The return value of the conversion: 0, or -1 if rgb82hpluv_image()
+ * finds colors out of HPLuv.
+ */
+int hsluv_frame_status(const HsluvFrame* frame);
+
+/**
+ * Durations of the steps of a frame, in seconds.
+ */
+typedef struct HsluvFrameTiming_tag HsluvFrameTiming;
+struct HsluvFrameTiming_tag {
+    double queue_time;      /**< From the submission to the start of the conversion. */
+    double convert_time;    /**< The conversion (without the callback). */
+    double latency;         /**< From the submission to the end of the conversion. */
+};
+
+/**
+ * Get the timing of a frame.
+ *
+ * @param frame The frame, after its conversion is done.
+ * @param[out] timing The timing.
+ */
+void hsluv_frame_timing(const HsluvFrame* frame, HsluvFrameTiming* timing);
+
+/**
+ * Latencies of all the frames converted by a pipeline, in seconds.
+ */
+typedef struct HsluvFramePipelineStats_tag HsluvFramePipelineStats;
+struct HsluvFramePipelineStats_tag {
+    size_t n_frames;        /**< Number of the frames converted. */
+    double mean_latency;    /**< Mean of HsluvFrameTiming::latency. */
+    double max_latency;     /**< Maximum of the same. */
+};
+
+/**
+ * Get the latencies of a pipeline.
+ *
+ * @param pipeline The pipeline.
+ * @param[out] stats The latencies.
+ */
+void hsluv_frame_pipeline_stats(HsluvFramePipeline* pipeline, HsluvFramePipelineStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HSLUV_IMAGE_H */
@@ -0,0 +1,371 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_INTERNAL_H
+#define HSLUV_INTERNAL_H
+
+/* This header is private to the library. It shares the color space constants
+ * between hsluv.c, the vectorized kernels (see hsluv-simd.h) and the other
+ * modules, and declares the kernel entry points. */
+
+/* The modules timing their work define HSLUV_WALL_TIME and include this header
+ * before anything else. They get wall_time(), and with it <windows.h> or the
+ * POSIX API for their other system calls. */
+#ifdef HSLUV_WALL_TIME
+    #if !defined _WIN32  &&  !defined _POSIX_C_SOURCE
+        #define _POSIX_C_SOURCE 200809L
+    #endif
+    #ifdef _WIN32
+        #include <windows.h>
+    #else
+        #include <time.h>
+    #endif
+#endif
+
+#include <stddef.h>
+
+#include "hsluv.h"
+
+#ifdef HSLUV_WALL_TIME
+/* Seconds from some arbitrary point of time, for the build times and frame
+ * timing of the statistics. */
+static inline double
+wall_time(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double) now.QuadPart / (double) freq.QuadPart;
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+#endif
+
+
+typedef struct Triplet_tag Triplet;
+struct Triplet_tag {
+    double a;
+    double b;
+    double c;
+};
+
+/* for RGB */
+static const Triplet m[3] = {
+    {  3.24096994190452134377, -1.53738317757009345794, -0.49861076029300328366 },
+    { -0.96924363628087982613,  1.87596750150772066772,  0.04155505740717561247 },
+    {  0.05563007969699360846, -0.20397695888897656435,  1.05697151424287856072 }
+};
+
+/* for XYZ */
+static const Triplet m_inv[3] = {
+    {  0.41239079926595948129,  0.35758433938387796373,  0.18048078840183428751 },
+    {  0.21263900587151035754,  0.71516867876775592746,  0.07219231536073371500 },
+    {  0.01933081871559185069,  0.11919477979462598791,  0.95053215224966058086 }
+};
+
+static const double ref_u = 0.19783000664283680764;
+static const double ref_v = 0.46831999493879100370;
+
+static const double kappa = 903.29629629629629629630;
+static const double epsilon = 0.00885645167903563082;
+
+/* The same as HsluvRgbSpace (see hsluv_rgb_space_init()). The bounds
+ * coefficients of the lines 2 * i and 2 * i + 1 are 284517 * m1 - 94839 * m3,
+ * 838422 * m3 + 769860 * m2 + 731718 * m1 and 632260 * m3 - 126452 * m2 of
+ * the row i (m1, m2, m3) of m, evaluated in double precision, and the terms
+ * 769860 * t and 126452 * t for t = 0 and 1 respectively; so get_bounds()
+ * gives bit-exact results of the original formulas. Functions taking a space
+ * get a pointer to this one for sRGB; once inlined, the compiler folds it into
+ * the constants. */
+static const HsluvRgbSpace srgb_space = {
+    {
+        {  3.24096994190452134377, -1.53738317757009345794, -0.49861076029300328366 },
+        { -0.96924363628087982613,  1.87596750150772066772,  0.04155505740717561247 },
+        {  0.05563007969699360846, -0.20397695888897656435,  1.05697151424287856072 }
+    },
+    {
+        {  0.41239079926595948129,  0.35758433938387796373,  0.18048078840183428751 },
+        {  0.21263900587151035754,  0.71516867876775592746,  0.07219231536073371500 },
+        {  0.01933081871559185069,  0.11919477979462598791,  0.95053215224966058086 }
+    },
+    0.19783000664283680764,
+    0.46831999493879100370,
+    {
+        969398.790856276755221, 969398.790856276755221,
+        -279707.331753166217823, -279707.331753166217823,
+        -84414.4180541308305692, -84414.4180541308305692
+    },
+    {
+        769860.0, 769860.0,
+        769860.0, 769860.0,
+        769860.000000000116415, 769860.000000000116415
+    },
+    { 0.0, 769860.0, 0.0, 769860.0, 0.0, 769860.0 },
+    {
+        -120846.46173276079935, -120846.46173276079935,
+        -210946.241904393420555, -210946.241904393420555,
+        694074.104000631254166, 694074.104000631254166
+    },
+    { 0.0, 126452.0, 0.0, 126452.0, 0.0, 126452.0 },
+    0.0031308,
+    0.04045,
+    12.92,
+    1.055,
+    0.055,
+    2.4
+};
+
+
+/* Layouts of HsluvFormat pixels: byte size and offsets of the RGB channels. */
+typedef struct Rgb8Format_tag Rgb8Format;
+struct Rgb8Format_tag {
+    size_t size;
+    size_t r;
+    size_t g;
+    size_t b;
+};
+
+static const Rgb8Format rgb8_formats[] = {
+    { 3, 0, 1, 2 },     /* HSLUV_FORMAT_RGB8 */
+    { 4, 0, 1, 2 },     /* HSLUV_FORMAT_RGBA8 */
+    { 4, 2, 1, 0 }      /* HSLUV_FORMAT_BGRA8 */
+};
+
+/* The conversions take the format as given (see HsluvFormat); only the
+ * functions which store it for later, and can fail anyway, check it. */
+static inline int
+rgb8_format_valid(HsluvFormat format)
+{
+    return ((unsigned) format < sizeof(rgb8_formats) / sizeof(rgb8_formats[0]));
+}
+
+static inline const Rgb8Format*
+rgb8_format(HsluvFormat format)
+{
+    return &rgb8_formats[format];
+}
+
+
+/* Signatures shared by all the kernels, in double and in single precision.
+ * These are also the signatures of the planar batched functions declared in
+ * hsluv.h. They return -1 only if rgb2hpluv() would return -1 for any of the
+ * colors, 0 otherwise. */
+typedef int (*HsluvKernelFunc)(const double* a, const double* b, const double* c,
+                               size_t in_stride, double* x, double* y, double* z,
+                               size_t out_stride, size_t n);
+typedef int (*HsluvKernelFuncF)(const float* a, const float* b, const float* c,
+                                size_t in_stride, float* x, float* y, float* z,
+                                size_t out_stride, size_t n);
+
+/* The same for any RGB working space (see hsluv_rgb_space_init()). */
+typedef int (*HsluvSpaceKernelFunc)(const HsluvRgbSpace* space,
+                                    const double* a, const double* b, const double* c,
+                                    size_t in_stride, double* x, double* y, double* z,
+                                    size_t out_stride, size_t n);
+typedef int (*HsluvSpaceKernelFuncF)(const HsluvRgbSpace* space,
+                                     const float* a, const float* b, const float* c,
+                                     size_t in_stride, float* x, float* y, float* z,
+                                     size_t out_stride, size_t n);
+
+/* The gamut polygon of one lightness as hue sectors (see hue_sectors_init()
+ * in hsluv.c): sector i spans the hues from the vertex (u[i], v[i])
+ * counterclockwise to the next one, and its boundary is the line
+ * v = a[i] * u + b[i]. Polygons of fewer than six vertices repeat the last
+ * one, and the closing edge is always sector 5. */
+typedef struct HueSectors_tag HueSectors;
+struct HueSectors_tag {
+    double u[6];
+    double v[6];
+    double a[6];
+    double b[6];
+};
+
+/* Colors of one lightness in a row the batched functions need before they
+ * build its hue sectors. */
+#ifndef HSLUV_SECTORS_MIN_RUN
+    #define HSLUV_SECTORS_MIN_RUN   64
+#endif
+
+/* The hue sectors of the lightness l in the space (for the vector kernels).
+ * Returns -1 for white, black and degenerate polygons. */
+HSLUV_API int hsluv_hue_sectors_for_l(const HsluvRgbSpace* space, double l,
+                                      HueSectors* sectors);
+
+/* Parameters of the fused edits of RGB colors (see hsluv_rotate_hue_rgb_n()
+ * and friends), and the signature of the double precision kernels doing
+ * them. */
+typedef enum EditOp_tag {
+    EDIT_ROTATE_HUE = 0,
+    EDIT_SET_LIGHTNESS,
+    EDIT_SCALE_SATURATION
+} EditOp;
+
+typedef struct Edit_tag Edit;
+struct Edit_tag {
+    EditOp op;
+    double sin_d;       /* EDIT_ROTATE_HUE: sine and cosine of the angle. */
+    double cos_d;
+    double l;           /* EDIT_SET_LIGHTNESS: the new lightness, */
+    int has_sectors;    /* and the hue sectors of its gamut, if valid. */
+    HueSectors sectors;
+    double factor;      /* EDIT_SCALE_SATURATION: the factor. */
+};
+
+typedef int (*HsluvEditFunc)(const double* r, const double* g, const double* b,
+                             size_t in_stride, double* x, double* y, double* z,
+                             size_t out_stride, size_t n, const Edit* edit);
+
+/* The 3D LUT of hsluv-lut3d.c as seen by the kernels interpolating it (see
+ * hsluv_lut3d_build()), and the signatures of the kernels. */
+typedef struct Lut3d_tag Lut3d;
+struct Lut3d_tag {
+    const float* nodes;     /* size^3 nodes of (L, u, v) of CIELUV; blue runs fastest. */
+    int size;
+};
+
+/* Colors darker than this get the exact conversion instead. */
+#define LUT3D_EXACT_L       4.0
+
+typedef int (*HsluvLut3dFunc)(const double* r, const double* g, const double* b,
+                              size_t in_stride, double* x, double* y, double* z,
+                              size_t out_stride, size_t n, const Lut3d* lut);
+typedef int (*HsluvLut3dFuncF)(const float* r, const float* g, const float* b,
+                               size_t in_stride, float* x, float* y, float* z,
+                               size_t out_stride, size_t n, const Lut3d* lut);
+
+/* The batched LUT evaluation on the current kernel (see hsluv_set_kernel()). */
+HSLUV_API int hsluv_lut3d_kernel(const Lut3d* lut, const double* in, size_t in_stride,
+                                 double* out, size_t out_stride, size_t n);
+HSLUV_API int hsluv_lut3d_kernelf(const Lut3d* lut, const float* in, size_t in_stride,
+                                  float* out, size_t out_stride, size_t n);
+
+#define HSLUV_DECLARE_KERNELS_API(api, prefix, real)                         \
+    api int prefix##_hsluv2rgb(const real* a, const real* b, const real* c,    \
+                size_t in_stride, real* x, real* y, real* z,                  \
+                size_t out_stride, size_t n);                                 \
+    api int prefix##_hpluv2rgb(const real* a, const real* b, const real* c,    \
+                size_t in_stride, real* x, real* y, real* z,                  \
+                size_t out_stride, size_t n);                                 \
+    api int prefix##_rgb2hsluv(const real* a, const real* b, const real* c,    \
+                size_t in_stride, real* x, real* y, real* z,                  \
+                size_t out_stride, size_t n);                                 \
+    api int prefix##_rgb2hpluv(const real* a, const real* b, const real* c,    \
+                size_t in_stride, real* x, real* y, real* z,                  \
+                size_t out_stride, size_t n);                                 \
+    api int prefix##_hsluv2rgb_space(const HsluvRgbSpace* space,              \
+                const real* a, const real* b, const real* c,                  \
+                size_t in_stride, real* x, real* y, real* z,                  \
+                size_t out_stride, size_t n);                                 \
+    api int prefix##_hpluv2rgb_space(const HsluvRgbSpace* space,              \
+                const real* a, const real* b, const real* c,                  \
+                size_t in_stride, real* x, real* y, real* z,                  \
+                size_t out_stride, size_t n);                                 \
+    api int prefix##_rgb2hsluv_space(const HsluvRgbSpace* space,              \
+                const real* a, const real* b, const real* c,                  \
+                size_t in_stride, real* x, real* y, real* z,                  \
+                size_t out_stride, size_t n);                                 \
+    api int prefix##_rgb2hpluv_space(const HsluvRgbSpace* space,              \
+                const real* a, const real* b, const real* c,                  \
+                size_t in_stride, real* x, real* y, real* z,                  \
+                size_t out_stride, size_t n);                                 \
+    api int prefix##_lut3d_rgb2hsluv(const real* a, const real* b,            \
+                const real* c, size_t in_stride, real* x, real* y, real* z,   \
+                size_t out_stride, size_t n, const Lut3d* lut);
+
+#define HSLUV_DECLARE_KERNELS(prefix, real)                                   \
+    HSLUV_DECLARE_KERNELS_API(, prefix, real)
+
+#define HSLUV_DECLARE_EDIT_KERNEL(prefix)                                     \
+    int prefix##_edit_rgb(const double* r, const double* g, const double* b,  \
+                size_t in_stride, double* x, double* y, double* z,            \
+                size_t out_stride, size_t n, const Edit* edit);
+
+/* Portable single precision kernels (hsluv-float.c). In the header-only
+ * static build (see hsluv.h), they are local to the including file too. */
+#if defined HSLUV_IMPLEMENTATION  &&  defined HSLUV_STATIC
+    #define HSLUV_SCALAR_FLOAT_API  static
+#else
+    #define HSLUV_SCALAR_FLOAT_API
+#endif
+HSLUV_DECLARE_KERNELS_API(HSLUV_SCALAR_FLOAT_API, hsluv_scalar_float, float)
+
+/* Kernels available in this build. The build system defines HSLUV_HAVE_xxx
+ * when it compiles the respective kernel with the flags the instruction set
+ * needs; the CPU support is then detected at run time. Without the build
+ * system, a kernel is built only if the whole library targets its ISA. (Not
+ * in the header-only build of hsluv.h, which never compiles the kernels.) */
+#ifndef HSLUV_IMPLEMENTATION
+#if !defined HSLUV_HAVE_SSE41  &&  (defined __SSE4_1__  ||  defined __AVX__)
+    #define HSLUV_HAVE_SSE41
+#endif
+#if !defined HSLUV_HAVE_AVX2  &&  defined __AVX2__  &&  defined __FMA__
+    #define HSLUV_HAVE_AVX2
+#endif
+#if !defined HSLUV_HAVE_AVX512  &&  defined __AVX512F__
+    #define HSLUV_HAVE_AVX512
+#endif
+#if !defined HSLUV_HAVE_NEON  &&  (defined __aarch64__  ||  defined _M_ARM64)
+    #define HSLUV_HAVE_NEON
+#endif
+#endif  /* HSLUV_IMPLEMENTATION */
+#ifdef HSLUV_NO_SIMD
+    #undef HSLUV_HAVE_SSE41
+    #undef HSLUV_HAVE_AVX2
+    #undef HSLUV_HAVE_AVX512
+    #undef HSLUV_HAVE_NEON
+#endif
+
+#ifdef HSLUV_HAVE_SSE41
+    HSLUV_DECLARE_KERNELS(hsluv_sse41, double)
+    HSLUV_DECLARE_EDIT_KERNEL(hsluv_sse41)
+    HSLUV_DECLARE_KERNELS(hsluv_sse41_float, float)
+#endif
+#ifdef HSLUV_HAVE_AVX2
+    HSLUV_DECLARE_KERNELS(hsluv_avx2, double)
+    HSLUV_DECLARE_EDIT_KERNEL(hsluv_avx2)
+    HSLUV_DECLARE_KERNELS(hsluv_avx2_float, float)
+#endif
+#ifdef HSLUV_HAVE_AVX512
+    HSLUV_DECLARE_KERNELS(hsluv_avx512, double)
+    HSLUV_DECLARE_EDIT_KERNEL(hsluv_avx512)
+    HSLUV_DECLARE_KERNELS(hsluv_avx512_float, float)
+#endif
+#ifdef HSLUV_HAVE_NEON
+    HSLUV_DECLARE_KERNELS(hsluv_neon, double)
+    HSLUV_DECLARE_EDIT_KERNEL(hsluv_neon)
+    HSLUV_DECLARE_KERNELS(hsluv_neon_float, float)
+#endif
+
+
+#endif  /* HSLUV_INTERNAL_H */
@@ -0,0 +1,226 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#define HSLUV_WALL_TIME
+#include "hsluv-internal.h"
+#include "hsluv-lut3d.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#define LUT3D_MIN_SIZE      3
+#define LUT3D_MAX_SIZE      256
+
+struct HsluvLut3d_tag {
+    Lut3d lut;
+    float* nodes;
+    double build_time;
+};
+
+
+HsluvLut3d*
+hsluv_lut3d_build(int size)
+{
+    HsluvLut3d* lut;
+    double* row;
+    double start = wall_time();
+    size_t n_nodes;
+    int r, g, b;
+
+    if(size < LUT3D_MIN_SIZE  ||  size > LUT3D_MAX_SIZE)
+        return NULL;
+    n_nodes = (size_t) size * size * size;
+
+    lut = (HsluvLut3d*) malloc(sizeof(HsluvLut3d));
+    if(lut == NULL)
+        return NULL;
+    lut->nodes = (float*) malloc(n_nodes * 3 * sizeof(float));
+    row = (double*) malloc((size_t) size * 3 * sizeof(double));
+    if(lut->nodes == NULL  ||  row == NULL) {
+        free(row);
+        free(lut->nodes);
+        free(lut);
+        return NULL;
+    }
+
+    /* One row of all the blues at a time, converted in place. */
+    for(r = 0; r < size; r++) {
+        for(g = 0; g < size; g++) {
+            float* node = lut->nodes + ((size_t) r * size + g) * size * 3;
+
+            for(b = 0; b < size; b++) {
+                row[b * 3] = (double) r / (size - 1);
+                row[b * 3 + 1] = (double) g / (size - 1);
+                row[b * 3 + 2] = (double) b / (size - 1);
+            }
+
+            rgb2hsluv_n(row, 3, row, 3, size);
+            hsluv2lch_n(row, 3, row, 3, size);
+
+            for(b = 0; b < size; b++) {
+                double c = row[b * 3 + 1];
+                double hrad = row[b * 3 + 2] * 0.01745329251994329577;  /* (pi / 180.0) */
+
+                node[b * 3] = (float) row[b * 3];
+                node[b * 3 + 1] = (float) (c * cos(hrad));
+                node[b * 3 + 2] = (float) (c * sin(hrad));
+            }
+        }
+    }
+
+    free(row);
+    lut->lut.nodes = lut->nodes;
+    lut->lut.size = size;
+    lut->build_time = wall_time() - start;
+    return lut;
+}
+
+void
+hsluv_lut3d_free(HsluvLut3d* lut)
+{
+    if(lut != NULL) {
+        free(lut->nodes);
+        free(lut);
+    }
+}
+
+int
+hsluv_lut3d_size(const HsluvLut3d* lut)
+{
+    return lut->lut.size;
+}
+
+size_t
+hsluv_lut3d_footprint(const HsluvLut3d* lut)
+{
+    return (size_t) lut->lut.size * lut->lut.size * lut->lut.size * 3 * sizeof(float);
+}
+
+double
+hsluv_lut3d_build_time(const HsluvLut3d* lut)
+{
+    return lut->build_time;
+}
+
+void
+hsluv_lut3d_rgb2hsluv(const HsluvLut3d* lut, double r, double g, double b,
+                      double* ph, double* ps, double* pl)
+{
+    double rgb[3] = { r, g, b };
+    double hsl[3];
+
+    hsluv_lut3d_kernel(&lut->lut, rgb, 3, hsl, 3, 1);
+    *ph = hsl[0];
+    *ps = hsl[1];
+    *pl = hsl[2];
+}
+
+void
+hsluv_lut3d_rgb2hsluv_n(const HsluvLut3d* lut, const double* in, size_t in_stride,
+                        double* out, size_t out_stride, size_t n)
+{
+    hsluv_lut3d_kernel(&lut->lut, in, in_stride, out, out_stride, n);
+}
+
+void
+hsluv_lut3d_rgb2hsluvf_n(const HsluvLut3d* lut, const float* in, size_t in_stride,
+                         float* out, size_t out_stride, size_t n)
+{
+    hsluv_lut3d_kernelf(&lut->lut, in, in_stride, out, out_stride, n);
+}
+
+int
+hsluv_lut3d_accuracy(const HsluvLut3d* lut, int steps, HsluvLut3dAccuracy* acc)
+{
+    double* row;
+    double* exact;
+    double* approx;
+    double sum_h = 0.0, sum_s = 0.0, sum_l = 0.0;
+    size_t n_h = 0;
+    int r, g, b;
+
+    if(steps < 1)
+        return -1;
+    row = (double*) malloc((size_t) steps * 3 * sizeof(double));
+    exact = (double*) malloc((size_t) steps * 3 * sizeof(double));
+    approx = (double*) malloc((size_t) steps * 3 * sizeof(double));
+    if(row == NULL  ||  exact == NULL  ||  approx == NULL) {
+        free(row);
+        free(exact);
+        free(approx);
+        return -1;
+    }
+
+    memset(acc, 0, sizeof(HsluvLut3dAccuracy));
+    for(r = 0; r < steps; r++) {
+        for(g = 0; g < steps; g++) {
+            for(b = 0; b < steps; b++) {
+                row[b * 3] = (r + 0.5) / steps;
+                row[b * 3 + 1] = (g + 0.5) / steps;
+                row[b * 3 + 2] = (b + 0.5) / steps;
+            }
+
+            rgb2hsluv_n(row, 3, exact, 3, steps);
+            hsluv_lut3d_rgb2hsluv_n(lut, row, 3, approx, 3, steps);
+
+            for(b = 0; b < steps * 3; b += 3) {
+                double dh = fabs(approx[b] - exact[b]);
+                double ds = fabs(approx[b + 1] - exact[b + 1]);
+                double dl = fabs(approx[b + 2] - exact[b + 2]);
+
+                /* The shorter way around. */
+                if(dh > 180.0)
+                    dh = 360.0 - dh;
+                if(exact[b + 1] >= 1.0) {
+                    if(dh > acc->max_h)
+                        acc->max_h = dh;
+                    sum_h += dh * dh;
+                    n_h++;
+                }
+                if(ds > acc->max_s)
+                    acc->max_s = ds;
+                if(dl > acc->max_l)
+                    acc->max_l = dl;
+                sum_s += ds * ds;
+                sum_l += dl * dl;
+            }
+        }
+    }
+
+    acc->n = (size_t) steps * steps * steps;
+    acc->rms_h = (n_h > 0 ? sqrt(sum_h / (double) n_h) : 0.0);
+    acc->rms_s = sqrt(sum_s / (double) acc->n);
+    acc->rms_l = sqrt(sum_l / (double) acc->n);
+
+    free(row);
+    free(exact);
+    free(approx);
+    return 0;
+}
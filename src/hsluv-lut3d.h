@@ -0,0 +1,183 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_LUT3D_H
+#define HSLUV_LUT3D_H
+
+#include "hsluv.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * RGB to HSLuv conversion interpolated from a 3D lookup table.
+ *
+ * Unlike HsluvCache, which is limited to 8-bit channels, the table works for
+ * any input precision (10-, 12- or 16-bit, float): it samples the RGB cube
+ * on a regular grid of size^3 nodes (e.g. 33^3 or 65^3, as is usual in color
+ * grading), each holding the exact rgb2hsluv() of its color, and the colors
+ * in between are interpolated tetrahedrally from four of the eight nodes of
+ * their cell.
+ *
+ * The nodes do not store HSLuv but CIELUV, which is smooth over the whole
+ * cube: the hue of HSLuv jumps from 360 to 0 degrees and is ill-defined on
+ * the gray axis, and its saturation is discontinuous in the black and white
+ * corners (the darkest reds, greens or blues are fully saturated, but black
+ * is not). The interpolated (L, u, v) then go through the exact tail of the
+ * conversion, so the saturation stays consistent with the gamut bounds, and
+ * grays, lying on the diagonal of the cells, interpolate from gray nodes only
+ * and get zero saturation. Only the very dark colors (lightness below 4.0),
+ * where a tiny error of u and v is a large error of the saturation, get the
+ * exact conversion instead.
+ *
+ * The error of the interpolation falls with the square of the grid spacing;
+ * hsluv_lut3d_accuracy() measures it. With 97 samples per axis, the errors
+ * are:
+ *
+ * | size | footprint | max. error of L, S | RMS error of L, S |
+ * |------|-----------|--------------------|-------------------|
+ * | 17   | 59 KB     | 0.39, 7.4          | 0.028, 0.24       |
+ * | 33   | 431 KB    | 0.14, 2.0          | 0.0079, 0.070     |
+ * | 65   | 3.3 MB    | 0.035, 0.67        | 0.0019, 0.017     |
+ * | 129  | 25.8 MB   | 0.0091, 0.14       | 0.00049, 0.0042   |
+ *
+ * (The largest errors of the saturation are those of the dark colors just
+ * above the exact range, the largest errors of the hue those of the barely
+ * saturated colors; elsewhere, the errors are far below the maximum.)
+ *
+ * The interpolation runs on the vectorized kernels (see hsluv_set_kernel()).
+ *
+ * The lookups do not modify the table, so one table may be used by many
+ * threads at once.
+ */
+typedef struct HsluvLut3d_tag HsluvLut3d;
+
+/**
+ * Build the table.
+ *
+ * @param size Number of nodes per axis. Between 3 and 256.
+ * @return The table, or NULL if out of memory or if @c size is out of range.
+ */
+HsluvLut3d* hsluv_lut3d_build(int size);
+
+/**
+ * Destroy the table.
+ *
+ * @param lut The table.
+ */
+void hsluv_lut3d_free(HsluvLut3d* lut);
+
+/**
+ * Get the number of nodes per axis.
+ *
+ * @param lut The table.
+ * @return The @c size passed to hsluv_lut3d_build().
+ */
+int hsluv_lut3d_size(const HsluvLut3d* lut);
+
+/**
+ * Get the memory footprint of the table.
+ *
+ * @param lut The table.
+ * @return Size of the nodes in bytes.
+ */
+size_t hsluv_lut3d_footprint(const HsluvLut3d* lut);
+
+/**
+ * Get how long building the table took.
+ *
+ * @param lut The table.
+ * @return The wall time of hsluv_lut3d_build() in seconds.
+ */
+double hsluv_lut3d_build_time(const HsluvLut3d* lut);
+
+/**
+ * Convert RGB to HSLuv by interpolating in the table.
+ *
+ * The input is clamped to the range [0.0, 1.0].
+ *
+ * @param lut The table.
+ * @param r Red component. Between 0.0 and 1.0.
+ * @param g Green component. Between 0.0 and 1.0.
+ * @param b Blue component. Between 0.0 and 1.0.
+ * @param[out] ph Hue. Between 0.0 and 360.0.
+ * @param[out] ps Saturation. Between 0.0 and 100.0.
+ * @param[out] pl Lightness. Between 0.0 and 100.0.
+ */
+void hsluv_lut3d_rgb2hsluv(const HsluvLut3d* lut, double r, double g, double b,
+                           double* ph, double* ps, double* pl);
+
+/**
+ * Convert RGB colors to HSLuv by interpolating in the table.
+ *
+ * These are the interpolated counterparts of rgb2hsluv_n() and
+ * rgb2hsluvf_n(), with the same layout of the data.
+ */
+void hsluv_lut3d_rgb2hsluv_n(const HsluvLut3d* lut, const double* in, size_t in_stride,
+                             double* out, size_t out_stride, size_t n);
+void hsluv_lut3d_rgb2hsluvf_n(const HsluvLut3d* lut, const float* in, size_t in_stride,
+                              float* out, size_t out_stride, size_t n);
+
+/**
+ * Errors of the table against the exact rgb2hsluv(), as measured by
+ * hsluv_lut3d_accuracy().
+ */
+typedef struct HsluvLut3dAccuracy_tag HsluvLut3dAccuracy;
+struct HsluvLut3dAccuracy_tag {
+    double max_h;       /**< Maximal error of hue (in degrees), for colors of saturation 1.0 or more. */
+    double max_s;       /**< Maximal error of saturation. */
+    double max_l;       /**< Maximal error of lightness. */
+    double rms_h;       /**< Root mean square errors of the same. */
+    double rms_s;
+    double rms_l;
+    size_t n;           /**< Number of the colors compared. */
+};
+
+/**
+ * Measure the errors of the table.
+ *
+ * The table is compared with rgb2hsluv_n() in the centers of the @c steps^3
+ * cells of a regular grid covering the RGB cube.
+ *
+ * @param lut The table.
+ * @param steps Number of samples per axis.
+ * @param[out] acc The errors.
+ * @return 0 on success, -1 if out of memory or if @c steps is not positive.
+ */
+int hsluv_lut3d_accuracy(const HsluvLut3d* lut, int steps, HsluvLut3dAccuracy* acc);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HSLUV_LUT3D_H */
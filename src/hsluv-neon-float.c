@@ -0,0 +1,100 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* NEON single precision kernels: 4 floats per vector. Built only for
+ * AArch64, together with the double precision ones. */
+
+#include "hsluv-internal.h"
+
+#ifdef HSLUV_HAVE_NEON
+
+#include <arm_neon.h>
+
+
+typedef float32x4_t vr;
+typedef uint32x4_t vm;
+
+#define SIMD_FLOAT              1
+#define VR_WIDTH                4
+#define SIMD_NAME(fn)           hsluv_neon_float_##fn
+
+static inline vr vr_set(double x)               { return vdupq_n_f32((float) x); }
+static inline vr vr_loadu(const float* p)       { return vld1q_f32(p); }
+static inline void vr_storeu(float* p, vr x)    { vst1q_f32(p, x); }
+static inline vr vr_add(vr x, vr y)             { return vaddq_f32(x, y); }
+static inline vr vr_sub(vr x, vr y)             { return vsubq_f32(x, y); }
+static inline vr vr_mul(vr x, vr y)             { return vmulq_f32(x, y); }
+static inline vr vr_div(vr x, vr y)             { return vdivq_f32(x, y); }
+static inline vr vr_fma(vr x, vr y, vr z)       { return vfmaq_f32(z, x, y); }
+static inline vr vr_sqrt(vr x)                  { return vsqrtq_f32(x); }
+static inline vr vr_min(vr x, vr y)             { return vminq_f32(x, y); }
+static inline vr vr_max(vr x, vr y)             { return vmaxq_f32(x, y); }
+static inline vr vr_round(vr x)                 { return vrndnq_f32(x); }
+static inline vr vr_floor(vr x)                 { return vrndmq_f32(x); }
+static inline vm vr_lt(vr x, vr y)              { return vcltq_f32(x, y); }
+static inline vm vr_le(vr x, vr y)              { return vcleq_f32(x, y); }
+static inline vm vr_gt(vr x, vr y)              { return vcgtq_f32(x, y); }
+static inline vm vr_ge(vr x, vr y)              { return vcgeq_f32(x, y); }
+static inline vr vr_sel(vm mask, vr x, vr y)    { return vbslq_f32(mask, x, y); }
+static inline vm vm_and(vm x, vm y)             { return vandq_u32(x, y); }
+static inline vm vm_or(vm x, vm y)              { return vorrq_u32(x, y); }
+static inline int vm_any(vm x)                  { return vmaxvq_u32(x) != 0; }
+
+/* Unbiased exponent of positive normal x, as a float. */
+static inline vr
+vr_exponent(vr x)
+{
+    uint32x4_t e = vshrq_n_u32(vreinterpretq_u32_f32(x), 23);
+    return vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(e), vdupq_n_s32(127)));
+}
+
+/* Mantissa of positive x, scaled into [1, 2). */
+static inline vr
+vr_mantissa(vr x)
+{
+    uint32x4_t bits = vandq_u32(vreinterpretq_u32_f32(x), vdupq_n_u32(0x007fffff));
+    return vreinterpretq_f32_u32(vorrq_u32(bits, vdupq_n_u32(0x3f800000)));
+}
+
+/* x * 2^k for integral k. */
+static inline vr
+vr_ldexp(vr x, vr k)
+{
+    int32x4_t e = vcvtq_s32_f32(vminq_f32(vmaxq_f32(k, vdupq_n_f32(-126.0f)), vdupq_n_f32(127.0f)));
+    int32x4_t bits = vshlq_n_s32(vaddq_s32(e, vdupq_n_s32(127)), 23);
+    return vmulq_f32(x, vreinterpretq_f32_s32(bits));
+}
+
+#include "hsluv-simd.h"
+
+#else
+
+/* ISO C forbids an empty translation unit. */
+typedef int hsluv_neon_float_unused;
+
+#endif
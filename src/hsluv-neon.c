@@ -0,0 +1,100 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* NEON kernels: 2 doubles per vector. Only AArch64 has double precision
+ * NEON, so there is nothing to build for 32-bit ARM. */
+
+#include "hsluv-internal.h"
+
+#ifdef HSLUV_HAVE_NEON
+
+#include <arm_neon.h>
+
+
+typedef float64x2_t vr;
+typedef uint64x2_t vm;
+
+#define SIMD_FLOAT              0
+#define VR_WIDTH                2
+#define SIMD_NAME(fn)           hsluv_neon_##fn
+
+static inline vr vr_set(double x)               { return vdupq_n_f64(x); }
+static inline vr vr_loadu(const double* p)      { return vld1q_f64(p); }
+static inline void vr_storeu(double* p, vr x)   { vst1q_f64(p, x); }
+static inline vr vr_add(vr x, vr y)             { return vaddq_f64(x, y); }
+static inline vr vr_sub(vr x, vr y)             { return vsubq_f64(x, y); }
+static inline vr vr_mul(vr x, vr y)             { return vmulq_f64(x, y); }
+static inline vr vr_div(vr x, vr y)             { return vdivq_f64(x, y); }
+static inline vr vr_fma(vr x, vr y, vr z)       { return vfmaq_f64(z, x, y); }
+static inline vr vr_sqrt(vr x)                  { return vsqrtq_f64(x); }
+static inline vr vr_min(vr x, vr y)             { return vminq_f64(x, y); }
+static inline vr vr_max(vr x, vr y)             { return vmaxq_f64(x, y); }
+static inline vr vr_round(vr x)                 { return vrndnq_f64(x); }
+static inline vr vr_floor(vr x)                 { return vrndmq_f64(x); }
+static inline vm vr_lt(vr x, vr y)              { return vcltq_f64(x, y); }
+static inline vm vr_le(vr x, vr y)              { return vcleq_f64(x, y); }
+static inline vm vr_gt(vr x, vr y)              { return vcgtq_f64(x, y); }
+static inline vm vr_ge(vr x, vr y)              { return vcgeq_f64(x, y); }
+static inline vr vr_sel(vm mask, vr x, vr y)    { return vbslq_f64(mask, x, y); }
+static inline vm vm_and(vm x, vm y)             { return vandq_u64(x, y); }
+static inline vm vm_or(vm x, vm y)              { return vorrq_u64(x, y); }
+static inline int vm_any(vm x)                  { return vmaxvq_u32(vreinterpretq_u32_u64(x)) != 0; }
+
+/* Unbiased exponent of positive normal x, as a double. */
+static inline vr
+vr_exponent(vr x)
+{
+    uint64x2_t e = vshrq_n_u64(vreinterpretq_u64_f64(x), 52);
+    return vcvtq_f64_s64(vsubq_s64(vreinterpretq_s64_u64(e), vdupq_n_s64(1023)));
+}
+
+/* Mantissa of positive x, scaled into [1, 2). */
+static inline vr
+vr_mantissa(vr x)
+{
+    uint64x2_t bits = vandq_u64(vreinterpretq_u64_f64(x), vdupq_n_u64(0x000fffffffffffffULL));
+    return vreinterpretq_f64_u64(vorrq_u64(bits, vdupq_n_u64(0x3ff0000000000000ULL)));
+}
+
+/* x * 2^k for integral k. */
+static inline vr
+vr_ldexp(vr x, vr k)
+{
+    int64x2_t e = vcvtq_s64_f64(vminq_f64(vmaxq_f64(k, vdupq_n_f64(-1022.0)), vdupq_n_f64(1023.0)));
+    int64x2_t bits = vshlq_n_s64(vaddq_s64(e, vdupq_n_s64(1023)), 52);
+    return vmulq_f64(x, vreinterpretq_f64_s64(bits));
+}
+
+#include "hsluv-simd.h"
+
+#else
+
+/* ISO C forbids an empty translation unit. */
+typedef int hsluv_neon_unused;
+
+#endif
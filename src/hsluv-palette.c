@@ -0,0 +1,402 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "hsluv-palette.h"
+#include "hsluv-internal.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+
+/* Colors per block of the batched queries. */
+#define PALETTE_BLOCK_COLORS    256
+
+/* Largest range searched by a linear scan instead of being split further. */
+#define PALETTE_LEAF_COLORS     8
+
+#define PALETTE_MAX_COLORS      65536
+#define PALETTE_CACHE_COLORS    (1 << 24)
+
+
+/* The k-d tree is implicit: each node is the median of a range of the
+ * array, splitting it into the ranges of its two subtrees, down to the leaf
+ * ranges of up to PALETTE_LEAF_COLORS colors. */
+typedef struct PaletteNode_tag PaletteNode;
+struct PaletteNode_tag {
+    double p[3];
+    uint16_t index;         /* Index of the color in the palette. */
+    unsigned char axis;     /* Splitting axis. */
+};
+
+struct HsluvPalette_tag {
+    HsluvPaletteSpace space;
+    size_t n;
+    PaletteNode* nodes;
+    uint16_t* cache;
+};
+
+typedef struct PaletteNearest_tag PaletteNearest;
+struct PaletteNearest_tag {
+    double dist;
+    uint16_t index;
+};
+
+
+/* Turn the cylindrical coordinates (as produced by rgb2hsluv() or, for LCh,
+ * by hsluv2lch()) of n colors into the Cartesian ones of the tree. */
+static void
+palette_cartesian(HsluvPaletteSpace space, double* buf, size_t n)
+{
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        double* c = buf + 3 * i;
+        double axial, radius, hrad;
+
+        if(space == HSLUV_PALETTE_LUV) {
+            axial = c[0];
+            radius = c[1];
+            hrad = c[2] * 0.01745329251994329577;  /* (pi / 180.0) */
+        } else {
+            axial = c[2];
+            radius = c[1];
+            hrad = c[0] * 0.01745329251994329577;  /* (pi / 180.0) */
+        }
+
+        c[0] = axial;
+        c[1] = radius * cos(hrad);
+        c[2] = radius * sin(hrad);
+    }
+}
+
+/* Convert up to PALETTE_BLOCK_COLORS colors given either as doubles or as
+ * 8-bit pixels into the coordinates of the tree. */
+static void
+palette_coords(HsluvPaletteSpace space, const double* rgb, size_t rgb_stride,
+               const unsigned char* rgb8, HsluvFormat format, double* buf, size_t n)
+{
+    if(space == HSLUV_PALETTE_HPLUV) {
+        if(rgb8 != NULL)
+            rgb82hpluv_n(rgb8, format, buf, 3, n);
+        else
+            rgb2hpluv_n(rgb, rgb_stride, buf, 3, n);
+    } else {
+        if(rgb8 != NULL)
+            rgb82hsluv_n(rgb8, format, buf, 3, n);
+        else
+            rgb2hsluv_n(rgb, rgb_stride, buf, 3, n);
+        if(space == HSLUV_PALETTE_LUV)
+            hsluv2lch_n(buf, 3, buf, 3, n);
+    }
+
+    palette_cartesian(space, buf, n);
+}
+
+
+static int
+node_cmp0(const void* a, const void* b)
+{
+    double pa = ((const PaletteNode*) a)->p[0];
+    double pb = ((const PaletteNode*) b)->p[0];
+    return (pa < pb ? -1 : (pa > pb ? 1 : 0));
+}
+
+static int
+node_cmp1(const void* a, const void* b)
+{
+    double pa = ((const PaletteNode*) a)->p[1];
+    double pb = ((const PaletteNode*) b)->p[1];
+    return (pa < pb ? -1 : (pa > pb ? 1 : 0));
+}
+
+static int
+node_cmp2(const void* a, const void* b)
+{
+    double pa = ((const PaletteNode*) a)->p[2];
+    double pb = ((const PaletteNode*) b)->p[2];
+    return (pa < pb ? -1 : (pa > pb ? 1 : 0));
+}
+
+/* Split the range along its longest extent, recursively. */
+static void
+kd_build(PaletteNode* nodes, size_t n)
+{
+    static int (*const cmp[3])(const void*, const void*) = { node_cmp0, node_cmp1, node_cmp2 };
+
+    while(n > PALETTE_LEAF_COLORS) {
+        double lo[3], hi[3];
+        unsigned axis = 0;
+        size_t mid = n / 2;
+        size_t i, k;
+
+        for(k = 0; k < 3; k++)
+            lo[k] = hi[k] = nodes[0].p[k];
+        for(i = 1; i < n; i++) {
+            for(k = 0; k < 3; k++) {
+                if(nodes[i].p[k] < lo[k])
+                    lo[k] = nodes[i].p[k];
+                if(nodes[i].p[k] > hi[k])
+                    hi[k] = nodes[i].p[k];
+            }
+        }
+        for(k = 1; k < 3; k++) {
+            if(hi[k] - lo[k] > hi[axis] - lo[axis])
+                axis = (unsigned) k;
+        }
+
+        qsort(nodes, n, sizeof(PaletteNode), cmp[axis]);
+        nodes[mid].axis = (unsigned char) axis;
+
+        kd_build(nodes, mid);
+        nodes += mid + 1;
+        n -= mid + 1;
+    }
+}
+
+static void
+kd_visit(const PaletteNode* node, const double* q, PaletteNearest* best)
+{
+    double d0 = q[0] - node->p[0];
+    double d1 = q[1] - node->p[1];
+    double d2 = q[2] - node->p[2];
+    double dist = d0 * d0 + d1 * d1 + d2 * d2;
+
+    if(dist < best->dist  ||  (dist == best->dist  &&  node->index < best->index)) {
+        best->dist = dist;
+        best->index = node->index;
+    }
+}
+
+static void
+kd_search(const PaletteNode* nodes, size_t n, const double* q, PaletteNearest* best)
+{
+    while(n > PALETTE_LEAF_COLORS) {
+        size_t mid = n / 2;
+        const PaletteNode* node = &nodes[mid];
+        double diff;
+
+        kd_visit(node, q, best);
+
+        /* Search the side of the query first; the other one only if it may
+         * be as near (equally near colors may have lower indexes). */
+        diff = q[node->axis] - node->p[node->axis];
+        if(diff < 0.0) {
+            kd_search(nodes, mid, q, best);
+            if(diff * diff > best->dist)
+                return;
+            nodes += mid + 1;
+            n -= mid + 1;
+        } else {
+            kd_search(nodes + mid + 1, n - mid - 1, q, best);
+            if(diff * diff > best->dist)
+                return;
+            n = mid;
+        }
+    }
+
+    while(n > 0) {
+        kd_visit(nodes, q, best);
+        nodes++;
+        n--;
+    }
+}
+
+static uint16_t
+palette_search(const HsluvPalette* palette, const double* q)
+{
+    PaletteNearest best;
+
+    best.dist = HUGE_VAL;
+    best.index = 0;
+    kd_search(palette->nodes, palette->n, q, &best);
+    return best.index;
+}
+
+
+HsluvPalette*
+hsluv_palette_create(const double* rgb, size_t rgb_stride, size_t n, HsluvPaletteSpace space)
+{
+    HsluvPalette* palette;
+    double buf[3 * PALETTE_BLOCK_COLORS];
+    size_t i, j;
+
+    if(n == 0  ||  n > PALETTE_MAX_COLORS)
+        return NULL;
+    if(space != HSLUV_PALETTE_LUV  &&  space != HSLUV_PALETTE_HSLUV  &&  space != HSLUV_PALETTE_HPLUV)
+        return NULL;
+
+    palette = (HsluvPalette*) malloc(sizeof(HsluvPalette));
+    if(palette == NULL)
+        return NULL;
+    palette->nodes = (PaletteNode*) malloc(n * sizeof(PaletteNode));
+    if(palette->nodes == NULL) {
+        free(palette);
+        return NULL;
+    }
+    palette->space = space;
+    palette->n = n;
+    palette->cache = NULL;
+
+    for(i = 0; i < n; i += PALETTE_BLOCK_COLORS) {
+        size_t k = (n - i < PALETTE_BLOCK_COLORS ? n - i : PALETTE_BLOCK_COLORS);
+
+        palette_coords(space, rgb + i * rgb_stride, rgb_stride, NULL, HSLUV_FORMAT_RGB8, buf, k);
+        for(j = 0; j < k; j++) {
+            PaletteNode* node = &palette->nodes[i + j];
+
+            node->p[0] = buf[3 * j];
+            node->p[1] = buf[3 * j + 1];
+            node->p[2] = buf[3 * j + 2];
+            node->index = (uint16_t) (i + j);
+            node->axis = 0;
+        }
+    }
+
+    kd_build(palette->nodes, n);
+    return palette;
+}
+
+void
+hsluv_palette_destroy(HsluvPalette* palette)
+{
+    if(palette == NULL)
+        return;
+
+    free(palette->cache);
+    free(palette->nodes);
+    free(palette);
+}
+
+size_t
+hsluv_palette_size(const HsluvPalette* palette)
+{
+    return palette->n;
+}
+
+size_t
+hsluv_palette_nearest(const HsluvPalette* palette, double r, double g, double b)
+{
+    uint16_t index;
+    double rgb[3] = { r, g, b };
+
+    hsluv_palette_nearest_n(palette, rgb, 3, &index, 1);
+    return index;
+}
+
+void
+hsluv_palette_nearest_n(const HsluvPalette* palette, const double* rgb, size_t rgb_stride,
+                        uint16_t* out, size_t n)
+{
+    double buf[3 * PALETTE_BLOCK_COLORS];
+    size_t i, j;
+
+    for(i = 0; i < n; i += PALETTE_BLOCK_COLORS) {
+        size_t k = (n - i < PALETTE_BLOCK_COLORS ? n - i : PALETTE_BLOCK_COLORS);
+
+        palette_coords(palette->space, rgb + i * rgb_stride, rgb_stride, NULL, HSLUV_FORMAT_RGB8, buf, k);
+        for(j = 0; j < k; j++)
+            out[i + j] = palette_search(palette, buf + 3 * j);
+    }
+}
+
+static void
+palette_search_rgb8(const HsluvPalette* palette, const unsigned char* rgb, HsluvFormat format,
+                    uint16_t* out, size_t n)
+{
+    const Rgb8Format* fmt = rgb8_format(format);
+    double buf[3 * PALETTE_BLOCK_COLORS];
+    size_t i, j;
+
+    for(i = 0; i < n; i += PALETTE_BLOCK_COLORS) {
+        size_t k = (n - i < PALETTE_BLOCK_COLORS ? n - i : PALETTE_BLOCK_COLORS);
+
+        palette_coords(palette->space, NULL, 0, rgb + i * fmt->size, format, buf, k);
+        for(j = 0; j < k; j++)
+            out[i + j] = palette_search(palette, buf + 3 * j);
+    }
+}
+
+void
+hsluv_palette_nearest_rgb8_n(const HsluvPalette* palette, const unsigned char* rgb, HsluvFormat format,
+                             uint16_t* out, size_t n)
+{
+    const Rgb8Format* fmt = rgb8_format(format);
+    size_t i;
+
+    if(palette->cache == NULL) {
+        palette_search_rgb8(palette, rgb, format, out, n);
+        return;
+    }
+
+    for(i = 0; i < n; i++) {
+        const unsigned char* pixel = rgb + i * fmt->size;
+        out[i] = palette->cache[((size_t) pixel[fmt->r] << 16) | ((size_t) pixel[fmt->g] << 8) | pixel[fmt->b]];
+    }
+}
+
+/* One slice of the cache: all the colors with the red value i. */
+static void
+palette_cache_slice(void* task_data, size_t i)
+{
+    HsluvPalette* palette = (HsluvPalette*) task_data;
+    unsigned char rgb[3 * 256];
+    size_t g, b;
+
+    for(g = 0; g < 256; g++) {
+        for(b = 0; b < 256; b++) {
+            rgb[3 * b] = (unsigned char) i;
+            rgb[3 * b + 1] = (unsigned char) g;
+            rgb[3 * b + 2] = (unsigned char) b;
+        }
+        palette_search_rgb8(palette, rgb, HSLUV_FORMAT_RGB8, palette->cache + (i << 16) + (g << 8), 256);
+    }
+}
+
+int
+hsluv_palette_build_cache(HsluvPalette* palette, HsluvParallelFunc parallel, void* parallel_data)
+{
+    size_t i;
+
+    if(palette->cache != NULL)
+        return 0;
+
+    palette->cache = (uint16_t*) malloc(PALETTE_CACHE_COLORS * sizeof(uint16_t));
+    if(palette->cache == NULL)
+        return -1;
+
+    /* The slices are computed by the kd-tree search (palette_search_rgb8()),
+     * not by the lookups of the cache being built. */
+    if(parallel != NULL) {
+        parallel(palette_cache_slice, palette, 256, parallel_data);
+    } else {
+        for(i = 0; i < 256; i++)
+            palette_cache_slice(palette, i);
+    }
+
+    return 0;
+}
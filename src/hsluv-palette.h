@@ -0,0 +1,137 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_PALETTE_H
+#define HSLUV_PALETTE_H
+
+#include "hsluv.h"
+#include "hsluv-image.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Color spaces where the distances between the colors of a palette are
+ * measured.
+ *
+ * The distance is Euclidean in all of them. For HSLuv and HPLuv, the colors
+ * are placed in a cylinder, with the saturation as its radius and the hue as
+ * its angle, so that the hues near 0.0 and near 360.0 are close, and the hue
+ * of a gray does not matter.
+ */
+typedef enum HsluvPaletteSpace_tag {
+    HSLUV_PALETTE_LUV = 0,  /**< CIE L*u*v* (i.e. LCh with h as angle). */
+    HSLUV_PALETTE_HSLUV,    /**< HSLuv cylinder. */
+    HSLUV_PALETTE_HPLUV     /**< HPLuv cylinder. */
+} HsluvPaletteSpace;
+
+/**
+ * Palette index.
+ *
+ * It answers the nearest-color queries over a palette of up to 65536 colors:
+ * the palette is converted once into the given color space and put into a
+ * k-d tree, so a query takes a logarithmic time in the palette size on
+ * average, instead of the linear scan.
+ *
+ * The queries return the index of the nearest palette color (the lowest
+ * index of the equally near ones, so the result is the same as of the
+ * linear scan). They may be run by multiple threads at the same time.
+ *
+ * The conversions use the batched functions of hsluv.h, so the same kernel
+ * (see hsluv_set_kernel()) and the same global settings apply.
+ */
+typedef struct HsluvPalette_tag HsluvPalette;
+
+/**
+ * Create a palette index.
+ *
+ * @param rgb The RGB colors of the palette, laid out as in hsluv2rgb_n().
+ * @param rgb_stride Distance between two consecutive colors (in doubles).
+ * @param n Number of the colors (1 to 65536).
+ * @param space Color space of the distances.
+ * @return The palette, or NULL if the arguments are invalid or out of memory.
+ */
+HsluvPalette* hsluv_palette_create(const double* rgb, size_t rgb_stride, size_t n, HsluvPaletteSpace space);
+
+/**
+ * Destroy a palette index.
+ *
+ * @param palette The palette. May be NULL.
+ */
+void hsluv_palette_destroy(HsluvPalette* palette);
+
+/**
+ * Get the number of colors of a palette.
+ */
+size_t hsluv_palette_size(const HsluvPalette* palette);
+
+/**
+ * Nearest-color queries.
+ *
+ * hsluv_palette_nearest() finds the palette color nearest to the given RGB
+ * color. The batched variants store the indexes of the colors nearest to
+ * @c n RGB colors laid out as in hsluv2rgb_n(), or to @c n 8-bit RGB pixels
+ * of the given format (see hsluv2rgb8_n()), into @c out.
+ *
+ * Once hsluv_palette_build_cache() succeeded, hsluv_palette_nearest_rgb8_n()
+ * only looks the pixels up in the cache.
+ */
+size_t hsluv_palette_nearest(const HsluvPalette* palette, double r, double g, double b);
+void hsluv_palette_nearest_n(const HsluvPalette* palette, const double* rgb, size_t rgb_stride,
+                             uint16_t* out, size_t n);
+void hsluv_palette_nearest_rgb8_n(const HsluvPalette* palette, const unsigned char* rgb, HsluvFormat format,
+                                  uint16_t* out, size_t n);
+
+/**
+ * Precompute the nearest palette colors of all the 2^24 8-bit RGB colors.
+ *
+ * The cache takes 32 MiB. Its 256 slices (one per red value) are computed by
+ * the given @c parallel function (see @c HsluvParallelFunc), or in the
+ * calling thread if it is NULL.
+ *
+ * This must not run at the same time as the queries on the same palette.
+ * Building the cache again does nothing.
+ *
+ * @param palette The palette.
+ * @param parallel The function running the tasks, or NULL.
+ * @param parallel_data User data of @c parallel.
+ * @return 0 on success, -1 if out of memory.
+ */
+int hsluv_palette_build_cache(HsluvPalette* palette, HsluvParallelFunc parallel, void* parallel_data);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HSLUV_PALETTE_H */
@@ -0,0 +1,441 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_RGB8_TABLES_H
+#define HSLUV_RGB8_TABLES_H
+
+/* This header is private to the library. It holds the tables of the 8-bit RGB
+ * conversions (see hsluv2rgb8_n() and rgb82hsluv_n() in hsluv.c).
+ *
+ * The values have been generated with to_linear() of hsluv.c and printed with
+ * 17 significant digits, so they read back as the very same doubles. */
+
+
+/* to_linear(i / 255.0) */
+static const double rgb8_to_linear[256] = {
+    0, 0.00030352698354883752, 0.00060705396709767503, 0.00091058095064651249,
+    0.0012141079341953501, 0.0015176349177441874, 0.001821161901293025, 0.0021246888848418626,
+    0.0024282158683907001, 0.0027317428519395373, 0.0030352698354883748, 0.0033465357638991608,
+    0.0036765073240474359, 0.0040247170184963066, 0.0043914420374102934, 0.0047769534806937292,
+    0.005181516702338386, 0.0056053916242027229, 0.0060488330228570539, 0.0065120907925944752,
+    0.0069954101872653869, 0.0074990320432261753, 0.0080231929853849943, 0.0085681256180693069,
+    0.0091340587022207872, 0.0097212173202378491, 0.010329823029626936, 0.010960094006488246,
+    0.011612245179743885, 0.012286488356915872, 0.012983032342173012, 0.013702083047289686,
+    0.014443843596092545, 0.015208514422912709, 0.015996293365509631, 0.016807375752887384,
+    0.017641954488384078, 0.018500220128379697, 0.019382360956935723, 0.020288563056652401,
+    0.021219010376003555, 0.022173884793387381, 0.02315336617811041, 0.024157632448504756,
+    0.02518685962736163, 0.026241221894849898, 0.027320891639074894, 0.028426039504420793,
+    0.0295568344378088, 0.030713443732993635, 0.031896033073011532, 0.033104766570885055,
+    0.03433980680868217, 0.035601314875020343, 0.036889450401100039, 0.038204371595346502,
+    0.039546235276732837, 0.040915196906853191, 0.042311410620809675, 0.043735029256973465,
+    0.045186204385675541, 0.046665086336880095, 0.048171824226889419, 0.049706565984127232,
+    0.051269458374043238, 0.052860647023180246, 0.054480276442442369, 0.056128490049600091,
+    0.057805430191067229, 0.059511238162981199, 0.061246054231617608, 0.063010017653167674,
+    0.064803266692905773, 0.066625938643772892, 0.068478169844400166, 0.070360095696595876,
+    0.072271850682317479, 0.074213568380149628, 0.076185381481307851, 0.078187421805186327,
+    0.080219820314468324, 0.082282707129814794, 0.084376211544148816, 0.086500462036549763,
+    0.088655586285772942, 0.090841711183407683, 0.093058962846687451, 0.095307466630964705,
+    0.097587347141862457, 0.099898728247113891, 0.10224173308810132, 0.10461648409110419,
+    0.10702310297826761, 0.10946171077829933, 0.1119324278369056, 0.11443537382697373,
+    0.11697066775851084, 0.11953842798834562, 0.12213877222960187, 0.12477181756095049,
+    0.12743768043564743, 0.13013647669036429, 0.13286832155381798, 0.13563332965520566,
+    0.13843161503245183, 0.14126329114027164, 0.14412847085805777, 0.14702726649759498,
+    0.14995978981060856, 0.15292615199615017, 0.1559264637078274, 0.15896083506088041,
+    0.16202937563911099, 0.16513219450166761, 0.16826940018969075, 0.17144110073282259,
+    0.17464740365558504, 0.17788841598362912, 0.18116424424986022, 0.184474994500441,
+    0.18782077230067787, 0.19120168274079138, 0.1946178304415758, 0.19806931955994886,
+    0.20155625379439707, 0.20507873639031693, 0.20863687014525575, 0.21223075741405523,
+    0.21586050011389926, 0.21952619972926921, 0.2232279573168085, 0.22696587351009836,
+    0.23074004852434915, 0.23455058216100522, 0.238397573812271, 0.24228112246555486,
+    0.24620132670783548, 0.25015828472995344, 0.25415209433082675, 0.25818285292159582,
+    0.26225065752969623, 0.26635560480286247, 0.27049779101306581, 0.27467731206038465,
+    0.2788942634768104, 0.28314874042999211, 0.28744083772691748, 0.29177064981753587,
+    0.29613827079832111, 0.3005437944157765, 0.30498731406988627, 0.30946892281750854,
+    0.31398871337571754, 0.31854677812509186, 0.32314320911295075, 0.32777809805654218,
+    0.33245153634617935, 0.33716361504833037, 0.34191442490866092, 0.3467040563550296,
+    0.35153259950043936, 0.35640014414594351, 0.3613067797835095, 0.36625259559883949,
+    0.37123768047414912, 0.3762621229909065, 0.38132601143253014, 0.38642943378704903,
+    0.39157247774972326, 0.39675523072562685, 0.40197777983219579, 0.4072402119017367,
+    0.41254261348390375, 0.41788507084813747, 0.42326766998607168, 0.42869049661390662,
+    0.43415363617474895, 0.43965717384091879, 0.44520119451622786, 0.45078578283822346,
+    0.45641102318040466, 0.46207699965440707, 0.46778379611215898, 0.47353149614800955,
+    0.4793201831008268, 0.48514994005607037, 0.49102084984783562, 0.49693299506087041,
+    0.50288645803256871, 0.50888132085493376, 0.51491766537652139, 0.5209955732043543,
+    0.52711512570581309, 0.53327640401050524, 0.53947948901210718, 0.5457244613701866,
+    0.55201140151200012, 0.55834038963426791, 0.56471150570492923, 0.57112482946487308,
+    0.57758044042965062, 0.5840784178911641, 0.59061884091933692, 0.59720178836376336,
+    0.60382733885533779, 0.61049557080786476, 0.61720656241965111, 0.62396039167507611,
+    0.63075713634614683, 0.63759687399403264, 0.64447968197058214, 0.65140563741982416,
+    0.65837481727944847, 0.66538729828227205, 0.67244315695768753, 0.67954246963309384,
+    0.6866853124353135, 0.69387176129198991, 0.70110189193297312, 0.70837577989168676,
+    0.71569350050648073, 0.72305512892196933, 0.73046074009035367, 0.73791040877273084,
+    0.74540420954038744, 0.75294221677607787, 0.76052450467529242, 0.76815114724750699,
+    0.7758222183174236, 0.78353779152619352, 0.79129794033263023, 0.79910273801440901,
+    0.8069522576692516, 0.81484657221610124, 0.82278575439628354, 0.83076987677465464,
+    0.83879901174074001, 0.84687323150985805, 0.85499260812423383, 0.86315721345410235,
+    0.87136711919879717, 0.87962239688783173, 0.88792311788196632, 0.89626935337426639,
+    0.90466117439114957, 0.9130986517934192, 0.92158185627729461, 0.93011085837542373,
+    0.938685728457888, 0.94730653673319987, 0.95597335324928612, 0.96468624789446511,
+    0.97344529039841254, 0.98225055033311715, 0.99110209711382979, 1,
+};
+
+/* to_linear((i + 0.5) / 255.0), i.e. the thresholds where the 8-bit
+ * value of a linear value changes from i to i + 1. */
+static const double rgb8_threshold[255] = {
+    0.00015176349177441876, 0.00045529047532325625, 0.00075881745887209371, 0.0010623444424209313,
+    0.0013658714259697686, 0.0016693984095186062, 0.0019729253930674436, 0.0022764523766162811,
+    0.0025799793601651187, 0.0028835063437139563, 0.003188300904430532, 0.0035092593495812301,
+    0.0038483149330964263, 0.0042057480301049468, 0.00458183274052838, 0.0049768372502740233,
+    0.0053910241598063811, 0.005824650784040898, 0.0062779694269141078, 0.0067512276334986228,
+    0.0072446684221289213, 0.0077585304986678601, 0.0082930484547623293, 0.0088484529516984975,
+    0.00942497089126609, 0.010022825574869039, 0.010642236851973576, 0.011283421258858298,
+    0.011946592148522129, 0.012631959812511863, 0.013339731595349034, 0.014070112002164469,
+    0.014823302800086416, 0.015599503113873273, 0.016398909516233677, 0.017221716113234104,
+    0.018068114625156378, 0.018938294463134074, 0.019832442801866853, 0.02075074464868551,
+    0.021693382909216234, 0.022660538449872064, 0.023652390157379497, 0.024669114995532006,
+    0.025710888059345766, 0.026777882626779784, 0.027870270208169259, 0.028988220593509972,
+    0.030131901897720907, 0.031301480604002861, 0.032497121605402225, 0.033718988244681086,
+    0.034967242352587947, 0.036242044284616387, 0.037543552956333111, 0.038871925877351582,
+    0.040227319184021844, 0.041609887670902887, 0.043019784821079411, 0.044457162835380919,
+    0.04592217266055746, 0.047414964016462821, 0.048935685422292978, 0.050484484221924877,
+    0.052061506608397201, 0.053666897647573375, 0.055300801301023862, 0.056963360448162942,
+    0.058654716907673543, 0.060375011458250812, 0.062124383858694746, 0.06390297286737924,
+    0.065710916261124602, 0.067548350853498043, 0.06941541251256611, 0.071312236178121435,
+    0.073238955878405426, 0.075195704746346667, 0.077182615035334343, 0.079199818134545033,
+    0.081247444583840409, 0.083325624088251643, 0.085434485532067034, 0.087574156992536831,
+    0.089744765753210623, 0.091946438316919774, 0.094179300418418391, 0.096443477036695036,
+    0.098739092406966933, 0.1010662700323678, 0.10342513269534023, 0.1058158024687427,
+    0.10823840072668099, 0.11069304815507364, 0.11317986476196008, 0.11569896988756009,
+    0.11825048221409341, 0.12083451977536606, 0.12345119996613248, 0.12610063955123937,
+    0.12878295467455941, 0.13149826086772048, 0.13424667305863719, 0.13702830557985107,
+    0.13984327217668513, 0.14269168601521828, 0.14557365969008559, 0.14848930523210871,
+    0.15143873411576272, 0.1544220572664832, 0.1574393850678189, 0.1604908273684337,
+    0.16357649348896341, 0.1666964922287304, 0.16985093187232053, 0.17303992019602688,
+    0.1762635644741625, 0.17952197148524762, 0.18281524751807332, 0.18614349837764563,
+    0.18950682939101379, 0.19290534541298454, 0.19633915083172693, 0.19980834957426891,
+    0.20331304511189069, 0.20685334046541501, 0.21042933821039977, 0.21404114048223255,
+    0.21768884898113222, 0.22137256497705879, 0.22509238931453279, 0.22884842241736916,
+    0.23264076429332461, 0.23646951453866302, 0.24033477234264017, 0.2442366364919083,
+    0.24817520537484558, 0.25215057698580889, 0.25616284892931379, 0.26021211842414343,
+    0.26429848230738662, 0.26842203703840828, 0.27258287870275355, 0.27678110301598524,
+    0.28101680532745971, 0.28529008062403893, 0.28960102353374223, 0.29394972832933958,
+    0.29833628893188452, 0.30276079891419333, 0.30722335150426627, 0.31172403958865513,
+    0.3162629557157785, 0.32084019209918369, 0.32545584062075916, 0.33010999283389664,
+    0.33480273996660304, 0.33953417292456833, 0.34430438229418264, 0.34911345834551089,
+    0.35396149103522073, 0.35884857000946707, 0.3637747846067349, 0.36874022386063821,
+    0.37374497650267891, 0.37878913096496591, 0.38387277538289261, 0.38899599759777848,
+    0.39415888515946967, 0.3993615253289054, 0.40460400508064542, 0.40988641110536289,
+    0.41520882981230195, 0.42057134733170159, 0.42597404951718398, 0.43141702194811221,
+    0.43690034993191296, 0.4424241185063697, 0.44798841244188325, 0.45359331624370169,
+    0.45923891415412094, 0.46492529015465522, 0.47065252796817919, 0.47642071106104089,
+    0.4822299226451468, 0.48808024568002051, 0.49397176287483296, 0.49990455669040795,
+    0.50587870934119983, 0.51189430279724724, 0.5179514187861014, 0.52405013879472884,
+    0.53019054407139199, 0.53637271562750366, 0.54259673423945975, 0.54886268045044928,
+    0.55517063457223936, 0.56152067668694239, 0.56791288664875739, 0.57434734408569166,
+    0.58082412840126207, 0.58734331877617363, 0.59390499416998066, 0.6005092333227251,
+    0.60715611475655584, 0.61384571677733113, 0.62057811747619895, 0.62735339473115903,
+    0.63417162620860912, 0.64103288936486924, 0.64793726144769204, 0.6548848194977529,
+    0.66187564035012247, 0.66890980063572592, 0.67598737678278087, 0.68310844501822221,
+    0.69027308136910925, 0.69748136166401642, 0.70473336153441068, 0.71202915641601039,
+    0.71936882155013127, 0.72675243198501716, 0.73418006257715418, 0.74165178799257336,
+    0.74916768270813605, 0.75672782101280722, 0.7643322770089146, 0.77198112461339308,
+    0.77967443755901666, 0.78741228939561736, 0.79519475349129032, 0.80302190303358689,
+    0.81089381103069336, 0.81881055031259986, 0.82677219353225406, 0.83477881316670599,
+    0.84283048151823714, 0.8509272707154808, 0.85906925271453016, 0.86725649930003423,
+    0.87548908208628184, 0.88376707251827691, 0.89209054187280101, 0.90045956125946547,
+    0.90887420162175181, 0.91733453373804386, 0.92584062822264912, 0.93439255552680667,
+    0.9429903859396902, 0.95163418958939683, 0.96032403644392739, 0.969059996312159,
+    0.97784213884480442, 0.98667053353536605, 0.99554524972107761,
+};
+
+/* Count of the thresholds below i / RGB8_BUCKETS, i.e. the 8-bit value of the
+ * linear value i / RGB8_BUCKETS. The buckets are narrower than the smallest gap
+ * between two thresholds, so each has at most one of them inside. */
+#define RGB8_BUCKETS    4096
+
+static const unsigned char rgb8_bucket[RGB8_BUCKETS] = {
+      0,   1,   2,   2,   3,   4,   5,   6,   6,   7,   8,   9,  10,  10,  11,  12,
+     13,  13,  14,  15,  15,  16,  16,  17,  18,  18,  19,  19,  20,  20,  21,  21,
+     22,  22,  23,  23,  23,  24,  24,  25,  25,  25,  26,  26,  27,  27,  27,  28,
+     28,  29,  29,  29,  30,  30,  30,  31,  31,  31,  32,  32,  32,  33,  33,  33,
+     34,  34,  34,  34,  35,  35,  35,  36,  36,  36,  36,  37,  37,  37,  38,  38,
+     38,  38,  39,  39,  39,  40,  40,  40,  40,  41,  41,  41,  41,  42,  42,  42,
+     42,  43,  43,  43,  43,  43,  44,  44,  44,  44,  45,  45,  45,  45,  46,  46,
+     46,  46,  46,  47,  47,  47,  47,  48,  48,  48,  48,  48,  49,  49,  49,  49,
+     49,  50,  50,  50,  50,  50,  51,  51,  51,  51,  51,  52,  52,  52,  52,  52,
+     53,  53,  53,  53,  53,  54,  54,  54,  54,  54,  55,  55,  55,  55,  55,  55,
+     56,  56,  56,  56,  56,  57,  57,  57,  57,  57,  57,  58,  58,  58,  58,  58,
+     58,  59,  59,  59,  59,  59,  59,  60,  60,  60,  60,  60,  60,  61,  61,  61,
+     61,  61,  61,  62,  62,  62,  62,  62,  62,  63,  63,  63,  63,  63,  63,  64,
+     64,  64,  64,  64,  64,  64,  65,  65,  65,  65,  65,  65,  66,  66,  66,  66,
+     66,  66,  66,  67,  67,  67,  67,  67,  67,  67,  68,  68,  68,  68,  68,  68,
+     68,  69,  69,  69,  69,  69,  69,  69,  70,  70,  70,  70,  70,  70,  70,  71,
+     71,  71,  71,  71,  71,  71,  72,  72,  72,  72,  72,  72,  72,  72,  73,  73,
+     73,  73,  73,  73,  73,  74,  74,  74,  74,  74,  74,  74,  74,  75,  75,  75,
+     75,  75,  75,  75,  75,  76,  76,  76,  76,  76,  76,  76,  77,  77,  77,  77,
+     77,  77,  77,  77,  77,  78,  78,  78,  78,  78,  78,  78,  78,  79,  79,  79,
+     79,  79,  79,  79,  79,  80,  80,  80,  80,  80,  80,  80,  80,  81,  81,  81,
+     81,  81,  81,  81,  81,  81,  82,  82,  82,  82,  82,  82,  82,  82,  83,  83,
+     83,  83,  83,  83,  83,  83,  83,  84,  84,  84,  84,  84,  84,  84,  84,  84,
+     85,  85,  85,  85,  85,  85,  85,  85,  85,  86,  86,  86,  86,  86,  86,  86,
+     86,  86,  87,  87,  87,  87,  87,  87,  87,  87,  87,  87,  88,  88,  88,  88,
+     88,  88,  88,  88,  88,  89,  89,  89,  89,  89,  89,  89,  89,  89,  90,  90,
+     90,  90,  90,  90,  90,  90,  90,  90,  91,  91,  91,  91,  91,  91,  91,  91,
+     91,  91,  92,  92,  92,  92,  92,  92,  92,  92,  92,  92,  93,  93,  93,  93,
+     93,  93,  93,  93,  93,  93,  94,  94,  94,  94,  94,  94,  94,  94,  94,  94,
+     95,  95,  95,  95,  95,  95,  95,  95,  95,  95,  96,  96,  96,  96,  96,  96,
+     96,  96,  96,  96,  96,  97,  97,  97,  97,  97,  97,  97,  97,  97,  97,  98,
+     98,  98,  98,  98,  98,  98,  98,  98,  98,  98,  99,  99,  99,  99,  99,  99,
+     99,  99,  99,  99,  99, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100,
+    101, 101, 101, 101, 101, 101, 101, 101, 101, 101, 101, 102, 102, 102, 102, 102,
+    102, 102, 102, 102, 102, 102, 103, 103, 103, 103, 103, 103, 103, 103, 103, 103,
+    103, 103, 104, 104, 104, 104, 104, 104, 104, 104, 104, 104, 104, 105, 105, 105,
+    105, 105, 105, 105, 105, 105, 105, 105, 105, 106, 106, 106, 106, 106, 106, 106,
+    106, 106, 106, 106, 106, 107, 107, 107, 107, 107, 107, 107, 107, 107, 107, 107,
+    107, 108, 108, 108, 108, 108, 108, 108, 108, 108, 108, 108, 108, 109, 109, 109,
+    109, 109, 109, 109, 109, 109, 109, 109, 109, 110, 110, 110, 110, 110, 110, 110,
+    110, 110, 110, 110, 110, 111, 111, 111, 111, 111, 111, 111, 111, 111, 111, 111,
+    111, 111, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 113,
+    113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 114, 114, 114, 114, 114,
+    114, 114, 114, 114, 114, 114, 114, 114, 115, 115, 115, 115, 115, 115, 115, 115,
+    115, 115, 115, 115, 115, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116,
+    116, 116, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117, 117,
+    118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 118, 119, 119, 119,
+    119, 119, 119, 119, 119, 119, 119, 119, 119, 119, 119, 120, 120, 120, 120, 120,
+    120, 120, 120, 120, 120, 120, 120, 120, 120, 121, 121, 121, 121, 121, 121, 121,
+    121, 121, 121, 121, 121, 121, 121, 122, 122, 122, 122, 122, 122, 122, 122, 122,
+    122, 122, 122, 122, 122, 123, 123, 123, 123, 123, 123, 123, 123, 123, 123, 123,
+    123, 123, 123, 124, 124, 124, 124, 124, 124, 124, 124, 124, 124, 124, 124, 124,
+    124, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125,
+    126, 126, 126, 126, 126, 126, 126, 126, 126, 126, 126, 126, 126, 126, 127, 127,
+    127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 127, 128, 128, 128,
+    128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 128, 129, 129, 129, 129,
+    129, 129, 129, 129, 129, 129, 129, 129, 129, 129, 129, 130, 130, 130, 130, 130,
+    130, 130, 130, 130, 130, 130, 130, 130, 130, 130, 131, 131, 131, 131, 131, 131,
+    131, 131, 131, 131, 131, 131, 131, 131, 131, 131, 132, 132, 132, 132, 132, 132,
+    132, 132, 132, 132, 132, 132, 132, 132, 132, 133, 133, 133, 133, 133, 133, 133,
+    133, 133, 133, 133, 133, 133, 133, 133, 133, 134, 134, 134, 134, 134, 134, 134,
+    134, 134, 134, 134, 134, 134, 134, 134, 134, 135, 135, 135, 135, 135, 135, 135,
+    135, 135, 135, 135, 135, 135, 135, 135, 135, 136, 136, 136, 136, 136, 136, 136,
+    136, 136, 136, 136, 136, 136, 136, 136, 136, 137, 137, 137, 137, 137, 137, 137,
+    137, 137, 137, 137, 137, 137, 137, 137, 137, 138, 138, 138, 138, 138, 138, 138,
+    138, 138, 138, 138, 138, 138, 138, 138, 138, 138, 139, 139, 139, 139, 139, 139,
+    139, 139, 139, 139, 139, 139, 139, 139, 139, 139, 140, 140, 140, 140, 140, 140,
+    140, 140, 140, 140, 140, 140, 140, 140, 140, 140, 140, 141, 141, 141, 141, 141,
+    141, 141, 141, 141, 141, 141, 141, 141, 141, 141, 141, 141, 142, 142, 142, 142,
+    142, 142, 142, 142, 142, 142, 142, 142, 142, 142, 142, 142, 142, 143, 143, 143,
+    143, 143, 143, 143, 143, 143, 143, 143, 143, 143, 143, 143, 143, 143, 144, 144,
+    144, 144, 144, 144, 144, 144, 144, 144, 144, 144, 144, 144, 144, 144, 144, 144,
+    145, 145, 145, 145, 145, 145, 145, 145, 145, 145, 145, 145, 145, 145, 145, 145,
+    145, 146, 146, 146, 146, 146, 146, 146, 146, 146, 146, 146, 146, 146, 146, 146,
+    146, 146, 146, 147, 147, 147, 147, 147, 147, 147, 147, 147, 147, 147, 147, 147,
+    147, 147, 147, 147, 147, 148, 148, 148, 148, 148, 148, 148, 148, 148, 148, 148,
+    148, 148, 148, 148, 148, 148, 149, 149, 149, 149, 149, 149, 149, 149, 149, 149,
+    149, 149, 149, 149, 149, 149, 149, 149, 149, 150, 150, 150, 150, 150, 150, 150,
+    150, 150, 150, 150, 150, 150, 150, 150, 150, 150, 150, 151, 151, 151, 151, 151,
+    151, 151, 151, 151, 151, 151, 151, 151, 151, 151, 151, 151, 151, 152, 152, 152,
+    152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152,
+    153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153,
+    153, 153, 153, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154,
+    154, 154, 154, 154, 154, 154, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155,
+    155, 155, 155, 155, 155, 155, 155, 155, 155, 156, 156, 156, 156, 156, 156, 156,
+    156, 156, 156, 156, 156, 156, 156, 156, 156, 156, 156, 156, 157, 157, 157, 157,
+    157, 157, 157, 157, 157, 157, 157, 157, 157, 157, 157, 157, 157, 157, 157, 158,
+    158, 158, 158, 158, 158, 158, 158, 158, 158, 158, 158, 158, 158, 158, 158, 158,
+    158, 158, 158, 159, 159, 159, 159, 159, 159, 159, 159, 159, 159, 159, 159, 159,
+    159, 159, 159, 159, 159, 159, 160, 160, 160, 160, 160, 160, 160, 160, 160, 160,
+    160, 160, 160, 160, 160, 160, 160, 160, 160, 160, 161, 161, 161, 161, 161, 161,
+    161, 161, 161, 161, 161, 161, 161, 161, 161, 161, 161, 161, 161, 161, 162, 162,
+    162, 162, 162, 162, 162, 162, 162, 162, 162, 162, 162, 162, 162, 162, 162, 162,
+    162, 162, 162, 163, 163, 163, 163, 163, 163, 163, 163, 163, 163, 163, 163, 163,
+    163, 163, 163, 163, 163, 163, 163, 164, 164, 164, 164, 164, 164, 164, 164, 164,
+    164, 164, 164, 164, 164, 164, 164, 164, 164, 164, 164, 165, 165, 165, 165, 165,
+    165, 165, 165, 165, 165, 165, 165, 165, 165, 165, 165, 165, 165, 165, 165, 165,
+    166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166,
+    166, 166, 166, 166, 166, 167, 167, 167, 167, 167, 167, 167, 167, 167, 167, 167,
+    167, 167, 167, 167, 167, 167, 167, 167, 167, 167, 168, 168, 168, 168, 168, 168,
+    168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 168, 169,
+    169, 169, 169, 169, 169, 169, 169, 169, 169, 169, 169, 169, 169, 169, 169, 169,
+    169, 169, 169, 169, 170, 170, 170, 170, 170, 170, 170, 170, 170, 170, 170, 170,
+    170, 170, 170, 170, 170, 170, 170, 170, 170, 170, 171, 171, 171, 171, 171, 171,
+    171, 171, 171, 171, 171, 171, 171, 171, 171, 171, 171, 171, 171, 171, 171, 172,
+    172, 172, 172, 172, 172, 172, 172, 172, 172, 172, 172, 172, 172, 172, 172, 172,
+    172, 172, 172, 172, 172, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173,
+    173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 174, 174, 174, 174, 174,
+    174, 174, 174, 174, 174, 174, 174, 174, 174, 174, 174, 174, 174, 174, 174, 174,
+    174, 175, 175, 175, 175, 175, 175, 175, 175, 175, 175, 175, 175, 175, 175, 175,
+    175, 175, 175, 175, 175, 175, 175, 175, 176, 176, 176, 176, 176, 176, 176, 176,
+    176, 176, 176, 176, 176, 176, 176, 176, 176, 176, 176, 176, 176, 176, 177, 177,
+    177, 177, 177, 177, 177, 177, 177, 177, 177, 177, 177, 177, 177, 177, 177, 177,
+    177, 177, 177, 177, 177, 178, 178, 178, 178, 178, 178, 178, 178, 178, 178, 178,
+    178, 178, 178, 178, 178, 178, 178, 178, 178, 178, 178, 179, 179, 179, 179, 179,
+    179, 179, 179, 179, 179, 179, 179, 179, 179, 179, 179, 179, 179, 179, 179, 179,
+    179, 179, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 180,
+    180, 180, 180, 180, 180, 180, 180, 180, 180, 180, 181, 181, 181, 181, 181, 181,
+    181, 181, 181, 181, 181, 181, 181, 181, 181, 181, 181, 181, 181, 181, 181, 181,
+    181, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182,
+    182, 182, 182, 182, 182, 182, 182, 182, 183, 183, 183, 183, 183, 183, 183, 183,
+    183, 183, 183, 183, 183, 183, 183, 183, 183, 183, 183, 183, 183, 183, 183, 183,
+    184, 184, 184, 184, 184, 184, 184, 184, 184, 184, 184, 184, 184, 184, 184, 184,
+    184, 184, 184, 184, 184, 184, 184, 184, 185, 185, 185, 185, 185, 185, 185, 185,
+    185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185, 185,
+    186, 186, 186, 186, 186, 186, 186, 186, 186, 186, 186, 186, 186, 186, 186, 186,
+    186, 186, 186, 186, 186, 186, 186, 186, 187, 187, 187, 187, 187, 187, 187, 187,
+    187, 187, 187, 187, 187, 187, 187, 187, 187, 187, 187, 187, 187, 187, 187, 187,
+    188, 188, 188, 188, 188, 188, 188, 188, 188, 188, 188, 188, 188, 188, 188, 188,
+    188, 188, 188, 188, 188, 188, 188, 188, 188, 189, 189, 189, 189, 189, 189, 189,
+    189, 189, 189, 189, 189, 189, 189, 189, 189, 189, 189, 189, 189, 189, 189, 189,
+    189, 190, 190, 190, 190, 190, 190, 190, 190, 190, 190, 190, 190, 190, 190, 190,
+    190, 190, 190, 190, 190, 190, 190, 190, 190, 190, 191, 191, 191, 191, 191, 191,
+    191, 191, 191, 191, 191, 191, 191, 191, 191, 191, 191, 191, 191, 191, 191, 191,
+    191, 191, 191, 192, 192, 192, 192, 192, 192, 192, 192, 192, 192, 192, 192, 192,
+    192, 192, 192, 192, 192, 192, 192, 192, 192, 192, 192, 192, 193, 193, 193, 193,
+    193, 193, 193, 193, 193, 193, 193, 193, 193, 193, 193, 193, 193, 193, 193, 193,
+    193, 193, 193, 193, 193, 194, 194, 194, 194, 194, 194, 194, 194, 194, 194, 194,
+    194, 194, 194, 194, 194, 194, 194, 194, 194, 194, 194, 194, 194, 194, 194, 195,
+    195, 195, 195, 195, 195, 195, 195, 195, 195, 195, 195, 195, 195, 195, 195, 195,
+    195, 195, 195, 195, 195, 195, 195, 195, 195, 196, 196, 196, 196, 196, 196, 196,
+    196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196,
+    196, 196, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197,
+    197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 198, 198, 198, 198,
+    198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198,
+    198, 198, 198, 198, 198, 198, 198, 199, 199, 199, 199, 199, 199, 199, 199, 199,
+    199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199,
+    199, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200,
+    200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 201, 201, 201, 201,
+    201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201,
+    201, 201, 201, 201, 201, 201, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202,
+    202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202,
+    202, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203,
+    203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 204, 204, 204, 204,
+    204, 204, 204, 204, 204, 204, 204, 204, 204, 204, 204, 204, 204, 204, 204, 204,
+    204, 204, 204, 204, 204, 204, 204, 205, 205, 205, 205, 205, 205, 205, 205, 205,
+    205, 205, 205, 205, 205, 205, 205, 205, 205, 205, 205, 205, 205, 205, 205, 205,
+    205, 205, 205, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206,
+    206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 206, 207, 207,
+    207, 207, 207, 207, 207, 207, 207, 207, 207, 207, 207, 207, 207, 207, 207, 207,
+    207, 207, 207, 207, 207, 207, 207, 207, 207, 207, 208, 208, 208, 208, 208, 208,
+    208, 208, 208, 208, 208, 208, 208, 208, 208, 208, 208, 208, 208, 208, 208, 208,
+    208, 208, 208, 208, 208, 208, 209, 209, 209, 209, 209, 209, 209, 209, 209, 209,
+    209, 209, 209, 209, 209, 209, 209, 209, 209, 209, 209, 209, 209, 209, 209, 209,
+    209, 209, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210,
+    210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 210, 211, 211,
+    211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 211,
+    211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 211, 212, 212, 212, 212, 212,
+    212, 212, 212, 212, 212, 212, 212, 212, 212, 212, 212, 212, 212, 212, 212, 212,
+    212, 212, 212, 212, 212, 212, 212, 212, 213, 213, 213, 213, 213, 213, 213, 213,
+    213, 213, 213, 213, 213, 213, 213, 213, 213, 213, 213, 213, 213, 213, 213, 213,
+    213, 213, 213, 213, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214,
+    214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214, 214,
+    214, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215,
+    215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 215, 216,
+    216, 216, 216, 216, 216, 216, 216, 216, 216, 216, 216, 216, 216, 216, 216, 216,
+    216, 216, 216, 216, 216, 216, 216, 216, 216, 216, 216, 216, 217, 217, 217, 217,
+    217, 217, 217, 217, 217, 217, 217, 217, 217, 217, 217, 217, 217, 217, 217, 217,
+    217, 217, 217, 217, 217, 217, 217, 217, 217, 218, 218, 218, 218, 218, 218, 218,
+    218, 218, 218, 218, 218, 218, 218, 218, 218, 218, 218, 218, 218, 218, 218, 218,
+    218, 218, 218, 218, 218, 218, 218, 219, 219, 219, 219, 219, 219, 219, 219, 219,
+    219, 219, 219, 219, 219, 219, 219, 219, 219, 219, 219, 219, 219, 219, 219, 219,
+    219, 219, 219, 219, 219, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220,
+    220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220, 220,
+    220, 220, 220, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221,
+    221, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221, 221,
+    221, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222,
+    222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222, 222,
+    223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223,
+    223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 223, 224, 224,
+    224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 224,
+    224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 224, 225, 225, 225,
+    225, 225, 225, 225, 225, 225, 225, 225, 225, 225, 225, 225, 225, 225, 225, 225,
+    225, 225, 225, 225, 225, 225, 225, 225, 225, 225, 225, 225, 226, 226, 226, 226,
+    226, 226, 226, 226, 226, 226, 226, 226, 226, 226, 226, 226, 226, 226, 226, 226,
+    226, 226, 226, 226, 226, 226, 226, 226, 226, 226, 226, 227, 227, 227, 227, 227,
+    227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227,
+    227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 227, 228, 228, 228, 228, 228,
+    228, 228, 228, 228, 228, 228, 228, 228, 228, 228, 228, 228, 228, 228, 228, 228,
+    228, 228, 228, 228, 228, 228, 228, 228, 228, 228, 229, 229, 229, 229, 229, 229,
+    229, 229, 229, 229, 229, 229, 229, 229, 229, 229, 229, 229, 229, 229, 229, 229,
+    229, 229, 229, 229, 229, 229, 229, 229, 229, 229, 230, 230, 230, 230, 230, 230,
+    230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 230,
+    230, 230, 230, 230, 230, 230, 230, 230, 230, 230, 231, 231, 231, 231, 231, 231,
+    231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 231,
+    231, 231, 231, 231, 231, 231, 231, 231, 231, 231, 232, 232, 232, 232, 232, 232,
+    232, 232, 232, 232, 232, 232, 232, 232, 232, 232, 232, 232, 232, 232, 232, 232,
+    232, 232, 232, 232, 232, 232, 232, 232, 232, 232, 233, 233, 233, 233, 233, 233,
+    233, 233, 233, 233, 233, 233, 233, 233, 233, 233, 233, 233, 233, 233, 233, 233,
+    233, 233, 233, 233, 233, 233, 233, 233, 233, 233, 234, 234, 234, 234, 234, 234,
+    234, 234, 234, 234, 234, 234, 234, 234, 234, 234, 234, 234, 234, 234, 234, 234,
+    234, 234, 234, 234, 234, 234, 234, 234, 234, 234, 234, 235, 235, 235, 235, 235,
+    235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235,
+    235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 235, 236, 236, 236, 236,
+    236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236,
+    236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 236, 237, 237, 237,
+    237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237,
+    237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 237, 238, 238,
+    238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238,
+    238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 238, 239,
+    239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239,
+    239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239, 239,
+    239, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240,
+    240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240, 240,
+    240, 240, 240, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241,
+    241, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241, 241,
+    241, 241, 241, 241, 242, 242, 242, 242, 242, 242, 242, 242, 242, 242, 242, 242,
+    242, 242, 242, 242, 242, 242, 242, 242, 242, 242, 242, 242, 242, 242, 242, 242,
+    242, 242, 242, 242, 242, 242, 242, 243, 243, 243, 243, 243, 243, 243, 243, 243,
+    243, 243, 243, 243, 243, 243, 243, 243, 243, 243, 243, 243, 243, 243, 243, 243,
+    243, 243, 243, 243, 243, 243, 243, 243, 243, 244, 244, 244, 244, 244, 244, 244,
+    244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244,
+    244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 244, 245, 245, 245, 245, 245,
+    245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245,
+    245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 245, 246, 246,
+    246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246,
+    246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246, 246,
+    246, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247,
+    247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247, 247,
+    247, 247, 247, 247, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248,
+    248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248, 248,
+    248, 248, 248, 248, 248, 248, 248, 249, 249, 249, 249, 249, 249, 249, 249, 249,
+    249, 249, 249, 249, 249, 249, 249, 249, 249, 249, 249, 249, 249, 249, 249, 249,
+    249, 249, 249, 249, 249, 249, 249, 249, 249, 249, 250, 250, 250, 250, 250, 250,
+    250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250,
+    250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 250, 251, 251,
+    251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251,
+    251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251, 251,
+    251, 251, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252,
+    252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252, 252,
+    252, 252, 252, 252, 252, 252, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253,
+    253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 253,
+    253, 253, 253, 253, 253, 253, 253, 253, 253, 253, 254, 254, 254, 254, 254, 254,
+    254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254,
+    254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 254, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+};
+
+
+#endif  /* HSLUV_RGB8_TABLES_H */
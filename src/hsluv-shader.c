@@ -0,0 +1,457 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "hsluv-shader.h"
+#include "hsluv-internal.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+
+/* The generated code follows the single precision pipeline of hsluv-simd.h
+ * (including its thresholds for grays, white and black), written out as
+ * scalar code in the common subset of the C-like shading languages. Each
+ * language only provides a prelude of macros for the vector type and the
+ * math functions, the suffix of float literals, and the heads of the compute
+ * kernels. */
+
+typedef struct ShaderLanguage_tag ShaderLanguage;
+struct ShaderLanguage_tag {
+    const char* prelude;
+    const char* suffix;         /* Of float literals. */
+    const char* kernel_head;    /* NULL if there are no kernels. */
+    const char* kernel_guard;   /* Opens the block running for color i. */
+};
+
+static const ShaderLanguage shader_languages[] = {
+    /* HSLUV_SHADER_GLSL */
+    {
+        "#define HSLUV_VEC3 vec3\n"
+        "#define HSLUV_MAKE3(a, b, c) vec3(a, b, c)\n"
+        "#define HSLUV_FN\n"
+        "#define HSLUV_SQRT(x) sqrt(x)\n"
+        "#define HSLUV_POW(x, y) pow(x, y)\n"
+        "#define HSLUV_SIN(x) sin(x)\n"
+        "#define HSLUV_COS(x) cos(x)\n"
+        "#define HSLUV_ATAN2(y, x) atan(y, x)\n",
+        "", NULL, NULL
+    },
+    /* HSLUV_SHADER_HLSL */
+    {
+        "#define HSLUV_VEC3 float3\n"
+        "#define HSLUV_MAKE3(a, b, c) float3(a, b, c)\n"
+        "#define HSLUV_FN\n"
+        "#define HSLUV_SQRT(x) sqrt(x)\n"
+        "#define HSLUV_POW(x, y) pow(x, y)\n"
+        "#define HSLUV_SIN(x) sin(x)\n"
+        "#define HSLUV_COS(x) cos(x)\n"
+        "#define HSLUV_ATAN2(y, x) atan2(y, x)\n",
+        "f", NULL, NULL
+    },
+    /* HSLUV_SHADER_METAL */
+    {
+        "#include <metal_stdlib>\n"
+        "#define HSLUV_VEC3 metal::float3\n"
+        "#define HSLUV_MAKE3(a, b, c) metal::float3(a, b, c)\n"
+        "#define HSLUV_FN static inline\n"
+        "#define HSLUV_SQRT(x) metal::sqrt(x)\n"
+        "#define HSLUV_POW(x, y) metal::pow(x, y)\n"
+        "#define HSLUV_SIN(x) metal::sin(x)\n"
+        "#define HSLUV_COS(x) metal::cos(x)\n"
+        "#define HSLUV_ATAN2(y, x) metal::atan2(y, x)\n",
+        "f",
+        "kernel void hsluv_%s_kernel(device const float* in [[buffer(0)]], device float* out [[buffer(1)]],\n"
+        "                            constant uint& n [[buffer(2)]], uint i [[thread_position_in_grid]])\n"
+        "{\n",
+        "    if(i < n) {\n"
+    },
+    /* HSLUV_SHADER_CUDA */
+    {
+        "#define HSLUV_VEC3 float3\n"
+        "#define HSLUV_MAKE3(a, b, c) make_float3(a, b, c)\n"
+        "#define HSLUV_FN static __device__ inline\n"
+        "#define HSLUV_SQRT(x) sqrtf(x)\n"
+        "#define HSLUV_POW(x, y) powf(x, y)\n"
+        "#define HSLUV_SIN(x) sinf(x)\n"
+        "#define HSLUV_COS(x) cosf(x)\n"
+        "#define HSLUV_ATAN2(y, x) atan2f(y, x)\n",
+        "f",
+        "extern \"C\" __global__ void hsluv_%s_kernel(const float* in, float* out, unsigned n)\n"
+        "{\n"
+        "    unsigned i = blockIdx.x * blockDim.x + threadIdx.x;\n",
+        "    if(i < n) {\n"
+    },
+    /* HSLUV_SHADER_OPENCL */
+    {
+        "#define HSLUV_VEC3 float3\n"
+        "#define HSLUV_MAKE3(a, b, c) ((float3)(a, b, c))\n"
+        "#define HSLUV_FN\n"
+        "#define HSLUV_SQRT(x) sqrt(x)\n"
+        "#define HSLUV_POW(x, y) pow(x, y)\n"
+        "#define HSLUV_SIN(x) sin(x)\n"
+        "#define HSLUV_COS(x) cos(x)\n"
+        "#define HSLUV_ATAN2(y, x) atan2(y, x)\n",
+        "f",
+        "__kernel void hsluv_%s_kernel(__global const float* in, __global float* out, uint n)\n"
+        "{\n"
+        "    uint i = get_global_id(0);\n",
+        "    if(i < n) {\n"
+    },
+    /* HSLUV_SHADER_C */
+    {
+        "#include <math.h>\n"
+        "#include <stddef.h>\n"
+        "typedef struct hsluv_vec3_tag { float x; float y; float z; } hsluv_vec3;\n"
+        "#define HSLUV_VEC3 hsluv_vec3\n"
+        "#define HSLUV_MAKE3(a, b, c) ((hsluv_vec3) { (a), (b), (c) })\n"
+        "#define HSLUV_FN static inline\n"
+        "#define HSLUV_SQRT(x) sqrtf(x)\n"
+        "#define HSLUV_POW(x, y) powf(x, y)\n"
+        "#define HSLUV_SIN(x) sinf(x)\n"
+        "#define HSLUV_COS(x) cosf(x)\n"
+        "#define HSLUV_ATAN2(y, x) atan2f(y, x)\n",
+        "f",
+        "static inline void hsluv_%s_kernel(const float* in, float* out, size_t n)\n"
+        "{\n"
+        "    size_t i;\n",
+        "    for(i = 0; i < n; i++) {\n"
+    }
+};
+
+/* See hsluv-simd.h. */
+#define SHADER_GRAY_C       0.001
+#define SHADER_WHITE_L      99.999
+#define SHADER_BLACK_L      0.00000001
+
+
+typedef struct ShaderWriter_tag ShaderWriter;
+struct ShaderWriter_tag {
+    const ShaderLanguage* lang;
+    char* buf;
+    size_t size;
+    size_t len;
+};
+
+static void
+write_str(ShaderWriter* w, const char* str, size_t n)
+{
+    if(w->len < w->size) {
+        size_t avail = w->size - w->len - 1;
+        memcpy(w->buf + w->len, str, (n < avail ? n : avail));
+    }
+    w->len += n;
+}
+
+/* Write the float literal of the language, with enough digits to round to
+ * the float nearest to the value. snprintf() uses the decimal separator of
+ * LC_NUMERIC, which may be ',' or even several bytes: whatever is not part
+ * of the number otherwise becomes a single '.'. */
+static void
+write_literal(ShaderWriter* w, double val)
+{
+    char tmp[32];
+    char* in;
+    char* out;
+
+    snprintf(tmp, sizeof(tmp), "%.9g", val);
+    for(in = out = tmp; *in != '\0'; in++) {
+        if(strchr("0123456789+-e", *in) != NULL)
+            *out++ = *in;
+        else if(out == tmp  ||  out[-1] != '.')
+            *out++ = '.';
+    }
+    *out = '\0';
+    if(strpbrk(tmp, ".e") == NULL)
+        strcat(tmp, ".0");
+    strcat(tmp, w->lang->suffix);
+    write_str(w, tmp, strlen(tmp));
+}
+
+/* A small printf(): %L writes a double as a float literal, %s a string. */
+static void
+emit(ShaderWriter* w, const char* fmt, ...)
+{
+    va_list args;
+    const char* p;
+
+    va_start(args, fmt);
+    while(*fmt != '\0') {
+        p = strchr(fmt, '%');
+        if(p == NULL) {
+            write_str(w, fmt, strlen(fmt));
+            break;
+        }
+
+        write_str(w, fmt, (size_t) (p - fmt));
+        if(p[1] == '\0')
+            break;
+        if(p[1] == 'L') {
+            write_literal(w, va_arg(args, double));
+        } else if(p[1] == 's') {
+            const char* str = va_arg(args, const char*);
+            write_str(w, str, strlen(str));
+        } else {
+            write_str(w, p + 1, 1);
+        }
+        fmt = p + 2;
+    }
+    va_end(args);
+}
+
+
+static void
+emit_transfer(ShaderWriter* w)
+{
+    emit(w, "HSLUV_FN float hsluv_from_linear(float c)\n"
+            "{\n"
+            "    return c <= %L ? %L * c : %L * HSLUV_POW(c, %L) - %L;\n"
+            "}\n\n",
+         0.0031308, 12.92, 1.055, 1.0 / 2.4, 0.055);
+    emit(w, "HSLUV_FN float hsluv_to_linear(float c)\n"
+            "{\n"
+            "    return c > %L ? HSLUV_POW((c + %L) / %L, %L) : c / %L;\n"
+            "}\n\n",
+         0.04045, 0.055, 1.055, 2.4, 12.92);
+    emit(w, "HSLUV_FN float hsluv_clamp(float x, float hi)\n"
+            "{\n"
+            "    return x < %L ? %L : (x > hi ? hi : x);\n"
+            "}\n\n",
+         0.0, 0.0);
+}
+
+/* The bounding lines (see get_bounds() in hsluv.c) with the coefficients of
+ * each channel precomputed in double precision. */
+static void
+emit_bounds(ShaderWriter* w, const char* name, const char* line_func, const char* args)
+{
+    int i;
+
+    emit(w, "HSLUV_FN float %s", name);
+    emit(w, "\n{\n"
+            "    float tl = l + %L;\n"
+            "    float sub1 = tl * tl * tl / %L;\n"
+            "    float sub2 = sub1 > %L ? sub1 : l / %L;\n",
+         16.0, 1560896.0, epsilon, kappa);
+    emit(w, "    float len = %L;\n", 1e30);
+
+    /* The lines of get_bounds(), from the precomputed coefficients of sRGB;
+     * the zero terms are left out. */
+    for(i = 0; i < 6; i++) {
+        const HsluvRgbSpace* sp = &srgb_space;
+
+        if(sp->bounds_top2_l[i] == 0.0  &&  sp->bounds_bottom_c[i] == 0.0) {
+            emit(w, "    len = %s(len, %L * sub2, %L * l * sub2, %L * sub2%s);\n",
+                 line_func, sp->bounds_top1[i], sp->bounds_top2[i], sp->bounds_bottom[i], args);
+        } else {
+            emit(w, "    len = %s(len, %L * sub2, %L * l * sub2 - %L * l, %L * sub2 + %L%s);\n",
+                 line_func, sp->bounds_top1[i], sp->bounds_top2[i], sp->bounds_top2_l[i],
+                 sp->bounds_bottom[i], sp->bounds_bottom_c[i], args);
+        }
+    }
+}
+
+static void
+emit_chroma(ShaderWriter* w)
+{
+    /* Length of the ray of the hue until it crosses the line v = a * u + b,
+     * if it does. */
+    emit(w, "HSLUV_FN float hsluv_min_ray(float len, float top1, float top2, float bottom, float sin_h, float cos_h)\n"
+            "{\n"
+            "    float a = top1 / bottom;\n"
+            "    float b = top2 / bottom;\n"
+            "    float r = b / (sin_h - a * cos_h);\n"
+            "    return (r >= %L && r < len) ? r : len;\n"
+            "}\n\n",
+         0.0);
+    emit_bounds(w, "hsluv_max_chroma(float l, float sin_h, float cos_h)", "hsluv_min_ray", ", sin_h, cos_h");
+    emit(w, "    return len;\n"
+            "}\n\n");
+
+    /* Squared distance of the line v = a * u + b from the pole. */
+    emit(w, "HSLUV_FN float hsluv_min_dist2(float len, float top1, float top2, float bottom)\n"
+            "{\n"
+            "    float a = top1 / bottom;\n"
+            "    float b = top2 / bottom;\n"
+            "    float x = b / (%L / a - a);\n"
+            "    float y = b + x * a;\n"
+            "    float d = x * x + y * y;\n"
+            "    return d < len ? d : len;\n"
+            "}\n\n",
+         -1.0);
+    emit_bounds(w, "hsluv_max_safe_chroma(float l)", "hsluv_min_dist2", "");
+    emit(w, "    return HSLUV_SQRT(len);\n"
+            "}\n\n");
+}
+
+static void
+emit_pipeline(ShaderWriter* w)
+{
+    emit(w, "HSLUV_FN HSLUV_VEC3 hsluv_lch2rgb(float l, float c, float sin_h, float cos_h)\n"
+            "{\n"
+            "    float y, var_u, var_v, x, z;\n"
+            "    if(l > %L)\n"
+            "        return HSLUV_MAKE3(%L, %L, %L);\n"
+            "    if(l < %L)\n"
+            "        return HSLUV_MAKE3(%L, %L, %L);\n",
+         SHADER_WHITE_L, 1.0, 1.0, 1.0, SHADER_BLACK_L, 0.0, 0.0, 0.0);
+    emit(w, "    if(l <= %L) {\n"
+            "        y = l / %L;\n"
+            "    } else {\n"
+            "        float t = (l + %L) / %L;\n"
+            "        y = t * t * t;\n"
+            "    }\n",
+         8.0, kappa, 16.0, 116.0);
+    emit(w, "    var_u = cos_h * c / (%L * l) + %L;\n"
+            "    var_v = sin_h * c / (%L * l) + %L;\n"
+            "    x = -(%L * y * var_u) / ((var_u - %L) * var_v - var_u * var_v);\n"
+            "    z = (%L * y - (%L * var_v * y) - (var_v * x)) / (%L * var_v);\n",
+         13.0, ref_u, 13.0, ref_v, 9.0, 4.0, 9.0, 15.0, 3.0);
+    emit(w, "    return HSLUV_MAKE3(\n"
+            "        hsluv_clamp(hsluv_from_linear(%L * x + %L * y + %L * z), %L),\n"
+            "        hsluv_clamp(hsluv_from_linear(%L * x + %L * y + %L * z), %L),\n"
+            "        hsluv_clamp(hsluv_from_linear(%L * x + %L * y + %L * z), %L));\n"
+            "}\n\n",
+         m[0].a, m[0].b, m[0].c, 1.0, m[1].a, m[1].b, m[1].c, 1.0, m[2].a, m[2].b, m[2].c, 1.0);
+
+    /* RGB to (L, u, v). */
+    emit(w, "HSLUV_FN HSLUV_VEC3 hsluv_rgb2luv(HSLUV_VEC3 rgb)\n"
+            "{\n"
+            "    float r = hsluv_to_linear(rgb.x);\n"
+            "    float g = hsluv_to_linear(rgb.y);\n"
+            "    float b = hsluv_to_linear(rgb.z);\n"
+            "    float x = %L * r + %L * g + %L * b;\n"
+            "    float y = %L * r + %L * g + %L * b;\n"
+            "    float z = %L * r + %L * g + %L * b;\n",
+         m_inv[0].a, m_inv[0].b, m_inv[0].c, m_inv[1].a, m_inv[1].b, m_inv[1].c,
+         m_inv[2].a, m_inv[2].b, m_inv[2].c);
+    emit(w, "    float l = y <= %L ? y * %L : %L * HSLUV_POW(y, %L) - %L;\n"
+            "    float d;\n"
+            "    if(l < %L)\n"
+            "        return HSLUV_MAKE3(%L, %L, %L);\n"
+            "    d = x + %L * y + %L * z;\n"
+            "    return HSLUV_MAKE3(l, %L * l * (%L * x / d - %L), %L * l * (%L * y / d - %L));\n"
+            "}\n\n",
+         epsilon, kappa, 116.0, 1.0 / 3.0, 16.0, SHADER_BLACK_L, 0.0, 0.0, 0.0,
+         15.0, 3.0, 13.0, 4.0, ref_u, 13.0, 9.0, ref_v);
+}
+
+static void
+emit_conversions(ShaderWriter* w)
+{
+    const char* names[2] = { "hsluv", "hpluv" };
+    int i;
+
+    for(i = 0; i < 2; i++) {
+        const char* bound = (i == 0 ? "hsluv_max_chroma(l, sin_h, cos_h)" : "hsluv_max_safe_chroma(l)");
+        const char* rev_bound = (i == 0 ? "hsluv_max_chroma(l, luv.z / c, luv.y / c)" : "hsluv_max_safe_chroma(l)");
+
+        emit(w, "HSLUV_FN HSLUV_VEC3 hsluv_%s2rgb(HSLUV_VEC3 hsl)\n", names[i]);
+        emit(w, "{\n"
+                "    float h = hsl.y < %L ? %L : hsl.x * %L;\n"
+                "    float l = hsl.z;\n"
+                "    float sin_h = HSLUV_SIN(h);\n"
+                "    float cos_h = HSLUV_COS(h);\n"
+                "    float c = %L;\n"
+                "    if(l <= %L && l >= %L)\n",
+             0.00000001, 0.0, 0.01745329251994329577, 0.0, SHADER_WHITE_L, SHADER_BLACK_L);
+        emit(w, "        c = %s * hsl.y / %L;\n"
+                "    return hsluv_lch2rgb(l, c, sin_h, cos_h);\n"
+                "}\n\n",
+             bound, 100.0);
+
+        emit(w, "HSLUV_FN HSLUV_VEC3 hsluv_rgb2%s(HSLUV_VEC3 rgb)\n", names[i]);
+        emit(w, "{\n"
+                "    HSLUV_VEC3 luv = hsluv_rgb2luv(rgb);\n"
+                "    float l = hsluv_clamp(luv.x, %L);\n"
+                "    float c = HSLUV_SQRT(luv.y * luv.y + luv.z * luv.z);\n"
+                "    float h, s;\n"
+                "    if(c < %L || l > %L || l < %L)\n"
+                "        return HSLUV_MAKE3(%L, %L, l);\n",
+             100.0, SHADER_GRAY_C, SHADER_WHITE_L, SHADER_BLACK_L, 0.0, 0.0);
+        emit(w, "    h = HSLUV_ATAN2(luv.z, luv.y) * %L;\n"
+                "    if(h < %L)\n"
+                "        h += %L;\n",
+             57.29577951308232087680, 0.0, 360.0);
+        emit(w, "    s = c / %s * %L;\n", rev_bound, 100.0);
+        if(i == 0)
+            emit(w, "    s = hsluv_clamp(s, %L);\n", 100.0);
+        emit(w, "    return HSLUV_MAKE3(hsluv_clamp(h, %L), s, l);\n"
+                "}\n\n",
+             360.0);
+    }
+}
+
+static void
+emit_kernels(ShaderWriter* w)
+{
+    static const char* const names[4] = { "hsluv2rgb", "rgb2hsluv", "hpluv2rgb", "rgb2hpluv" };
+    int i;
+
+    if(w->lang->kernel_head == NULL)
+        return;
+
+    for(i = 0; i < 4; i++) {
+        emit(w, w->lang->kernel_head, names[i]);
+        emit(w, w->lang->kernel_guard);
+        emit(w, "        HSLUV_VEC3 c = hsluv_%s(HSLUV_MAKE3(in[3 * i], in[3 * i + 1], in[3 * i + 2]));\n"
+                "        out[3 * i] = c.x;\n"
+                "        out[3 * i + 1] = c.y;\n"
+                "        out[3 * i + 2] = c.z;\n"
+                "    }\n"
+                "}\n\n",
+             names[i]);
+    }
+}
+
+size_t
+hsluv_shader_source(HsluvShaderLanguage language, char* buf, size_t buf_size)
+{
+    ShaderWriter w;
+
+    if((size_t) language >= sizeof(shader_languages) / sizeof(shader_languages[0]))
+        return 0;
+
+    w.lang = &shader_languages[language];
+    w.buf = buf;
+    w.size = buf_size;
+    w.len = 0;
+
+    emit(&w, "/* HSLuv conversions. Generated by hsluv-c (see hsluv-shader.h). */\n\n");
+    emit(&w, w.lang->prelude);
+    emit(&w, "\n");
+    emit_transfer(&w);
+    emit_chroma(&w);
+    emit_pipeline(&w);
+    emit_conversions(&w);
+    emit_kernels(&w);
+
+    if(buf_size > 0)
+        buf[w.len < buf_size ? w.len : buf_size - 1] = '\0';
+    return w.len;
+}
@@ -0,0 +1,93 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_SHADER_H
+#define HSLUV_SHADER_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Languages of the generated GPU code.
+ */
+typedef enum HsluvShaderLanguage_tag {
+    HSLUV_SHADER_GLSL = 0,  /**< OpenGL / Vulkan GLSL (3.30, ES 3.00 or newer). */
+    HSLUV_SHADER_HLSL,      /**< Direct3D HLSL. */
+    HSLUV_SHADER_METAL,     /**< Metal Shading Language. */
+    HSLUV_SHADER_CUDA,      /**< CUDA C++. */
+    HSLUV_SHADER_OPENCL,    /**< OpenCL C. */
+    HSLUV_SHADER_C          /**< C99; a CPU reference of the generated code. */
+} HsluvShaderLanguage;
+
+/**
+ * Generate GPU source code of the conversions.
+ *
+ * The code defines four functions working in single precision on three
+ * component vectors (e.g. @c vec3 in GLSL, @c float3 in HLSL, Metal, CUDA
+ * and OpenCL, and a struct @c hsluv_vec3 in C):
+ *  - hsluv_hsluv2rgb(hsl),
+ *  - hsluv_rgb2hsluv(rgb),
+ *  - hsluv_hpluv2rgb(hpl),
+ *  - hsluv_rgb2hpluv(rgb),
+ *
+ * with the same ranges and semantics as hsluv2rgb() and the like. The code
+ * is produced from the constants of this library (the RGB matrices, the
+ * reference white, kappa and epsilon), so it cannot drift from it; its
+ * accuracy is that of hsluv2rgbf() and the like.
+ *
+ * Except for GLSL and HLSL, where the functions are meant to be pasted into
+ * an application shader, the code also defines compute kernels converting
+ * @c n colors laid out as three consecutive floats (as in hsluv2rgbf_n()),
+ * one color per thread: hsluv_hsluv2rgb_kernel(in, out, n) and the like.
+ * CUDA kernels are @c extern @c "C" @c __global__ functions, OpenCL ones
+ * take @c __global buffers, and Metal ones take the buffers and @c n at
+ * the indexes 0, 1 and 2. The C ones are plain loops.
+ *
+ * All the names the code defines (functions and macros) start with
+ * @c hsluv_ or @c HSLUV_.
+ *
+ * @param language The language.
+ * @param[out] buf Where to store the source code, terminated with a
+ * null character. It is truncated if it does not fit. It may be NULL if
+ * @c buf_size is zero.
+ * @param buf_size Size of @c buf in bytes.
+ * @return Length of the whole source code (excluding the terminating null
+ * character), like snprintf(), or 0 if the language is invalid.
+ */
+size_t hsluv_shader_source(HsluvShaderLanguage language, char* buf, size_t buf_size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HSLUV_SHADER_H */
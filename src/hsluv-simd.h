@@ -0,0 +1,979 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+/* This file is a template of the vectorized conversion kernels. It is not
+ * compiled on its own: each of hsluv-<isa>.c and hsluv-<isa>-float.c (and
+ * hsluv-float.c for portable single precision) includes it after providing:
+ *
+ *  - macro SIMD_FLOAT, 1 for single precision kernels, 0 for double;
+ *  - type vr (vector of VR_WIDTH floats or doubles) and type vm (vector mask);
+ *  - macro SIMD_NAME(fn) forming names of the exported kernels;
+ *  - the primitive operations vr_xxx() and vm_xxx() used below.
+ *
+ * All the color space constants come from an HsluvRgbSpace. The kernels of
+ * the plain sRGB functions pass the static srgb_space, so once the inline
+ * functions are inlined, the compiler folds its members into immediate
+ * constants; the kernels with the _space suffix read them from the space
+ * given by the application.
+ *
+ * The kernels replace the libm calls of hsluv.c with polynomial
+ * approximations, and the branches with masked selects. In double precision,
+ * the approximations are accurate to a few ulps in the ranges the color
+ * conversions need, so the kernels agree with the scalar code well below the
+ * precision of the test snapshot. Single precision kernels use shorter
+ * polynomials matching the float precision.
+ */
+
+#include <float.h>
+
+
+#if SIMD_FLOAT
+    #define SIMD_REAL           float
+    #define SIMD_REAL_MAX       FLT_MAX
+    /* ln(2) split into a high part with trailing zero bits, so that k * hi is
+     * exact for any exponent k, and the low remainder. */
+    #define LN2_HI              0.693359375
+    #define LN2_LO              (-2.12194440054690582e-04)
+    /* In float, rounding errors leave chroma of the order of 1e-4 for
+     * grays, and lightness of white may fall a few ulps below 100. */
+    #define GRAY_C              0.001
+    #define WHITE_L             99.999
+#else
+    #define SIMD_REAL           double
+    #define SIMD_REAL_MAX       DBL_MAX
+    #define LN2_HI              6.93147180369123816490e-01
+    #define LN2_LO              1.90821492927058770002e-10
+    #define GRAY_C              0.00000001
+    #define WHITE_L             99.9999999
+#endif
+
+#define BLACK_L             0.00000001
+
+
+#define ARRAY_SIZE(arr)     (sizeof(arr) / sizeof((arr)[0]))
+
+/* Sub-block used when the data is strided, and for the trailing partial
+ * vector. Must be a multiple of any VR_WIDTH. */
+#define SIMD_BLOCK          64
+
+
+static inline vr
+vr_neg(vr x)
+{
+    return vr_sub(vr_set(0.0), x);
+}
+
+static inline vr
+vr_abs(vr x)
+{
+    return vr_max(x, vr_neg(x));
+}
+
+static inline vr
+vr_clamp(vr x, double min_val, double max_val)
+{
+    return vr_max(vr_min(x, vr_set(max_val)), vr_set(min_val));
+}
+
+static inline vr
+vr_poly(vr x, const double* coef, int n)
+{
+    vr p = vr_set(coef[0]);
+    int i;
+
+    for(i = 1; i < n; i++)
+        p = vr_fma(p, x, vr_set(coef[i]));
+    return p;
+}
+
+/* Evaluate polynomial with coefficients coef[] (the highest degree first).
+ * Single precision uses just the last n_float terms. */
+#if SIMD_FLOAT
+    #define POLY(x, coef, n_float)                                          \
+        vr_poly((x), (coef) + ARRAY_SIZE(coef) - (n_float), (n_float))
+#else
+    #define POLY(x, coef, n_float)                                          \
+        vr_poly((x), (coef), ARRAY_SIZE(coef))
+#endif
+
+
+/* log(x) for positive normal x.
+ *
+ * x = 2^e * mnt with mnt in [sqrt(2)/2, sqrt(2)), and
+ * log(mnt) = 2 * atanh(s) with s = (mnt - 1) / (mnt + 1), |s| < 0.1716.
+ */
+static const double log_coef[] = {
+    1.0 / 21.0, 1.0 / 19.0, 1.0 / 17.0, 1.0 / 15.0, 1.0 / 13.0, 1.0 / 11.0,
+    1.0 / 9.0, 1.0 / 7.0, 1.0 / 5.0, 1.0 / 3.0, 1.0
+};
+
+static inline vr
+vr_log(vr x)
+{
+    vr one = vr_set(1.0);
+    vr e = vr_exponent(x);
+    vr mnt = vr_mantissa(x);
+    vm big = vr_gt(mnt, vr_set(1.41421356237309504880));
+    vr s, p;
+
+    mnt = vr_sel(big, vr_mul(mnt, vr_set(0.5)), mnt);
+    e = vr_sel(big, vr_add(e, one), e);
+    s = vr_div(vr_sub(mnt, one), vr_add(mnt, one));
+    p = vr_mul(vr_add(s, s), POLY(vr_mul(s, s), log_coef, 5));
+
+    return vr_fma(e, vr_set(LN2_HI), vr_fma(e, vr_set(LN2_LO), p));
+}
+
+/* exp(x) for moderate x.
+ *
+ * x = k * ln(2) + r with |r| <= ln(2) / 2, and exp(r) is its Taylor
+ * polynomial of degree 13 (or 7 in float).
+ */
+static const double exp_coef[] = {
+    1.0 / 6227020800.0, 1.0 / 479001600.0, 1.0 / 39916800.0,
+    1.0 / 3628800.0, 1.0 / 362880.0, 1.0 / 40320.0, 1.0 / 5040.0,
+    1.0 / 720.0, 1.0 / 120.0, 1.0 / 24.0, 1.0 / 6.0, 1.0 / 2.0, 1.0, 1.0
+};
+
+static inline vr
+vr_exp(vr x)
+{
+    vr k = vr_round(vr_mul(x, vr_set(1.44269504088896340736)));
+    vr r;
+
+    r = vr_fma(k, vr_set(-LN2_HI), x);
+    r = vr_fma(k, vr_set(-LN2_LO), r);
+    return vr_ldexp(POLY(r, exp_coef, 8), k);
+}
+
+/* x^y for positive x. */
+static inline vr
+vr_pow(vr x, double y)
+{
+    return vr_exp(vr_mul(vr_log(x), vr_set(y)));
+}
+
+/* Cube root of positive x: exp(log(x) / 3) refined by one Newton step. */
+static inline vr
+vr_cbrt(vr x)
+{
+    vr r = vr_exp(vr_mul(vr_log(x), vr_set(1.0 / 3.0)));
+    vr r2 = vr_mul(r, r);
+
+    return vr_sub(r, vr_div(vr_fma(r2, r, vr_neg(x)), vr_mul(vr_set(3.0), r2)));
+}
+
+/* Sine and cosine of angle h given in degrees.
+ *
+ * h = k * 90 + r with |r| <= 45 so the reduction is exact, then both are
+ * Taylor polynomials (degree 15 and 16, or 9 and 8 in float) in r converted
+ * to radians. The quadrant k mod 4 swaps and negates the results.
+ */
+static const double sin_coef[] = {
+    -1.0 / 1307674368000.0, 1.0 / 6227020800.0, -1.0 / 39916800.0,
+    1.0 / 362880.0, -1.0 / 5040.0, 1.0 / 120.0, -1.0 / 6.0
+};
+
+static const double cos_coef[] = {
+    1.0 / 20922789888000.0, -1.0 / 87178291200.0, 1.0 / 479001600.0,
+    -1.0 / 3628800.0, 1.0 / 40320.0, -1.0 / 720.0, 1.0 / 24.0, -1.0 / 2.0
+};
+
+static inline void
+vr_sincos_deg(vr h, vr* p_sin, vr* p_cos)
+{
+    vr k = vr_round(vr_mul(h, vr_set(1.0 / 90.0)));
+    vr r = vr_mul(vr_fma(k, vr_set(-90.0), h), vr_set(0.01745329251994329577));
+    vr z = vr_mul(r, r);
+    vr sn = vr_fma(vr_mul(r, z), POLY(z, sin_coef, 4), r);
+    vr cs = vr_fma(z, POLY(z, cos_coef, 4), vr_set(1.0));
+    vr q = vr_fma(vr_floor(vr_mul(k, vr_set(0.25))), vr_set(-4.0), k);
+    vr q_odd = vr_fma(vr_floor(vr_mul(q, vr_set(0.5))), vr_set(-2.0), q);
+    vm swap = vr_gt(q_odd, vr_set(0.5));
+    vm neg_sin = vr_gt(q, vr_set(1.5));
+    vm neg_cos = vm_and(vr_gt(q, vr_set(0.5)), vr_lt(q, vr_set(2.5)));
+    vr s = vr_sel(swap, cs, sn);
+    vr c = vr_sel(swap, sn, cs);
+
+    *p_sin = vr_sel(neg_sin, vr_neg(s), s);
+    *p_cos = vr_sel(neg_cos, vr_neg(c), c);
+}
+
+/* atan2(v, u) in degrees, in the range (-180, 180].
+ *
+ * The ratio of the smaller to the bigger of |u| and |v| is in [0, 1]. Two
+ * steps of atan(t) = 2 * atan(t / (1 + sqrt(1 + t^2))) bring it below
+ * tan(pi/16) where the Taylor series of degree 23 (or 9 in float) suffices.
+ * Octant symmetries then give the full angle.
+ */
+static const double atan_coef[] = {
+    -1.0 / 23.0, 1.0 / 21.0, -1.0 / 19.0, 1.0 / 17.0, -1.0 / 15.0, 1.0 / 13.0,
+    -1.0 / 11.0, 1.0 / 9.0, -1.0 / 7.0, 1.0 / 5.0, -1.0 / 3.0, 1.0
+};
+
+static inline vr
+vr_atan2_deg(vr v, vr u)
+{
+    vr one = vr_set(1.0);
+    vr au = vr_abs(u);
+    vr av = vr_abs(v);
+    vr t = vr_div(vr_min(au, av), vr_max(au, av));
+    vr ang;
+
+    t = vr_div(t, vr_add(one, vr_sqrt(vr_fma(t, t, one))));
+    t = vr_div(t, vr_add(one, vr_sqrt(vr_fma(t, t, one))));
+    ang = vr_mul(vr_mul(t, POLY(vr_mul(t, t), atan_coef, 5)),
+                 vr_set(229.18311805232928350719));  /* (4 * 180 / pi) */
+
+    ang = vr_sel(vr_gt(av, au), vr_sub(vr_set(90.0), ang), ang);
+    ang = vr_sel(vr_lt(u, vr_set(0.0)), vr_sub(vr_set(180.0), ang), ang);
+    ang = vr_sel(vr_lt(v, vr_set(0.0)), vr_neg(ang), ang);
+    return ang;
+}
+
+
+/* Vectorized get_bounds(). For each of the six lines, we keep the numerators
+ * (top1, top2) and the common denominator (bottom) separately, as both
+ * max_chroma_for_lh() and max_safe_chroma_for_l() can be then computed with
+ * a single division per line. */
+typedef struct VBounds_tag VBounds;
+struct VBounds_tag {
+    vr top1[6];
+    vr top2[6];
+    vr bottom[6];
+};
+
+static inline void
+vbounds(const HsluvRgbSpace* sp, vr l, VBounds* bounds)
+{
+    vr tl = vr_add(l, vr_set(16.0));
+    vr sub1 = vr_mul(vr_mul(vr_mul(tl, tl), tl), vr_set(1.0 / 1560896.0));
+    vr sub2 = vr_sel(vr_gt(sub1, vr_set(epsilon)), sub1, vr_div(l, vr_set(kappa)));
+    vr lsub2 = vr_mul(l, sub2);
+    int i;
+
+    /* The same per-line coefficients as get_bounds() of hsluv.c. (The zero
+     * terms of the even lines fold away for sRGB, and so do the products
+     * shared by the two lines of each channel.) */
+    for(i = 0; i < 6; i++) {
+        bounds->top1[i] = vr_mul(vr_set(sp->bounds_top1[i]), sub2);
+        bounds->top2[i] = vr_fma(vr_set(-sp->bounds_top2_l[i]), l,
+                                 vr_mul(vr_set(sp->bounds_top2[i]), lsub2));
+        bounds->bottom[i] = vr_add(vr_mul(vr_set(sp->bounds_bottom[i]), sub2), vr_set(sp->bounds_bottom_c[i]));
+    }
+}
+
+/* ray_length_until_intersect() is b / (sin - a * cos) where a = top1 / bottom
+ * and b = top2 / bottom; multiplying by bottom leaves a single division. */
+static inline vr
+vmax_chroma_for_bounds(const VBounds* bounds, vr sin_h, vr cos_h)
+{
+    vr zero = vr_set(0.0);
+    vr min_len = vr_set(SIMD_REAL_MAX);
+    int i;
+
+    for(i = 0; i < 6; i++) {
+        vr den = vr_sub(vr_mul(bounds->bottom[i], sin_h), vr_mul(bounds->top1[i], cos_h));
+        vr len = vr_div(bounds->top2[i], den);
+
+        min_len = vr_sel(vm_and(vr_ge(len, zero), vr_lt(len, min_len)), len, min_len);
+    }
+    return min_len;
+}
+
+static inline vr
+vmax_chroma_for_lh(const HsluvRgbSpace* sp, vr l, vr sin_h, vr cos_h)
+{
+    VBounds bounds;
+
+    vbounds(sp, l, &bounds);
+    return vmax_chroma_for_bounds(&bounds, sin_h, cos_h);
+}
+
+/* The hue sectors of one lightness shared by all the lanes (see
+ * max_chroma_for_sectors() of hsluv.c, which this is a lane-wise copy of). */
+typedef struct VSectors_tag VSectors;
+struct VSectors_tag {
+    vr u[6];
+    vr v[6];
+    vr a[6];
+    vr b[6];
+};
+
+static inline void
+vsectors_init(VSectors* vs, const HueSectors* sectors)
+{
+    int i;
+
+    for(i = 0; i < 6; i++) {
+        vs->u[i] = vr_set(sectors->u[i]);
+        vs->v[i] = vr_set(sectors->v[i]);
+        vs->a[i] = vr_set(sectors->a[i]);
+        vs->b[i] = vr_set(sectors->b[i]);
+    }
+}
+
+static inline vr
+vmax_chroma_for_sectors(const VSectors* vs, vr sin_h, vr cos_h)
+{
+    vr zero = vr_set(0.0);
+    vr a = vs->a[5];
+    vr b = vs->b[5];
+    vr side[6];
+    int i;
+
+    for(i = 0; i < 6; i++)
+        side[i] = vr_sub(vr_mul(vs->u[i], sin_h), vr_mul(vs->v[i], cos_h));
+
+    for(i = 0; i < 5; i++) {
+        vm in = vm_and(vr_ge(side[i], zero), vr_lt(side[i + 1], zero));
+
+        a = vr_sel(in, vs->a[i], a);
+        b = vr_sel(in, vs->b[i], b);
+    }
+
+    return vr_div(b, vr_sub(sin_h, vr_mul(a, cos_h)));
+}
+
+/* Run of vectors of one lightness in all the lanes (see sectors_for_run() of
+ * hsluv.c): once it is HSLUV_SECTORS_MIN_RUN colors long, the maximal chroma
+ * comes from the hue sectors of the lightness instead of the six lines. */
+typedef struct VRun_tag VRun;
+struct VRun_tag {
+    SIMD_REAL l;
+    unsigned len;           /* Number of colors of the lightness in a row. */
+    int sectors_state;      /* 0: not built (yet), 1: valid, -1: degenerate. */
+    VSectors sectors;
+};
+
+static inline void
+vrun_init(VRun* run)
+{
+    run->l = -1.0;
+    run->len = 0;
+    run->sectors_state = 0;
+}
+
+/* The hue sectors for the lightness l, or NULL if vmax_chroma_for_lh() is to
+ * be used. */
+static inline const VSectors*
+vrun_sectors(const HsluvRgbSpace* sp, VRun* run, vr l)
+{
+    SIMD_REAL lanes[VR_WIDTH];
+    vr run_l;
+
+    vr_storeu(lanes, l);
+    if(lanes[0] != run->l) {
+        run->l = lanes[0];
+        run->len = 0;
+        run->sectors_state = 0;
+    }
+
+    run_l = vr_set(run->l);
+    if(vm_any(vm_or(vr_lt(l, run_l), vr_gt(l, run_l)))) {
+        run->len = 0;
+        return NULL;
+    }
+
+    if(run->len < HSLUV_SECTORS_MIN_RUN) {
+        run->len += VR_WIDTH;
+        return NULL;
+    }
+
+    if(run->sectors_state == 0) {
+        HueSectors sectors;
+
+        if(hsluv_hue_sectors_for_l(sp, run->l, &sectors) == 0) {
+            vsectors_init(&run->sectors, &sectors);
+            run->sectors_state = 1;
+        } else {
+            run->sectors_state = -1;
+        }
+    }
+
+    return (run->sectors_state > 0 ? &run->sectors : NULL);
+}
+
+/* Squared distance of the line y = a * x + b from the origin is
+ * b^2 / (1 + a^2), i.e. top2^2 / (bottom^2 + top1^2). */
+static inline vr
+vmax_safe_chroma_for_l(const HsluvRgbSpace* sp, vr l)
+{
+    VBounds bounds;
+    vr min_len_squared = vr_set(SIMD_REAL_MAX);
+    int i;
+
+    vbounds(sp, l, &bounds);
+    for(i = 0; i < 6; i++) {
+        vr num = vr_mul(bounds.top2[i], bounds.top2[i]);
+        vr den = vr_fma(bounds.bottom[i], bounds.bottom[i],
+                        vr_mul(bounds.top1[i], bounds.top1[i]));
+
+        min_len_squared = vr_min(min_len_squared, vr_div(num, den));
+    }
+    return vr_sqrt(min_len_squared);
+}
+
+static inline vr
+vfrom_linear(const HsluvRgbSpace* sp, vr c)
+{
+    vr lo = vr_mul(c, vr_set(sp->tf_slope));
+    vr hi = vr_fma(vr_set(sp->tf_scale), vr_pow(c, 1.0 / sp->tf_gamma), vr_set(-sp->tf_offset));
+
+    return vr_sel(vr_le(c, vr_set(sp->tf_cut)), lo, hi);
+}
+
+static inline vr
+vto_linear(const HsluvRgbSpace* sp, vr c)
+{
+    vr lo = vr_mul(c, vr_set(1.0 / sp->tf_slope));
+    vr hi = vr_pow(vr_mul(vr_add(c, vr_set(sp->tf_offset)), vr_set(1.0 / sp->tf_scale)), sp->tf_gamma);
+
+    return vr_sel(vr_gt(c, vr_set(sp->tf_cut_encoded)), hi, lo);
+}
+
+static inline vr
+vdot(const double* row, vr a, vr b, vr c)
+{
+    return vr_fma(vr_set(row[0]), a, vr_fma(vr_set(row[1]), b, vr_mul(vr_set(row[2]), c)));
+}
+
+static inline vr
+vl2y(vr l)
+{
+    vr y_hi = vr_mul(vr_add(l, vr_set(16.0)), vr_set(1.0 / 116.0));
+
+    y_hi = vr_mul(vr_mul(y_hi, y_hi), y_hi);
+    return vr_sel(vr_le(l, vr_set(8.0)), vr_div(l, vr_set(kappa)), y_hi);
+}
+
+/* Common tail of hsluv2rgb() and hpluv2rgb(): lch2luv, luv2xyz and xyz2rgb,
+ * with y = l2y(l) passed by the caller. */
+static inline void
+vlch2rgb_y(const HsluvRgbSpace* sp, vr l, vr y, vr c, vr sin_h, vr cos_h, vr* p_r, vr* p_g, vr* p_b)
+{
+    vr u = vr_mul(cos_h, c);
+    vr v = vr_mul(sin_h, c);
+    vr var_u, var_v, x, z;
+    vm black = vr_le(l, vr_set(BLACK_L));
+
+    /* luv2xyz(); for black, this would divide by zero, so we patch the lanes
+     * at the end. Note ((var_u - 4) * var_v - var_u * var_v) == -4 * var_v. */
+    var_u = vr_add(vr_div(u, vr_mul(vr_set(13.0), l)), vr_set(sp->ref_u));
+    var_v = vr_add(vr_div(v, vr_mul(vr_set(13.0), l)), vr_set(sp->ref_v));
+    x = vr_div(vr_mul(vr_mul(vr_set(9.0), y), var_u), vr_mul(vr_set(4.0), var_v));
+    z = vr_div(vr_sub(vr_mul(y, vr_fma(vr_set(-15.0), var_v, vr_set(9.0))), vr_mul(var_v, x)),
+               vr_mul(vr_set(3.0), var_v));
+    x = vr_sel(black, vr_set(0.0), x);
+    y = vr_sel(black, vr_set(0.0), y);
+    z = vr_sel(black, vr_set(0.0), z);
+
+    /* xyz2rgb() */
+    *p_r = vr_clamp(vfrom_linear(sp, vdot(sp->m[0], x, y, z)), 0.0, 1.0);
+    *p_g = vr_clamp(vfrom_linear(sp, vdot(sp->m[1], x, y, z)), 0.0, 1.0);
+    *p_b = vr_clamp(vfrom_linear(sp, vdot(sp->m[2], x, y, z)), 0.0, 1.0);
+}
+
+static inline void
+vlch2rgb(const HsluvRgbSpace* sp, vr l, vr c, vr sin_h, vr cos_h, vr* p_r, vr* p_g, vr* p_b)
+{
+    vlch2rgb_y(sp, l, vl2y(l), c, sin_h, cos_h, p_r, p_g, p_b);
+}
+
+/* Common head of rgb2hsluv() and rgb2hpluv(): rgb2xyz and xyz2luv. Returns
+ * also the Y of XYZ. */
+static inline void
+vrgb2luv(const HsluvRgbSpace* sp, vr r, vr g, vr b, vr* p_l, vr* p_u, vr* p_v, vr* p_y)
+{
+    vr zero = vr_set(0.0);
+    vr rl = vto_linear(sp, r);
+    vr gl = vto_linear(sp, g);
+    vr bl = vto_linear(sp, b);
+    vr x = vdot(sp->m_inv[0], rl, gl, bl);
+    vr y = vdot(sp->m_inv[1], rl, gl, bl);
+    vr z = vdot(sp->m_inv[2], rl, gl, bl);
+    vr den, var_u, var_v, l;
+    vm black;
+
+    /* xyz2luv() */
+    den = vr_add(vr_fma(vr_set(15.0), y, x), vr_mul(vr_set(3.0), z));
+    var_u = vr_div(vr_mul(vr_set(4.0), x), den);
+    var_v = vr_div(vr_mul(vr_set(9.0), y), den);
+    l = vr_sel(vr_le(y, vr_set(epsilon)), vr_mul(y, vr_set(kappa)),
+               vr_fma(vr_set(116.0), vr_cbrt(y), vr_set(-16.0)));
+    black = vr_lt(l, vr_set(BLACK_L));
+
+    *p_l = l;
+    *p_u = vr_sel(black, zero, vr_mul(vr_mul(vr_set(13.0), l), vr_sub(var_u, vr_set(sp->ref_u))));
+    *p_v = vr_sel(black, zero, vr_mul(vr_mul(vr_set(13.0), l), vr_sub(var_v, vr_set(sp->ref_v))));
+    *p_y = y;
+}
+
+/* luv2lch(), with the sine and cosine of the hue taken from u / c and v / c
+ * (so the bounds need no trigonometry), as luv2lch() of hsluv.c. */
+static inline void
+vluv2lch(vr u, vr v, vr* p_c, vr* p_h, vr* p_sin, vr* p_cos)
+{
+    vr zero = vr_set(0.0);
+    vr one = vr_set(1.0);
+    vr c, h, inv_c;
+    vm gray;
+
+    c = vr_sqrt(vr_fma(u, u, vr_mul(v, v)));
+    h = vr_atan2_deg(v, u);
+    h = vr_sel(vr_lt(h, zero), vr_add(h, vr_set(360.0)), h);
+    gray = vr_lt(c, vr_set(GRAY_C));
+    h = vr_sel(gray, zero, h);
+    inv_c = vr_div(one, vr_sel(gray, one, c));
+    /* Unlike hsluv.c, zero also the chroma of grays, so that the rounding
+     * noise does not leak into the saturation. (In double precision, this
+     * changes the result by less than 1e-8.) */
+    c = vr_sel(gray, zero, c);
+
+    *p_c = c;
+    *p_h = h;
+    *p_sin = vr_sel(gray, zero, vr_mul(v, inv_c));
+    *p_cos = vr_sel(gray, one, vr_mul(u, inv_c));
+}
+
+/* ... and luv2lch. */
+static inline void
+vrgb2lch(const HsluvRgbSpace* sp, vr r, vr g, vr b, vr* p_l, vr* p_c, vr* p_h,
+         vr* p_sin, vr* p_cos)
+{
+    vr u, v, y;
+
+    vrgb2luv(sp, r, g, b, p_l, &u, &v, &y);
+    vluv2lch(u, v, p_c, p_h, p_sin, p_cos);
+}
+
+/* White or black: chroma and saturation are zero. */
+static inline vm
+vextreme_l(vr l)
+{
+    return vm_or(vr_gt(l, vr_set(WHITE_L)), vr_lt(l, vr_set(BLACK_L)));
+}
+
+/* The maximal chroma of the lightness l and the hue, from the hue sectors of
+ * the run if there are any (the run may be NULL). */
+static inline vr
+vmax_chroma_for_run(const HsluvRgbSpace* sp, VRun* run, vr l, vr sin_h, vr cos_h)
+{
+    const VSectors* sectors = (run != NULL ? vrun_sectors(sp, run, l) : NULL);
+
+    if(sectors != NULL)
+        return vmax_chroma_for_sectors(sectors, sin_h, cos_h);
+    return vmax_chroma_for_lh(sp, l, sin_h, cos_h);
+}
+
+static inline int
+vhsluv2rgb(const HsluvRgbSpace* sp, vr* a, vr* b, vr* c, VRun* run)
+{
+    vr h = *a, s = *b, l = *c;
+    vr zero = vr_set(0.0);
+    vr sin_h, cos_h, chroma;
+    vm gray = vr_lt(s, vr_set(0.00000001));
+
+    vr_sincos_deg(h, &sin_h, &cos_h);
+    chroma = vr_mul(vmax_chroma_for_run(sp, run, l, sin_h, cos_h), vr_mul(s, vr_set(1.0 / 100.0)));
+    chroma = vr_sel(vextreme_l(l), zero, chroma);
+    /* Grays: hue is zero. */
+    sin_h = vr_sel(gray, zero, sin_h);
+    cos_h = vr_sel(gray, vr_set(1.0), cos_h);
+    vlch2rgb(sp, l, chroma, sin_h, cos_h, a, b, c);
+    return 0;
+}
+
+static inline int
+vhpluv2rgb(const HsluvRgbSpace* sp, vr* a, vr* b, vr* c)
+{
+    vr h = *a, s = *b, l = *c;
+    vr zero = vr_set(0.0);
+    vr sin_h, cos_h, chroma;
+    vm gray = vr_lt(s, vr_set(0.00000001));
+
+    vr_sincos_deg(vr_sel(gray, zero, h), &sin_h, &cos_h);
+    chroma = vr_mul(vmax_safe_chroma_for_l(sp, l), vr_mul(s, vr_set(1.0 / 100.0)));
+    chroma = vr_sel(vextreme_l(l), zero, chroma);
+    vlch2rgb(sp, l, chroma, sin_h, cos_h, a, b, c);
+    return 0;
+}
+
+static inline int
+vrgb2hsluv(const HsluvRgbSpace* sp, vr* a, vr* b, vr* c, VRun* run)
+{
+    vr l, chroma, h, s, sin_h, cos_h;
+
+    vrgb2lch(sp, *a, *b, *c, &l, &chroma, &h, &sin_h, &cos_h);
+    s = vr_mul(vr_div(chroma, vmax_chroma_for_run(sp, run, l, sin_h, cos_h)), vr_set(100.0));
+    s = vr_sel(vextreme_l(l), vr_set(0.0), s);
+
+    *a = vr_clamp(h, 0.0, 360.0);
+    *b = vr_clamp(s, 0.0, 100.0);
+    *c = vr_clamp(l, 0.0, 100.0);
+    return 0;
+}
+
+/* Tetrahedral interpolation in the 3D LUT of hsluv-lut3d.c (see
+ * scalar_lut3d_rgb2hsluv() of hsluv.c for the scalar original). The vector
+ * units have no gathers, so the eight nodes of the cells are loaded lane by
+ * lane; everything else, including the choice of the tetrahedron, is done
+ * with masked selects. The axes are ranked with the ties broken as red >
+ * green > blue, so the tetrahedron is always one of the six proper ones.
+ *
+ * The interpolated Luv color then goes the way of vrgb2hsluv(), except for
+ * the dark colors, which get the exact vrgb2hsluv() (see HsluvLut3d). */
+static inline int
+vlut3d_rgb2hsluv(const Lut3d* lut, vr* a, vr* b, vr* c)
+{
+    SIMD_REAL idx[3][VR_WIDTH];
+    SIMD_REAL node[8][3][VR_WIDTH];
+    vr zero = vr_set(0.0);
+    vr last = vr_set((double) (lut->size - 2));
+    vr scale = vr_set((double) (lut->size - 1));
+    vr r = vr_clamp(*a, 0.0, 1.0);
+    vr g = vr_clamp(*b, 0.0, 1.0);
+    vr bl = vr_clamp(*c, 0.0, 1.0);
+    vr xr = vr_mul(r, scale), xg = vr_mul(g, scale), xb = vr_mul(bl, scale);
+    vr ir = vr_min(vr_floor(xr), last), ig = vr_min(vr_floor(xg), last), ib = vr_min(vr_floor(xb), last);
+    vr fr = vr_sub(xr, ir), fg = vr_sub(xg, ig), fb = vr_sub(xb, ib);
+    vr fmax, fmin, fmid, l, chroma, h, s, sin_h, cos_h;
+    vm rg, rb, gb, r_max, g_max, b_min, g_min, exact;
+    vr val[3];
+    size_t stride_r = (size_t) lut->size * lut->size * 3;
+    size_t stride_g = (size_t) lut->size * 3;
+    int j, k;
+
+    vr_storeu(idx[0], ir);
+    vr_storeu(idx[1], ig);
+    vr_storeu(idx[2], ib);
+    for(j = 0; j < VR_WIDTH; j++) {
+        const float* p = lut->nodes + (size_t) idx[0][j] * stride_r
+                                    + (size_t) idx[1][j] * stride_g + (size_t) idx[2][j] * 3;
+
+        for(k = 0; k < 3; k++) {
+            node[0][k][j] = p[k];
+            node[1][k][j] = p[stride_r + k];
+            node[2][k][j] = p[stride_g + k];
+            node[3][k][j] = p[3 + k];
+            node[4][k][j] = p[stride_r + stride_g + k];
+            node[5][k][j] = p[stride_r + 3 + k];
+            node[6][k][j] = p[stride_g + 3 + k];
+            node[7][k][j] = p[stride_r + stride_g + 3 + k];
+        }
+    }
+
+    rg = vr_ge(fr, fg);
+    rb = vr_ge(fr, fb);
+    gb = vr_ge(fg, fb);
+    r_max = vm_and(rg, rb);
+    g_max = vm_and(vr_lt(fr, fg), gb);
+    b_min = vm_and(rb, gb);
+    g_min = vm_and(rg, vr_lt(fg, fb));
+    fmax = vr_max(vr_max(fr, fg), fb);
+    fmin = vr_min(vr_min(fr, fg), fb);
+    fmid = vr_sub(vr_sub(vr_add(vr_add(fr, fg), fb), fmax), fmin);
+
+    for(k = 0; k < 3; k++) {
+        vr c000 = vr_loadu(node[0][k]);
+        vr c111 = vr_loadu(node[7][k]);
+        /* The node after stepping along the largest fraction, and also along
+         * the middle one. */
+        vr ca = vr_sel(r_max, vr_loadu(node[1][k]),
+                       vr_sel(g_max, vr_loadu(node[2][k]), vr_loadu(node[3][k])));
+        vr cb = vr_sel(b_min, vr_loadu(node[4][k]),
+                       vr_sel(g_min, vr_loadu(node[5][k]), vr_loadu(node[6][k])));
+
+        val[k] = vr_fma(vr_sub(ca, c000), fmax, c000);
+        val[k] = vr_fma(vr_sub(cb, ca), fmid, val[k]);
+        val[k] = vr_fma(vr_sub(c111, cb), fmin, val[k]);
+    }
+
+    l = val[0];
+    vluv2lch(val[1], val[2], &chroma, &h, &sin_h, &cos_h);
+    s = vr_mul(vr_div(chroma, vmax_chroma_for_lh(&srgb_space, l, sin_h, cos_h)), vr_set(100.0));
+    s = vr_sel(vextreme_l(l), zero, s);
+    h = vr_clamp(h, 0.0, 360.0);
+    s = vr_clamp(s, 0.0, 100.0);
+    l = vr_clamp(l, 0.0, 100.0);
+
+    exact = vr_lt(l, vr_set(LUT3D_EXACT_L));
+    if(vm_any(exact)) {
+        vr eh = r, es = g, el = bl;
+
+        vrgb2hsluv(&srgb_space, &eh, &es, &el, NULL);
+        h = vr_sel(exact, eh, h);
+        s = vr_sel(exact, es, s);
+        l = vr_sel(exact, el, l);
+    }
+
+    *a = h;
+    *b = s;
+    *c = l;
+    return 0;
+}
+
+static inline int
+vrgb2hpluv(const HsluvRgbSpace* sp, vr* a, vr* b, vr* c)
+{
+    vr l, chroma, h, s, sin_h, cos_h;
+
+    vrgb2lch(sp, *a, *b, *c, &l, &chroma, &h, &sin_h, &cos_h);
+    s = vr_mul(vr_div(chroma, vmax_safe_chroma_for_l(sp, l)), vr_set(100.0));
+    s = vr_sel(vextreme_l(l), vr_set(0.0), s);
+
+    *a = vr_clamp(h, 0.0, 360.0);
+    /* Do NOT clamp the saturation, just like rgb2hpluv(). */
+    *b = s;
+    *c = vr_clamp(l, 0.0, 100.0);
+    return vm_any(vm_or(vr_lt(s, vr_set(0.0)), vr_gt(s, vr_set(100.0)))) ? -1 : 0;
+}
+
+
+#if !SIMD_FLOAT
+/* Fused edits of RGB colors (see hsluv_rotate_hue_rgb_n() and friends). The
+ * hue comes as its sine and cosine straight from (u, v), so no atan2() nor
+ * sincos() is needed: the rotation is done by the angle addition formulas.
+ * Edits keeping the lightness reuse Y and the bounds of the input color; the
+ * bounds of the new lightness are computed once per call. */
+typedef struct VEdit_tag VEdit;
+struct VEdit_tag {
+    EditOp op;
+    vr sin_d;
+    vr cos_d;
+    vr l;
+    vr y;
+    vr factor;
+    int has_sectors;
+    VBounds bounds;
+    VSectors sectors;
+};
+
+static inline void
+vedit_init(VEdit* ve, const Edit* edit)
+{
+    ve->op = edit->op;
+    ve->sin_d = vr_set(edit->sin_d);
+    ve->cos_d = vr_set(edit->cos_d);
+    ve->l = vr_set(edit->l);
+    ve->y = vl2y(ve->l);
+    ve->factor = vr_set(edit->factor);
+    ve->has_sectors = edit->has_sectors;
+    if(edit->op == EDIT_SET_LIGHTNESS) {
+        vbounds(&srgb_space, ve->l, &ve->bounds);
+        if(edit->has_sectors)
+            vsectors_init(&ve->sectors, &edit->sectors);
+    }
+}
+
+static inline int
+vedit_rgb(vr* a, vr* b, vr* c, const VEdit* ve)
+{
+    vr zero = vr_set(0.0);
+    vr one = vr_set(1.0);
+    vr l, u, v, y, chroma, inv_c, sin_h, cos_h, max_c, s;
+    vm gray;
+    VBounds bounds;
+
+    vrgb2luv(&srgb_space, *a, *b, *c, &l, &u, &v, &y);
+    chroma = vr_sqrt(vr_fma(u, u, vr_mul(v, v)));
+    gray = vr_lt(chroma, vr_set(GRAY_C));
+    inv_c = vr_div(one, vr_sel(gray, one, chroma));
+    sin_h = vr_sel(gray, zero, vr_mul(v, inv_c));
+    cos_h = vr_sel(gray, one, vr_mul(u, inv_c));
+
+    /* The saturation, clamped as by rgb2hsluv(). */
+    vbounds(&srgb_space, l, &bounds);
+    max_c = vmax_chroma_for_bounds(&bounds, sin_h, cos_h);
+    s = vr_min(vr_div(chroma, max_c), one);
+    s = vr_sel(vm_or(gray, vextreme_l(l)), zero, s);
+
+    switch(ve->op) {
+        case EDIT_ROTATE_HUE:
+        {
+            vr sin_r = vr_fma(sin_h, ve->cos_d, vr_mul(cos_h, ve->sin_d));
+            vr cos_r = vr_sub(vr_mul(cos_h, ve->cos_d), vr_mul(sin_h, ve->sin_d));
+
+            chroma = vr_mul(vmax_chroma_for_bounds(&bounds, sin_r, cos_r), s);
+            sin_h = sin_r;
+            cos_h = cos_r;
+            break;
+        }
+
+        case EDIT_SET_LIGHTNESS:
+            if(ve->has_sectors)
+                chroma = vr_mul(vmax_chroma_for_sectors(&ve->sectors, sin_h, cos_h), s);
+            else
+                chroma = vr_mul(vmax_chroma_for_bounds(&ve->bounds, sin_h, cos_h), s);
+            l = ve->l;
+            y = ve->y;
+            break;
+
+        case EDIT_SCALE_SATURATION:
+            chroma = vr_mul(max_c, vr_clamp(vr_mul(s, ve->factor), 0.0, 1.0));
+            break;
+    }
+
+    chroma = vr_sel(vextreme_l(l), zero, chroma);
+    vlch2rgb_y(&srgb_space, l, y, chroma, sin_h, cos_h, a, b, c);
+    return 0;
+}
+#endif
+
+
+/* Drive a vxxx() call over the whole input (used as the body of the kernel
+ * functions below). Dense planes are processed directly; strided data and the
+ * trailing partial vector go through a small dense block on the stack. */
+#define SIMD_KERNEL_BODY(call)                                                  \
+    SIMD_REAL blk[3][SIMD_BLOCK];                                               \
+    size_t i = 0;                                                               \
+    size_t j, cnt;                                                              \
+    int ret = 0;                                                                \
+                                                                                \
+    if(in_stride == 1  &&  out_stride == 1) {                                   \
+        for(; i + VR_WIDTH <= n; i += VR_WIDTH) {                               \
+            vr va = vr_loadu(a + i);                                            \
+            vr vb = vr_loadu(b + i);                                            \
+            vr vc = vr_loadu(c + i);                                            \
+                                                                                \
+            if(call != 0)                                                       \
+                ret = -1;                                                       \
+            vr_storeu(x + i, va);                                               \
+            vr_storeu(y + i, vb);                                               \
+            vr_storeu(z + i, vc);                                               \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    while(i < n) {                                                              \
+        cnt = (n - i < SIMD_BLOCK) ? n - i : SIMD_BLOCK;                        \
+        for(j = 0; j < cnt; j++) {                                              \
+            blk[0][j] = a[(i + j) * in_stride];                                 \
+            blk[1][j] = b[(i + j) * in_stride];                                 \
+            blk[2][j] = c[(i + j) * in_stride];                                 \
+        }                                                                       \
+        /* Pad the last vector with harmless black. */                         \
+        for(; j % VR_WIDTH != 0; j++)                                           \
+            blk[0][j] = blk[1][j] = blk[2][j] = 0.0;                            \
+                                                                                \
+        for(j = 0; j < cnt; j += VR_WIDTH) {                                    \
+            vr va = vr_loadu(&blk[0][j]);                                       \
+            vr vb = vr_loadu(&blk[1][j]);                                       \
+            vr vc = vr_loadu(&blk[2][j]);                                       \
+                                                                                \
+            if(call != 0)                                                       \
+                ret = -1;                                                       \
+            vr_storeu(&blk[0][j], va);                                          \
+            vr_storeu(&blk[1][j], vb);                                          \
+            vr_storeu(&blk[2][j], vc);                                          \
+        }                                                                       \
+                                                                                \
+        for(j = 0; j < cnt; j++) {                                              \
+            x[(i + j) * out_stride] = blk[0][j];                                \
+            y[(i + j) * out_stride] = blk[1][j];                                \
+            z[(i + j) * out_stride] = blk[2][j];                                \
+        }                                                                       \
+        i += cnt;                                                               \
+    }                                                                           \
+                                                                                \
+    return ret;
+
+#define SIMD_DEFINE_KERNEL(fn)                                                  \
+    int                                                                         \
+    SIMD_NAME(fn)(const SIMD_REAL* a, const SIMD_REAL* b, const SIMD_REAL* c,   \
+                  size_t in_stride, SIMD_REAL* x, SIMD_REAL* y, SIMD_REAL* z,   \
+                  size_t out_stride, size_t n)                                  \
+    {                                                                           \
+        SIMD_KERNEL_BODY(v##fn(&srgb_space, &va, &vb, &vc))                     \
+    }                                                                           \
+                                                                                \
+    int                                                                         \
+    SIMD_NAME(fn##_space)(const HsluvRgbSpace* space,                           \
+                  const SIMD_REAL* a, const SIMD_REAL* b, const SIMD_REAL* c,   \
+                  size_t in_stride, SIMD_REAL* x, SIMD_REAL* y, SIMD_REAL* z,   \
+                  size_t out_stride, size_t n)                                  \
+    {                                                                           \
+        SIMD_KERNEL_BODY(v##fn(space, &va, &vb, &vc))                           \
+    }
+
+/* The same for the HSLuv kernels, which keep the run of the lightness across
+ * the vectors (see VRun). */
+#define SIMD_DEFINE_RUN_KERNEL(fn)                                              \
+    int                                                                         \
+    SIMD_NAME(fn)(const SIMD_REAL* a, const SIMD_REAL* b, const SIMD_REAL* c,   \
+                  size_t in_stride, SIMD_REAL* x, SIMD_REAL* y, SIMD_REAL* z,   \
+                  size_t out_stride, size_t n)                                  \
+    {                                                                           \
+        VRun run;                                                               \
+                                                                                \
+        vrun_init(&run);                                                        \
+        {                                                                       \
+            SIMD_KERNEL_BODY(v##fn(&srgb_space, &va, &vb, &vc, &run))           \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+    int                                                                         \
+    SIMD_NAME(fn##_space)(const HsluvRgbSpace* space,                           \
+                  const SIMD_REAL* a, const SIMD_REAL* b, const SIMD_REAL* c,   \
+                  size_t in_stride, SIMD_REAL* x, SIMD_REAL* y, SIMD_REAL* z,   \
+                  size_t out_stride, size_t n)                                  \
+    {                                                                           \
+        VRun run;                                                               \
+                                                                                \
+        vrun_init(&run);                                                        \
+        {                                                                       \
+            SIMD_KERNEL_BODY(v##fn(space, &va, &vb, &vc, &run))                 \
+        }                                                                       \
+    }
+
+SIMD_DEFINE_RUN_KERNEL(hsluv2rgb)
+SIMD_DEFINE_KERNEL(hpluv2rgb)
+SIMD_DEFINE_RUN_KERNEL(rgb2hsluv)
+SIMD_DEFINE_KERNEL(rgb2hpluv)
+
+int
+SIMD_NAME(lut3d_rgb2hsluv)(const SIMD_REAL* a, const SIMD_REAL* b, const SIMD_REAL* c,
+                           size_t in_stride, SIMD_REAL* x, SIMD_REAL* y, SIMD_REAL* z,
+                           size_t out_stride, size_t n, const Lut3d* lut)
+{
+    SIMD_KERNEL_BODY(vlut3d_rgb2hsluv(lut, &va, &vb, &vc))
+}
+
+#if !SIMD_FLOAT
+int
+SIMD_NAME(edit_rgb)(const double* a, const double* b, const double* c,
+                    size_t in_stride, double* x, double* y, double* z,
+                    size_t out_stride, size_t n, const Edit* edit)
+{
+    VEdit ve;
+
+    vedit_init(&ve, edit);
+    {
+        SIMD_KERNEL_BODY(vedit_rgb(&va, &vb, &vc, &ve))
+    }
+}
+#endif
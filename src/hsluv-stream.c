@@ -0,0 +1,374 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "hsluv-stream.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Pixels per block. The doubles of a block stay on the stack, in the L1 cache. */
+#define STREAM_BLOCK_PIXELS     256
+
+
+typedef enum ChannelType_tag {
+    CHANNEL_U8 = 0,
+    CHANNEL_U16,
+    CHANNEL_F16,
+    CHANNEL_F32
+} ChannelType;
+
+typedef struct PixelLayout_tag PixelLayout;
+struct PixelLayout_tag {
+    ChannelType type;
+    size_t channels;    /* Channels per pixel. */
+    size_t c[3];        /* Indexes of the color channels. */
+    int has_alpha;
+    size_t alpha;       /* Index of the alpha channel. */
+};
+
+static const PixelLayout pixel_layouts[] = {
+    { CHANNEL_U8,  3, { 0, 1, 2 }, 0, 0 },     /* HSLUV_PIXEL_RGB8 */
+    { CHANNEL_U8,  4, { 0, 1, 2 }, 1, 3 },     /* HSLUV_PIXEL_RGBA8 */
+    { CHANNEL_U8,  4, { 2, 1, 0 }, 1, 3 },     /* HSLUV_PIXEL_BGRA8 */
+    { CHANNEL_U16, 3, { 0, 1, 2 }, 0, 0 },     /* HSLUV_PIXEL_RGB16 */
+    { CHANNEL_U16, 4, { 0, 1, 2 }, 1, 3 },     /* HSLUV_PIXEL_RGBA16 */
+    { CHANNEL_F16, 3, { 0, 1, 2 }, 0, 0 },     /* HSLUV_PIXEL_RGB_F16 */
+    { CHANNEL_F16, 4, { 0, 1, 2 }, 1, 3 },     /* HSLUV_PIXEL_RGBA_F16 */
+    { CHANNEL_F32, 3, { 0, 1, 2 }, 0, 0 },     /* HSLUV_PIXEL_RGB_F32 */
+    { CHANNEL_F32, 4, { 0, 1, 2 }, 1, 3 }      /* HSLUV_PIXEL_RGBA_F32 */
+};
+
+/* Values of the normalized channels: RGB channels are used as they are, the
+ * hue, saturation and lightness are divided by these. */
+static const double rgb_scale[3] = { 1.0, 1.0, 1.0 };
+static const double hsl_scale[3] = { 360.0, 100.0, 100.0 };
+
+struct HsluvStream_tag {
+    HsluvSpace in_space;
+    HsluvSpace out_space;
+    const PixelLayout* in;
+    const PixelLayout* out;
+    const double* in_scale;
+    const double* out_scale;
+    int in_premultiplied;
+    int out_premultiplied;
+};
+
+
+/* IEEE 754 half-precision floats. Done with the bits, so that neither the
+ * compiler nor the CPU need to support them. */
+
+static float
+half2float(uint16_t h)
+{
+    uint32_t sign = (uint32_t) (h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    uint32_t bits;
+    float v;
+
+    if(exp == 0x1f) {
+        /* Infinity or NaN. */
+        bits = sign | 0x7f800000 | (mant << 13);
+    } else if(exp != 0) {
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    } else if(mant != 0) {
+        /* Subnormal: normalize the mantissa. */
+        exp = 113;
+        while(!(mant & 0x400)) {
+            mant <<= 1;
+            exp--;
+        }
+        bits = sign | (exp << 23) | ((mant & 0x3ff) << 13);
+    } else {
+        bits = sign;
+    }
+
+    memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+/* Rounds to nearest, ties to even. */
+static uint16_t
+float2half(float v)
+{
+    uint32_t bits;
+    uint32_t sign;
+    uint32_t abs;
+    uint32_t h;
+    uint32_t rem;
+
+    memcpy(&bits, &v, sizeof(bits));
+    sign = (bits >> 16) & 0x8000;
+    abs = bits & 0x7fffffff;
+
+    if(abs > 0x7f800000)
+        return (uint16_t) (sign | 0x7e00);                  /* NaN */
+    if(abs >= 0x477ff000)
+        return (uint16_t) (sign | 0x7c00);                  /* Infinity, or rounds to it. */
+
+    if(abs < 0x38800000) {
+        /* Below the smallest normal half: the result is subnormal (or zero),
+         * the mantissa being the value times 2^24. */
+        uint32_t shift;
+        uint32_t half_ulp;
+
+        if(abs < 0x33000000)
+            return (uint16_t) sign;
+        shift = 126 - (abs >> 23);
+        h = ((abs & 0x7fffff) | 0x800000) >> shift;
+        rem = ((abs & 0x7fffff) | 0x800000) & ((1u << shift) - 1);
+        half_ulp = 1u << (shift - 1);
+        if(rem > half_ulp  ||  (rem == half_ulp  &&  (h & 1)))
+            h++;
+        return (uint16_t) (sign | h);
+    }
+
+    /* Rebias the exponent, drop 13 bits of the mantissa. A carry from the
+     * rounding correctly propagates into the exponent. */
+    h = (abs - (112u << 23)) >> 13;
+    rem = abs & 0x1fff;
+    if(rem > 0x1000  ||  (rem == 0x1000  &&  (h & 1)))
+        h++;
+    return (uint16_t) (sign | h);
+}
+
+
+static double
+clamp01(double v)
+{
+    /* Also maps NaN to 0.0. */
+    return (v > 0.0 ? (v < 1.0 ? v : 1.0) : 0.0);
+}
+
+/* Unpack the pixels into the normalized channels and the alpha. */
+#define UNPACK_LOOP(ctype, load)                                            \
+    do {                                                                    \
+        const ctype* src = (const ctype*) in;                               \
+        for(i = 0; i < n; i++, src += lay->channels) {                      \
+            buf[3 * i]     = load(src[lay->c[0]]);                          \
+            buf[3 * i + 1] = load(src[lay->c[1]]);                          \
+            buf[3 * i + 2] = load(src[lay->c[2]]);                          \
+            alpha[i] = (lay->has_alpha ? load(src[lay->alpha]) : 1.0);      \
+        }                                                                   \
+    } while(0)
+
+#define LOAD_U8(x)      ((double) (x) * (1.0 / 255.0))
+#define LOAD_U16(x)     ((double) (x) * (1.0 / 65535.0))
+#define LOAD_F16(x)     ((double) half2float(x))
+#define LOAD_F32(x)     ((double) (x))
+
+static void
+stream_unpack(const HsluvStream* stream, const void* in, double* buf, double* alpha, size_t n)
+{
+    const PixelLayout* lay = stream->in;
+    const double* scale = stream->in_scale;
+    size_t i;
+
+    switch(lay->type) {
+        case CHANNEL_U8:    UNPACK_LOOP(unsigned char, LOAD_U8); break;
+        case CHANNEL_U16:   UNPACK_LOOP(uint16_t, LOAD_U16); break;
+        case CHANNEL_F16:   UNPACK_LOOP(uint16_t, LOAD_F16); break;
+        case CHANNEL_F32:   UNPACK_LOOP(float, LOAD_F32); break;
+    }
+
+    if(stream->in_premultiplied) {
+        for(i = 0; i < n; i++) {
+            double inv = (alpha[i] > 0.0 ? 1.0 / alpha[i] : 0.0);
+
+            buf[3 * i] *= inv;
+            buf[3 * i + 1] *= inv;
+            buf[3 * i + 2] *= inv;
+        }
+    }
+
+    if(scale != rgb_scale) {
+        for(i = 0; i < n; i++) {
+            buf[3 * i] *= scale[0];
+            buf[3 * i + 1] *= scale[1];
+            buf[3 * i + 2] *= scale[2];
+        }
+    }
+}
+
+/* Pack the normalized channels and the alpha into the pixels. The integer
+ * channels are clamped, the floating point ones are not. */
+#define PACK_LOOP(ctype, store)                                             \
+    do {                                                                    \
+        ctype* dst = (ctype*) out;                                          \
+        for(i = 0; i < n; i++, dst += lay->channels) {                      \
+            double mul = (stream->out_premultiplied ? alpha[i] : 1.0);      \
+            dst[lay->c[0]] = store(buf[3 * i] * inv_scale[0] * mul);        \
+            dst[lay->c[1]] = store(buf[3 * i + 1] * inv_scale[1] * mul);    \
+            dst[lay->c[2]] = store(buf[3 * i + 2] * inv_scale[2] * mul);    \
+            if(lay->has_alpha)                                              \
+                dst[lay->alpha] = store(alpha[i]);                          \
+        }                                                                   \
+    } while(0)
+
+#define STORE_U8(x)     ((unsigned char) (clamp01(x) * 255.0 + 0.5))
+#define STORE_U16(x)    ((uint16_t) (clamp01(x) * 65535.0 + 0.5))
+#define STORE_F16(x)    float2half((float) (x))
+#define STORE_F32(x)    ((float) (x))
+
+static void
+stream_pack(const HsluvStream* stream, const double* buf, const double* alpha, void* out, size_t n)
+{
+    const PixelLayout* lay = stream->out;
+    double inv_scale[3];
+    size_t i;
+
+    inv_scale[0] = 1.0 / stream->out_scale[0];
+    inv_scale[1] = 1.0 / stream->out_scale[1];
+    inv_scale[2] = 1.0 / stream->out_scale[2];
+
+    switch(lay->type) {
+        case CHANNEL_U8:    PACK_LOOP(unsigned char, STORE_U8); break;
+        case CHANNEL_U16:   PACK_LOOP(uint16_t, STORE_U16); break;
+        case CHANNEL_F16:   PACK_LOOP(uint16_t, STORE_F16); break;
+        case CHANNEL_F32:   PACK_LOOP(float, STORE_F32); break;
+    }
+}
+
+static int
+stream_convert_block(const HsluvStream* stream, double* buf, size_t n)
+{
+    switch(stream->in_space) {
+        case HSLUV_SPACE_RGB:
+            if(stream->out_space == HSLUV_SPACE_HSLUV)
+                rgb2hsluv_n(buf, 3, buf, 3, n);
+            else if(stream->out_space == HSLUV_SPACE_HPLUV)
+                return rgb2hpluv_n(buf, 3, buf, 3, n);
+            break;
+
+        case HSLUV_SPACE_HSLUV:
+            if(stream->out_space == HSLUV_SPACE_RGB) {
+                hsluv2rgb_n(buf, 3, buf, 3, n);
+            } else if(stream->out_space == HSLUV_SPACE_HPLUV) {
+                hsluv2lch_n(buf, 3, buf, 3, n);
+                return lch2hpluv_n(buf, 3, buf, 3, n);
+            }
+            break;
+
+        case HSLUV_SPACE_HPLUV:
+            if(stream->out_space == HSLUV_SPACE_RGB) {
+                hpluv2rgb_n(buf, 3, buf, 3, n);
+            } else if(stream->out_space == HSLUV_SPACE_HSLUV) {
+                hpluv2lch_n(buf, 3, buf, 3, n);
+                lch2hsluv_n(buf, 3, buf, 3, n);
+            }
+            break;
+    }
+
+    return 0;
+}
+
+
+static size_t
+pixel_size(const PixelLayout* lay)
+{
+    static const size_t channel_size[] = { 1, 2, 2, 4 };
+    return lay->channels * channel_size[lay->type];
+}
+
+static int
+space_valid(HsluvSpace space)
+{
+    return (space == HSLUV_SPACE_RGB  ||  space == HSLUV_SPACE_HSLUV  ||  space == HSLUV_SPACE_HPLUV);
+}
+
+HsluvStream*
+hsluv_stream_create(HsluvSpace in_space, HsluvPixelFormat in_format,
+                    HsluvSpace out_space, HsluvPixelFormat out_format,
+                    unsigned flags)
+{
+    static const size_t n_formats = sizeof(pixel_layouts) / sizeof(pixel_layouts[0]);
+    HsluvStream* stream;
+
+    if(!space_valid(in_space)  ||  !space_valid(out_space))
+        return NULL;
+    if((size_t) in_format >= n_formats  ||  (size_t) out_format >= n_formats)
+        return NULL;
+    if(flags & ~(unsigned) (HSLUV_STREAM_PREMULTIPLIED_IN | HSLUV_STREAM_PREMULTIPLIED_OUT))
+        return NULL;
+    if((flags & HSLUV_STREAM_PREMULTIPLIED_IN)  &&
+       (in_space != HSLUV_SPACE_RGB  ||  !pixel_layouts[in_format].has_alpha))
+        return NULL;
+    if((flags & HSLUV_STREAM_PREMULTIPLIED_OUT)  &&
+       (out_space != HSLUV_SPACE_RGB  ||  !pixel_layouts[out_format].has_alpha))
+        return NULL;
+
+    stream = (HsluvStream*) malloc(sizeof(HsluvStream));
+    if(stream == NULL)
+        return NULL;
+
+    stream->in_space = in_space;
+    stream->out_space = out_space;
+    stream->in = &pixel_layouts[in_format];
+    stream->out = &pixel_layouts[out_format];
+    stream->in_scale = (in_space == HSLUV_SPACE_RGB ? rgb_scale : hsl_scale);
+    stream->out_scale = (out_space == HSLUV_SPACE_RGB ? rgb_scale : hsl_scale);
+    stream->in_premultiplied = ((flags & HSLUV_STREAM_PREMULTIPLIED_IN) != 0);
+    stream->out_premultiplied = ((flags & HSLUV_STREAM_PREMULTIPLIED_OUT) != 0);
+    return stream;
+}
+
+void
+hsluv_stream_destroy(HsluvStream* stream)
+{
+    free(stream);
+}
+
+int
+hsluv_stream_convert(const HsluvStream* stream, const void* in, void* out, size_t n)
+{
+    double buf[3 * STREAM_BLOCK_PIXELS];
+    double alpha[STREAM_BLOCK_PIXELS];
+    const unsigned char* src = (const unsigned char*) in;
+    unsigned char* dst = (unsigned char*) out;
+    size_t in_size = pixel_size(stream->in);
+    size_t out_size = pixel_size(stream->out);
+    int ret = 0;
+
+    while(n > 0) {
+        size_t k = (n < STREAM_BLOCK_PIXELS ? n : STREAM_BLOCK_PIXELS);
+
+        stream_unpack(stream, src, buf, alpha, k);
+        if(stream_convert_block(stream, buf, k) != 0)
+            ret = -1;
+        stream_pack(stream, buf, alpha, dst, k);
+
+        src += k * in_size;
+        dst += k * out_size;
+        n -= k;
+    }
+
+    return ret;
+}
@@ -0,0 +1,154 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_STREAM_H
+#define HSLUV_STREAM_H
+
+#include "hsluv.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Color spaces of the pixels handled by a stream converter.
+ */
+typedef enum HsluvSpace_tag {
+    HSLUV_SPACE_RGB = 0,    /**< sRGB; channels red, green, blue. */
+    HSLUV_SPACE_HSLUV,      /**< HSLuv; channels hue, saturation, lightness. */
+    HSLUV_SPACE_HPLUV       /**< HPLuv; channels hue, saturation, lightness. */
+} HsluvSpace;
+
+/**
+ * Layouts of the pixels handled by a stream converter.
+ *
+ * The names give the order of the channels in memory for RGB pixels; HSLuv
+ * and HPLuv pixels put hue, saturation and lightness where red, green and
+ * blue are. The 16-bit formats use unsigned integers and the @c F16 formats
+ * IEEE 754 half-precision floats, both in the native byte order; the @c F32
+ * formats use floats. The pixels must be aligned for their channel type.
+ *
+ * Every channel is normalized to the range from 0.0 to 1.0, i.e. an integer
+ * channel holds the value times 255 or 65535 (rounded), and the hue, the
+ * saturation and the lightness are divided by 360, 100 and 100. The floating
+ * point formats are not clamped, so that they can also carry the HPLuv
+ * saturations above 100 (see rgb2hpluv()).
+ */
+typedef enum HsluvPixelFormat_tag {
+    HSLUV_PIXEL_RGB8 = 0,   /**< 3 bytes per pixel. */
+    HSLUV_PIXEL_RGBA8,      /**< 4 bytes per pixel. */
+    HSLUV_PIXEL_BGRA8,      /**< 4 bytes per pixel. */
+    HSLUV_PIXEL_RGB16,      /**< 3 16-bit integers per pixel. */
+    HSLUV_PIXEL_RGBA16,     /**< 4 16-bit integers per pixel. */
+    HSLUV_PIXEL_RGB_F16,    /**< 3 half floats per pixel. */
+    HSLUV_PIXEL_RGBA_F16,   /**< 4 half floats per pixel. */
+    HSLUV_PIXEL_RGB_F32,    /**< 3 floats per pixel. */
+    HSLUV_PIXEL_RGBA_F32    /**< 4 floats per pixel. */
+} HsluvPixelFormat;
+
+/**
+ * Flags of hsluv_stream_create().
+ *
+ * RGB pixels with alpha may have their color channels premultiplied by the
+ * alpha: the source ones are then divided by it before the conversion (a
+ * fully transparent pixel becomes black), and the destination ones are
+ * multiplied by it after. The flags are only allowed on the RGB side of the
+ * conversion, with a format having alpha.
+ */
+#define HSLUV_STREAM_PREMULTIPLIED_IN       0x0001
+#define HSLUV_STREAM_PREMULTIPLIED_OUT      0x0002
+
+/**
+ * Stream converter.
+ *
+ * The converter is set up once for the given color spaces and formats of
+ * the source and destination pixels, and then fed the pixels in chunks of
+ * any size with hsluv_stream_convert(). Each chunk is unpacked, converted and
+ * repacked in a single pass: it is processed in blocks of 256 pixels, which
+ * only go through a small buffer on the stack, so the pixels make a single
+ * trip through the memory instead of one per unpacking, conversion and
+ * packing pass.
+ *
+ * The alpha passes through; it becomes 1.0 (opaque) when the source format
+ * has none, and it is dropped when the destination format has none.
+ *
+ * The conversions use the batched functions of hsluv.h, so the same kernel
+ * (see hsluv_set_kernel()) and the same global settings apply. Conversions
+ * between HSLuv and HPLuv go through LCh (see hsluv2lch_n()), and those with
+ * the same space on both sides only repack the pixels.
+ *
+ * The converter keeps no state between the chunks, so the same one may be
+ * used by multiple threads at the same time.
+ */
+typedef struct HsluvStream_tag HsluvStream;
+
+/**
+ * Create a stream converter.
+ *
+ * @param in_space Color space of the source pixels.
+ * @param in_format Format of the source pixels.
+ * @param out_space Color space of the destination pixels.
+ * @param out_format Format of the destination pixels.
+ * @param flags Bitmask of @c HSLUV_STREAM_xxx flags.
+ * @return The converter, or NULL if the arguments are invalid or out of
+ * memory.
+ */
+HsluvStream* hsluv_stream_create(HsluvSpace in_space, HsluvPixelFormat in_format,
+                                 HsluvSpace out_space, HsluvPixelFormat out_format,
+                                 unsigned flags);
+
+/**
+ * Destroy a stream converter.
+ *
+ * @param stream The converter. May be NULL.
+ */
+void hsluv_stream_destroy(HsluvStream* stream);
+
+/**
+ * Convert a chunk of pixels.
+ *
+ * @param stream The converter.
+ * @param in The @c n source pixels, tightly packed.
+ * @param out Where to store the @c n destination pixels, tightly packed. It
+ * must not overlap with @c in, unless both start at the same address and the
+ * source pixels are no smaller than the destination ones.
+ * @param n Number of the pixels.
+ * @return 0 if all the pixels are representable in the destination color
+ * space, -1 otherwise (as rgb2hpluv() does for the conversions to HPLuv).
+ */
+int hsluv_stream_convert(const HsluvStream* stream, const void* in, void* out, size_t n);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HSLUV_STREAM_H */
@@ -27,79 +27,225 @@
  */
 
 #include "hsluv.h"
+#include "hsluv-internal.h"
+#include "hsluv-rgb8-tables.h"
 
 #include <float.h>
 #include <math.h>
+#include <string.h>
 
 
 #define CLAMP(val, min_val, max_val)        \
     ((val) < (min_val) ? (min_val) : ((val) > (max_val) ? (max_val) : (val)))
 
 
-typedef struct Triplet_tag Triplet;
-struct Triplet_tag {
-    double a;
-    double b;
-    double c;
-};
+/* Profiling counters (see hsluv_stats_get()). Without HSLUV_STATS, all the
+ * STATS_xxx() macros expand to nothing. */
+#ifdef HSLUV_STATS
+    #if defined _MSC_VER
+        #include <intrin.h>
+    #elif defined __x86_64__  ||  defined __i386__
+        #include <x86intrin.h>
+    #endif
 
-/* for RGB */
-static const Triplet m[3] = {
-    {  3.24096994190452134377, -1.53738317757009345794, -0.49861076029300328366 },
-    { -0.96924363628087982613,  1.87596750150772066772,  0.04155505740717561247 },
-    {  0.05563007969699360846, -0.20397695888897656435,  1.05697151424287856072 }
-};
+static HsluvStats stats;
 
-/* for XYZ */
-static const Triplet m_inv[3] = {
-    {  0.41239079926595948129,  0.35758433938387796373,  0.18048078840183428751 },
-    {  0.21263900587151035754,  0.71516867876775592746,  0.07219231536073371500 },
-    {  0.01933081871559185069,  0.11919477979462598791,  0.95053215224966058086 }
-};
+static void
+stats_add(uint64_t* counter, uint64_t value)
+{
+#if defined __GNUC__  ||  defined __clang__
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+#elif defined _MSC_VER  &&  (defined _M_X64  ||  defined _M_ARM64)
+    _InterlockedExchangeAdd64((volatile __int64*) counter, (__int64) value);
+#else
+    *counter += value;
+#endif
+}
+
+static uint64_t
+stats_ticks(void)
+{
+#if defined _MSC_VER  &&  (defined _M_X64  ||  defined _M_IX86)
+    return __rdtsc();
+#elif defined __x86_64__  ||  defined __i386__
+    return __rdtsc();
+#elif defined __aarch64__
+    uint64_t ticks;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r" (ticks));
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+    #define STATS_BEGIN(stage)                                                \
+        uint64_t stats_t0_##stage = stats_ticks()
+    #define STATS_END(stage)                                                  \
+        do {                                                                  \
+            stats_add(&stats.stage_ticks[stage], stats_ticks() - stats_t0_##stage); \
+            stats_add(&stats.stage_calls[stage], 1);                          \
+        } while(0)
+    #define STATS_EVENT(event)          stats_add(&stats.events[event], 1)
+    #define STATS_KERNEL(id, n)                                               \
+        do {                                                                  \
+            stats_add(&stats.kernel_calls[id], 1);                            \
+            stats_add(&stats.kernel_colors[id], (n));                         \
+        } while(0)
+#else
+    #define STATS_BEGIN(stage)          do { } while(0)
+    #define STATS_END(stage)            do { } while(0)
+    #define STATS_EVENT(event)          do { } while(0)
+    #define STATS_KERNEL(id, n)         do { } while(0)
+#endif
+
+/* Disambiguation of white and black, counted. */
+#define STATS_EXTREME_L(l)                                                    \
+    STATS_EVENT((l) > 50.0 ? HSLUV_STATS_WHITE : HSLUV_STATS_BLACK)
+
+int
+hsluv_stats_enabled(void)
+{
+#ifdef HSLUV_STATS
+    return 1;
+#else
+    return 0;
+#endif
+}
 
-static const double ref_u = 0.19783000664283680764;
-static const double ref_v = 0.46831999493879100370;
+void
+hsluv_stats_get(HsluvStats* out)
+{
+#ifdef HSLUV_STATS
+    *out = *(volatile HsluvStats*) &stats;
+#else
+    memset(out, 0, sizeof(HsluvStats));
+#endif
+}
 
-static const double kappa = 903.29629629629629629630;
-static const double epsilon = 0.00885645167903563082;
+void
+hsluv_stats_reset(void)
+{
+#ifdef HSLUV_STATS
+    memset((void*) &stats, 0, sizeof(stats));
+#endif
+}
 
 
-typedef struct Bounds_tag Bounds;
-struct Bounds_tag {
-    double a;
-    double b;
+/* Sine and cosine of a hue. They are computed just once per color and serve
+ * both for the bounds (see max_chroma_for_bounds()) and for the conversion
+ * between LCh and Luv. (In the RGB -> HSLuv direction, they come for free as
+ * v / c and u / c; see luv2lch().) */
+typedef struct HueSinCos_tag HueSinCos;
+struct HueSinCos_tag {
+    double sin;
+    double cos;
 };
 
+static const HueSinCos hue_zero = { 0.0, 1.0 };
+
+
+/* Polynomial approximations for hsluv2rgb_fast() and friends. The coefficients are
+ * the single precision minimax ones of the Cephes library, for sin and cos on
+ * [-pi/4, pi/4] and for atan on [0, tan(pi/8)]. Evaluated in double precision,
+ * their absolute error is below 3e-9 (sin, cos) and 1e-8 radians (atan). */
+
+static void
+fast_sincos(double h, HueSinCos* out)
+{
+    /* Reduce to the nearest multiple of 90 degrees. */
+    double q = floor(h / 90.0 + 0.5);
+    double x = (h - 90.0 * q) * 0.01745329251994329577;  /* (pi / 180.0) */
+    double x2 = x * x;
+    double sx = x + x * x2 * ((-1.9515295891e-4 * x2 + 8.3321608736e-3) * x2 - 1.6666654611e-1);
+    double cx = 1.0 - 0.5 * x2 + x2 * x2 * ((2.443315711809948e-5 * x2 - 1.388731625493765e-3) * x2
+                                            + 4.166664568298827e-2);
+
+    switch((int) (q - 4.0 * floor(q / 4.0))) {
+        case 0:     out->sin = sx;  out->cos = cx;  break;
+        case 1:     out->sin = cx;  out->cos = -sx; break;
+        case 2:     out->sin = -sx; out->cos = -cx; break;
+        default:    out->sin = -cx; out->cos = sx;  break;
+    }
+}
+
+/* atan2(v, u) in degrees, in the range [0.0, 360.0). */
+static double
+fast_atan2(double v, double u)
+{
+    double au = fabs(u);
+    double av = fabs(v);
+    int swapped = (av > au);
+    double t = (swapped ? au / av : av / au);
+    double a = 0.0;
+    double t2;
+
+    /* Reduce to [0, tan(pi/8)] with atan(t) = pi/4 + atan((t - 1) / (t + 1)). */
+    if(t > 0.4142135623730950488) {
+        t = (t - 1.0) / (t + 1.0);
+        a = 45.0;
+    }
+    t2 = t * t;
+    a += 57.29577951308232087680 * (t + t * t2 * (((8.05374449538e-2 * t2 - 1.38776856032e-1) * t2
+                                                   + 1.99777106478e-1) * t2 - 3.33329491539e-1));
+
+    if(swapped)
+        a = 90.0 - a;
+    if(u < 0.0)
+        a = 180.0 - a;
+    if(v < 0.0)
+        a = 360.0 - a;
+    return (a >= 360.0 ? a - 360.0 : a);
+}
+
+static void
+hue_sincos(double h, int fast_trig, HueSinCos* out)
+{
+    STATS_BEGIN(HSLUV_STATS_TRIG);
+
+    if(fast_trig) {
+        fast_sincos(h, out);
+    } else {
+        double hrad = h * 0.01745329251994329577;  /* (pi / 180.0) */
+        out->sin = sin(hrad);
+        out->cos = cos(hrad);
+    }
+
+    STATS_END(HSLUV_STATS_TRIG);
+}
+
 
+/* The RGB gamut, cut at some lightness, is a polygon in the (u, v) plane of
+ * CIELUV. Its edges lie on six lines, v = a[i] * u + b[i]; see HsluvBounds.
+ * Only sub2 (the Y of the lightness) and l vary: all the rest comes
+ * precomputed per line from the space (see hsluv_rgb_space_init()), so this
+ * is one uniform loop over the six lines the compiler can vectorize. */
 static void
-get_bounds(double l, Bounds bounds[6])
+get_bounds(const HsluvRgbSpace* sp, double l, HsluvBounds* bounds)
 {
     double tl = l + 16.0;
     double sub1 = (tl * tl * tl) / 1560896.0;
     double sub2 = (sub1 > epsilon ? sub1 : (l / kappa));
-    int channel;
-    int t;
+    int i;
+    STATS_BEGIN(HSLUV_STATS_GET_BOUNDS);
 
-    for(channel = 0; channel < 3; channel++) {
-        double m1 = m[channel].a;
-        double m2 = m[channel].b;
-        double m3 = m[channel].c;
+    bounds->l = l;
 
-        for (t = 0; t < 2; t++) {
-            double top1 = (284517.0 * m1 - 94839.0 * m3) * sub2;
-            double top2 = (838422.0 * m3 + 769860.0 * m2 + 731718.0 * m1) * l * sub2 -  769860.0 * t * l;
-            double bottom = (632260.0 * m3 - 126452.0 * m2) * sub2 + 126452.0 * t;
+    for(i = 0; i < 6; i++) {
+        double top1 = sp->bounds_top1[i] * sub2;
+        double top2 = sp->bounds_top2[i] * l * sub2 - sp->bounds_top2_l[i] * l;
+        double bottom = sp->bounds_bottom[i] * sub2 + sp->bounds_bottom_c[i];
 
-            bounds[channel * 2 + t].a = top1 / bottom;
-            bounds[channel * 2 + t].b = top2 / bottom;
-        }
+        bounds->a[i] = top1 / bottom;
+        bounds->b[i] = top2 / bottom;
     }
+
+    STATS_END(HSLUV_STATS_GET_BOUNDS);
 }
 
 static double
-intersect_line_line(const Bounds* line1, const Bounds* line2)
+intersect_line_line(double a1, double b1, double a2, double b2)
 {
-    return (line1->b - line2->b) / (line2->a - line1->a);
+    return (b1 - b2) / (a2 - a1);
 }
 
 static double
@@ -109,26 +255,28 @@ dist_from_pole_squared(double x, double y)
 }
 
 static double
-ray_length_until_intersect(double theta, const Bounds* line)
+ray_length_until_intersect(const HueSinCos* theta, double a, double b)
+{
+    return b / (theta->sin - a * theta->cos);
+}
+
+static double
+line_dist_from_pole_squared(double m1, double b1)
 {
-    return line->b / (sin(theta) - line->a * cos(theta));
+    /* x where line intersects with perpendicular running though (0, 0) */
+    double x = intersect_line_line(m1, b1, -1.0 / m1, 0.0);
+
+    return dist_from_pole_squared(x, b1 + x * m1);
 }
 
 static double
-max_safe_chroma_for_l(double l)
+max_safe_chroma_for_bounds(const HsluvBounds* bounds)
 {
     double min_len_squared = DBL_MAX;
-    Bounds bounds[6];
     int i;
 
-    get_bounds(l, bounds);
     for(i = 0; i < 6; i++) {
-        double m1 = bounds[i].a;
-        double b1 = bounds[i].b;
-        /* x where line intersects with perpendicular running though (0, 0) */
-        Bounds line2 = { -1.0 / m1, 0.0 };
-        double x = intersect_line_line(&bounds[i], &line2);
-        double distance = dist_from_pole_squared(x, b1 + x * m1);
+        double distance = line_dist_from_pole_squared(bounds->a[i], bounds->b[i]);
 
         if(distance < min_len_squared)
             min_len_squared = distance;
@@ -138,16 +286,13 @@ max_safe_chroma_for_l(double l)
 }
 
 static double
-max_chroma_for_lh(double l, double h)
+max_chroma_for_bounds(const HsluvBounds* bounds, const HueSinCos* hue)
 {
     double min_len = DBL_MAX;
-    double hrad = h * 0.01745329251994329577; /* (2 * pi / 360) */
-    Bounds bounds[6];
     int i;
 
-    get_bounds(l, bounds);
     for(i = 0; i < 6; i++) {
-        double len = ray_length_until_intersect(hrad, &bounds[i]);
+        double len = ray_length_until_intersect(hue, bounds->a[i], bounds->b[i]);
 
         if(len >= 0  &&  len < min_len)
             min_len = len;
@@ -155,54 +300,420 @@ max_chroma_for_lh(double l, double h)
     return min_len;
 }
 
+
+/* Hue sectors of the gamut polygon (see HueSectors in hsluv-internal.h).
+ *
+ * max_chroma_for_bounds() tries all six lines, i.e. six divisions and six
+ * data-dependent branches per color. But which of the lines is the nearest
+ * one is a piecewise constant function of the hue: the polygon has at most
+ * six edges, and the nearest line changes only at its vertices. Once the
+ * vertices of one lightness are known, the maximal chroma of any hue is one
+ * branchless sector selection and a single division.
+ *
+ * Building the sectors costs about as much as a few dozen
+ * max_chroma_for_bounds() calls, so they pay off only for many colors of one
+ * lightness: long runs in the batched functions (see sectors_for_run(), and
+ * vrun_sectors() of the vector kernels), hue sweeps, and the fused edit
+ * setting the lightness. */
+
+/* Tolerance of the line-point incidence, relative to the magnitude of the
+ * terms. */
+#define SECTOR_EPS          1e-9
+
+/* Pseudo-angle of (u, v): monotonic with atan2(v, u) over [0, 4), and
+ * much cheaper. Used just to sort the vertices. */
+static double
+pseudo_angle(double u, double v)
+{
+    double p = u / (fabs(u) + fabs(v));
+
+    return (v >= 0.0 ? 1.0 - p : 3.0 + p);
+}
+
+/* Bit mask of the lines passing through (u, v), or 0 if the point lies
+ * beyond any of them (on the other side than the pole, where the line
+ * function is -b). Most of the candidate vertices fail early. */
+static unsigned
+lines_through(const HsluvBounds* bounds, double u, double v)
+{
+    unsigned mask = 0;
+    int i;
+
+    for(i = 0; i < 6; i++) {
+        double a = bounds->a[i];
+        double b = bounds->b[i];
+        double f = v - a * u - b;
+        double tol = SECTOR_EPS * (fabs(v) + fabs(a * u) + fabs(b));
+
+        if(fabs(f) <= tol)
+            mask |= 1u << i;
+        else if((f > 0.0) != (b < 0.0))
+            return 0;
+    }
+
+    return mask;
+}
+
+/* Returns 0 on success, or -1 if the polygon is too degenerate to be
+ * resolved reliably (only ever near black and white); max_chroma_for_bounds()
+ * is then to be used instead. */
+static int
+hue_sectors_init(const HsluvBounds* bounds, HueSectors* sectors)
+{
+    double pu[15], pv[15];
+    double vu[15], vv[15], va[15];
+    unsigned vmask[15];
+    int n = 0;
+    int i, j, k, p;
+
+    /* Vertices: the intersections of the lines which are not cut off by
+     * any other line. All the intersections are computed first, so that
+     * the divisions do not wait for each other. (Parallel lines give
+     * infinities or NaNs, which lines_through() rejects.) */
+    for(i = 0, p = 0; i < 6; i++) {
+        for(j = i + 1; j < 6; j++, p++) {
+            pu[p] = intersect_line_line(bounds->a[i], bounds->b[i], bounds->a[j], bounds->b[j]);
+            pv[p] = bounds->a[i] * pu[p] + bounds->b[i];
+        }
+    }
+
+    for(i = 0, p = 0; i < 6; i++) {
+        for(j = i + 1; j < 6; j++, p++) {
+            double u = pu[p];
+            double v = pv[p];
+            double pa;
+            unsigned mask;
+
+            mask = lines_through(bounds, u, v);
+            if(mask == 0)
+                continue;
+            mask |= (1u << i) | (1u << j);
+
+            /* Three or more concurrent lines give the vertex repeatedly. */
+            for(k = 0; k < n; k++) {
+                if(fabs(vu[k] - u) + fabs(vv[k] - v) <= SECTOR_EPS * (fabs(u) + fabs(v)))
+                    break;
+            }
+            if(k < n) {
+                vmask[k] |= mask;
+                continue;
+            }
+
+            /* Insert sorted counterclockwise. */
+            pa = pseudo_angle(u, v);
+            for(k = n; k > 0  &&  va[k - 1] > pa; k--) {
+                vu[k] = vu[k - 1];
+                vv[k] = vv[k - 1];
+                va[k] = va[k - 1];
+                vmask[k] = vmask[k - 1];
+            }
+            vu[k] = u;
+            vv[k] = v;
+            va[k] = pa;
+            vmask[k] = mask;
+            n++;
+        }
+    }
+
+    if(n < 3  ||  n > 6)
+        return -1;
+
+    /* The edge between two consecutive vertices lies on their common line.
+     * The vertex list is padded by repeating its last vertex (giving sectors
+     * of zero width which never match), so the closing edge always ends up
+     * at index 5. */
+    for(k = 0; k < 6; k++) {
+        int v0 = (k < n ? k : n - 1);
+        unsigned common = (k < n - 1 ? vmask[k] & vmask[k + 1] : vmask[n - 1] & vmask[0]);
+        int line;
+
+        if(common == 0)
+            return -1;
+        for(line = 0; !(common & (1u << line)); line++)
+            ;
+
+        sectors->u[k] = vu[v0];
+        sectors->v[k] = vv[v0];
+        sectors->a[k] = bounds->a[line];
+        sectors->b[k] = bounds->b[line];
+    }
+
+    return 0;
+}
+
+/* The hue lies in sector i iff its direction is counterclockwise of the
+ * vertex i and clockwise of the vertex i + 1. Every sector spans less than
+ * 180 degrees (the pole is inside the polygon), so the two sign tests of the
+ * cross products decide it. The line is selected, not branched to; the
+ * closing sector 5 is taken when no other matches, and the padded sectors of
+ * zero width never do. */
+static double
+max_chroma_for_sectors(const HueSectors* sectors, const HueSinCos* hue)
+{
+    int ccw[6];
+    int k = 5;
+    int i;
+
+    for(i = 0; i < 6; i++)
+        ccw[i] = (sectors->u[i] * hue->sin - sectors->v[i] * hue->cos >= 0.0);
+
+    for(i = 0; i < 5; i++)
+        k = ((ccw[i] & !ccw[i + 1]) ? i : k);
+
+    return ray_length_until_intersect(hue, sectors->a[k], sectors->b[k]);
+}
+
+static double
+max_chroma(const HsluvBounds* bounds, const HueSectors* sectors, const HueSinCos* hue)
+{
+    if(sectors != NULL)
+        return max_chroma_for_sectors(sectors, hue);
+    return max_chroma_for_bounds(bounds, hue);
+}
+
+
+/* Lookup table for max_safe_chroma_for_bounds() (see HsluvHpluvLut).
+ *
+ * The maximal safe chroma is the distance of the nearest of the six bounding
+ * lines from the pole. Each of the distances is a smooth function of the
+ * lightness, but their minimum is not (the nearest line changes at L ~ 76.05),
+ * so the table holds the six distances separately and the minimum is taken
+ * only after the interpolation.
+ *
+ * The samples are uniformly spaced over the lightness range [0, 100], and
+ * there is one extra sample on each end, extrapolated from the first and last
+ * three, so that the cubic interpolation needs no special cases. */
+void
+hsluv_hpluv_lut_init(HsluvHpluvLut* lut)
+{
+    double (*hpluv_lut)[6] = lut->samples;
+    int i, j;
+
+    /* All the distances are zero for black. */
+    for(j = 0; j < 6; j++)
+        hpluv_lut[1][j] = 0.0;
+
+    for(i = 1; i < HSLUV_HPLUV_LUT_SIZE; i++) {
+        HsluvBounds bounds;
+
+        get_bounds(&srgb_space, 100.0 * i / (HSLUV_HPLUV_LUT_SIZE - 1), &bounds);
+        for(j = 0; j < 6; j++)
+            hpluv_lut[i + 1][j] = sqrt(line_dist_from_pole_squared(bounds.a[j], bounds.b[j]));
+    }
+
+    for(j = 0; j < 6; j++) {
+        hpluv_lut[0][j] = 3.0 * hpluv_lut[1][j] - 3.0 * hpluv_lut[2][j] + hpluv_lut[3][j];
+        hpluv_lut[HSLUV_HPLUV_LUT_SIZE + 1][j] = 3.0 * hpluv_lut[HSLUV_HPLUV_LUT_SIZE][j]
+                    - 3.0 * hpluv_lut[HSLUV_HPLUV_LUT_SIZE - 1][j] + hpluv_lut[HSLUV_HPLUV_LUT_SIZE - 2][j];
+    }
+}
+
+static double
+max_safe_chroma_from_lut(const HsluvHpluvLut* lut, double l)
+{
+    const double (*hpluv_lut)[6] = lut->samples;
+    double min_len = DBL_MAX;
+    double pos = l * ((HSLUV_HPLUV_LUT_SIZE - 1) / 100.0);
+    int i = (int) pos;
+    double t;
+    int j;
+
+    if(i < 0)
+        i = 0;
+    else if(i > HSLUV_HPLUV_LUT_SIZE - 2)
+        i = HSLUV_HPLUV_LUT_SIZE - 2;
+    t = pos - i;
+
+    /* Catmull-Rom spline through the samples around the lightness. */
+    for(j = 0; j < 6; j++) {
+        double p0 = hpluv_lut[i][j];
+        double p1 = hpluv_lut[i + 1][j];
+        double p2 = hpluv_lut[i + 2][j];
+        double p3 = hpluv_lut[i + 3][j];
+        double len = p1 + 0.5 * t * (p2 - p0 + t * (2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3
+                                                    + t * (3.0 * (p1 - p2) + p3 - p0)));
+
+        if(len < min_len)
+            min_len = len;
+    }
+
+    return min_len;
+}
+
+
+/* Bounds of the lightness seen last. Computing them is the most expensive part
+ * of the HSLuv/HPLuv <-> LCh conversion, and the batched functions often get
+ * runs of colors of the same lightness (gradients, palettes, tints of one
+ * color, ...), so the scalar kernels keep the bounds for as long as the
+ * lightness stays the same. The maximal safe chroma (needed only by HPLuv) is
+ * computed lazily, and so are the hue sectors once the run is long enough
+ * (see sectors_for_run()).
+ *
+ * The cache also carries the RGB space to the whole pipeline of the
+ * conversion; see hsluv_rgb_space_init(). */
+typedef struct BoundsCache_tag BoundsCache;
+struct BoundsCache_tag {
+    const HsluvRgbSpace* space;
+    HsluvBounds bounds;
+    int has_bounds;
+    int has_safe_chroma;
+    int sectors_state;      /* 0: not built (yet), 1: valid, -1: degenerate. */
+    unsigned run;           /* Number of hits of the bounds in a row. */
+    HueSectors sectors;
+    int fast_trig;          /* Non-zero for hsluv2rgb_fast() and friends. */
+    const HsluvHpluvLut* hpluv_lut; /* For hpluv2rgb_lut() and rgb2hpluv_lut(). */
+};
+
+static void
+bounds_cache_init(BoundsCache* cache, const HsluvRgbSpace* space)
+{
+    cache->space = space;
+    cache->has_bounds = 0;
+    cache->has_safe_chroma = 0;
+    cache->sectors_state = 0;
+    cache->run = 0;
+    cache->fast_trig = 0;
+    cache->hpluv_lut = NULL;
+}
+
+/* Returns NULL for white and black: these need no bounds (see hsluv2lch_stage()). */
+static const HsluvBounds*
+bounds_for_l(BoundsCache* cache, double l)
+{
+    if(l > 99.9999999 || l < 0.00000001)
+        return NULL;
+
+    if(!cache->has_bounds  ||  cache->bounds.l != l) {
+        get_bounds(cache->space, l, &cache->bounds);
+        cache->has_bounds = 1;
+        cache->has_safe_chroma = 0;
+        cache->sectors_state = 0;
+        cache->run = 0;
+    } else {
+        cache->run++;
+    }
+
+    return &cache->bounds;
+}
+
+/* The hue sectors of the bounds returned by the last bounds_for_l(), or NULL
+ * if max_chroma_for_bounds() is to be used. */
+static const HueSectors*
+sectors_for_run(BoundsCache* cache)
+{
+    if(cache->run < HSLUV_SECTORS_MIN_RUN)
+        return NULL;
+
+    if(cache->sectors_state == 0)
+        cache->sectors_state = (hue_sectors_init(&cache->bounds, &cache->sectors) == 0 ? 1 : -1);
+
+    return (cache->sectors_state > 0 ? &cache->sectors : NULL);
+}
+
+static const HsluvBounds*
+safe_bounds_for_l(BoundsCache* cache, double l)
+{
+    /* The table is for sRGB. */
+    if(cache->hpluv_lut != NULL  &&  cache->space == &srgb_space) {
+        if(l > 99.9999999 || l < 0.00000001)
+            return NULL;
+
+        /* Only the lightness and the maximal safe chroma are valid then. */
+        cache->bounds.l = l;
+        cache->bounds.max_safe_chroma = max_safe_chroma_from_lut(cache->hpluv_lut, l);
+        cache->has_bounds = 0;
+        cache->has_safe_chroma = 0;
+        return &cache->bounds;
+    }
+
+    if(bounds_for_l(cache, l) == NULL)
+        return NULL;
+
+    if(!cache->has_safe_chroma) {
+        cache->bounds.max_safe_chroma = max_safe_chroma_for_bounds(&cache->bounds);
+        cache->has_safe_chroma = 1;
+    }
+
+    return &cache->bounds;
+}
+
 static double
-dot_product(const Triplet* t1, const Triplet* t2)
+dot_product(const double* row, const Triplet* t)
 {
-    return (t1->a * t2->a + t1->b * t2->b + t1->c * t2->c);
+    return (row[0] * t->a + row[1] * t->b + row[2] * t->c);
 }
 
 /* Used for rgb conversions */
 static double
-from_linear(double c)
+from_linear(const HsluvRgbSpace* sp, double c)
 {
-    if(c <= 0.0031308)
-        return 12.92 * c;
+    double ret;
+    STATS_BEGIN(HSLUV_STATS_FROM_LINEAR);
+
+    if(c <= sp->tf_cut)
+        ret = sp->tf_slope * c;
     else
-        return 1.055 * pow(c, 1.0 / 2.4) - 0.055;
+        ret = sp->tf_scale * pow(c, 1.0 / sp->tf_gamma) - sp->tf_offset;
+
+    STATS_END(HSLUV_STATS_FROM_LINEAR);
+    return ret;
 }
 
 static double
-to_linear(double c)
+to_linear(const HsluvRgbSpace* sp, double c)
 {
-    if (c > 0.04045)
-        return pow((c + 0.055) / 1.055, 2.4);
+    double ret;
+    STATS_BEGIN(HSLUV_STATS_TO_LINEAR);
+
+    if (c > sp->tf_cut_encoded)
+        ret = pow((c + sp->tf_offset) / sp->tf_scale, sp->tf_gamma);
     else
-        return c / 12.92;
+        ret = c / sp->tf_slope;
+
+    STATS_END(HSLUV_STATS_TO_LINEAR);
+    return ret;
 }
 
 static void
-xyz2rgb(Triplet* in_out)
+xyz2linear(const HsluvRgbSpace* sp, Triplet* in_out)
 {
-    double r = from_linear(dot_product(&m[0], in_out));
-    double g = from_linear(dot_product(&m[1], in_out));
-    double b = from_linear(dot_product(&m[2], in_out));
+    double r = dot_product(sp->m[0], in_out);
+    double g = dot_product(sp->m[1], in_out);
+    double b = dot_product(sp->m[2], in_out);
     in_out->a = r;
     in_out->b = g;
     in_out->c = b;
 }
 
 static void
-rgb2xyz(Triplet* in_out)
+linear2xyz(const HsluvRgbSpace* sp, Triplet* in_out)
 {
-    Triplet rgbl = { to_linear(in_out->a), to_linear(in_out->b), to_linear(in_out->c) };
-    double x = dot_product(&m_inv[0], &rgbl);
-    double y = dot_product(&m_inv[1], &rgbl);
-    double z = dot_product(&m_inv[2], &rgbl);
+    double x = dot_product(sp->m_inv[0], in_out);
+    double y = dot_product(sp->m_inv[1], in_out);
+    double z = dot_product(sp->m_inv[2], in_out);
     in_out->a = x;
     in_out->b = y;
     in_out->c = z;
 }
 
+static void
+xyz2rgb(const HsluvRgbSpace* sp, Triplet* in_out)
+{
+    xyz2linear(sp, in_out);
+    in_out->a = from_linear(sp, in_out->a);
+    in_out->b = from_linear(sp, in_out->b);
+    in_out->c = from_linear(sp, in_out->c);
+}
+
+static void
+rgb2xyz(const HsluvRgbSpace* sp, Triplet* in_out)
+{
+    in_out->a = to_linear(sp, in_out->a);
+    in_out->b = to_linear(sp, in_out->b);
+    in_out->c = to_linear(sp, in_out->c);
+    linear2xyz(sp, in_out);
+}
+
 /* https://en.wikipedia.org/wiki/CIELUV
  * In these formulas, Yn refers to the reference white point. We are using
  * illuminant D65, so Yn (see refY in Maxima file) equals 1. The formula is
@@ -229,13 +740,13 @@ l2y(double l)
 }
 
 static void
-xyz2luv(Triplet* in_out)
+xyz2luv(const HsluvRgbSpace* sp, Triplet* in_out)
 {
     double var_u = (4.0 * in_out->a) / (in_out->a + (15.0 * in_out->b) + (3.0 * in_out->c));
     double var_v = (9.0 * in_out->b) / (in_out->a + (15.0 * in_out->b) + (3.0 * in_out->c));
     double l = y2l(in_out->b);
-    double u = 13.0 * l * (var_u - ref_u);
-    double v = 13.0 * l * (var_v - ref_v);
+    double u = 13.0 * l * (var_u - sp->ref_u);
+    double v = 13.0 * l * (var_v - sp->ref_v);
 
     in_out->a = l;
     if(l < 0.00000001) {
@@ -247,8 +758,9 @@ xyz2luv(Triplet* in_out)
     }
 }
 
+/* luv2xyz() with y = l2y(l) passed by the caller. */
 static void
-luv2xyz(Triplet* in_out)
+luv2xyz_y(const HsluvRgbSpace* sp, Triplet* in_out, double y)
 {
     if(in_out->a <= 0.00000001) {
         /* Black will create a divide-by-zero error. */
@@ -258,9 +770,8 @@ luv2xyz(Triplet* in_out)
         return;
     }
 
-    double var_u = in_out->b / (13.0 * in_out->a) + ref_u;
-    double var_v = in_out->c / (13.0 * in_out->a) + ref_v;
-    double y = l2y(in_out->a);
+    double var_u = in_out->b / (13.0 * in_out->a) + sp->ref_u;
+    double var_v = in_out->c / (13.0 * in_out->a) + sp->ref_v;
     double x = -(9.0 * y * var_u) / ((var_u - 4.0) * var_v - var_u * var_v);
     double z = (9.0 * y - (15.0 * var_v * y) - (var_v * x)) / (3.0 * var_v);
     in_out->a = x;
@@ -269,7 +780,13 @@ luv2xyz(Triplet* in_out)
 }
 
 static void
-luv2lch(Triplet* in_out)
+luv2xyz(const HsluvRgbSpace* sp, Triplet* in_out)
+{
+    luv2xyz_y(sp, in_out, l2y(in_out->a));
+}
+
+static void
+luv2lch(Triplet* in_out, int fast_trig, HueSinCos* hue)
 {
     double l = in_out->a;
     double u = in_out->b;
@@ -280,10 +797,19 @@ luv2lch(Triplet* in_out)
     /* Grays: disambiguate hue */
     if(c < 0.00000001) {
         h = 0;
+        *hue = hue_zero;
     } else {
-        h = atan2(v, u) * 57.29577951308232087680;  /* (180 / pi) */
-        if(h < 0.0)
-            h += 360.0;
+        STATS_BEGIN(HSLUV_STATS_TRIG);
+        if(fast_trig) {
+            h = fast_atan2(v, u);
+        } else {
+            h = atan2(v, u) * 57.29577951308232087680;  /* (180 / pi) */
+            if(h < 0.0)
+                h += 360.0;
+        }
+        STATS_END(HSLUV_STATS_TRIG);
+        hue->sin = v / c;
+        hue->cos = u / c;
     }
 
     in_out->a = l;
@@ -292,33 +818,40 @@ luv2lch(Triplet* in_out)
 }
 
 static void
-lch2luv(Triplet* in_out)
+lch2luv(Triplet* in_out, const HueSinCos* hue)
 {
-    double hrad = in_out->c * 0.01745329251994329577;  /* (pi / 180.0) */
-    double u = cos(hrad) * in_out->b;
-    double v = sin(hrad) * in_out->b;
+    double u = hue->cos * in_out->b;
+    double v = hue->sin * in_out->b;
 
     in_out->b = u;
     in_out->c = v;
 }
 
 static void
-hsluv2lch(Triplet* in_out)
+hsluv2lch_stage(Triplet* in_out, const HsluvBounds* bounds, const HueSectors* sectors,
+                int fast_trig, HueSinCos* hue)
 {
     double h = in_out->a;
     double s = in_out->b;
     double l = in_out->c;
     double c;
 
+    hue_sincos(h, fast_trig, hue);
+
     /* White and black: disambiguate chroma */
-    if(l > 99.9999999 || l < 0.00000001)
+    if(l > 99.9999999 || l < 0.00000001) {
+        STATS_EXTREME_L(l);
         c = 0.0;
-    else
-        c = max_chroma_for_lh(l, h) / 100.0 * s;
+    } else {
+        c = max_chroma(bounds, sectors, hue) / 100.0 * s;
+    }
 
     /* Grays: disambiguate hue */
-    if (s < 0.00000001)
+    if (s < 0.00000001) {
+        STATS_EVENT(HSLUV_STATS_GRAY);
         h = 0.0;
+        *hue = hue_zero;
+    }
 
     in_out->a = l;
     in_out->b = c;
@@ -326,7 +859,8 @@ hsluv2lch(Triplet* in_out)
 }
 
 static void
-lch2hsluv(Triplet* in_out)
+lch2hsluv_stage(Triplet* in_out, const HsluvBounds* bounds, const HueSectors* sectors,
+                const HueSinCos* hue)
 {
     double l = in_out->a;
     double c = in_out->b;
@@ -334,14 +868,18 @@ lch2hsluv(Triplet* in_out)
     double s;
 
     /* White and black: disambiguate saturation */
-    if(l > 99.9999999 || l < 0.00000001)
+    if(l > 99.9999999 || l < 0.00000001) {
+        STATS_EXTREME_L(l);
         s = 0.0;
-    else
-        s = c / max_chroma_for_lh(l, h) * 100.0;
+    } else {
+        s = c / max_chroma(bounds, sectors, hue) * 100.0;
+    }
 
     /* Grays: disambiguate hue */
-    if (c < 0.00000001)
+    if (c < 0.00000001) {
+        STATS_EVENT(HSLUV_STATS_GRAY);
         h = 0.0;
+    }
 
     in_out->a = h;
     in_out->b = s;
@@ -349,7 +887,7 @@ lch2hsluv(Triplet* in_out)
 }
 
 static void
-hpluv2lch(Triplet* in_out)
+hpluv2lch_stage(Triplet* in_out, const HsluvBounds* bounds, int fast_trig, HueSinCos* hue)
 {
     double h = in_out->a;
     double s = in_out->b;
@@ -357,14 +895,21 @@ hpluv2lch(Triplet* in_out)
     double c;
 
     /* White and black: disambiguate chroma */
-    if(l > 99.9999999 || l < 0.00000001)
+    if(l > 99.9999999 || l < 0.00000001) {
+        STATS_EXTREME_L(l);
         c = 0.0;
-    else
-        c = max_safe_chroma_for_l(l) / 100.0 * s;
+    } else {
+        c = bounds->max_safe_chroma / 100.0 * s;
+    }
 
     /* Grays: disambiguate hue */
-    if (s < 0.00000001)
+    if (s < 0.00000001) {
+        STATS_EVENT(HSLUV_STATS_GRAY);
         h = 0.0;
+        *hue = hue_zero;
+    } else {
+        hue_sincos(h, fast_trig, hue);
+    }
 
     in_out->a = l;
     in_out->b = c;
@@ -372,7 +917,7 @@ hpluv2lch(Triplet* in_out)
 }
 
 static void
-lch2hpluv(Triplet* in_out)
+lch2hpluv_stage(Triplet* in_out, const HsluvBounds* bounds)
 {
     double l = in_out->a;
     double c = in_out->b;
@@ -380,14 +925,18 @@ lch2hpluv(Triplet* in_out)
     double s;
 
     /* White and black: disambiguate saturation */
-    if (l > 99.9999999 || l < 0.00000001)
+    if (l > 99.9999999 || l < 0.00000001) {
+        STATS_EXTREME_L(l);
         s = 0.0;
-    else
-        s = c / max_safe_chroma_for_l(l) * 100.0;
+    } else {
+        s = c / bounds->max_safe_chroma * 100.0;
+    }
 
     /* Grays: disambiguate hue */
-    if (c < 0.00000001)
+    if (c < 0.00000001) {
+        STATS_EVENT(HSLUV_STATS_GRAY);
         h = 0.0;
+    }
 
     in_out->a = h;
     in_out->b = s;
@@ -395,67 +944,2121 @@ lch2hpluv(Triplet* in_out)
 }
 
 
+/* HSLuv/HPLuv <-> XYZ, the part of the pipeline shared by all the RGB
+ * conversions. */
+static void
+hsluv2xyz_triplet(Triplet* in_out, BoundsCache* cache)
+{
+    const HsluvBounds* bounds = bounds_for_l(cache, in_out->c);
+    HueSinCos hue;
+
+    hsluv2lch_stage(in_out, bounds, sectors_for_run(cache), cache->fast_trig, &hue);
+    lch2luv(in_out, &hue);
+    luv2xyz(cache->space, in_out);
+}
+
+static void
+hpluv2xyz_triplet(Triplet* in_out, BoundsCache* cache)
+{
+    HueSinCos hue;
+
+    hpluv2lch_stage(in_out, safe_bounds_for_l(cache, in_out->c), cache->fast_trig, &hue);
+    lch2luv(in_out, &hue);
+    luv2xyz(cache->space, in_out);
+}
+
+static void
+clamp_hsl(Triplet* in_out)
+{
+    in_out->a = CLAMP(in_out->a, 0.0, 360.0);
+    in_out->b = CLAMP(in_out->b, 0.0, 100.0);
+    in_out->c = CLAMP(in_out->c, 0.0, 100.0);
+}
+
+/* Do NOT clamp the saturation. Application may want to have an idea how much
+ * off the valid range the given color is. */
+static int
+clamp_hpl(Triplet* in_out)
+{
+    in_out->a = CLAMP(in_out->a, 0.0, 360.0);
+    in_out->c = CLAMP(in_out->c, 0.0, 100.0);
+
+    if(0.0 <= in_out->b  &&  in_out->b <= 100.0)
+        return 0;
+    STATS_EVENT(HSLUV_STATS_HPLUV_OUT_OF_RANGE);
+    return -1;
+}
+
+static void
+xyz2hsluv_triplet(Triplet* in_out, BoundsCache* cache)
+{
+    const HsluvBounds* bounds;
+    HueSinCos hue;
+
+    xyz2luv(cache->space, in_out);
+    luv2lch(in_out, cache->fast_trig, &hue);
+    bounds = bounds_for_l(cache, in_out->a);
+    lch2hsluv_stage(in_out, bounds, sectors_for_run(cache), &hue);
+    clamp_hsl(in_out);
+}
+
+static int
+xyz2hpluv_triplet(Triplet* in_out, BoundsCache* cache)
+{
+    HueSinCos hue;
+
+    xyz2luv(cache->space, in_out);
+    luv2lch(in_out, cache->fast_trig, &hue);
+    lch2hpluv_stage(in_out, safe_bounds_for_l(cache, in_out->a));
+    return clamp_hpl(in_out);
+}
+
+static void
+clamp_rgb(Triplet* in_out)
+{
+    in_out->a = CLAMP(in_out->a, 0.0, 1.0);
+    in_out->b = CLAMP(in_out->b, 0.0, 1.0);
+    in_out->c = CLAMP(in_out->c, 0.0, 1.0);
+}
+
+static void
+hsluv2rgb_triplet(Triplet* in_out, BoundsCache* cache)
+{
+    hsluv2xyz_triplet(in_out, cache);
+    xyz2rgb(cache->space, in_out);
+    clamp_rgb(in_out);
+}
+
+static void
+hpluv2rgb_triplet(Triplet* in_out, BoundsCache* cache)
+{
+    hpluv2xyz_triplet(in_out, cache);
+    xyz2rgb(cache->space, in_out);
+    clamp_rgb(in_out);
+}
+
+static void
+rgb2hsluv_triplet(Triplet* in_out, BoundsCache* cache)
+{
+    rgb2xyz(cache->space, in_out);
+    xyz2hsluv_triplet(in_out, cache);
+}
+
+static int
+rgb2hpluv_triplet(Triplet* in_out, BoundsCache* cache)
+{
+    rgb2xyz(cache->space, in_out);
+    return xyz2hpluv_triplet(in_out, cache);
+}
+
+
+HsluvRgb
+hsluv2rgb_v(HsluvHsl hsl)
+{
+    Triplet tmp = { hsl.h, hsl.s, hsl.l };
+    BoundsCache cache;
+    HsluvRgb rgb;
+
+    bounds_cache_init(&cache, &srgb_space);
+    hsluv2rgb_triplet(&tmp, &cache);
+
+    rgb.r = tmp.a;
+    rgb.g = tmp.b;
+    rgb.b = tmp.c;
+    return rgb;
+}
+
+HsluvRgb
+hpluv2rgb_v(HsluvHsl hpl)
+{
+    Triplet tmp = { hpl.h, hpl.s, hpl.l };
+    BoundsCache cache;
+    HsluvRgb rgb;
+
+    bounds_cache_init(&cache, &srgb_space);
+    hpluv2rgb_triplet(&tmp, &cache);
+
+    rgb.r = tmp.a;
+    rgb.g = tmp.b;
+    rgb.b = tmp.c;
+    return rgb;
+}
+
+HsluvHsl
+rgb2hsluv_v(HsluvRgb rgb)
+{
+    Triplet tmp = { rgb.r, rgb.g, rgb.b };
+    BoundsCache cache;
+    HsluvHsl hsl;
+
+    bounds_cache_init(&cache, &srgb_space);
+    rgb2hsluv_triplet(&tmp, &cache);
+
+    hsl.h = tmp.a;
+    hsl.s = tmp.b;
+    hsl.l = tmp.c;
+    return hsl;
+}
+
+HsluvHsl
+rgb2hpluv_v(HsluvRgb rgb)
+{
+    Triplet tmp = { rgb.r, rgb.g, rgb.b };
+    BoundsCache cache;
+    HsluvHsl hpl;
+
+    bounds_cache_init(&cache, &srgb_space);
+    rgb2hpluv_triplet(&tmp, &cache);
+
+    hpl.h = tmp.a;
+    hpl.s = tmp.b;
+    hpl.l = tmp.c;
+    return hpl;
+}
 
 void
 hsluv2rgb(double h, double s, double l, double* pr, double* pg, double* pb)
 {
-    Triplet tmp = { h, s, l };
+    HsluvHsl hsl = { h, s, l };
+    HsluvRgb rgb = hsluv2rgb_v(hsl);
 
-    hsluv2lch(&tmp);
-    lch2luv(&tmp);
-    luv2xyz(&tmp);
-    xyz2rgb(&tmp);
-
-    *pr = CLAMP(tmp.a, 0.0, 1.0);
-    *pg = CLAMP(tmp.b, 0.0, 1.0);
-    *pb = CLAMP(tmp.c, 0.0, 1.0);
+    *pr = rgb.r;
+    *pg = rgb.g;
+    *pb = rgb.b;
 }
 
 void
 hpluv2rgb(double h, double s, double l, double* pr, double* pg, double* pb)
 {
-    Triplet tmp = { h, s, l };
-
-    hpluv2lch(&tmp);
-    lch2luv(&tmp);
-    luv2xyz(&tmp);
-    xyz2rgb(&tmp);
+    HsluvHsl hpl = { h, s, l };
+    HsluvRgb rgb = hpluv2rgb_v(hpl);
 
-    *pr = CLAMP(tmp.a, 0.0, 1.0);
-    *pg = CLAMP(tmp.b, 0.0, 1.0);
-    *pb = CLAMP(tmp.c, 0.0, 1.0);
+    *pr = rgb.r;
+    *pg = rgb.g;
+    *pb = rgb.b;
 }
 
 void
 rgb2hsluv(double r, double g, double b, double* ph, double* ps, double* pl)
 {
-    Triplet tmp = { r, g, b };
+    HsluvRgb rgb = { r, g, b };
+    HsluvHsl hsl = rgb2hsluv_v(rgb);
 
-    rgb2xyz(&tmp);
-    xyz2luv(&tmp);
-    luv2lch(&tmp);
-    lch2hsluv(&tmp);
-
-    *ph = CLAMP(tmp.a, 0.0, 360.0);
-    *ps = CLAMP(tmp.b, 0.0, 100.0);
-    *pl = CLAMP(tmp.c, 0.0, 100.0);
+    *ph = hsl.h;
+    *ps = hsl.s;
+    *pl = hsl.l;
 }
 
 int
 rgb2hpluv(double r, double g, double b, double* ph, double* ps, double* pl)
 {
-    Triplet tmp = { r, g, b };
+    HsluvRgb rgb = { r, g, b };
+    HsluvHsl hpl = rgb2hpluv_v(rgb);
 
-    rgb2xyz(&tmp);
-    xyz2luv(&tmp);
-    luv2lch(&tmp);
-    lch2hpluv(&tmp);
+    *ph = hpl.h;
+    *ps = hpl.s;
+    *pl = hpl.l;
 
-    *ph = CLAMP(tmp.a, 0.0, 360.0);
-    /* Do NOT clamp the saturation. Application may want to have an idea
-     * how much off the valid range the given RGB color is. */
+    return (0.0 <= hpl.s  &&  hpl.s <= 100.0) ? 0 : -1;
+}
+
+void
+hsluv2rgb_fast(double h, double s, double l, double* pr, double* pg, double* pb)
+{
+    Triplet tmp = { h, s, l };
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, &srgb_space);
+    cache.fast_trig = 1;
+    hsluv2rgb_triplet(&tmp, &cache);
+
+    *pr = tmp.a;
+    *pg = tmp.b;
+    *pb = tmp.c;
+}
+
+void
+hpluv2rgb_fast(double h, double s, double l, double* pr, double* pg, double* pb)
+{
+    Triplet tmp = { h, s, l };
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, &srgb_space);
+    cache.fast_trig = 1;
+    hpluv2rgb_triplet(&tmp, &cache);
+
+    *pr = tmp.a;
+    *pg = tmp.b;
+    *pb = tmp.c;
+}
+
+void
+rgb2hsluv_fast(double r, double g, double b, double* ph, double* ps, double* pl)
+{
+    Triplet tmp = { r, g, b };
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, &srgb_space);
+    cache.fast_trig = 1;
+    rgb2hsluv_triplet(&tmp, &cache);
+
+    *ph = tmp.a;
+    *ps = tmp.b;
+    *pl = tmp.c;
+}
+
+int
+rgb2hpluv_fast(double r, double g, double b, double* ph, double* ps, double* pl)
+{
+    Triplet tmp = { r, g, b };
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, &srgb_space);
+    cache.fast_trig = 1;
+    rgb2hpluv_triplet(&tmp, &cache);
+
+    *ph = tmp.a;
     *ps = tmp.b;
-    *pl = CLAMP(tmp.c, 0.0, 100.0);
+    *pl = tmp.c;
+    return (0.0 <= tmp.b  &&  tmp.b <= 100.0) ? 0 : -1;
+}
+
+void
+hpluv2rgb_lut(const HsluvHpluvLut* lut, double h, double s, double l,
+              double* pr, double* pg, double* pb)
+{
+    Triplet tmp = { h, s, l };
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, &srgb_space);
+    cache.hpluv_lut = lut;
+    hpluv2rgb_triplet(&tmp, &cache);
+
+    *pr = tmp.a;
+    *pg = tmp.b;
+    *pb = tmp.c;
+}
+
+int
+rgb2hpluv_lut(const HsluvHpluvLut* lut, double r, double g, double b,
+              double* ph, double* ps, double* pl)
+{
+    Triplet tmp = { r, g, b };
+    BoundsCache cache;
 
+    bounds_cache_init(&cache, &srgb_space);
+    cache.hpluv_lut = lut;
+    rgb2hpluv_triplet(&tmp, &cache);
+
+    *ph = tmp.a;
+    *ps = tmp.b;
+    *pl = tmp.c;
     return (0.0 <= tmp.b  &&  tmp.b <= 100.0) ? 0 : -1;
 }
+
+
+/* RGB working spaces.
+ *
+ * The matrix from linear RGB to XYZ has the XYZ of the primaries (with Y = 1)
+ * in its columns, each scaled so that RGB white (1, 1, 1) maps to the XYZ of
+ * the white point (again with Y = 1, so white has L = 100). */
+
+static int
+invert3(double a[3][3], double inv[3][3])
+{
+    double det;
+    int i, j;
+
+    inv[0][0] = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+    inv[0][1] = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+    inv[0][2] = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+    inv[1][0] = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+    inv[1][1] = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+    inv[1][2] = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+    inv[2][0] = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+    inv[2][1] = a[0][1] * a[2][0] - a[0][0] * a[2][1];
+    inv[2][2] = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+
+    det = a[0][0] * inv[0][0] + a[0][1] * inv[1][0] + a[0][2] * inv[2][0];
+    if(!(fabs(det) > 1e-12))
+        return -1;
+
+    for(i = 0; i < 3; i++) {
+        for(j = 0; j < 3; j++)
+            inv[i][j] /= det;
+    }
+    return 0;
+}
+
+/* XYZ (with Y = 1) of chromaticity (x, y). */
+static int
+xy2xyz(double x, double y, double xyz[3])
+{
+    if(!(y > 0.0))
+        return -1;
+    xyz[0] = x / y;
+    xyz[1] = 1.0;
+    xyz[2] = (1.0 - x - y) / y;
+    return 0;
+}
+
+int
+hsluv_rgb_space_init(HsluvRgbSpace* space, const double primaries[6], const double white[2],
+                     HsluvTransfer transfer)
+{
+    double prim[3][3];
+    double prim_inv[3][3];
+    double w[3];
+    double xyz[3];
+    double den;
+    int i, j;
+
+    switch(transfer) {
+        case HSLUV_TRANSFER_SRGB:
+            space->tf_cut = srgb_space.tf_cut;
+            space->tf_cut_encoded = srgb_space.tf_cut_encoded;
+            space->tf_slope = srgb_space.tf_slope;
+            space->tf_scale = srgb_space.tf_scale;
+            space->tf_offset = srgb_space.tf_offset;
+            space->tf_gamma = srgb_space.tf_gamma;
+            break;
+
+        case HSLUV_TRANSFER_BT709:
+            space->tf_cut = 0.018;
+            space->tf_cut_encoded = 0.081;
+            space->tf_slope = 4.5;
+            space->tf_scale = 1.099;
+            space->tf_offset = 0.099;
+            space->tf_gamma = 1.0 / 0.45;
+            break;
+
+        case HSLUV_TRANSFER_LINEAR:
+            /* Just the linear segment, up to any sane value. */
+            space->tf_cut = 1e30;
+            space->tf_cut_encoded = 1e30;
+            space->tf_slope = 1.0;
+            space->tf_scale = 1.0;
+            space->tf_offset = 0.0;
+            space->tf_gamma = 1.0;
+            break;
+
+        default:
+            return -1;
+    }
+
+    for(i = 0; i < 3; i++) {
+        if(xy2xyz(primaries[i * 2], primaries[i * 2 + 1], xyz) != 0)
+            return -1;
+        for(j = 0; j < 3; j++)
+            prim[j][i] = xyz[j];
+    }
+    if(xy2xyz(white[0], white[1], w) != 0  ||  invert3(prim, prim_inv) != 0)
+        return -1;
+
+    /* Scale of each primary. If any is not positive, the white point is
+     * outside of the triangle of the primaries. */
+    for(i = 0; i < 3; i++) {
+        double scale = prim_inv[i][0] * w[0] + prim_inv[i][1] * w[1] + prim_inv[i][2] * w[2];
+
+        if(!(scale > 0.0))
+            return -1;
+        for(j = 0; j < 3; j++)
+            space->m_inv[j][i] = prim[j][i] * scale;
+    }
+    if(invert3(space->m_inv, space->m) != 0)
+        return -1;
+
+    den = -2.0 * white[0] + 12.0 * white[1] + 3.0;
+    space->ref_u = 4.0 * white[0] / den;
+    space->ref_v = 9.0 * white[1] / den;
+
+    /* The lines 2 * i + t of get_bounds() solve (m1 * X + m2 * Y + m3 * Z) = t
+     * for the row i of m and t = 0 and 1, with X and Z expressed through
+     * (L, u, v). The factor 31613 keeps the magnitudes of the coefficients of
+     * the original sRGB formulas (see srgb_space). */
+    for(i = 0; i < 6; i++) {
+        double m1 = space->m[i / 2][0];
+        double m2 = space->m[i / 2][1];
+        double m3 = space->m[i / 2][2];
+        int t = i % 2;
+
+        space->bounds_top1[i] = 31613.0 * (9.0 * m1 - 3.0 * m3);
+        space->bounds_top2[i] = 31613.0 * 13.0 * (space->ref_u * (9.0 * m1 - 3.0 * m3) +
+                                space->ref_v * (4.0 * m2 - 20.0 * m3) + 12.0 * m3);
+        space->bounds_top2_l[i] = 31613.0 * 52.0 * space->ref_v * t;
+        space->bounds_bottom[i] = 31613.0 * (20.0 * m3 - 4.0 * m2);
+        space->bounds_bottom_c[i] = 31613.0 * 4.0 * t;
+    }
+
+    return 0;
+}
+
+int
+hsluv_rgb_space_init_std(HsluvRgbSpace* space, HsluvRgbSpaceId id)
+{
+    static const double d65[2] = { 0.3127, 0.3290 };
+    static const double p3[6] = { 0.680, 0.320, 0.265, 0.690, 0.150, 0.060 };
+    static const double rec2020[6] = { 0.708, 0.292, 0.170, 0.797, 0.131, 0.046 };
+
+    switch(id) {
+        case HSLUV_RGB_SPACE_SRGB:
+            *space = srgb_space;
+            return 0;
+
+        case HSLUV_RGB_SPACE_DISPLAY_P3:
+            return hsluv_rgb_space_init(space, p3, d65, HSLUV_TRANSFER_SRGB);
+
+        case HSLUV_RGB_SPACE_REC2020:
+            return hsluv_rgb_space_init(space, rec2020, d65, HSLUV_TRANSFER_BT709);
+
+        default:
+            return -1;
+    }
+}
+
+/* Single-color conversions in a space share the Triplet pipeline with the
+ * sRGB ones; the kernels of the batched ones are below. */
+typedef void (*SpaceTripletFunc)(Triplet* in_out, BoundsCache* cache);
+
+static void
+space_triplet(const HsluvRgbSpace* space, SpaceTripletFunc func,
+              double a, double b, double c, double* px, double* py, double* pz)
+{
+    Triplet tmp = { a, b, c };
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, (space != NULL) ? space : &srgb_space);
+    func(&tmp, &cache);
+
+    *px = tmp.a;
+    *py = tmp.b;
+    *pz = tmp.c;
+}
+
+static void
+rgb2hpluv_triplet_void(Triplet* in_out, BoundsCache* cache)
+{
+    rgb2hpluv_triplet(in_out, cache);
+}
+
+void
+hsluv2rgb_space(const HsluvRgbSpace* space, double h, double s, double l,
+                double* pr, double* pg, double* pb)
+{
+    space_triplet(space, hsluv2rgb_triplet, h, s, l, pr, pg, pb);
+}
+
+void
+hpluv2rgb_space(const HsluvRgbSpace* space, double h, double s, double l,
+                double* pr, double* pg, double* pb)
+{
+    space_triplet(space, hpluv2rgb_triplet, h, s, l, pr, pg, pb);
+}
+
+void
+rgb2hsluv_space(const HsluvRgbSpace* space, double r, double g, double b,
+                double* ph, double* ps, double* pl)
+{
+    space_triplet(space, rgb2hsluv_triplet, r, g, b, ph, ps, pl);
+}
+
+int
+rgb2hpluv_space(const HsluvRgbSpace* space, double r, double g, double b,
+                double* ph, double* ps, double* pl)
+{
+    space_triplet(space, rgb2hpluv_triplet_void, r, g, b, ph, ps, pl);
+    return (0.0 <= *ps  &&  *ps <= 100.0) ? 0 : -1;
+}
+
+
+void
+hsluv_bounds_init(HsluvBounds* bounds, double l)
+{
+    get_bounds(&srgb_space, l, bounds);
+    bounds->max_safe_chroma = max_safe_chroma_for_bounds(bounds);
+}
+
+double
+hsluv_bounds_max_chroma(const HsluvBounds* bounds, double h)
+{
+    HueSinCos hue;
+
+    hue_sincos(h, 0, &hue);
+    return max_chroma_for_bounds(bounds, &hue);
+}
+
+void
+hsluv2rgb_bounds(const HsluvBounds* bounds, double h, double s,
+                 double* pr, double* pg, double* pb)
+{
+    Triplet tmp = { h, s, bounds->l };
+    HueSinCos hue;
+
+    hsluv2lch_stage(&tmp, bounds, NULL, 0, &hue);
+    lch2luv(&tmp, &hue);
+    luv2xyz(&srgb_space, &tmp);
+    xyz2rgb(&srgb_space, &tmp);
+
+    *pr = CLAMP(tmp.a, 0.0, 1.0);
+    *pg = CLAMP(tmp.b, 0.0, 1.0);
+    *pb = CLAMP(tmp.c, 0.0, 1.0);
+}
+
+void
+hpluv2rgb_bounds(const HsluvBounds* bounds, double h, double s,
+                 double* pr, double* pg, double* pb)
+{
+    Triplet tmp = { h, s, bounds->l };
+    HueSinCos hue;
+
+    hpluv2lch_stage(&tmp, bounds, 0, &hue);
+    lch2luv(&tmp, &hue);
+    luv2xyz(&srgb_space, &tmp);
+    xyz2rgb(&srgb_space, &tmp);
+
+    *pr = CLAMP(tmp.a, 0.0, 1.0);
+    *pg = CLAMP(tmp.b, 0.0, 1.0);
+    *pb = CLAMP(tmp.c, 0.0, 1.0);
+}
+
+
+/* Gradients. The colors of a gradient have their hues in an arithmetic
+ * sequence, so the sine and cosine of each one follow from the previous ones
+ * by the angle addition formulas. To keep the rounding errors of that
+ * recurrence from piling up, it restarts from the exact values every
+ * GRADIENT_RESYNC steps. And as the lightness is constant or changes in
+ * steady steps, BoundsCache reuses the bounds across the whole gradient in
+ * the former case. */
+#define GRADIENT_RESYNC     64
+
+static void
+gradient(double h0, double dh, double s0, double ds, double l0, double dl,
+         double* out, size_t out_stride, size_t n)
+{
+    BoundsCache cache;
+    HueSinCos hue, step;
+    size_t i;
+
+    bounds_cache_init(&cache, &srgb_space);
+    hue_sincos(dh, 0, &step);
+    for(i = 0; i < n; i++) {
+        double s = s0 + ds * (double) i;
+        double l = l0 + dl * (double) i;
+        const HsluvBounds* bounds = bounds_for_l(&cache, l);
+        Triplet tmp;
+
+        if(i % GRADIENT_RESYNC == 0) {
+            hue_sincos(h0 + dh * (double) i, 0, &hue);
+        } else {
+            HueSinCos next;
+
+            next.sin = hue.sin * step.cos + hue.cos * step.sin;
+            next.cos = hue.cos * step.cos - hue.sin * step.sin;
+            hue = next;
+        }
+
+        /* hsluv2lch_stage() with the hue already in hand. */
+        tmp.a = l;
+        if(bounds == NULL  ||  s < 0.00000001)
+            tmp.b = 0.0;
+        else
+            tmp.b = max_chroma(bounds, sectors_for_run(&cache), &hue) / 100.0 * s;
+        lch2luv(&tmp, &hue);
+        luv2xyz(&srgb_space, &tmp);
+        xyz2rgb(&srgb_space, &tmp);
+
+        out[i * out_stride] = CLAMP(tmp.a, 0.0, 1.0);
+        out[i * out_stride + 1] = CLAMP(tmp.b, 0.0, 1.0);
+        out[i * out_stride + 2] = CLAMP(tmp.c, 0.0, 1.0);
+    }
+}
+
+void
+hsluv_gradient(double h0, double s0, double l0, double h1, double s1, double l1,
+               double* out, size_t out_stride, size_t n)
+{
+    double dh = h1 - h0;
+    double steps = (double) (n - 1);
+
+    /* The shorter way around. */
+    dh = fmod(dh, 360.0);
+    if(dh > 180.0)
+        dh -= 360.0;
+    else if(dh <= -180.0)
+        dh += 360.0;
+
+    if(n == 0)
+        return;
+    if(n == 1) {
+        hsluv2rgb(h0, s0, l0, &out[0], &out[1], &out[2]);
+        return;
+    }
+
+    gradient(h0, dh / steps, s0, (s1 - s0) / steps, l0, (l1 - l0) / steps, out, out_stride, n - 1);
+
+    /* Make the end exact. */
+    out += (n - 1) * out_stride;
+    hsluv2rgb(h1, s1, l1, &out[0], &out[1], &out[2]);
+}
+
+void
+hsluv_hue_sweep(double h, double h_step, double s, double l,
+                double* out, size_t out_stride, size_t n)
+{
+    gradient(h, h_step, s, 0.0, l, 0.0, out, out_stride, n);
+}
+
+
+/* Scalar kernels, i.e. just the Triplet pipeline in a tight loop. Each color
+ * is loaded into a local Triplet before anything is stored, so converting in
+ * place (with in == out and the same stride) is fine. Consecutive colors of
+ * the same lightness share the bounds (see BoundsCache).
+ *
+ * The kernels have the signature of the planar functions so that the
+ * vectorized ones (see hsluv-simd.h) can be used instead of them. */
+
+static int
+scalar_hsluv2rgb_space(const HsluvRgbSpace* space,
+                       const double* h, const double* s, const double* l, size_t in_stride,
+                       double* r, double* g, double* b, size_t out_stride, size_t n)
+{
+    size_t i;
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp = { h[i * in_stride], s[i * in_stride], l[i * in_stride] };
+
+        hsluv2rgb_triplet(&tmp, &cache);
+
+        r[i * out_stride] = tmp.a;
+        g[i * out_stride] = tmp.b;
+        b[i * out_stride] = tmp.c;
+    }
+
+    return 0;
+}
+
+static int
+scalar_hsluv2rgb(const double* h, const double* s, const double* l, size_t in_stride,
+                 double* r, double* g, double* b, size_t out_stride, size_t n)
+{
+    return scalar_hsluv2rgb_space(&srgb_space, h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+static int
+scalar_hpluv2rgb_space(const HsluvRgbSpace* space,
+                       const double* h, const double* s, const double* l, size_t in_stride,
+                       double* r, double* g, double* b, size_t out_stride, size_t n)
+{
+    size_t i;
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp = { h[i * in_stride], s[i * in_stride], l[i * in_stride] };
+
+        hpluv2rgb_triplet(&tmp, &cache);
+
+        r[i * out_stride] = tmp.a;
+        g[i * out_stride] = tmp.b;
+        b[i * out_stride] = tmp.c;
+    }
+
+    return 0;
+}
+
+static int
+scalar_hpluv2rgb(const double* h, const double* s, const double* l, size_t in_stride,
+                 double* r, double* g, double* b, size_t out_stride, size_t n)
+{
+    return scalar_hpluv2rgb_space(&srgb_space, h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+static int
+scalar_rgb2hsluv_space(const HsluvRgbSpace* space,
+                       const double* r, const double* g, const double* b, size_t in_stride,
+                       double* h, double* s, double* l, size_t out_stride, size_t n)
+{
+    size_t i;
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp = { r[i * in_stride], g[i * in_stride], b[i * in_stride] };
+
+        rgb2hsluv_triplet(&tmp, &cache);
+
+        h[i * out_stride] = tmp.a;
+        s[i * out_stride] = tmp.b;
+        l[i * out_stride] = tmp.c;
+    }
+
+    return 0;
+}
+
+static int
+scalar_rgb2hsluv(const double* r, const double* g, const double* b, size_t in_stride,
+                 double* h, double* s, double* l, size_t out_stride, size_t n)
+{
+    return scalar_rgb2hsluv_space(&srgb_space, r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+static int
+scalar_rgb2hpluv_space(const HsluvRgbSpace* space,
+                       const double* r, const double* g, const double* b, size_t in_stride,
+                       double* h, double* s, double* l, size_t out_stride, size_t n)
+{
+    size_t i;
+    int ret = 0;
+    BoundsCache cache;
+
+    bounds_cache_init(&cache, space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp = { r[i * in_stride], g[i * in_stride], b[i * in_stride] };
+
+        if(rgb2hpluv_triplet(&tmp, &cache) != 0)
+            ret = -1;
+
+        h[i * out_stride] = tmp.a;
+        s[i * out_stride] = tmp.b;
+        l[i * out_stride] = tmp.c;
+    }
+
+    return ret;
+}
+
+static int
+scalar_rgb2hpluv(const double* r, const double* g, const double* b, size_t in_stride,
+                 double* h, double* s, double* l, size_t out_stride, size_t n)
+{
+    return scalar_rgb2hpluv_space(&srgb_space, r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+/* Fused edits: see hsluv-simd.h for the ideas, and hsluv_rotate_hue_rgb_n()
+ * and friends for the semantics. */
+static int
+scalar_edit_rgb(const double* r, const double* g, const double* b, size_t in_stride,
+                double* x, double* y, double* z, size_t out_stride, size_t n,
+                const Edit* edit)
+{
+    BoundsCache cache;
+    HsluvBounds target_bounds;
+    const HsluvBounds* target = NULL;
+    const HueSectors* target_sectors = (edit->has_sectors ? &edit->sectors : NULL);
+    double target_y = l2y(edit->l);
+    size_t i;
+
+    if(edit->op == EDIT_SET_LIGHTNESS  &&  !(edit->l > 99.9999999 || edit->l < 0.00000001)) {
+        get_bounds(&srgb_space, edit->l, &target_bounds);
+        target = &target_bounds;
+    }
+
+    bounds_cache_init(&cache, &srgb_space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp = { r[i * in_stride], g[i * in_stride], b[i * in_stride] };
+        const HsluvBounds* bounds;
+        const HueSectors* sectors;
+        HueSinCos hue;
+        double l, c, lum_y, s = 0.0;
+
+        rgb2xyz(&srgb_space, &tmp);
+        lum_y = tmp.b;
+        xyz2luv(&srgb_space, &tmp);
+        l = tmp.a;
+        c = sqrt(tmp.b * tmp.b + tmp.c * tmp.c);
+        if(c < 0.00000001) {
+            hue = hue_zero;
+        } else {
+            hue.sin = tmp.c / c;
+            hue.cos = tmp.b / c;
+        }
+
+        /* The saturation, clamped as by rgb2hsluv(). */
+        bounds = bounds_for_l(&cache, l);
+        sectors = sectors_for_run(&cache);
+        if(bounds != NULL  &&  c >= 0.00000001) {
+            s = c / max_chroma(bounds, sectors, &hue);
+            if(s > 1.0)
+                s = 1.0;
+        }
+
+        switch(edit->op) {
+            case EDIT_ROTATE_HUE:
+            {
+                HueSinCos rotated;
+
+                rotated.sin = hue.sin * edit->cos_d + hue.cos * edit->sin_d;
+                rotated.cos = hue.cos * edit->cos_d - hue.sin * edit->sin_d;
+                hue = rotated;
+                c = (bounds != NULL ? max_chroma(bounds, sectors, &hue) * s : 0.0);
+                break;
+            }
+
+            case EDIT_SET_LIGHTNESS:
+                c = (target != NULL ? max_chroma(target, target_sectors, &hue) * s : 0.0);
+                l = edit->l;
+                lum_y = target_y;
+                break;
+
+            case EDIT_SCALE_SATURATION:
+                s = CLAMP(s * edit->factor, 0.0, 1.0);
+                c = (bounds != NULL ? max_chroma(bounds, sectors, &hue) * s : 0.0);
+                break;
+        }
+
+        tmp.a = l;
+        tmp.b = c;
+        lch2luv(&tmp, &hue);
+        luv2xyz_y(&srgb_space, &tmp, lum_y);
+        xyz2rgb(&srgb_space, &tmp);
+        clamp_rgb(&tmp);
+
+        x[i * out_stride] = tmp.a;
+        y[i * out_stride] = tmp.b;
+        z[i * out_stride] = tmp.c;
+    }
+
+    return 0;
+}
+
+/* Tetrahedral interpolation in the 3D LUT (see hsluv-lut3d.c). The cell is
+ * split along its main diagonal into six tetrahedra; the one holding the
+ * color is given by the order of the fractions, and the value is then blended
+ * from the four nodes along the path from the node (0, 0, 0) to (1, 1, 1)
+ * through it. The nodes hold CIELUV, which is smooth over the whole cube
+ * (unlike the saturation and hue, it has no wrap-around nor singularities on
+ * the gray axis), and grays, lying on the diagonal of the cells, interpolate
+ * from gray nodes only. The rest of the conversion is exact. */
+static int
+scalar_lut3d_rgb2hsluv(const double* r, const double* g, const double* b, size_t in_stride,
+                       double* x, double* y, double* z, size_t out_stride, size_t n,
+                       const Lut3d* lut)
+{
+    size_t stride_r = (size_t) lut->size * lut->size * 3;
+    size_t stride_g = (size_t) lut->size * 3;
+    size_t stride_b = 3;
+    int last = lut->size - 2;
+    double scale = (double) (lut->size - 1);
+    BoundsCache cache;
+    size_t i;
+
+    bounds_cache_init(&cache, &srgb_space);
+    for(i = 0; i < n; i++) {
+        double rr = CLAMP(r[i * in_stride], 0.0, 1.0);
+        double gg = CLAMP(g[i * in_stride], 0.0, 1.0);
+        double bb = CLAMP(b[i * in_stride], 0.0, 1.0);
+        double xr = rr * scale, xg = gg * scale, xb = bb * scale;
+        int ir = (int) xr, ig = (int) xg, ib = (int) xb;
+        double fr, fg, fb, fmax, fmid, fmin;
+        size_t step_a, step_b;
+        const float* p;
+        double val[3];
+        Triplet tmp;
+        int k;
+
+        ir = (ir > last ? last : ir);
+        ig = (ig > last ? last : ig);
+        ib = (ib > last ? last : ib);
+        fr = xr - ir;
+        fg = xg - ig;
+        fb = xb - ib;
+        if(fr >= fg) {
+            if(fg >= fb) {
+                fmax = fr; fmid = fg; fmin = fb; step_a = stride_r; step_b = stride_g;
+            } else if(fr >= fb) {
+                fmax = fr; fmid = fb; fmin = fg; step_a = stride_r; step_b = stride_b;
+            } else {
+                fmax = fb; fmid = fr; fmin = fg; step_a = stride_b; step_b = stride_r;
+            }
+        } else {
+            if(fb > fg) {
+                fmax = fb; fmid = fg; fmin = fr; step_a = stride_b; step_b = stride_g;
+            } else if(fb > fr) {
+                fmax = fg; fmid = fb; fmin = fr; step_a = stride_g; step_b = stride_b;
+            } else {
+                fmax = fg; fmid = fr; fmin = fb; step_a = stride_g; step_b = stride_r;
+            }
+        }
+
+        p = lut->nodes + ir * stride_r + ig * stride_g + ib * stride_b;
+        for(k = 0; k < 3; k++) {
+            double c000 = p[k];
+            double ca = p[step_a + k];
+            double cb = p[step_a + step_b + k];
+            double c111 = p[stride_r + stride_g + stride_b + k];
+
+            val[k] = c000 + (ca - c000) * fmax + (cb - ca) * fmid + (c111 - cb) * fmin;
+        }
+
+        if(val[0] < LUT3D_EXACT_L) {
+            /* The dark colors get the exact conversion (see HsluvLut3d). */
+            tmp.a = rr;
+            tmp.b = gg;
+            tmp.c = bb;
+            rgb2hsluv_triplet(&tmp, &cache);
+        } else {
+            /* The tail of xyz2hsluv_triplet(). */
+            const HsluvBounds* bounds;
+            HueSinCos hue;
+
+            tmp.a = val[0];
+            tmp.b = val[1];
+            tmp.c = val[2];
+            luv2lch(&tmp, 0, &hue);
+            bounds = bounds_for_l(&cache, tmp.a);
+            lch2hsluv_stage(&tmp, bounds, sectors_for_run(&cache), &hue);
+            clamp_hsl(&tmp);
+        }
+
+        x[i * out_stride] = tmp.a;
+        y[i * out_stride] = tmp.b;
+        z[i * out_stride] = tmp.c;
+    }
+
+    return 0;
+}
+
+
+/* 8-bit RGB conversions. The part of the pipeline between linear RGB and
+ * HSLuv/HPLuv is the same as for the doubles; only the sRGB transfer curve is
+ * replaced with the tables of hsluv-rgb8-tables.h. */
+
+/* Correctly rounded from_linear(c) * 255.0 of c in [0.0, 1.0]. */
+static unsigned char
+linear2rgb8(double c)
+{
+    int i = (int) (c * RGB8_BUCKETS);
+    unsigned char v;
+
+    if(i < 0)
+        return 0;
+    if(i >= RGB8_BUCKETS)
+        return 255;
+
+    v = rgb8_bucket[i];
+    if(v < 255  &&  c >= rgb8_threshold[v])
+        v++;
+    return v;
+}
+
+static void
+store_rgb8(const Triplet* linear, unsigned char* pixel, const Rgb8Format* fmt)
+{
+    pixel[fmt->r] = linear2rgb8(linear->a);
+    pixel[fmt->g] = linear2rgb8(linear->b);
+    pixel[fmt->b] = linear2rgb8(linear->c);
+}
+
+static void
+load_rgb8(const unsigned char* pixel, const Rgb8Format* fmt, Triplet* linear)
+{
+    linear->a = rgb8_to_linear[pixel[fmt->r]];
+    linear->b = rgb8_to_linear[pixel[fmt->g]];
+    linear->c = rgb8_to_linear[pixel[fmt->b]];
+}
+
+void
+hsluv2rgb8_n(const double* in, size_t in_stride, unsigned char* out, HsluvFormat format, size_t n)
+{
+    const Rgb8Format* fmt = rgb8_format(format);
+    BoundsCache cache;
+    size_t i;
+
+    bounds_cache_init(&cache, &srgb_space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp = { in[i * in_stride], in[i * in_stride + 1], in[i * in_stride + 2] };
+
+        hsluv2xyz_triplet(&tmp, &cache);
+        xyz2linear(&srgb_space, &tmp);
+        store_rgb8(&tmp, out + i * fmt->size, fmt);
+    }
+}
+
+void
+hpluv2rgb8_n(const double* in, size_t in_stride, unsigned char* out, HsluvFormat format, size_t n)
+{
+    const Rgb8Format* fmt = rgb8_format(format);
+    BoundsCache cache;
+    size_t i;
+
+    bounds_cache_init(&cache, &srgb_space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp = { in[i * in_stride], in[i * in_stride + 1], in[i * in_stride + 2] };
+
+        hpluv2xyz_triplet(&tmp, &cache);
+        xyz2linear(&srgb_space, &tmp);
+        store_rgb8(&tmp, out + i * fmt->size, fmt);
+    }
+}
+
+void
+rgb82hsluv_n(const unsigned char* in, HsluvFormat format, double* out, size_t out_stride, size_t n)
+{
+    const Rgb8Format* fmt = rgb8_format(format);
+    BoundsCache cache;
+    size_t i;
+
+    bounds_cache_init(&cache, &srgb_space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp;
+
+        load_rgb8(in + i * fmt->size, fmt, &tmp);
+        linear2xyz(&srgb_space, &tmp);
+        xyz2hsluv_triplet(&tmp, &cache);
+
+        out[i * out_stride] = tmp.a;
+        out[i * out_stride + 1] = tmp.b;
+        out[i * out_stride + 2] = tmp.c;
+    }
+}
+
+int
+rgb82hpluv_n(const unsigned char* in, HsluvFormat format, double* out, size_t out_stride, size_t n)
+{
+    const Rgb8Format* fmt = rgb8_format(format);
+    BoundsCache cache;
+    size_t i;
+    int ret = 0;
+
+    bounds_cache_init(&cache, &srgb_space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp;
+
+        load_rgb8(in + i * fmt->size, fmt, &tmp);
+        linear2xyz(&srgb_space, &tmp);
+        if(xyz2hpluv_triplet(&tmp, &cache) != 0)
+            ret = -1;
+
+        out[i * out_stride] = tmp.a;
+        out[i * out_stride + 1] = tmp.b;
+        out[i * out_stride + 2] = tmp.c;
+    }
+
+    return ret;
+}
+
+
+/* Conversions from and to the intermediate color spaces. Each one is a pair
+ * of a Triplet function and the batched loop calling it; the loop converts in
+ * place safely for the same reason as the scalar kernels. */
+
+typedef int (*StageFunc)(Triplet* in_out, BoundsCache* cache);
+
+static int
+stage_n(StageFunc func, const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    BoundsCache cache;
+    size_t i;
+    int ret = 0;
+
+    bounds_cache_init(&cache, &srgb_space);
+    for(i = 0; i < n; i++) {
+        Triplet tmp = { in[i * in_stride], in[i * in_stride + 1], in[i * in_stride + 2] };
+
+        if(func(&tmp, &cache) != 0)
+            ret = -1;
+
+        out[i * out_stride] = tmp.a;
+        out[i * out_stride + 1] = tmp.b;
+        out[i * out_stride + 2] = tmp.c;
+    }
+
+    return ret;
+}
+
+static int
+stage_hsluv2lch(Triplet* in_out, BoundsCache* cache)
+{
+    const HsluvBounds* bounds = bounds_for_l(cache, in_out->c);
+    HueSinCos hue;
+
+    hsluv2lch_stage(in_out, bounds, sectors_for_run(cache), cache->fast_trig, &hue);
+    return 0;
+}
+
+static int
+stage_lch2hsluv(Triplet* in_out, BoundsCache* cache)
+{
+    const HsluvBounds* bounds = bounds_for_l(cache, in_out->a);
+    HueSinCos hue;
+
+    hue_sincos(in_out->c, cache->fast_trig, &hue);
+    lch2hsluv_stage(in_out, bounds, sectors_for_run(cache), &hue);
+    clamp_hsl(in_out);
+    return 0;
+}
+
+static int
+stage_hpluv2lch(Triplet* in_out, BoundsCache* cache)
+{
+    HueSinCos hue;
+
+    hpluv2lch_stage(in_out, safe_bounds_for_l(cache, in_out->c), cache->fast_trig, &hue);
+    return 0;
+}
+
+static int
+stage_lch2hpluv(Triplet* in_out, BoundsCache* cache)
+{
+    lch2hpluv_stage(in_out, safe_bounds_for_l(cache, in_out->a));
+    return clamp_hpl(in_out);
+}
+
+static int
+stage_hsluv2xyz(Triplet* in_out, BoundsCache* cache)
+{
+    hsluv2xyz_triplet(in_out, cache);
+    return 0;
+}
+
+static int
+stage_xyz2hsluv(Triplet* in_out, BoundsCache* cache)
+{
+    xyz2hsluv_triplet(in_out, cache);
+    return 0;
+}
+
+static int
+stage_hpluv2xyz(Triplet* in_out, BoundsCache* cache)
+{
+    hpluv2xyz_triplet(in_out, cache);
+    return 0;
+}
+
+static int
+stage_xyz2hpluv(Triplet* in_out, BoundsCache* cache)
+{
+    return xyz2hpluv_triplet(in_out, cache);
+}
+
+static int
+stage_hsluv2linrgb(Triplet* in_out, BoundsCache* cache)
+{
+    hsluv2xyz_triplet(in_out, cache);
+    xyz2linear(cache->space, in_out);
+    clamp_rgb(in_out);
+    return 0;
+}
+
+static int
+stage_linrgb2hsluv(Triplet* in_out, BoundsCache* cache)
+{
+    linear2xyz(cache->space, in_out);
+    xyz2hsluv_triplet(in_out, cache);
+    return 0;
+}
+
+static int
+stage_hpluv2linrgb(Triplet* in_out, BoundsCache* cache)
+{
+    hpluv2xyz_triplet(in_out, cache);
+    xyz2linear(cache->space, in_out);
+    clamp_rgb(in_out);
+    return 0;
+}
+
+static int
+stage_linrgb2hpluv(Triplet* in_out, BoundsCache* cache)
+{
+    linear2xyz(cache->space, in_out);
+    return xyz2hpluv_triplet(in_out, cache);
+}
+
+static int
+stage_1(StageFunc func, double a, double b, double c, double* px, double* py, double* pz)
+{
+    Triplet tmp = { a, b, c };
+    BoundsCache cache;
+    int ret;
+
+    bounds_cache_init(&cache, &srgb_space);
+    ret = func(&tmp, &cache);
+
+    *px = tmp.a;
+    *py = tmp.b;
+    *pz = tmp.c;
+
+    return ret;
+}
+
+void
+hsluv2lch(double h, double s, double l, double* pl, double* pc, double* ph)
+{
+    stage_1(stage_hsluv2lch, h, s, l, pl, pc, ph);
+}
+
+void
+lch2hsluv(double l, double c, double h, double* ph, double* ps, double* pl)
+{
+    stage_1(stage_lch2hsluv, l, c, h, ph, ps, pl);
+}
+
+void
+hpluv2lch(double h, double s, double l, double* pl, double* pc, double* ph)
+{
+    stage_1(stage_hpluv2lch, h, s, l, pl, pc, ph);
+}
+
+int
+lch2hpluv(double l, double c, double h, double* ph, double* ps, double* pl)
+{
+    return stage_1(stage_lch2hpluv, l, c, h, ph, ps, pl);
+}
+
+void
+hsluv2xyz(double h, double s, double l, double* px, double* py, double* pz)
+{
+    stage_1(stage_hsluv2xyz, h, s, l, px, py, pz);
+}
+
+void
+xyz2hsluv(double x, double y, double z, double* ph, double* ps, double* pl)
+{
+    stage_1(stage_xyz2hsluv, x, y, z, ph, ps, pl);
+}
+
+void
+hpluv2xyz(double h, double s, double l, double* px, double* py, double* pz)
+{
+    stage_1(stage_hpluv2xyz, h, s, l, px, py, pz);
+}
+
+int
+xyz2hpluv(double x, double y, double z, double* ph, double* ps, double* pl)
+{
+    return stage_1(stage_xyz2hpluv, x, y, z, ph, ps, pl);
+}
+
+void
+hsluv2linrgb(double h, double s, double l, double* pr, double* pg, double* pb)
+{
+    stage_1(stage_hsluv2linrgb, h, s, l, pr, pg, pb);
+}
+
+void
+linrgb2hsluv(double r, double g, double b, double* ph, double* ps, double* pl)
+{
+    stage_1(stage_linrgb2hsluv, r, g, b, ph, ps, pl);
+}
+
+void
+hpluv2linrgb(double h, double s, double l, double* pr, double* pg, double* pb)
+{
+    stage_1(stage_hpluv2linrgb, h, s, l, pr, pg, pb);
+}
+
+int
+linrgb2hpluv(double r, double g, double b, double* ph, double* ps, double* pl)
+{
+    return stage_1(stage_linrgb2hpluv, r, g, b, ph, ps, pl);
+}
+
+void
+hsluv2lch_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    stage_n(stage_hsluv2lch, in, in_stride, out, out_stride, n);
+}
+
+void
+lch2hsluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    stage_n(stage_lch2hsluv, in, in_stride, out, out_stride, n);
+}
+
+void
+hpluv2lch_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    stage_n(stage_hpluv2lch, in, in_stride, out, out_stride, n);
+}
+
+int
+lch2hpluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    return stage_n(stage_lch2hpluv, in, in_stride, out, out_stride, n);
+}
+
+void
+hsluv2xyz_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    stage_n(stage_hsluv2xyz, in, in_stride, out, out_stride, n);
+}
+
+void
+xyz2hsluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    stage_n(stage_xyz2hsluv, in, in_stride, out, out_stride, n);
+}
+
+void
+hpluv2xyz_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    stage_n(stage_hpluv2xyz, in, in_stride, out, out_stride, n);
+}
+
+int
+xyz2hpluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    return stage_n(stage_xyz2hpluv, in, in_stride, out, out_stride, n);
+}
+
+void
+hsluv2linrgb_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    stage_n(stage_hsluv2linrgb, in, in_stride, out, out_stride, n);
+}
+
+void
+linrgb2hsluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    stage_n(stage_linrgb2hsluv, in, in_stride, out, out_stride, n);
+}
+
+void
+hpluv2linrgb_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    stage_n(stage_hpluv2linrgb, in, in_stride, out, out_stride, n);
+}
+
+int
+linrgb2hpluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    return stage_n(stage_linrgb2hpluv, in, in_stride, out, out_stride, n);
+}
+
+
+/* Gamut clipping of LCh colors. The batched loop gets colors of any
+ * lightnesses in any order, so instead of BoundsCache it keeps the bounds of
+ * several lightnesses in a small direct-mapped table indexed by a hash of the
+ * lightness. */
+
+#ifndef HSLUV_CLIP_BOUNDS_TABLE_SIZE
+    #define HSLUV_CLIP_BOUNDS_TABLE_SIZE    64  /* Must be a power of 2. */
+#endif
+
+typedef struct BoundsTable_tag BoundsTable;
+struct BoundsTable_tag {
+    HsluvBounds bounds[HSLUV_CLIP_BOUNDS_TABLE_SIZE];
+    unsigned char valid[HSLUV_CLIP_BOUNDS_TABLE_SIZE];
+};
+
+static const HsluvBounds*
+bounds_table_for_l(BoundsTable* table, double l)
+{
+    uint64_t bits;
+    size_t i;
+
+    memcpy(&bits, &l, sizeof(bits));
+    i = (size_t) ((bits * 0x9e3779b97f4a7c15ull) >> 32) & (HSLUV_CLIP_BOUNDS_TABLE_SIZE - 1);
+
+    if(!table->valid[i]  ||  table->bounds[i].l != l) {
+        get_bounds(&srgb_space, l, &table->bounds[i]);
+        table->valid[i] = 1;
+    }
+
+    return &table->bounds[i];
+}
+
+/* Returns -1 if the color had to be changed. The bounds are NULL for white
+ * and black (and beyond), which get no chroma at all. */
+static int
+lch_clip_triplet(Triplet* in_out, const HsluvBounds* bounds)
+{
+    double l = in_out->a;
+    double c = in_out->b;
+    int ret = 0;
+
+    /* Negative chroma is not valid, and NaN is not in the gamut either:
+     * both become gray. */
+    if(!(c >= 0.0)) {
+        c = 0.0;
+        in_out->b = 0.0;
+        ret = -1;
+    }
+
+    if(bounds == NULL) {
+        if(l > 100.0) {
+            in_out->a = 100.0;
+            ret = -1;
+        } else if(l < 0.0) {
+            in_out->a = 0.0;
+            ret = -1;
+        }
+        if(c > 0.00000001)
+            ret = -1;
+        in_out->b = 0.0;
+    } else {
+        HueSinCos hue;
+        double max_c;
+
+        hue_sincos(in_out->c, 0, &hue);
+        max_c = max_chroma_for_bounds(bounds, &hue);
+        if(c > max_c) {
+            in_out->b = max_c;
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+static int
+is_extreme_l(double l)
+{
+    return (l > 99.9999999 || l < 0.00000001);
+}
+
+int
+lch_clip_gamut(double l, double c, double h, double* pl, double* pc, double* ph)
+{
+    HsluvBounds bounds;
+    Triplet tmp = { l, c, h };
+    int ret;
+
+    if(!is_extreme_l(l))
+        get_bounds(&srgb_space, l, &bounds);
+    ret = lch_clip_triplet(&tmp, is_extreme_l(l) ? NULL : &bounds);
+
+    *pl = tmp.a;
+    *pc = tmp.b;
+    *ph = tmp.c;
+    return ret;
+}
+
+int
+lch_clip_gamut_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    BoundsTable table;
+    size_t i;
+    int ret = 0;
+
+    memset(table.valid, 0, sizeof(table.valid));
+    for(i = 0; i < n; i++) {
+        Triplet tmp = { in[i * in_stride], in[i * in_stride + 1], in[i * in_stride + 2] };
+
+        const HsluvBounds* bounds = (is_extreme_l(tmp.a) ? NULL : bounds_table_for_l(&table, tmp.a));
+
+        if(lch_clip_triplet(&tmp, bounds) != 0)
+            ret = -1;
+
+        out[i * out_stride] = tmp.a;
+        out[i * out_stride + 1] = tmp.b;
+        out[i * out_stride + 2] = tmp.c;
+    }
+
+    return ret;
+}
+
+
+/* Runtime kernel dispatch.
+ *
+ * The CPU features are detected once, on the first use of any batched
+ * function. From then on, each call costs just one pointer load. */
+
+typedef struct KernelTable_tag KernelTable;
+struct KernelTable_tag {
+    HsluvKernel id;
+    const char* name;
+    HsluvKernelFunc hsluv2rgb;
+    HsluvKernelFunc hpluv2rgb;
+    HsluvKernelFunc rgb2hsluv;
+    HsluvKernelFunc rgb2hpluv;
+    HsluvKernelFuncF hsluv2rgbf;
+    HsluvKernelFuncF hpluv2rgbf;
+    HsluvKernelFuncF rgb2hsluvf;
+    HsluvKernelFuncF rgb2hpluvf;
+    HsluvEditFunc edit_rgb;
+    HsluvSpaceKernelFunc hsluv2rgb_space;
+    HsluvSpaceKernelFunc hpluv2rgb_space;
+    HsluvSpaceKernelFunc rgb2hsluv_space;
+    HsluvSpaceKernelFunc rgb2hpluv_space;
+    HsluvSpaceKernelFuncF hsluv2rgbf_space;
+    HsluvSpaceKernelFuncF hpluv2rgbf_space;
+    HsluvSpaceKernelFuncF rgb2hsluvf_space;
+    HsluvSpaceKernelFuncF rgb2hpluvf_space;
+    HsluvLut3dFunc lut3d_rgb2hsluv;
+    HsluvLut3dFuncF lut3d_rgb2hsluvf;
+};
+
+#define KERNEL_TABLE(id, name, prefix, prefix_float)                       \
+    { id, name, prefix##_hsluv2rgb, prefix##_hpluv2rgb,                    \
+      prefix##_rgb2hsluv, prefix##_rgb2hpluv,                              \
+      prefix_float##_hsluv2rgb, prefix_float##_hpluv2rgb,                  \
+      prefix_float##_rgb2hsluv, prefix_float##_rgb2hpluv,                  \
+      prefix##_edit_rgb,                                                   \
+      prefix##_hsluv2rgb_space, prefix##_hpluv2rgb_space,                  \
+      prefix##_rgb2hsluv_space, prefix##_rgb2hpluv_space,                  \
+      prefix_float##_hsluv2rgb_space, prefix_float##_hpluv2rgb_space,      \
+      prefix_float##_rgb2hsluv_space, prefix_float##_rgb2hpluv_space,      \
+      prefix##_lut3d_rgb2hsluv, prefix_float##_lut3d_rgb2hsluv }
+
+/* Ordered from the least to the most preferred one. */
+static const KernelTable kernel_tables[] = {
+    KERNEL_TABLE(HSLUV_KERNEL_SCALAR, "scalar", scalar, hsluv_scalar_float),
+#ifdef HSLUV_HAVE_SSE41
+    KERNEL_TABLE(HSLUV_KERNEL_SSE41, "sse4.1", hsluv_sse41, hsluv_sse41_float),
+#endif
+#ifdef HSLUV_HAVE_NEON
+    KERNEL_TABLE(HSLUV_KERNEL_NEON, "neon", hsluv_neon, hsluv_neon_float),
+#endif
+#ifdef HSLUV_HAVE_AVX2
+    KERNEL_TABLE(HSLUV_KERNEL_AVX2, "avx2", hsluv_avx2, hsluv_avx2_float),
+#endif
+#ifdef HSLUV_HAVE_AVX512
+    KERNEL_TABLE(HSLUV_KERNEL_AVX512, "avx512", hsluv_avx512, hsluv_avx512_float),
+#endif
+};
+
+#define KERNEL_TABLE_COUNT  ((int)(sizeof(kernel_tables) / sizeof(kernel_tables[0])))
+
+#if defined HSLUV_HAVE_SSE41  ||  defined HSLUV_HAVE_AVX2  ||  defined HSLUV_HAVE_AVX512
+    #define HAVE_X86_KERNELS
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+#ifdef HAVE_X86_KERNELS
+static void
+x86_cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4])
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, (int) leaf, (int) subleaf);
+    regs[0] = (unsigned) info[0];
+    regs[1] = (unsigned) info[1];
+    regs[2] = (unsigned) info[2];
+    regs[3] = (unsigned) info[3];
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/* Register state the OS saves on context switch (XCR0). */
+static unsigned
+x86_xgetbv(void)
+{
+#ifdef _MSC_VER
+    return (unsigned) _xgetbv(0);
+#else
+    unsigned lo, hi;
+    /* xgetbv, spelled out for assemblers which do not know it. */
+    __asm__ volatile(".byte 0x0f, 0x01, 0xd0" : "=a" (lo), "=d" (hi) : "c" (0));
+    return lo;
+#endif
+}
+#endif
+
+static int
+kernel_cpu_supported(HsluvKernel id)
+{
+#ifdef HAVE_X86_KERNELS
+    unsigned regs[4];
+    unsigned max_leaf;
+    unsigned xcr0 = 0;
+    int has_avx_os = 0;
+
+    x86_cpuid(0, 0, regs);
+    max_leaf = regs[0];
+    x86_cpuid(1, 0, regs);
+
+    if(id == HSLUV_KERNEL_SSE41)
+        return (regs[2] & (1u << 19)) != 0;
+
+    /* AVX2 and AVX-512 need the OS to preserve the wider registers. */
+    if((regs[2] & (1u << 27)) != 0) {   /* OSXSAVE */
+        xcr0 = x86_xgetbv();
+        has_avx_os = ((xcr0 & 0x06) == 0x06);
+    }
+
+    if(id == HSLUV_KERNEL_AVX2) {
+        int has_fma = ((regs[2] & (1u << 12)) != 0);
+        if(!has_avx_os  ||  !has_fma  ||  max_leaf < 7)
+            return 0;
+        x86_cpuid(7, 0, regs);
+        return (regs[1] & (1u << 5)) != 0;
+    }
+
+    if(id == HSLUV_KERNEL_AVX512) {
+        if(!has_avx_os  ||  (xcr0 & 0xe0) != 0xe0  ||  max_leaf < 7)
+            return 0;
+        x86_cpuid(7, 0, regs);
+        return (regs[1] & (1u << 16)) != 0;
+    }
+#endif
+
+    /* Advanced SIMD is a mandatory part of AArch64, so NEON needs no
+     * detection (nor getauxval()). */
+    return (id == HSLUV_KERNEL_SCALAR  ||  id == HSLUV_KERNEL_NEON);
+}
+
+static const KernelTable*
+find_kernel(HsluvKernel id)
+{
+    int i;
+
+    for(i = 0; i < KERNEL_TABLE_COUNT; i++) {
+        if(kernel_tables[i].id == id)
+            return &kernel_tables[i];
+    }
+    return NULL;
+}
+
+static const KernelTable*
+best_kernel(void)
+{
+    int i;
+
+    for(i = KERNEL_TABLE_COUNT - 1; i > 0; i--) {
+        if(kernel_cpu_supported(kernel_tables[i].id))
+            return &kernel_tables[i];
+    }
+    return &kernel_tables[0];
+}
+
+/* Set on the first use, or by hsluv_set_kernel(), and read by every batched
+ * call, possibly from several threads at once. So it is accessed atomically:
+ * the tables it points to are constant, thus relaxed ordering is enough.
+ * Concurrent first uses may all store best_kernel(), which is harmless once
+ * the stores are atomic. Without C11 atomics nor the GCC builtins, it falls
+ * back to a volatile pointer; that is formally a data race, though aligned
+ * pointer loads and stores do not tear on any CPU with a kernel here. */
+#if defined __STDC_VERSION__  &&  __STDC_VERSION__ >= 201112L  &&  !defined __STDC_NO_ATOMICS__
+    #include <stdatomic.h>
+    static const KernelTable* _Atomic active_kernel = NULL;
+    #define ACTIVE_KERNEL_LOAD()    atomic_load_explicit(&active_kernel, memory_order_relaxed)
+    #define ACTIVE_KERNEL_STORE(k)  atomic_store_explicit(&active_kernel, (k), memory_order_relaxed)
+#elif defined __GNUC__  ||  defined __clang__
+    static const KernelTable* active_kernel = NULL;
+    #define ACTIVE_KERNEL_LOAD()    __atomic_load_n(&active_kernel, __ATOMIC_RELAXED)
+    #define ACTIVE_KERNEL_STORE(k)  __atomic_store_n(&active_kernel, (k), __ATOMIC_RELAXED)
+#else
+    static const KernelTable* volatile active_kernel = NULL;
+    #define ACTIVE_KERNEL_LOAD()    (active_kernel)
+    #define ACTIVE_KERNEL_STORE(k)  (active_kernel = (k))
+#endif
+
+static const KernelTable*
+kernel(void)
+{
+    const KernelTable* k = ACTIVE_KERNEL_LOAD();
+
+    if(k == NULL) {
+        k = best_kernel();
+        ACTIVE_KERNEL_STORE(k);
+    }
+    return k;
+}
+
+/* The kernel for a batched call of n colors. */
+static const KernelTable*
+kernel_n(size_t n)
+{
+    const KernelTable* k = kernel();
+
+    STATS_KERNEL(k->id, n);
+    (void) n;
+    return k;
+}
+
+int
+hsluv_kernel_available(HsluvKernel id)
+{
+    if(id == HSLUV_KERNEL_AUTO)
+        return 1;
+    return (find_kernel(id) != NULL  &&  kernel_cpu_supported(id));
+}
+
+int
+hsluv_set_kernel(HsluvKernel id)
+{
+    if(id == HSLUV_KERNEL_AUTO) {
+        ACTIVE_KERNEL_STORE(best_kernel());
+        return 0;
+    }
+
+    if(!hsluv_kernel_available(id))
+        return -1;
+    ACTIVE_KERNEL_STORE(find_kernel(id));
+    return 0;
+}
+
+HsluvKernel
+hsluv_get_kernel(void)
+{
+    return kernel()->id;
+}
+
+const char*
+hsluv_kernel_name(HsluvKernel id)
+{
+    const KernelTable* k;
+
+    if(id == HSLUV_KERNEL_AUTO)
+        return "auto";
+    k = find_kernel(id);
+    return (k != NULL) ? k->name : NULL;
+}
+
+
+void
+hsluv2rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    kernel_n(n)->hsluv2rgb(in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+hpluv2rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    kernel_n(n)->hpluv2rgb(in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+rgb2hsluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    kernel_n(n)->rgb2hsluv(in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+int
+rgb2hpluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    return kernel_n(n)->rgb2hpluv(in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+hsluv2rgb_planar_n(const double* h, const double* s, const double* l, size_t in_stride,
+                   double* r, double* g, double* b, size_t out_stride, size_t n)
+{
+    kernel_n(n)->hsluv2rgb(h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+void
+hpluv2rgb_planar_n(const double* h, const double* s, const double* l, size_t in_stride,
+                   double* r, double* g, double* b, size_t out_stride, size_t n)
+{
+    kernel_n(n)->hpluv2rgb(h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+void
+rgb2hsluv_planar_n(const double* r, const double* g, const double* b, size_t in_stride,
+                   double* h, double* s, double* l, size_t out_stride, size_t n)
+{
+    kernel_n(n)->rgb2hsluv(r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+int
+rgb2hpluv_planar_n(const double* r, const double* g, const double* b, size_t in_stride,
+                   double* h, double* s, double* l, size_t out_stride, size_t n)
+{
+    return kernel_n(n)->rgb2hpluv(r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+static void
+edit_rgb_n(const Edit* edit, const double* in, size_t in_stride, double* out, size_t out_stride, size_t n)
+{
+    kernel_n(n)->edit_rgb(in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n, edit);
+}
+
+static void
+edit_init(Edit* edit, EditOp op)
+{
+    edit->op = op;
+    edit->sin_d = 0.0;
+    edit->cos_d = 1.0;
+    edit->l = 0.0;
+    edit->has_sectors = 0;
+    edit->factor = 1.0;
+}
+
+void
+hsluv_rotate_hue_rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride,
+                       size_t n, double degrees)
+{
+    Edit edit;
+    HueSinCos rotation;
+
+    edit_init(&edit, EDIT_ROTATE_HUE);
+    hue_sincos(fmod(degrees, 360.0), 0, &rotation);
+    edit.sin_d = rotation.sin;
+    edit.cos_d = rotation.cos;
+    edit_rgb_n(&edit, in, in_stride, out, out_stride, n);
+}
+
+void
+hsluv_set_lightness_rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride,
+                          size_t n, double l)
+{
+    Edit edit;
+
+    edit_init(&edit, EDIT_SET_LIGHTNESS);
+    edit.l = CLAMP(l, 0.0, 100.0);
+    if(!(edit.l > 99.9999999 || edit.l < 0.00000001)) {
+        HsluvBounds bounds;
+
+        /* All the colors get the new lightness: select the chroma by sectors. */
+        get_bounds(&srgb_space, edit.l, &bounds);
+        edit.has_sectors = (hue_sectors_init(&bounds, &edit.sectors) == 0);
+    }
+    edit_rgb_n(&edit, in, in_stride, out, out_stride, n);
+}
+
+void
+hsluv_scale_saturation_rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride,
+                             size_t n, double factor)
+{
+    Edit edit;
+
+    edit_init(&edit, EDIT_SCALE_SATURATION);
+    edit.factor = factor;
+    edit_rgb_n(&edit, in, in_stride, out, out_stride, n);
+}
+
+void
+hsluv2rgbf_n(const float* in, size_t in_stride, float* out, size_t out_stride, size_t n)
+{
+    kernel_n(n)->hsluv2rgbf(in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+hpluv2rgbf_n(const float* in, size_t in_stride, float* out, size_t out_stride, size_t n)
+{
+    kernel_n(n)->hpluv2rgbf(in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+rgb2hsluvf_n(const float* in, size_t in_stride, float* out, size_t out_stride, size_t n)
+{
+    kernel_n(n)->rgb2hsluvf(in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+int
+rgb2hpluvf_n(const float* in, size_t in_stride, float* out, size_t out_stride, size_t n)
+{
+    return kernel_n(n)->rgb2hpluvf(in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+hsluv2rgbf_planar_n(const float* h, const float* s, const float* l, size_t in_stride,
+                    float* r, float* g, float* b, size_t out_stride, size_t n)
+{
+    kernel_n(n)->hsluv2rgbf(h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+void
+hpluv2rgbf_planar_n(const float* h, const float* s, const float* l, size_t in_stride,
+                    float* r, float* g, float* b, size_t out_stride, size_t n)
+{
+    kernel_n(n)->hpluv2rgbf(h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+void
+rgb2hsluvf_planar_n(const float* r, const float* g, const float* b, size_t in_stride,
+                    float* h, float* s, float* l, size_t out_stride, size_t n)
+{
+    kernel_n(n)->rgb2hsluvf(r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+int
+rgb2hpluvf_planar_n(const float* r, const float* g, const float* b, size_t in_stride,
+                    float* h, float* s, float* l, size_t out_stride, size_t n)
+{
+    return kernel_n(n)->rgb2hpluvf(r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+
+/* Batched conversions in RGB working spaces. NULL takes the kernels of the
+ * plain functions with the sRGB constants folded in. */
+
+void
+hsluv2rgb_space_n(const HsluvRgbSpace* space, const double* in, size_t in_stride,
+                  double* out, size_t out_stride, size_t n)
+{
+    hsluv2rgb_space_planar_n(space, in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+hsluv2rgb_space_planar_n(const HsluvRgbSpace* space,
+                         const double* h, const double* s, const double* l, size_t in_stride,
+                         double* r, double* g, double* b, size_t out_stride, size_t n)
+{
+    const KernelTable* k = kernel_n(n);
+
+    if(space == NULL)
+        k->hsluv2rgb(h, s, l, in_stride, r, g, b, out_stride, n);
+    else
+        k->hsluv2rgb_space(space, h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+void
+hpluv2rgb_space_n(const HsluvRgbSpace* space, const double* in, size_t in_stride,
+                  double* out, size_t out_stride, size_t n)
+{
+    hpluv2rgb_space_planar_n(space, in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+hpluv2rgb_space_planar_n(const HsluvRgbSpace* space,
+                         const double* h, const double* s, const double* l, size_t in_stride,
+                         double* r, double* g, double* b, size_t out_stride, size_t n)
+{
+    const KernelTable* k = kernel_n(n);
+
+    if(space == NULL)
+        k->hpluv2rgb(h, s, l, in_stride, r, g, b, out_stride, n);
+    else
+        k->hpluv2rgb_space(space, h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+void
+rgb2hsluv_space_n(const HsluvRgbSpace* space, const double* in, size_t in_stride,
+                  double* out, size_t out_stride, size_t n)
+{
+    rgb2hsluv_space_planar_n(space, in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+rgb2hsluv_space_planar_n(const HsluvRgbSpace* space,
+                         const double* r, const double* g, const double* b, size_t in_stride,
+                         double* h, double* s, double* l, size_t out_stride, size_t n)
+{
+    const KernelTable* k = kernel_n(n);
+
+    if(space == NULL)
+        k->rgb2hsluv(r, g, b, in_stride, h, s, l, out_stride, n);
+    else
+        k->rgb2hsluv_space(space, r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+int
+rgb2hpluv_space_n(const HsluvRgbSpace* space, const double* in, size_t in_stride,
+                  double* out, size_t out_stride, size_t n)
+{
+    return rgb2hpluv_space_planar_n(space, in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+int
+rgb2hpluv_space_planar_n(const HsluvRgbSpace* space,
+                         const double* r, const double* g, const double* b, size_t in_stride,
+                         double* h, double* s, double* l, size_t out_stride, size_t n)
+{
+    const KernelTable* k = kernel_n(n);
+
+    if(space == NULL)
+        return k->rgb2hpluv(r, g, b, in_stride, h, s, l, out_stride, n);
+    return k->rgb2hpluv_space(space, r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+void
+hsluv2rgbf_space_n(const HsluvRgbSpace* space, const float* in, size_t in_stride,
+                   float* out, size_t out_stride, size_t n)
+{
+    hsluv2rgbf_space_planar_n(space, in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+hsluv2rgbf_space_planar_n(const HsluvRgbSpace* space,
+                          const float* h, const float* s, const float* l, size_t in_stride,
+                          float* r, float* g, float* b, size_t out_stride, size_t n)
+{
+    const KernelTable* k = kernel_n(n);
+
+    if(space == NULL)
+        k->hsluv2rgbf(h, s, l, in_stride, r, g, b, out_stride, n);
+    else
+        k->hsluv2rgbf_space(space, h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+void
+hpluv2rgbf_space_n(const HsluvRgbSpace* space, const float* in, size_t in_stride,
+                   float* out, size_t out_stride, size_t n)
+{
+    hpluv2rgbf_space_planar_n(space, in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+hpluv2rgbf_space_planar_n(const HsluvRgbSpace* space,
+                          const float* h, const float* s, const float* l, size_t in_stride,
+                          float* r, float* g, float* b, size_t out_stride, size_t n)
+{
+    const KernelTable* k = kernel_n(n);
+
+    if(space == NULL)
+        k->hpluv2rgbf(h, s, l, in_stride, r, g, b, out_stride, n);
+    else
+        k->hpluv2rgbf_space(space, h, s, l, in_stride, r, g, b, out_stride, n);
+}
+
+void
+rgb2hsluvf_space_n(const HsluvRgbSpace* space, const float* in, size_t in_stride,
+                   float* out, size_t out_stride, size_t n)
+{
+    rgb2hsluvf_space_planar_n(space, in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+void
+rgb2hsluvf_space_planar_n(const HsluvRgbSpace* space,
+                          const float* r, const float* g, const float* b, size_t in_stride,
+                          float* h, float* s, float* l, size_t out_stride, size_t n)
+{
+    const KernelTable* k = kernel_n(n);
+
+    if(space == NULL)
+        k->rgb2hsluvf(r, g, b, in_stride, h, s, l, out_stride, n);
+    else
+        k->rgb2hsluvf_space(space, r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+int
+rgb2hpluvf_space_n(const HsluvRgbSpace* space, const float* in, size_t in_stride,
+                   float* out, size_t out_stride, size_t n)
+{
+    return rgb2hpluvf_space_planar_n(space, in, in + 1, in + 2, in_stride, out, out + 1, out + 2, out_stride, n);
+}
+
+int
+rgb2hpluvf_space_planar_n(const HsluvRgbSpace* space,
+                          const float* r, const float* g, const float* b, size_t in_stride,
+                          float* h, float* s, float* l, size_t out_stride, size_t n)
+{
+    const KernelTable* k = kernel_n(n);
+
+    if(space == NULL)
+        return k->rgb2hpluvf(r, g, b, in_stride, h, s, l, out_stride, n);
+    return k->rgb2hpluvf_space(space, r, g, b, in_stride, h, s, l, out_stride, n);
+}
+
+
+/* For the vector kernels (see vrun_sectors() in hsluv-simd.h). */
+
+int
+hsluv_hue_sectors_for_l(const HsluvRgbSpace* space, double l, HueSectors* sectors)
+{
+    HsluvBounds bounds;
+
+    if(l > 99.9999999 || l < 0.00000001)
+        return -1;
+
+    get_bounds(space, l, &bounds);
+    return hue_sectors_init(&bounds, sectors);
+}
+
+
+/* For hsluv-lut3d.c. */
+
+int
+hsluv_lut3d_kernel(const Lut3d* lut, const double* in, size_t in_stride,
+                   double* out, size_t out_stride, size_t n)
+{
+    return kernel_n(n)->lut3d_rgb2hsluv(in, in + 1, in + 2, in_stride,
+                                        out, out + 1, out + 2, out_stride, n, lut);
+}
+
+int
+hsluv_lut3d_kernelf(const Lut3d* lut, const float* in, size_t in_stride,
+                    float* out, size_t out_stride, size_t n)
+{
+    return kernel_n(n)->lut3d_rgb2hsluvf(in, in + 1, in + 2, in_stride,
+                                         out, out + 1, out + 2, out_stride, n, lut);
+}
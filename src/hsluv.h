@@ -29,6 +29,35 @@
 #ifndef HSLUV_H
 #define HSLUV_H
 
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * Header-only build.
+ *
+ * Instead of building the library, one source file of the application may
+ * define @c HSLUV_IMPLEMENTATION before including this header, which then
+ * brings in the whole portable implementation (@c hsluv.c and
+ * @c hsluv-float.c; the other headers of @c src/ must be reachable in the
+ * include path). The vectorized kernels need their own compiler flags, so
+ * they are not included; build them separately and define the respective
+ * @c HSLUV_HAVE_xxx to use them.
+ *
+ * If @c HSLUV_STATIC is defined as well, all the functions are defined as
+ * <tt>static inline</tt>. The compiler may then inline the conversions into
+ * the callers and specialize them for constant arguments, without any link
+ * time optimization. (The global settings like hsluv_set_kernel() then apply
+ * only to the source file which has included the implementation.)
+ */
+#ifndef HSLUV_API
+    #if defined HSLUV_IMPLEMENTATION  &&  defined HSLUV_STATIC
+        #define HSLUV_API   static inline
+    #else
+        #define HSLUV_API
+    #endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -44,7 +73,7 @@ extern "C" {
  * @param[out] pg Green component. Between 0.0 and 1.0.
  * @param[out] pb Blue component. Between 0.0 and 1.0.
  */
-void hsluv2rgb(double h, double s, double l, double* pr, double* pg, double* pb);
+HSLUV_API void hsluv2rgb(double h, double s, double l, double* pr, double* pg, double* pb);
 
 /**
  * Convert RGB to HSLuv.
@@ -56,7 +85,7 @@ void hsluv2rgb(double h, double s, double l, double* pr, double* pg, double* pb)
  * @param[out] ps Saturation. Between 0.0 and 100.0.
  * @param[out] pl Lightness. Between 0.0 and 100.0.
  */
-void rgb2hsluv(double r, double g, double b, double* ph, double* ps, double* pl);
+HSLUV_API void rgb2hsluv(double r, double g, double b, double* ph, double* ps, double* pl);
 
 /**
  * Convert HPLuv to RGB.
@@ -68,7 +97,7 @@ void rgb2hsluv(double r, double g, double b, double* ph, double* ps, double* pl)
  * @param[out] pg Green component. Between 0.0 and 1.0.
  * @param[out] pb Blue component. Between 0.0 and 1.0.
  */
-void hpluv2rgb(double h, double s, double l, double* pr, double* pg, double* pb);
+HSLUV_API void hpluv2rgb(double h, double s, double l, double* pr, double* pg, double* pb);
 
 /**
  * Convert RGB to HPLuv.
@@ -103,11 +132,767 @@ void hpluv2rgb(double h, double s, double l, double* pr, double* pg, double* pb)
  * @return Returns 0 if the RGB triplet is representable in the HPLuv color
  * space, -1 otherwise.
  */
-int rgb2hpluv(double r, double g, double b, double* ph, double* ps, double* pl);
+HSLUV_API int rgb2hpluv(double r, double g, double b, double* ph, double* ps, double* pl);
+
+
+/**
+ * Colors passed by value.
+ *
+ * @c HsluvHsl holds an HSLuv or an HPLuv color, @c HsluvRgb an RGB color, with
+ * the same ranges as the arguments of the functions above.
+ */
+typedef struct HsluvHsl_tag HsluvHsl;
+struct HsluvHsl_tag {
+    double h;
+    double s;
+    double l;
+};
+
+typedef struct HsluvRgb_tag HsluvRgb;
+struct HsluvRgb_tag {
+    double r;
+    double g;
+    double b;
+};
+
+/**
+ * Single-color conversions taking and returning the colors by value.
+ *
+ * These are the same conversions as hsluv2rgb() and friends (which are just
+ * wrappers of these), without the output pointers: the compiler does not have
+ * to assume the outputs may alias anything, and where the ABI passes small
+ * structures in registers (e.g. AArch64 for both precisions, x86-64 System V
+ * for the single precision variants below), the colors do not go through
+ * memory at all.
+ *
+ * rgb2hpluv_v() has no return value: whether the color is representable in
+ * HPLuv can be told from the saturation (see rgb2hpluv()).
+ */
+HSLUV_API HsluvRgb hsluv2rgb_v(HsluvHsl hsl);
+HSLUV_API HsluvHsl rgb2hsluv_v(HsluvRgb rgb);
+HSLUV_API HsluvRgb hpluv2rgb_v(HsluvHsl hpl);
+HSLUV_API HsluvHsl rgb2hpluv_v(HsluvRgb rgb);
+
+
+/**
+ * Precomputed bounds of the RGB gamut for a given lightness.
+ *
+ * The costly part of HSLuv and HPLuv conversions is finding the maximal chroma
+ * of the color: it depends on the lightness only through six lines bounding
+ * the RGB gamut in the (u, v) plane of CIELUV. When converting many colors of
+ * the same lightness (e.g. a hue wheel or a palette of one lightness), compute
+ * the bounds once with hsluv_bounds_init() and pass them to
+ * hsluv2rgb_bounds() or hpluv2rgb_bounds().
+ *
+ * The members are filled by hsluv_bounds_init(); application should treat
+ * them as read-only.
+ */
+typedef struct HsluvBounds_tag HsluvBounds;
+struct HsluvBounds_tag {
+    double l;                   /**< The lightness the bounds are for. */
+    double max_safe_chroma;     /**< Maximal chroma valid for any hue. */
+    double a[6];                /**< Slopes of the bounding lines. */
+    double b[6];                /**< Intercepts of the bounding lines. */
+};
+
+/**
+ * Compute bounds of the RGB gamut for the given lightness.
+ *
+ * @param[out] bounds The bounds.
+ * @param l Lightness. Between 0.0 and 100.0.
+ */
+HSLUV_API void hsluv_bounds_init(HsluvBounds* bounds, double l);
+
+/**
+ * Get the maximal chroma of an RGB color of the given hue and of the lightness
+ * of the bounds. This is the chroma of HSLuv saturation 100.0.
+ *
+ * @param bounds Bounds, as computed by hsluv_bounds_init().
+ * @param h Hue. Between 0.0 and 360.0.
+ * @return The chroma.
+ */
+HSLUV_API double hsluv_bounds_max_chroma(const HsluvBounds* bounds, double h);
+
+/**
+ * Convert HSLuv to RGB, using precomputed bounds.
+ *
+ * This is equivalent to <tt>hsluv2rgb(h, s, bounds->l, pr, pg, pb)</tt>.
+ *
+ * @param bounds Bounds, as computed by hsluv_bounds_init().
+ * @param h Hue. Between 0.0 and 360.0.
+ * @param s Saturation. Between 0.0 and 100.0.
+ * @param[out] pr Red component. Between 0.0 and 1.0.
+ * @param[out] pg Green component. Between 0.0 and 1.0.
+ * @param[out] pb Blue component. Between 0.0 and 1.0.
+ */
+HSLUV_API void hsluv2rgb_bounds(const HsluvBounds* bounds, double h, double s,
+                                double* pr, double* pg, double* pb);
+
+/**
+ * Convert HPLuv to RGB, using precomputed bounds.
+ *
+ * This is equivalent to <tt>hpluv2rgb(h, s, bounds->l, pr, pg, pb)</tt>.
+ *
+ * @param bounds Bounds, as computed by hsluv_bounds_init().
+ * @param h Hue. Between 0.0 and 360.0.
+ * @param s Saturation. Between 0.0 and 100.0.
+ * @param[out] pr Red component. Between 0.0 and 1.0.
+ * @param[out] pg Green component. Between 0.0 and 1.0.
+ * @param[out] pb Blue component. Between 0.0 and 1.0.
+ */
+HSLUV_API void hpluv2rgb_bounds(const HsluvBounds* bounds, double h, double s,
+                                double* pr, double* pg, double* pb);
+
+/**
+ * Generate a gradient between two HSLuv colors.
+ *
+ * Fills @c out (laid out as the output of hsluv2rgb_n()) with @c n RGB colors
+ * going linearly in HSLuv from the first color to the second one, both
+ * included. (For @c n == 1, just the first color.) The hue goes the shorter
+ * way around the circle.
+ *
+ * This is faster than converting the colors one by one: the sine and cosine
+ * of the hues are computed incrementally, and if both colors have the same
+ * lightness, the bounds of the gamut are computed just once. The result
+ * differs from hsluv2rgb() of the interpolated colors by less than 1e-9.
+ *
+ * @param h0 Hue of the first color. Between 0.0 and 360.0.
+ * @param s0 Saturation of the first color. Between 0.0 and 100.0.
+ * @param l0 Lightness of the first color. Between 0.0 and 100.0.
+ * @param h1 Hue of the last color. Between 0.0 and 360.0.
+ * @param s1 Saturation of the last color. Between 0.0 and 100.0.
+ * @param l1 Lightness of the last color. Between 0.0 and 100.0.
+ * @param[out] out Buffer for the RGB colors.
+ * @param out_stride Distance between two consecutive output colors, in doubles.
+ * @param n Number of the colors.
+ */
+HSLUV_API void hsluv_gradient(double h0, double s0, double l0, double h1, double s1, double l1,
+                              double* out, size_t out_stride, size_t n);
+
+/**
+ * Generate a sweep of hues of one saturation and lightness.
+ *
+ * Same as hsluv_gradient(), but the color @c i has hue <tt>h + i * h_step</tt>
+ * (which may go around the circle any number of times). E.g. a categorical
+ * palette of @c n colors uses <tt>h_step = 360.0 / n</tt>.
+ *
+ * @param h Hue of the first color. Between 0.0 and 360.0.
+ * @param h_step Difference of the hues of two consecutive colors.
+ * @param s Saturation. Between 0.0 and 100.0.
+ * @param l Lightness. Between 0.0 and 100.0.
+ * @param[out] out Buffer for the RGB colors.
+ * @param out_stride Distance between two consecutive output colors, in doubles.
+ * @param n Number of the colors.
+ */
+HSLUV_API void hsluv_hue_sweep(double h, double h_step, double s, double l,
+                               double* out, size_t out_stride, size_t n);
+
+
+/**
+ * Lookup table for HPLuv.
+ *
+ * HPLuv conversions spend most of their time computing the maximal chroma
+ * which is safe for all hues of a given lightness. hpluv2rgb_lut() and
+ * rgb2hpluv_lut() interpolate it from a table of samples instead. The table
+ * is built once by hsluv_hpluv_lut_init() and only read afterwards, so one
+ * table may serve any number of threads; other conversions are not affected.
+ *
+ * With the default table size of 257 samples, the relative error of the
+ * interpolated chroma is below 2.5e-5. That makes the RGB components off by
+ * less than 1e-7 (for saturations in the valid range) and the HPLuv
+ * saturation by less than 0.0025. The error decreases with the square of the
+ * table size, which can be changed by defining @c HSLUV_HPLUV_LUT_SIZE (the
+ * same for the library and for the application).
+ *
+ * The members are filled by hsluv_hpluv_lut_init(); application should treat
+ * them as private.
+ */
+#ifndef HSLUV_HPLUV_LUT_SIZE
+    #define HSLUV_HPLUV_LUT_SIZE    257
+#endif
+
+typedef struct HsluvHpluvLut_tag HsluvHpluvLut;
+struct HsluvHpluvLut_tag {
+    double samples[HSLUV_HPLUV_LUT_SIZE + 2][6];
+};
+
+/**
+ * Build the lookup table for HPLuv.
+ *
+ * @param[out] lut The table.
+ */
+HSLUV_API void hsluv_hpluv_lut_init(HsluvHpluvLut* lut);
+
+/**
+ * The same as hpluv2rgb() and rgb2hpluv(), with the maximal safe chroma
+ * interpolated in the lookup table.
+ *
+ * @param lut The table, as built by hsluv_hpluv_lut_init().
+ */
+HSLUV_API void hpluv2rgb_lut(const HsluvHpluvLut* lut, double h, double s, double l,
+                             double* pr, double* pg, double* pb);
+HSLUV_API int rgb2hpluv_lut(const HsluvHpluvLut* lut, double r, double g, double b,
+                            double* ph, double* ps, double* pl);
+
+
+/**
+ * The same as hsluv2rgb(), hpluv2rgb(), rgb2hsluv() and rgb2hpluv(), with fast
+ * approximations of the trigonometric functions.
+ *
+ * Each HSLuv or HPLuv to RGB conversion needs the sine and cosine of the hue,
+ * and each RGB to HSLuv or HPLuv conversion needs the arc tangent to get the
+ * hue. The plain functions get them from the C library; these use polynomial
+ * approximations instead. Their error budget is:
+ *  - sine and cosine: absolute error below 3e-9, which makes the RGB
+ *    components off by less than 5e-8;
+ *  - arc tangent: hue off by less than 5e-7 degrees. (Saturation and
+ *    lightness do not depend on it.)
+ *
+ * The results do not depend on any setting (e.g. hsluv_set_kernel()), and
+ * the functions are safe to call from any threads.
+ */
+HSLUV_API void hsluv2rgb_fast(double h, double s, double l, double* pr, double* pg, double* pb);
+HSLUV_API void hpluv2rgb_fast(double h, double s, double l, double* pr, double* pg, double* pb);
+HSLUV_API void rgb2hsluv_fast(double r, double g, double b, double* ph, double* ps, double* pl);
+HSLUV_API int rgb2hpluv_fast(double r, double g, double b, double* ph, double* ps, double* pl);
+
+
+/**
+ * Batched conversions.
+ *
+ * These functions convert @c n colors in one call. They produce the same
+ * results as the respective single-color functions above, up to rounding
+ * errors: when built for a CPU with SIMD instructions (SSE4.1, AVX2, AVX-512
+ * or AArch64 NEON), the library uses vectorized kernels with their own
+ * implementation of the transcendental functions. (The difference is below
+ * 1e-10 in all channels.) See hsluv_set_kernel() for how the kernel is
+ * selected.
+ *
+ * The interleaved variants (with @c _n suffix) expect each color stored as
+ * three consecutive doubles (e.g. R, G, B). @c in_stride and @c out_stride
+ * specify the distance between two consecutive colors in the input and the
+ * output buffer, measured in doubles (not bytes). Use 3 for tightly packed
+ * triplets, or e.g. 4 if there is an extra (alpha) channel which the
+ * function then leaves untouched.
+ *
+ * The planar variants (with @c _planar_n suffix) expect each channel in its
+ * own array. The strides then specify the distance between two consecutive
+ * values of the same channel, again measured in doubles. Use 1 for densely
+ * packed planes.
+ *
+ * The conversion may be done in place: the output may be the very same
+ * buffer as the input, as long as the output stride equals the input stride.
+ * Any other kind of overlap between the input and the output is not
+ * supported.
+ *
+ * rgb2hpluv_n() and rgb2hpluv_planar_n() return 0 if all the RGB triplets
+ * are representable in the HPLuv color space, -1 otherwise. The saturation
+ * of each color is left unclamped just like rgb2hpluv() does.
+ */
+HSLUV_API void hsluv2rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API void rgb2hsluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API void hpluv2rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API int rgb2hpluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+
+HSLUV_API void hsluv2rgb_planar_n(const double* h, const double* s, const double* l, size_t in_stride,
+                                  double* r, double* g, double* b, size_t out_stride, size_t n);
+HSLUV_API void rgb2hsluv_planar_n(const double* r, const double* g, const double* b, size_t in_stride,
+                                  double* h, double* s, double* l, size_t out_stride, size_t n);
+HSLUV_API void hpluv2rgb_planar_n(const double* h, const double* s, const double* l, size_t in_stride,
+                                  double* r, double* g, double* b, size_t out_stride, size_t n);
+HSLUV_API int rgb2hpluv_planar_n(const double* r, const double* g, const double* b, size_t in_stride,
+                                 double* h, double* s, double* l, size_t out_stride, size_t n);
+
+
+/**
+ * Fused edits of RGB colors.
+ *
+ * These do the common HSLuv edits of @c n RGB colors (laid out as for
+ * rgb2hsluv_n()) in one pass, without the full round trip through
+ * rgb2hsluv_n() and hsluv2rgb_n(). The result is the same as of that round
+ * trip with the HSLuv color changed in between, up to rounding errors (below
+ * 1e-9 in all channels):
+ *  - hsluv_rotate_hue_rgb_n(): hue h becomes (h + degrees) modulo 360.0;
+ *  - hsluv_set_lightness_rgb_n(): lightness becomes @c l (clamped to the
+ *    range between 0.0 and 100.0);
+ *  - hsluv_scale_saturation_rgb_n(): saturation s becomes s * factor, clamped
+ *    to the range between 0.0 and 100.0.
+ *
+ * The edits share the intermediate results between the two directions: the
+ * hue never gets converted to degrees and back (its sine and cosine come
+ * straight from the color, and the rotation is done with the angle addition
+ * formulas), and the lightness, Y and the bounds of the gamut computed for
+ * the input are reused for the output. Like the other batched functions,
+ * they run on the vectorized kernels (see hsluv_set_kernel()).
+ *
+ * The edit may be done in place, under the same conditions as hsluv2rgb_n().
+ */
+HSLUV_API void hsluv_rotate_hue_rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride,
+                                      size_t n, double degrees);
+HSLUV_API void hsluv_set_lightness_rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride,
+                                         size_t n, double l);
+HSLUV_API void hsluv_scale_saturation_rgb_n(const double* in, size_t in_stride, double* out, size_t out_stride,
+                                            size_t n, double factor);
+
+/**
+ * Layouts of 8-bit RGB pixels.
+ *
+ * The functions taking a format expect one of these values and do not check
+ * it, as they do not check their pointers and strides: any other value is
+ * undefined behavior. Only hsluv_frame_pipeline_create(), which keeps the
+ * format for later, validates it and fails on any other value.
+ */
+typedef enum HsluvFormat_tag {
+    HSLUV_FORMAT_RGB8 = 0,  /**< 3 bytes per pixel: red, green, blue. */
+    HSLUV_FORMAT_RGBA8,     /**< 4 bytes per pixel: red, green, blue, alpha. */
+    HSLUV_FORMAT_BGRA8      /**< 4 bytes per pixel: blue, green, red, alpha. */
+} HsluvFormat;
+
+/**
+ * Batched conversions from and to 8-bit RGB pixels.
+ *
+ * These convert @c n pixels of the given format, packed one after another,
+ * from or to colors laid out as in hsluv2rgb_n() and the like.
+ *
+ * They avoid the power functions of the sRGB transfer curve: the input is
+ * linearized by a table of all the 256 values, and the output is quantized by
+ * a search in a table of the values where the rounded 8-bit result changes.
+ * The results are the same as of the double precision functions with each RGB
+ * channel @c c mapped to <tt>c / 255.0</tt> on input, and to
+ * <tt>(unsigned char)(c * 255.0 + 0.5)</tt> on output.
+ *
+ * The alpha byte is ignored on input, and left untouched on output.
+ *
+ * rgb82hpluv_n() returns 0 if all the pixels are representable in the HPLuv
+ * color space, -1 otherwise (see rgb2hpluv()).
+ */
+HSLUV_API void hsluv2rgb8_n(const double* in, size_t in_stride, unsigned char* out, HsluvFormat format, size_t n);
+HSLUV_API void rgb82hsluv_n(const unsigned char* in, HsluvFormat format, double* out, size_t out_stride, size_t n);
+HSLUV_API void hpluv2rgb8_n(const double* in, size_t in_stride, unsigned char* out, HsluvFormat format, size_t n);
+HSLUV_API int rgb82hpluv_n(const unsigned char* in, HsluvFormat format, double* out, size_t out_stride, size_t n);
+
+
+/**
+ * Conversions from and to the intermediate color spaces.
+ *
+ * The conversion between HSLuv (or HPLuv) and RGB goes through these color
+ * spaces:
+ *  - CIE LCh(uv): lightness between 0.0 and 100.0, chroma (0.0 or more) and
+ *    hue between 0.0 and 360.0. The triplets are ordered L, C, h.
+ *  - CIE XYZ with the D65 white point, scaled so that Y of white is 1.0.
+ *  - Linear RGB, i.e. sRGB without the transfer curve ("gamma"). The
+ *    components are between 0.0 and 1.0.
+ *
+ * Application working in one of these spaces can convert from and to it
+ * directly, skipping the other stages (in particular the power functions of
+ * the sRGB transfer curve). The results are the same as of the respective
+ * stages of hsluv2rgb() and the like.
+ *
+ * The HSLuv and HPLuv outputs are clamped the same way as of rgb2hsluv() and
+ * rgb2hpluv(): for colors outside of the RGB gamut, the HSLuv saturation is
+ * clamped to 100.0, while the HPLuv saturation is left as is, and the
+ * functions converting to HPLuv return -1 if it falls outside the valid range
+ * (0 otherwise). Linear RGB outputs are clamped to the range between 0.0 and
+ * 1.0. LCh and XYZ outputs are not clamped.
+ *
+ * The batched variants (with @c _n suffix) lay out the colors as
+ * hsluv2rgb_n() does, and may be done in place too. They always run the
+ * portable code, not the vectorized kernels of hsluv_set_kernel().
+ */
+HSLUV_API void hsluv2lch(double h, double s, double l, double* pl, double* pc, double* ph);
+HSLUV_API void lch2hsluv(double l, double c, double h, double* ph, double* ps, double* pl);
+HSLUV_API void hpluv2lch(double h, double s, double l, double* pl, double* pc, double* ph);
+HSLUV_API int lch2hpluv(double l, double c, double h, double* ph, double* ps, double* pl);
+
+HSLUV_API void hsluv2xyz(double h, double s, double l, double* px, double* py, double* pz);
+HSLUV_API void xyz2hsluv(double x, double y, double z, double* ph, double* ps, double* pl);
+HSLUV_API void hpluv2xyz(double h, double s, double l, double* px, double* py, double* pz);
+HSLUV_API int xyz2hpluv(double x, double y, double z, double* ph, double* ps, double* pl);
+
+HSLUV_API void hsluv2linrgb(double h, double s, double l, double* pr, double* pg, double* pb);
+HSLUV_API void linrgb2hsluv(double r, double g, double b, double* ph, double* ps, double* pl);
+HSLUV_API void hpluv2linrgb(double h, double s, double l, double* pr, double* pg, double* pb);
+HSLUV_API int linrgb2hpluv(double r, double g, double b, double* ph, double* ps, double* pl);
+
+HSLUV_API void hsluv2lch_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API void lch2hsluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API void hpluv2lch_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API int lch2hpluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+
+HSLUV_API void hsluv2xyz_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API void xyz2hsluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API void hpluv2xyz_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API int xyz2hpluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+
+HSLUV_API void hsluv2linrgb_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API void linrgb2hsluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API void hpluv2linrgb_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+HSLUV_API int linrgb2hpluv_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+
+/**
+ * Gamut clipping of LCh colors.
+ *
+ * These map CIE LCh(uv) colors (see above) of any chroma into the RGB gamut.
+ * The lightness and the hue stay the same, and the chroma is reduced to the
+ * maximal chroma of the RGB gamut for them (see hsluv_bounds_max_chroma())
+ * if it is larger. The lightness outside of the range between 0.0 and 100.0
+ * is clamped first; white and black then get zero chroma. Negative and NaN
+ * chroma are not valid and become zero (so the result reports them).
+ *
+ * The clipped colors convert to RGB exactly (to HSLuv saturation 100.0)
+ * instead of being clamped channel by channel, which would shift their hue
+ * and lightness.
+ *
+ * The batched variant lays out the colors as hsluv2rgb_n() does, and may be
+ * done in place too. It keeps the bounds of recent lightnesses in a small
+ * table, so colors of a limited set of lightnesses (e.g. quantized ones)
+ * share the bounds even when they do not come in runs.
+ *
+ * @return 0 if all the colors were in the gamut already (and are left
+ * unchanged), -1 otherwise.
+ */
+HSLUV_API int lch_clip_gamut(double l, double c, double h, double* pl, double* pc, double* ph);
+HSLUV_API int lch_clip_gamut_n(const double* in, size_t in_stride, double* out, size_t out_stride, size_t n);
+
+/**
+ * Single precision conversions.
+ *
+ * These are counterparts of all the functions above working with floats
+ * instead of doubles, including the batched variants. (The strides are then
+ * measured in floats.)
+ *
+ * They use their own single precision implementation of the whole pipeline,
+ * i.e. they are not just wrappers of the double precision functions. That
+ * makes the vectorized kernels process twice as many colors per iteration.
+ *
+ * Measured against the test snapshot (i.e. the reference double precision
+ * results of all the 4096 colors with 4-bit channels), the maximal absolute
+ * error is:
+ *  - RGB channels: 1e-5 (i.e. under 0.003 of an 8-bit unit).
+ *  - HSLuv: hue 4e-4, saturation 0.0015, lightness 1.5e-5.
+ *  - HPLuv: hue 4e-4, saturation 0.02 (out of values up to about 500 for
+ *    colors outside of HPLuv), lightness 1.5e-5.
+ *
+ * Hue error grows for colors close to grays, where it is ill-defined: in
+ * single precision, colors with chroma below 0.001 are treated as grays.
+ */
+HSLUV_API void hsluv2rgbf(float h, float s, float l, float* pr, float* pg, float* pb);
+HSLUV_API void rgb2hsluvf(float r, float g, float b, float* ph, float* ps, float* pl);
+HSLUV_API void hpluv2rgbf(float h, float s, float l, float* pr, float* pg, float* pb);
+HSLUV_API int rgb2hpluvf(float r, float g, float b, float* ph, float* ps, float* pl);
+
+typedef struct HsluvHslf_tag HsluvHslf;
+struct HsluvHslf_tag {
+    float h;
+    float s;
+    float l;
+};
+
+typedef struct HsluvRgbf_tag HsluvRgbf;
+struct HsluvRgbf_tag {
+    float r;
+    float g;
+    float b;
+};
+
+HSLUV_API HsluvRgbf hsluv2rgbf_v(HsluvHslf hsl);
+HSLUV_API HsluvHslf rgb2hsluvf_v(HsluvRgbf rgb);
+HSLUV_API HsluvRgbf hpluv2rgbf_v(HsluvHslf hpl);
+HSLUV_API HsluvHslf rgb2hpluvf_v(HsluvRgbf rgb);
+
+HSLUV_API void hsluv2rgbf_n(const float* in, size_t in_stride, float* out, size_t out_stride, size_t n);
+HSLUV_API void rgb2hsluvf_n(const float* in, size_t in_stride, float* out, size_t out_stride, size_t n);
+HSLUV_API void hpluv2rgbf_n(const float* in, size_t in_stride, float* out, size_t out_stride, size_t n);
+HSLUV_API int rgb2hpluvf_n(const float* in, size_t in_stride, float* out, size_t out_stride, size_t n);
+
+HSLUV_API void hsluv2rgbf_planar_n(const float* h, const float* s, const float* l, size_t in_stride,
+                                   float* r, float* g, float* b, size_t out_stride, size_t n);
+HSLUV_API void rgb2hsluvf_planar_n(const float* r, const float* g, const float* b, size_t in_stride,
+                                   float* h, float* s, float* l, size_t out_stride, size_t n);
+HSLUV_API void hpluv2rgbf_planar_n(const float* h, const float* s, const float* l, size_t in_stride,
+                                   float* r, float* g, float* b, size_t out_stride, size_t n);
+HSLUV_API int rgb2hpluvf_planar_n(const float* r, const float* g, const float* b, size_t in_stride,
+                                  float* h, float* s, float* l, size_t out_stride, size_t n);
+
+
+/**
+ * Transfer functions of RGB working spaces (see HsluvRgbSpace).
+ */
+typedef enum HsluvTransfer_tag {
+    HSLUV_TRANSFER_SRGB = 0,    /**< IEC 61966-2-1 (sRGB, Display P3). */
+    HSLUV_TRANSFER_BT709,       /**< ITU-R BT.709 and BT.2020 (OETF). */
+    HSLUV_TRANSFER_LINEAR       /**< None: the channels are linear. */
+} HsluvTransfer;
+
+/**
+ * Standard RGB working spaces (see hsluv_rgb_space_init_std()).
+ */
+typedef enum HsluvRgbSpaceId_tag {
+    HSLUV_RGB_SPACE_SRGB = 0,   /**< sRGB, the space of all the other functions. */
+    HSLUV_RGB_SPACE_DISPLAY_P3, /**< Display P3: DCI-P3 primaries, D65, sRGB transfer. */
+    HSLUV_RGB_SPACE_REC2020     /**< ITU-R BT.2020: its primaries, D65, BT.709 transfer. */
+} HsluvRgbSpaceId;
+
+/**
+ * RGB working space.
+ *
+ * All the functions above work with sRGB. The functions below take the RGB
+ * working space as an extra argument instead: its primaries and white point
+ * determine the matrices between XYZ and linear RGB, the reference white of
+ * CIELUV (so the white of the space always has HSLuv lightness 100.0 and zero
+ * saturation), and the lines bounding the gamut (so that HSLuv saturation
+ * 100.0 is the edge of the gamut of that space).
+ *
+ * The structure is initialized once by hsluv_rgb_space_init() or
+ * hsluv_rgb_space_init_std(), with everything the conversions need
+ * precomputed; application should treat the members as read-only. It may then
+ * be shared by any number of threads. @c NULL stands for sRGB: the conversions
+ * are then exactly the same as of the respective functions above (e.g.
+ * hsluv2rgb_space_n(NULL, ...) is hsluv2rgb_n(...)).
+ *
+ * The batched functions run on the vectorized kernels just like hsluv2rgb_n()
+ * and friends (see hsluv_set_kernel()). The kernels of the plain functions use
+ * the sRGB constants as immediate operands, so they do not pay for the
+ * generality.
+ *
+ * The 8-bit and fixed point functions and the other modules of the library
+ * (hsluv-cache.h, hsluv-image.h, ...) work with sRGB only.
+ */
+typedef struct HsluvRgbSpace_tag HsluvRgbSpace;
+struct HsluvRgbSpace_tag {
+    double m[3][3];             /**< XYZ to linear RGB. */
+    double m_inv[3][3];         /**< Linear RGB to XYZ. */
+    double ref_u;               /**< u' of the white point. */
+    double ref_v;               /**< v' of the white point. */
+    /** Coefficients of the six lines bounding the gamut (see HsluvBounds):
+     * at lightness @c l of luminance @c y, the line @c i has the slope
+     * <tt>top1 / bottom</tt> and the intercept <tt>top2 / bottom</tt> with
+     * <tt>top1 = bounds_top1[i] * y</tt>,
+     * <tt>top2 = bounds_top2[i] * l * y - bounds_top2_l[i] * l</tt> and
+     * <tt>bottom = bounds_bottom[i] * y + bounds_bottom_c[i]</tt>. */
+    double bounds_top1[6];
+    double bounds_top2[6];
+    double bounds_top2_l[6];
+    double bounds_bottom[6];
+    double bounds_bottom_c[6];
+    double tf_cut;              /**< Transfer function: end of the linear segment, */
+    double tf_cut_encoded;      /**< ... the same encoded, */
+    double tf_slope;            /**< ... its slope, */
+    double tf_scale;            /**< ... and the power segment scale * c^(1/gamma) - offset. */
+    double tf_offset;
+    double tf_gamma;
+};
+
+/**
+ * Initialize RGB working space from its primaries and white point.
+ *
+ * @param[out] space The space to initialize.
+ * @param primaries CIE 1931 chromaticities of the red, green and blue
+ * primaries: x and y of each, in this order.
+ * @param white x and y of the white point.
+ * @param transfer Transfer function of the RGB channels.
+ *
+ * @return 0 on success, -1 if the chromaticities do not define a valid space
+ * (e.g. the primaries are collinear).
+ */
+HSLUV_API int hsluv_rgb_space_init(HsluvRgbSpace* space, const double primaries[6], const double white[2],
+                                   HsluvTransfer transfer);
+
+/**
+ * Initialize one of the standard RGB working spaces. @c HSLUV_RGB_SPACE_SRGB
+ * gets the very constants of the sRGB functions above.
+ *
+ * @return 0 on success, -1 for an unknown @c id.
+ */
+HSLUV_API int hsluv_rgb_space_init_std(HsluvRgbSpace* space, HsluvRgbSpaceId id);
+
+/**
+ * Conversions in RGB working space.
+ *
+ * The counterparts of hsluv2rgb(), hsluv2rgb_n(), hsluv2rgb_planar_n(),
+ * hsluv2rgbf_n() and hsluv2rgbf_planar_n() (and the same of the other three
+ * conversions), with the RGB colors in the given space (@c NULL for sRGB).
+ */
+HSLUV_API void hsluv2rgb_space(const HsluvRgbSpace* space, double h, double s, double l,
+                               double* pr, double* pg, double* pb);
+HSLUV_API void rgb2hsluv_space(const HsluvRgbSpace* space, double r, double g, double b,
+                               double* ph, double* ps, double* pl);
+HSLUV_API void hpluv2rgb_space(const HsluvRgbSpace* space, double h, double s, double l,
+                               double* pr, double* pg, double* pb);
+HSLUV_API int rgb2hpluv_space(const HsluvRgbSpace* space, double r, double g, double b,
+                              double* ph, double* ps, double* pl);
+
+HSLUV_API void hsluv2rgb_space_n(const HsluvRgbSpace* space, const double* in, size_t in_stride,
+                                 double* out, size_t out_stride, size_t n);
+HSLUV_API void rgb2hsluv_space_n(const HsluvRgbSpace* space, const double* in, size_t in_stride,
+                                 double* out, size_t out_stride, size_t n);
+HSLUV_API void hpluv2rgb_space_n(const HsluvRgbSpace* space, const double* in, size_t in_stride,
+                                 double* out, size_t out_stride, size_t n);
+HSLUV_API int rgb2hpluv_space_n(const HsluvRgbSpace* space, const double* in, size_t in_stride,
+                                double* out, size_t out_stride, size_t n);
+
+HSLUV_API void hsluv2rgb_space_planar_n(const HsluvRgbSpace* space,
+                                        const double* h, const double* s, const double* l, size_t in_stride,
+                                        double* r, double* g, double* b, size_t out_stride, size_t n);
+HSLUV_API void rgb2hsluv_space_planar_n(const HsluvRgbSpace* space,
+                                        const double* r, const double* g, const double* b, size_t in_stride,
+                                        double* h, double* s, double* l, size_t out_stride, size_t n);
+HSLUV_API void hpluv2rgb_space_planar_n(const HsluvRgbSpace* space,
+                                        const double* h, const double* s, const double* l, size_t in_stride,
+                                        double* r, double* g, double* b, size_t out_stride, size_t n);
+HSLUV_API int rgb2hpluv_space_planar_n(const HsluvRgbSpace* space,
+                                       const double* r, const double* g, const double* b, size_t in_stride,
+                                       double* h, double* s, double* l, size_t out_stride, size_t n);
+
+HSLUV_API void hsluv2rgbf_space_n(const HsluvRgbSpace* space, const float* in, size_t in_stride,
+                                  float* out, size_t out_stride, size_t n);
+HSLUV_API void rgb2hsluvf_space_n(const HsluvRgbSpace* space, const float* in, size_t in_stride,
+                                  float* out, size_t out_stride, size_t n);
+HSLUV_API void hpluv2rgbf_space_n(const HsluvRgbSpace* space, const float* in, size_t in_stride,
+                                  float* out, size_t out_stride, size_t n);
+HSLUV_API int rgb2hpluvf_space_n(const HsluvRgbSpace* space, const float* in, size_t in_stride,
+                                 float* out, size_t out_stride, size_t n);
+
+HSLUV_API void hsluv2rgbf_space_planar_n(const HsluvRgbSpace* space,
+                                         const float* h, const float* s, const float* l, size_t in_stride,
+                                         float* r, float* g, float* b, size_t out_stride, size_t n);
+HSLUV_API void rgb2hsluvf_space_planar_n(const HsluvRgbSpace* space,
+                                         const float* r, const float* g, const float* b, size_t in_stride,
+                                         float* h, float* s, float* l, size_t out_stride, size_t n);
+HSLUV_API void hpluv2rgbf_space_planar_n(const HsluvRgbSpace* space,
+                                         const float* h, const float* s, const float* l, size_t in_stride,
+                                         float* r, float* g, float* b, size_t out_stride, size_t n);
+HSLUV_API int rgb2hpluvf_space_planar_n(const HsluvRgbSpace* space,
+                                        const float* r, const float* g, const float* b, size_t in_stride,
+                                        float* h, float* s, float* l, size_t out_stride, size_t n);
+
+
+/**
+ * Kernels implementing the batched conversions.
+ */
+typedef enum HsluvKernel_tag {
+    HSLUV_KERNEL_AUTO = 0,  /**< The best kernel the CPU supports. */
+    HSLUV_KERNEL_SCALAR,    /**< Portable C; always available. */
+    HSLUV_KERNEL_SSE41,     /**< x86 SSE4.1; 2 colors per iteration. */
+    HSLUV_KERNEL_AVX2,      /**< x86 AVX2 and FMA; 4 colors per iteration. */
+    HSLUV_KERNEL_AVX512,    /**< x86 AVX-512F; 8 colors per iteration. */
+    HSLUV_KERNEL_NEON       /**< AArch64 NEON; 2 colors per iteration. */
+} HsluvKernel;
+
+/**
+ * Check whether the given kernel is built into the library and supported by
+ * the CPU.
+ *
+ * @param kernel The kernel.
+ * @return Non-zero if the kernel can be used, zero otherwise.
+ */
+HSLUV_API int hsluv_kernel_available(HsluvKernel kernel);
+
+/**
+ * Select the kernel used by the batched conversions.
+ *
+ * By default (or after setting @c HSLUV_KERNEL_AUTO), the library detects the
+ * CPU features on the first batched call and then sticks with the best kernel
+ * available. Pinning a specific kernel is mostly useful for benchmarking and
+ * testing.
+ *
+ * The selection is global. It is not meant to be changed while other threads
+ * are running batched conversions.
+ *
+ * @param kernel The kernel to use.
+ * @return 0 on success, -1 if the kernel is not available (in which case the
+ * selection is not changed).
+ */
+HSLUV_API int hsluv_set_kernel(HsluvKernel kernel);
+
+/**
+ * Get the kernel used by the batched conversions.
+ *
+ * @return The active kernel. Never @c HSLUV_KERNEL_AUTO.
+ */
+HSLUV_API HsluvKernel hsluv_get_kernel(void);
+
+/**
+ * Get a human-readable name of the kernel, e.g. "avx2".
+ *
+ * @param kernel The kernel.
+ * @return The name, or NULL if the kernel is not built into the library.
+ */
+HSLUV_API const char* hsluv_kernel_name(HsluvKernel kernel);
+
+
+/**
+ * Profiling counters.
+ *
+ * When the library is built with @c HSLUV_STATS defined (CMake option
+ * @c HSLUV_C_STATS), the double precision conversions count how often they
+ * run each costly stage and how long it takes, how often they hit the special
+ * cases, and how many colors each kernel converts. Otherwise the counters
+ * are compiled out and cost nothing; hsluv_stats_get() then reports zeros.
+ *
+ * The stages and the special cases are counted only in the code which handles
+ * the colors one at a time: the single-color functions, the scalar kernel, the
+ * 8-bit RGB and the stage conversions. The vectorized kernels and the single
+ * precision functions are counted only per kernel.
+ *
+ * The counters are global and updated atomically, which is not free: a build
+ * with them is meant for profiling, not for production.
+ */
+typedef enum HsluvStatsStage_tag {
+    HSLUV_STATS_GET_BOUNDS = 0,     /**< The gamut bounds of a lightness. */
+    HSLUV_STATS_TRIG,               /**< Sine and cosine, or arc tangent, of the hue. */
+    HSLUV_STATS_TO_LINEAR,          /**< sRGB gamma expansion of one channel. */
+    HSLUV_STATS_FROM_LINEAR,        /**< sRGB gamma compression of one channel. */
+    HSLUV_STATS_STAGE_COUNT
+} HsluvStatsStage;
+
+typedef enum HsluvStatsEvent_tag {
+    HSLUV_STATS_GRAY = 0,           /**< Zero saturation or chroma: the hue is set to 0. */
+    HSLUV_STATS_WHITE,              /**< Lightness above 99.9999999. */
+    HSLUV_STATS_BLACK,              /**< Lightness below 0.00000001. */
+    HSLUV_STATS_HPLUV_OUT_OF_RANGE, /**< A color out of the HPLuv range (see rgb2hpluv()). */
+    HSLUV_STATS_EVENT_COUNT
+} HsluvStatsEvent;
+
+typedef struct HsluvStats_tag HsluvStats;
+struct HsluvStats_tag {
+    uint64_t stage_calls[HSLUV_STATS_STAGE_COUNT];
+    /** Time spent in each stage, in CPU timestamp counter ticks (cycles on
+     * x86, the generic timer on AArch64; zero on other architectures). */
+    uint64_t stage_ticks[HSLUV_STATS_STAGE_COUNT];
+    uint64_t events[HSLUV_STATS_EVENT_COUNT];
+    /** Batched calls and colors, indexed by @c HsluvKernel. */
+    uint64_t kernel_calls[HSLUV_KERNEL_NEON + 1];
+    uint64_t kernel_colors[HSLUV_KERNEL_NEON + 1];
+};
+
+/**
+ * Check whether the library has been built with the counters.
+ *
+ * @return Non-zero if the counters are compiled in, zero otherwise.
+ */
+HSLUV_API int hsluv_stats_enabled(void);
+
+/**
+ * Read the counters.
+ *
+ * @param[out] stats The current values.
+ */
+HSLUV_API void hsluv_stats_get(HsluvStats* stats);
+
+/**
+ * Reset all the counters to zero.
+ */
+HSLUV_API void hsluv_stats_reset(void);
 
 
 #ifdef __cplusplus
 }
 #endif
 
+#ifdef HSLUV_IMPLEMENTATION
+    #include "hsluv.c"
+    #include "hsluv-float.c"
+#endif
+
 #endif  /* HSLUV_H */
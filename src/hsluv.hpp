@@ -0,0 +1,710 @@
+/*
+ * HSLuv-C: Human-friendly HSL
+ * <https://github.com/hsluv/hsluv-c>
+ * <https://www.hsluv.org/>
+ *
+ * Copyright (c) 2015 Alexei Boronine (original idea, JavaScript implementation)
+ * Copyright (c) 2015 Roger Tallada (Obj-C implementation)
+ * Copyright (c) 2017 Martin Mitáš (C implementation, based on Obj-C implementation)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef HSLUV_HPP
+#define HSLUV_HPP
+
+/* C++ layer over hsluv.h (C++14 or newer).
+ *
+ * Namespace hsluv::ct ("compile time") provides constexpr implementations of
+ * the four basic conversions, so that palettes and lookup tables can be baked
+ * into the binary:
+ *
+ * @code C++
+ * constexpr hsluv::Rgb<double> accent = hsluv::ct::hsluv2rgb(hsluv::Hsl<double>{ 250.0, 90.0, 60.0 });
+ * @endcode
+ *
+ * They use their own constexpr replacements of sqrt(), cbrt(), pow(), sin(),
+ * cos() and atan2(), accurate to a few ULPs. Their results agree with the C
+ * functions to 1e-14 in RGB and 1e-11 in HSLuv and HPLuv. Being written for
+ * the compiler to evaluate, they are however slow at run time.
+ *
+ * Namespace hsluv itself provides inline templates for the run time, which
+ * forward to the double or single precision functions of the library.
+ */
+
+#include "hsluv.h"
+
+#include <limits>
+
+
+namespace hsluv {
+
+template<typename T> struct Hsl {
+    T h;
+    T s;
+    T l;
+};
+
+template<typename T> struct Rgb {
+    T r;
+    T g;
+    T b;
+};
+
+
+namespace detail {
+
+/* Constants shared with hsluv-internal.h. */
+constexpr double m[3][3] = {
+    {  3.24096994190452134377, -1.53738317757009345794, -0.49861076029300328366 },
+    { -0.96924363628087982613,  1.87596750150772066772,  0.04155505740717561247 },
+    {  0.05563007969699360846, -0.20397695888897656435,  1.05697151424287856072 }
+};
+
+constexpr double m_inv[3][3] = {
+    {  0.41239079926595948129,  0.35758433938387796373,  0.18048078840183428751 },
+    {  0.21263900587151035754,  0.71516867876775592746,  0.07219231536073371500 },
+    {  0.01933081871559185069,  0.11919477979462598791,  0.95053215224966058086 }
+};
+
+constexpr double ref_u = 0.19783000664283680764;
+constexpr double ref_v = 0.46831999493879100370;
+constexpr double kappa = 903.29629629629629629630;
+constexpr double epsilon = 0.00885645167903563082;
+
+constexpr double pi = 3.14159265358979323846;
+constexpr double ln2 = 0.69314718055994530942;
+
+
+constexpr double
+clamp(double x, double lo, double hi)
+{
+    return (x < lo) ? lo : ((x > hi) ? hi : x);
+}
+
+constexpr bool
+is_finite(double x)
+{
+    return (x - x == 0.0);
+}
+
+/* The powers 2^(2^i): scaling by them splits and rebuilds any double in at
+ * most a few steps per power, unlike stepping by a constant factor. */
+constexpr double pow2_pow2[10] = {
+    2.0, 4.0, 16.0, 256.0, 65536.0, 4294967296.0, 18446744073709551616.0,
+    3.40282366920938463463e+38, 1.15792089237316195424e+77, 1.34078079299425970996e+154
+};
+
+/* Positive finite x = f * 2^e with f in [1, 2) (a constexpr frexp()). */
+struct Frexp {
+    double f;
+    int e;
+};
+
+constexpr Frexp
+frexp(double x)
+{
+    int e = 0;
+
+    for(int i = 9; i >= 0; i--) {
+        while(x >= pow2_pow2[i]) {
+            x /= pow2_pow2[i];
+            e += 1 << i;
+        }
+        while(x < 1.0 / pow2_pow2[i]) {
+            x *= pow2_pow2[i];
+            e -= 1 << i;
+        }
+    }
+    if(x < 1.0) {
+        x *= 2.0;
+        e--;
+    }
+    return Frexp{ x, e };
+}
+
+/* x * 2^e (a constexpr ldexp()). */
+constexpr double
+ldexp(double x, int e)
+{
+    for(int i = 9; i >= 0; i--) {
+        while(e >= (1 << i)) {
+            x *= pow2_pow2[i];
+            e -= 1 << i;
+        }
+        while(e <= -(1 << i)) {
+            x /= pow2_pow2[i];
+            e += 1 << i;
+        }
+    }
+    return x;
+}
+
+/* Newton's iterations from an estimate within a factor of 2. */
+constexpr double
+sqrt(double x)
+{
+    Frexp fe = {};
+    double y = 0.0;
+
+    if(x <= 0.0)
+        return 0.0;
+    if(!is_finite(x))
+        return x;
+    /* x = f * 2^e with f in [1, 4) and e even. */
+    fe = frexp(x);
+    if(fe.e % 2 != 0) {
+        fe.f *= 2.0;
+        fe.e--;
+    }
+    y = 0.5 * (fe.f + 1.0);
+    for(int i = 0; i < 6; i++)
+        y = 0.5 * (y + fe.f / y);
+    return ldexp(y, fe.e / 2);
+}
+
+constexpr double
+cbrt(double x)
+{
+    Frexp fe = {};
+    int r = 0;
+    double y = 0.0;
+
+    if(x == 0.0  ||  !is_finite(x))
+        return x;
+    if(x < 0.0)
+        return -cbrt(-x);
+    /* x = f * 2^e with f in [1, 8) and e a multiple of 3. */
+    fe = frexp(x);
+    r = ((fe.e % 3) + 3) % 3;
+    fe.f = ldexp(fe.f, r);
+    fe.e -= r;
+    y = 1.0 + (fe.f - 1.0) / 7.0;
+    for(int i = 0; i < 8; i++)
+        y = y - (y * y * y - fe.f) / (3.0 * y * y);
+    return ldexp(y, fe.e / 3);
+}
+
+/* exp(x) = 2^k * exp(r) with |r| <= ln(2) / 2. */
+constexpr double
+exp(double x)
+{
+    int k = 0;
+    double r = 0.0;
+    double term = 1.0;
+    double sum = 1.0;
+
+    if(x != x)
+        return x;
+    /* Out of the range of doubles (which also keeps k in the range of int). */
+    if(x > 709.78271289338399678)   /* log(DBL_MAX) */
+        return std::numeric_limits<double>::infinity();
+    if(x < -745.5)
+        return 0.0;
+    k = static_cast<int>(x / ln2 + (x >= 0.0 ? 0.5 : -0.5));
+    r = x - k * ln2;
+    for(int i = 1; i < 24; i++) {
+        term *= r / i;
+        sum += term;
+    }
+    return ldexp(sum, k);
+}
+
+/* log(x) = e * log(2) + 2 * atanh((f - 1) / (f + 1)) with f in [sqrt(1/2), sqrt(2)). */
+constexpr double
+log(double x)
+{
+    Frexp fe = {};
+    int e = 0;
+    double z = 0.0;
+    double z2 = 0.0;
+    double term = 0.0;
+    double sum = 0.0;
+
+    if(x == 0.0)
+        return -std::numeric_limits<double>::infinity();
+    if(x < 0.0)
+        return std::numeric_limits<double>::quiet_NaN();
+    if(!is_finite(x))
+        return x;
+    fe = frexp(x);
+    x = fe.f;
+    e = fe.e;
+    if(x >= 1.41421356237309504880) {
+        x *= 0.5;
+        e++;
+    }
+    z = (x - 1.0) / (x + 1.0);
+    z2 = z * z;
+    term = z;
+    for(int i = 1; i < 40; i += 2) {
+        sum += term / i;
+        term *= z2;
+    }
+    return e * ln2 + 2.0 * sum;
+}
+
+constexpr double
+pow(double x, double y)
+{
+    return (x <= 0.0) ? 0.0 : exp(y * log(x));
+}
+
+/* Sine and cosine of an angle in degrees. */
+struct SinCos {
+    double sin;
+    double cos;
+};
+
+/* h modulo 360.0, exactly, for any finite h (a constexpr fmod()). */
+constexpr double
+mod360(double h)
+{
+    double a = (h < 0.0) ? -h : h;
+    int n = 0;
+    double step = 0.0;
+
+    if(a >= 360.0) {
+        /* Subtract 360 * 2^n for decreasing n; each is exact (Sterbenz). */
+        n = frexp(a).e - frexp(360.0).e;
+        step = ldexp(360.0, n);
+        for(; n >= 0; n--) {
+            if(a >= step)
+                a -= step;
+            step *= 0.5;
+        }
+    }
+    return (h < 0.0  &&  a != 0.0) ? 360.0 - a : a;
+}
+
+constexpr SinCos
+sincos_deg(double h)
+{
+    double q = 0.0;
+    double x = 0.0;
+    double x2 = 0.0;
+    double s = 0.0;
+    double c = 0.0;
+    double term_s = 0.0;
+    double term_c = 1.0;
+    int quadrant = 0;
+
+    if(!is_finite(h))
+        return SinCos{ h - h, h - h };
+    /* Keep the multiples of 90 degrees below in the range of long long. */
+    if(h > 1e15  ||  h < -1e15)
+        h = mod360(h);
+
+    /* Reduce to the nearest multiple of 90 degrees. */
+    q = h / 90.0;
+    q = static_cast<double>(static_cast<long long>(q + (q >= 0.0 ? 0.5 : -0.5)));
+    x = (h - 90.0 * q) * (pi / 180.0);
+    x2 = x * x;
+    term_s = x;
+    for(int i = 0; i < 12; i++) {
+        s += term_s;
+        c += term_c;
+        term_s *= -x2 / ((2 * i + 2) * (2 * i + 3));
+        term_c *= -x2 / ((2 * i + 1) * (2 * i + 2));
+    }
+
+    quadrant = static_cast<int>(static_cast<long long>(q) % 4);
+    if(quadrant < 0)
+        quadrant += 4;
+    switch(quadrant) {
+        case 0:     return SinCos{ s, c };
+        case 1:     return SinCos{ c, -s };
+        case 2:     return SinCos{ -s, -c };
+        default:    return SinCos{ -c, s };
+    }
+}
+
+/* atan2(v, u) in degrees, in the range [0.0, 360.0). */
+constexpr double
+atan2_deg(double v, double u)
+{
+    double au = (u < 0.0) ? -u : u;
+    double av = (v < 0.0) ? -v : v;
+    bool swapped = (av > au);
+    double t = 0.0;
+    double a = 0.0;
+    double t2 = 0.0;
+    double term = 0.0;
+    double sum = 0.0;
+
+    if(au == 0.0  &&  av == 0.0)
+        return 0.0;
+    t = swapped ? au / av : av / au;
+
+    /* Reduce to [0, tan(pi/8)] with atan(t) = pi/4 + atan((t - 1) / (t + 1)). */
+    if(t > 0.41421356237309504880) {
+        t = (t - 1.0) / (t + 1.0);
+        a = 45.0;
+    }
+    t2 = t * t;
+    term = t;
+    for(int i = 1; i < 48; i += 2) {
+        sum += term / i;
+        term *= -t2;
+    }
+    a += sum * (180.0 / pi);
+
+    if(swapped)
+        a = 90.0 - a;
+    if(u < 0.0)
+        a = 180.0 - a;
+    if(v < 0.0)
+        a = 360.0 - a;
+    return (a >= 360.0) ? a - 360.0 : a;
+}
+
+
+/* The six lines bounding the gamut at a lightness (see HsluvBounds). */
+struct Bounds {
+    double a[6];
+    double b[6];
+};
+
+/* Per-line coefficients of the lines, the same as those of srgb_space in
+ * hsluv-internal.h (see HsluvRgbSpace), computed once at compile time. */
+struct BoundsCoef {
+    double top1[6];
+    double top2[6];
+    double top2_l[6];
+    double bottom[6];
+    double bottom_c[6];
+};
+
+constexpr BoundsCoef
+make_bounds_coef()
+{
+    BoundsCoef coef = {};
+
+    for(int i = 0; i < 6; i++) {
+        double m1 = m[i / 2][0];
+        double m2 = m[i / 2][1];
+        double m3 = m[i / 2][2];
+        int t = i % 2;
+
+        coef.top1[i] = 284517.0 * m1 - 94839.0 * m3;
+        coef.top2[i] = 838422.0 * m3 + 769860.0 * m2 + 731718.0 * m1;
+        coef.top2_l[i] = 769860.0 * t;
+        coef.bottom[i] = 632260.0 * m3 - 126452.0 * m2;
+        coef.bottom_c[i] = 126452.0 * t;
+    }
+    return coef;
+}
+
+constexpr BoundsCoef bounds_coef = make_bounds_coef();
+
+constexpr Bounds
+get_bounds(double l)
+{
+    Bounds bounds = {};
+    double tl = l + 16.0;
+    double sub1 = (tl * tl * tl) / 1560896.0;
+    double sub2 = (sub1 > epsilon) ? sub1 : (l / kappa);
+
+    for(int i = 0; i < 6; i++) {
+        double top1 = bounds_coef.top1[i] * sub2;
+        double top2 = bounds_coef.top2[i] * l * sub2 - bounds_coef.top2_l[i] * l;
+        double bottom = bounds_coef.bottom[i] * sub2 + bounds_coef.bottom_c[i];
+
+        bounds.a[i] = top1 / bottom;
+        bounds.b[i] = top2 / bottom;
+    }
+    return bounds;
+}
+
+constexpr double
+max_chroma_for_bounds(const Bounds& bounds, const SinCos& hue)
+{
+    double min_len = std::numeric_limits<double>::max();
+
+    for(int i = 0; i < 6; i++) {
+        double denom = hue.sin - bounds.a[i] * hue.cos;
+
+        if(denom != 0.0) {
+            double len = bounds.b[i] / denom;
+            if(len >= 0.0  &&  len < min_len)
+                min_len = len;
+        }
+    }
+    return min_len;
+}
+
+constexpr double
+max_safe_chroma_for_bounds(const Bounds& bounds)
+{
+    double min_len_squared = std::numeric_limits<double>::max();
+
+    for(int i = 0; i < 6; i++) {
+        double m1 = bounds.a[i];
+        double b1 = bounds.b[i];
+        double x = b1 / (-1.0 / m1 - m1);
+        double y = b1 + x * m1;
+        double distance = x * x + y * y;
+
+        if(distance < min_len_squared)
+            min_len_squared = distance;
+    }
+    return sqrt(min_len_squared);
+}
+
+constexpr bool
+extreme_l(double l)
+{
+    return (l > 99.9999999  ||  l < 0.00000001);
+}
+
+constexpr double
+from_linear(double c)
+{
+    return (c <= 0.0031308) ? 12.92 * c : 1.055 * pow(c, 1.0 / 2.4) - 0.055;
+}
+
+constexpr double
+to_linear(double c)
+{
+    return (c > 0.04045) ? pow((c + 0.055) / 1.055, 2.4) : c / 12.92;
+}
+
+constexpr double
+l2y(double l)
+{
+    return (l <= 8.0) ? l / kappa : ((l + 16.0) / 116.0) * ((l + 16.0) / 116.0) * ((l + 16.0) / 116.0);
+}
+
+constexpr double
+y2l(double y)
+{
+    return (y <= epsilon) ? y * kappa : 116.0 * cbrt(y) - 16.0;
+}
+
+/* LCh (with the sine and cosine of the hue) -> RGB. */
+constexpr Rgb<double>
+lch2rgb(double l, double c, const SinCos& hue)
+{
+    double u = hue.cos * c;
+    double v = hue.sin * c;
+    double x = 0.0, y = 0.0, z = 0.0;
+    double rgb[3] = {};
+
+    /* As luv2xyz() of hsluv.c: black (but not NaN) is all zeros. */
+    if(!(l <= 0.00000001)) {
+        double var_u = u / (13.0 * l) + ref_u;
+        double var_v = v / (13.0 * l) + ref_v;
+        y = l2y(l);
+        x = -(9.0 * y * var_u) / ((var_u - 4.0) * var_v - var_u * var_v);
+        z = (9.0 * y - (15.0 * var_v * y) - (var_v * x)) / (3.0 * var_v);
+    }
+
+    for(int i = 0; i < 3; i++)
+        rgb[i] = clamp(from_linear(m[i][0] * x + m[i][1] * y + m[i][2] * z), 0.0, 1.0);
+    return Rgb<double>{ rgb[0], rgb[1], rgb[2] };
+}
+
+/* RGB -> LCh, with the sine and cosine of the hue. */
+struct Lch {
+    double l;
+    double c;
+    double h;
+    SinCos hue;
+};
+
+constexpr Lch
+rgb2lch(const Rgb<double>& rgb)
+{
+    double lin[3] = { to_linear(rgb.r), to_linear(rgb.g), to_linear(rgb.b) };
+    double xyz[3] = {};
+    double denom = 0.0;
+    double l = 0.0, u = 0.0, v = 0.0, c = 0.0;
+    Lch lch = { 0.0, 0.0, 0.0, SinCos{ 0.0, 1.0 } };
+
+    for(int i = 0; i < 3; i++)
+        xyz[i] = m_inv[i][0] * lin[0] + m_inv[i][1] * lin[1] + m_inv[i][2] * lin[2];
+
+    denom = xyz[0] + 15.0 * xyz[1] + 3.0 * xyz[2];
+    l = y2l(xyz[1]);
+    if(l >= 0.00000001  &&  denom != 0.0) {
+        u = 13.0 * l * (4.0 * xyz[0] / denom - ref_u);
+        v = 13.0 * l * (9.0 * xyz[1] / denom - ref_v);
+    }
+
+    c = sqrt(u * u + v * v);
+    lch.l = l;
+    lch.c = c;
+    /* Grays: disambiguate hue */
+    if(c >= 0.00000001) {
+        lch.h = atan2_deg(v, u);
+        lch.hue = SinCos{ v / c, u / c };
+    }
+    return lch;
+}
+
+}   /* namespace detail */
+
+
+namespace ct {
+
+/**
+ * Compile-time HSLuv and HPLuv conversions.
+ *
+ * Same as hsluv2rgb(), rgb2hsluv(), hpluv2rgb() and rgb2hpluv() of the C
+ * library. The single precision instances compute in double precision too.
+ * Whether a color is representable in HPLuv can be told from the saturation
+ * rgb2hpluv() returns.
+ */
+template<typename T> constexpr Rgb<T>
+hsluv2rgb(const Hsl<T>& hsl)
+{
+    double h = static_cast<double>(hsl.h);
+    double s = static_cast<double>(hsl.s);
+    double l = static_cast<double>(hsl.l);
+    detail::SinCos hue = detail::sincos_deg(h);
+    double c = 0.0;
+    Rgb<double> rgb = {};
+
+    /* White and black: disambiguate chroma */
+    if(!detail::extreme_l(l))
+        c = detail::max_chroma_for_bounds(detail::get_bounds(l), hue) / 100.0 * s;
+    /* Grays: disambiguate hue */
+    if(s < 0.00000001)
+        hue = detail::SinCos{ 0.0, 1.0 };
+
+    rgb = detail::lch2rgb(l, c, hue);
+    return Rgb<T>{ static_cast<T>(rgb.r), static_cast<T>(rgb.g), static_cast<T>(rgb.b) };
+}
+
+template<typename T> constexpr Rgb<T>
+hpluv2rgb(const Hsl<T>& hpl)
+{
+    double h = static_cast<double>(hpl.h);
+    double s = static_cast<double>(hpl.s);
+    double l = static_cast<double>(hpl.l);
+    detail::SinCos hue = detail::sincos_deg(h);
+    double c = 0.0;
+    Rgb<double> rgb = {};
+
+    if(!detail::extreme_l(l))
+        c = detail::max_safe_chroma_for_bounds(detail::get_bounds(l)) / 100.0 * s;
+    if(s < 0.00000001)
+        hue = detail::SinCos{ 0.0, 1.0 };
+
+    rgb = detail::lch2rgb(l, c, hue);
+    return Rgb<T>{ static_cast<T>(rgb.r), static_cast<T>(rgb.g), static_cast<T>(rgb.b) };
+}
+
+template<typename T> constexpr Hsl<T>
+rgb2hsluv(const Rgb<T>& rgb)
+{
+    detail::Lch lch = detail::rgb2lch(Rgb<double>{ static_cast<double>(rgb.r),
+                static_cast<double>(rgb.g), static_cast<double>(rgb.b) });
+    double s = 0.0;
+
+    /* White and black: disambiguate saturation */
+    if(!detail::extreme_l(lch.l))
+        s = lch.c / detail::max_chroma_for_bounds(detail::get_bounds(lch.l), lch.hue) * 100.0;
+
+    return Hsl<T>{ static_cast<T>(detail::clamp(lch.h, 0.0, 360.0)),
+                   static_cast<T>(detail::clamp(s, 0.0, 100.0)),
+                   static_cast<T>(detail::clamp(lch.l, 0.0, 100.0)) };
+}
+
+template<typename T> constexpr Hsl<T>
+rgb2hpluv(const Rgb<T>& rgb)
+{
+    detail::Lch lch = detail::rgb2lch(Rgb<double>{ static_cast<double>(rgb.r),
+                static_cast<double>(rgb.g), static_cast<double>(rgb.b) });
+    double s = 0.0;
+
+    if(!detail::extreme_l(lch.l))
+        s = lch.c / detail::max_safe_chroma_for_bounds(detail::get_bounds(lch.l)) * 100.0;
+
+    /* Do NOT clamp the saturation, just like rgb2hpluv(). */
+    return Hsl<T>{ static_cast<T>(detail::clamp(lch.h, 0.0, 360.0)),
+                   static_cast<T>(s),
+                   static_cast<T>(detail::clamp(lch.l, 0.0, 100.0)) };
+}
+
+}   /* namespace ct */
+
+
+namespace detail {
+
+template<typename T> struct Impl;
+
+template<> struct Impl<double> {
+    static Rgb<double> hsluv2rgb(const Hsl<double>& c)
+        { HsluvRgb r = ::hsluv2rgb_v(HsluvHsl{ c.h, c.s, c.l }); return Rgb<double>{ r.r, r.g, r.b }; }
+    static Rgb<double> hpluv2rgb(const Hsl<double>& c)
+        { HsluvRgb r = ::hpluv2rgb_v(HsluvHsl{ c.h, c.s, c.l }); return Rgb<double>{ r.r, r.g, r.b }; }
+    static Hsl<double> rgb2hsluv(const Rgb<double>& c)
+        { HsluvHsl r = ::rgb2hsluv_v(HsluvRgb{ c.r, c.g, c.b }); return Hsl<double>{ r.h, r.s, r.l }; }
+    static Hsl<double> rgb2hpluv(const Rgb<double>& c)
+        { HsluvHsl r = ::rgb2hpluv_v(HsluvRgb{ c.r, c.g, c.b }); return Hsl<double>{ r.h, r.s, r.l }; }
+};
+
+template<> struct Impl<float> {
+    static Rgb<float> hsluv2rgb(const Hsl<float>& c)
+        { HsluvRgbf r = ::hsluv2rgbf_v(HsluvHslf{ c.h, c.s, c.l }); return Rgb<float>{ r.r, r.g, r.b }; }
+    static Rgb<float> hpluv2rgb(const Hsl<float>& c)
+        { HsluvRgbf r = ::hpluv2rgbf_v(HsluvHslf{ c.h, c.s, c.l }); return Rgb<float>{ r.r, r.g, r.b }; }
+    static Hsl<float> rgb2hsluv(const Rgb<float>& c)
+        { HsluvHslf r = ::rgb2hsluvf_v(HsluvRgbf{ c.r, c.g, c.b }); return Hsl<float>{ r.h, r.s, r.l }; }
+    static Hsl<float> rgb2hpluv(const Rgb<float>& c)
+        { HsluvHslf r = ::rgb2hpluvf_v(HsluvRgbf{ c.r, c.g, c.b }); return Hsl<float>{ r.h, r.s, r.l }; }
+};
+
+}   /* namespace detail */
+
+/**
+ * Run-time HSLuv and HPLuv conversions.
+ *
+ * These forward to the hsluv2rgb_v() family for double, and to the
+ * hsluv2rgbf_v() family for float.
+ */
+template<typename T> inline Rgb<T>
+hsluv2rgb(const Hsl<T>& hsl)
+{
+    return detail::Impl<T>::hsluv2rgb(hsl);
+}
+
+template<typename T> inline Rgb<T>
+hpluv2rgb(const Hsl<T>& hpl)
+{
+    return detail::Impl<T>::hpluv2rgb(hpl);
+}
+
+template<typename T> inline Hsl<T>
+rgb2hsluv(const Rgb<T>& rgb)
+{
+    return detail::Impl<T>::rgb2hsluv(rgb);
+}
+
+template<typename T> inline Hsl<T>
+rgb2hpluv(const Rgb<T>& rgb)
+{
+    return detail::Impl<T>::rgb2hpluv(rgb);
+}
+
+}   /* namespace hsluv */
+
+
+#endif  /* HSLUV_HPP */
@@ -0,0 +1,28 @@
+/* Writes the C variant of the generated GPU code (see hsluv-shader.h), so
+ * that test_hsluv_shader can validate it against the snapshot. */
+
+#include "hsluv-shader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+int
+main(int argc, char** argv)
+{
+    size_t len = hsluv_shader_source(HSLUV_SHADER_C, NULL, 0);
+    char* buf = (char*) malloc(len + 1);
+    FILE* f;
+
+    if(argc != 2  ||  buf == NULL)
+        return 1;
+
+    hsluv_shader_source(HSLUV_SHADER_C, buf, len + 1);
+    f = fopen(argv[1], "w");
+    if(f == NULL)
+        return 1;
+    fputs(buf, f);
+    fclose(f);
+    free(buf);
+    return 0;
+}
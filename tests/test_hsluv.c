@@ -1,13 +1,46 @@
 
 #include "acutest.h"
 #include "hsluv.h"
+#include "hsluv-cache.h"
+#include "hsluv-image.h"
+#include "hsluv-lut3d.h"
+#include "hsluv-palette.h"
+#include "hsluv-stream.h"
 #include "snapshot.h"
 
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 
 #define EPSILON             0.00000001
 
+/* Error bounds of the single precision functions (see hsluv.h). */
+#define EPSILON_F_RGB       0.00002
+#define EPSILON_F_HUE       0.001
+#define EPSILON_F_SAT       0.005
+#define EPSILON_F_SAT_HPLUV 0.05
+#define EPSILON_F_L         0.00005
+
 #define ABS(x)              ((x) >= 0 ? (x) : -(x))
 
+#define TEST_CHANNEL_F(name, produced, expected, eps)                       \
+    do {                                                                    \
+        if(!TEST_CHECK_(ABS((double)(produced) - (expected)) < (eps),       \
+                        "%s channel", name))                                \
+        {                                                                   \
+            TEST_MSG("Produced: %f", (double)(produced));                   \
+            TEST_MSG("Expected: %f", expected);                             \
+        }                                                                   \
+    } while(0)
+
+/* Run the block once with each kernel available. */
+#define FOR_EACH_KERNEL(kernel)                                             \
+    for(kernel = HSLUV_KERNEL_SCALAR; kernel <= HSLUV_KERNEL_NEON; kernel++) \
+        if(hsluv_set_kernel(kernel) == 0)
+
 #define TEST_CHANNEL(name, produced, expected)                              \
     do {                                                                    \
         if(!TEST_CHECK_(ABS((produced) - (expected)) < EPSILON,             \
@@ -91,11 +124,2154 @@ test_rgb2hpluv(void)
     }
 }
 
+static void
+test_by_value(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        HsluvHsl hsluv = { snapshot[i].hsluv_h, snapshot[i].hsluv_s, snapshot[i].hsluv_l };
+        HsluvHsl hpluv = { snapshot[i].hpluv_h, snapshot[i].hpluv_s, snapshot[i].hpluv_l };
+        HsluvRgb rgb = { snapshot[i].rgb_r, snapshot[i].rgb_g, snapshot[i].rgb_b };
+        HsluvHslf hsluv_f = { (float) hsluv.h, (float) hsluv.s, (float) hsluv.l };
+        HsluvRgbf rgb_f = { (float) rgb.r, (float) rgb.g, (float) rgb.b };
+        HsluvRgb out_rgb;
+        HsluvHsl out_hsl;
+        HsluvRgbf out_rgb_f;
+        HsluvHslf out_hsl_f;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        out_rgb = hsluv2rgb_v(hsluv);
+        TEST_CHANNEL("red", out_rgb.r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", out_rgb.g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", out_rgb.b, snapshot[i].rgb_b);
+
+        out_rgb = hpluv2rgb_v(hpluv);
+        TEST_CHANNEL("red", out_rgb.r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", out_rgb.g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", out_rgb.b, snapshot[i].rgb_b);
+
+        out_hsl = rgb2hsluv_v(rgb);
+        TEST_CHANNEL("hue", out_hsl.h, snapshot[i].hsluv_h);
+        TEST_CHANNEL("saturation", out_hsl.s, snapshot[i].hsluv_s);
+        TEST_CHANNEL("lightness", out_hsl.l, snapshot[i].hsluv_l);
+
+        out_hsl = rgb2hpluv_v(rgb);
+        TEST_CHANNEL("hue", out_hsl.h, snapshot[i].hpluv_h);
+        TEST_CHANNEL("saturation", out_hsl.s, snapshot[i].hpluv_s);
+        TEST_CHANNEL("lightness", out_hsl.l, snapshot[i].hpluv_l);
+
+        out_rgb_f = hsluv2rgbf_v(hsluv_f);
+        TEST_CHANNEL_F("red", out_rgb_f.r, snapshot[i].rgb_r, EPSILON_F_RGB);
+        TEST_CHANNEL_F("green", out_rgb_f.g, snapshot[i].rgb_g, EPSILON_F_RGB);
+        TEST_CHANNEL_F("blue", out_rgb_f.b, snapshot[i].rgb_b, EPSILON_F_RGB);
+
+        out_hsl_f = rgb2hsluvf_v(rgb_f);
+        TEST_CHANNEL_F("saturation", out_hsl_f.s, snapshot[i].hsluv_s, EPSILON_F_SAT);
+        TEST_CHANNEL_F("lightness", out_hsl_f.l, snapshot[i].hsluv_l, EPSILON_F_L);
+    }
+}
+
+static void
+test_hsluv2rgb_n(void)
+{
+    /* Use stride 4 to verify the 4th (alpha) channel is left intact. */
+    static double buf[4 * (sizeof(snapshot) / sizeof(TestVector))];
+    int kernel;
+    int i;
+
+    FOR_EACH_KERNEL(kernel) {
+        for(i = 0; i < snapshot_n; i++) {
+            buf[4*i + 0] = snapshot[i].hsluv_h;
+            buf[4*i + 1] = snapshot[i].hsluv_s;
+            buf[4*i + 2] = snapshot[i].hsluv_l;
+            buf[4*i + 3] = 0.5;
+        }
+
+        hsluv2rgb_n(buf, 4, buf, 4, snapshot_n);
+
+        for(i = 0; i < snapshot_n; i++) {
+            TEST_CASE_("%s: %s", hsluv_kernel_name(kernel), snapshot[i].hex_str);
+            TEST_CHANNEL("red", buf[4*i + 0], snapshot[i].rgb_r);
+            TEST_CHANNEL("green", buf[4*i + 1], snapshot[i].rgb_g);
+            TEST_CHANNEL("blue", buf[4*i + 2], snapshot[i].rgb_b);
+            TEST_CHANNEL("alpha", buf[4*i + 3], 0.5);
+        }
+    }
+
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+}
+
+static void
+test_rgb2hsluv_n(void)
+{
+    static double in[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    static double out[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    int kernel;
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        in[3*i + 0] = snapshot[i].rgb_r;
+        in[3*i + 1] = snapshot[i].rgb_g;
+        in[3*i + 2] = snapshot[i].rgb_b;
+    }
+
+    FOR_EACH_KERNEL(kernel) {
+        /* Split the work to exercise handling of partial vectors in the kernels. */
+        rgb2hsluv_n(in, 3, out, 3, 13);
+        rgb2hsluv_n(in + 3*13, 3, out + 3*13, 3, snapshot_n - 13);
+
+        for(i = 0; i < snapshot_n; i++) {
+            TEST_CASE_("%s: %s", hsluv_kernel_name(kernel), snapshot[i].hex_str);
+            TEST_CHANNEL("hue", out[3*i + 0], snapshot[i].hsluv_h);
+            TEST_CHANNEL("saturation", out[3*i + 1], snapshot[i].hsluv_s);
+            TEST_CHANNEL("lightness", out[3*i + 2], snapshot[i].hsluv_l);
+        }
+    }
+
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+}
+
+static void
+test_hpluv2rgb_planar_n(void)
+{
+    static double h[sizeof(snapshot) / sizeof(TestVector)];
+    static double s[sizeof(snapshot) / sizeof(TestVector)];
+    static double l[sizeof(snapshot) / sizeof(TestVector)];
+    int kernel;
+    int i;
+
+    FOR_EACH_KERNEL(kernel) {
+        for(i = 0; i < snapshot_n; i++) {
+            h[i] = snapshot[i].hpluv_h;
+            s[i] = snapshot[i].hpluv_s;
+            l[i] = snapshot[i].hpluv_l;
+        }
+
+        hpluv2rgb_planar_n(h, s, l, 1, h, s, l, 1, 5);
+        hpluv2rgb_planar_n(h + 5, s + 5, l + 5, 1, h + 5, s + 5, l + 5, 1, snapshot_n - 5);
+
+        for(i = 0; i < snapshot_n; i++) {
+            TEST_CASE_("%s: %s", hsluv_kernel_name(kernel), snapshot[i].hex_str);
+            TEST_CHANNEL("red", h[i], snapshot[i].rgb_r);
+            TEST_CHANNEL("green", s[i], snapshot[i].rgb_g);
+            TEST_CHANNEL("blue", l[i], snapshot[i].rgb_b);
+        }
+    }
+
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+}
+
+static void
+test_rgb2hpluv_planar_n(void)
+{
+    static double r[sizeof(snapshot) / sizeof(TestVector)];
+    static double g[sizeof(snapshot) / sizeof(TestVector)];
+    static double b[sizeof(snapshot) / sizeof(TestVector)];
+    static double out[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    int kernel;
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        r[i] = snapshot[i].rgb_r;
+        g[i] = snapshot[i].rgb_g;
+        b[i] = snapshot[i].rgb_b;
+    }
+
+    FOR_EACH_KERNEL(kernel) {
+        TEST_CASE(hsluv_kernel_name(kernel));
+
+        /* The snapshot contains saturated colors not representable in HPLuv. */
+        TEST_CHECK(rgb2hpluv_planar_n(r, g, b, 1, out, out + 1, out + 2, 3, snapshot_n) == -1);
+        TEST_CHECK(rgb2hpluv_planar_n(r, g, b, 1, out, out + 1, out + 2, 3, 1) == 0);
+
+        for(i = 0; i < snapshot_n; i++) {
+            TEST_CASE_("%s: %s", hsluv_kernel_name(kernel), snapshot[i].hex_str);
+            TEST_CHANNEL("hue", out[3*i + 0], snapshot[i].hpluv_h);
+            TEST_CHANNEL("saturation", out[3*i + 1], snapshot[i].hpluv_s);
+            TEST_CHANNEL("lightness", out[3*i + 2], snapshot[i].hpluv_l);
+        }
+    }
+
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+}
+
+static void
+test_kernel_dispatch(void)
+{
+    HsluvKernel best = hsluv_get_kernel();
+
+    TEST_CHECK(best != HSLUV_KERNEL_AUTO);
+    TEST_CHECK(hsluv_kernel_available(best));
+    TEST_CHECK(hsluv_kernel_available(HSLUV_KERNEL_SCALAR));
+    TEST_MSG("Selected kernel: %s", hsluv_kernel_name(best));
+
+    TEST_CHECK(hsluv_set_kernel(HSLUV_KERNEL_SCALAR) == 0);
+    TEST_CHECK(hsluv_get_kernel() == HSLUV_KERNEL_SCALAR);
+    TEST_CHECK(hsluv_set_kernel(HSLUV_KERNEL_AUTO) == 0);
+    TEST_CHECK(hsluv_get_kernel() == best);
+
+    /* x86 and ARM kernels are never both built in. */
+    TEST_CHECK(!hsluv_kernel_available(HSLUV_KERNEL_SSE41)  ||  !hsluv_kernel_available(HSLUV_KERNEL_NEON));
+    TEST_CHECK(hsluv_set_kernel((HsluvKernel) 1000) == -1);
+    TEST_CHECK(hsluv_get_kernel() == best);
+    TEST_CHECK(hsluv_kernel_name((HsluvKernel) 1000) == NULL);
+}
+static void
+test_hsluv2rgbf(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        float r, g, b;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        hsluv2rgbf((float) snapshot[i].hsluv_h, (float) snapshot[i].hsluv_s,
+                   (float) snapshot[i].hsluv_l, &r, &g, &b);
+
+        TEST_CHANNEL_F("red", r, snapshot[i].rgb_r, EPSILON_F_RGB);
+        TEST_CHANNEL_F("green", g, snapshot[i].rgb_g, EPSILON_F_RGB);
+        TEST_CHANNEL_F("blue", b, snapshot[i].rgb_b, EPSILON_F_RGB);
+    }
+}
+
+static void
+test_rgb2hsluvf(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        float h, s, l;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        rgb2hsluvf((float) snapshot[i].rgb_r, (float) snapshot[i].rgb_g,
+                   (float) snapshot[i].rgb_b, &h, &s, &l);
+
+        TEST_CHANNEL_F("hue", h, snapshot[i].hsluv_h, EPSILON_F_HUE);
+        TEST_CHANNEL_F("saturation", s, snapshot[i].hsluv_s, EPSILON_F_SAT);
+        TEST_CHANNEL_F("lightness", l, snapshot[i].hsluv_l, EPSILON_F_L);
+    }
+}
+
+static void
+test_hpluv2rgbf(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        float r, g, b;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        hpluv2rgbf((float) snapshot[i].hpluv_h, (float) snapshot[i].hpluv_s,
+                   (float) snapshot[i].hpluv_l, &r, &g, &b);
+
+        TEST_CHANNEL_F("red", r, snapshot[i].rgb_r, EPSILON_F_RGB);
+        TEST_CHANNEL_F("green", g, snapshot[i].rgb_g, EPSILON_F_RGB);
+        TEST_CHANNEL_F("blue", b, snapshot[i].rgb_b, EPSILON_F_RGB);
+    }
+}
+
+static void
+test_rgb2hpluvf(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        float h, s, l;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        rgb2hpluvf((float) snapshot[i].rgb_r, (float) snapshot[i].rgb_g,
+                   (float) snapshot[i].rgb_b, &h, &s, &l);
+
+        TEST_CHANNEL_F("hue", h, snapshot[i].hpluv_h, EPSILON_F_HUE);
+        TEST_CHANNEL_F("saturation", s, snapshot[i].hpluv_s, EPSILON_F_SAT_HPLUV);
+        TEST_CHANNEL_F("lightness", l, snapshot[i].hpluv_l, EPSILON_F_L);
+    }
+}
+
+static void
+test_float_n(void)
+{
+    static float rgb[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    static float hsluv[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    static float hpluv[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    static float out[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    int kernel;
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        rgb[3*i + 0] = (float) snapshot[i].rgb_r;
+        rgb[3*i + 1] = (float) snapshot[i].rgb_g;
+        rgb[3*i + 2] = (float) snapshot[i].rgb_b;
+        hsluv[3*i + 0] = (float) snapshot[i].hsluv_h;
+        hsluv[3*i + 1] = (float) snapshot[i].hsluv_s;
+        hsluv[3*i + 2] = (float) snapshot[i].hsluv_l;
+        hpluv[3*i + 0] = (float) snapshot[i].hpluv_h;
+        hpluv[3*i + 1] = (float) snapshot[i].hpluv_s;
+        hpluv[3*i + 2] = (float) snapshot[i].hpluv_l;
+    }
+
+    FOR_EACH_KERNEL(kernel) {
+        /* Mix dense planes (with partial vector at the end) and strided
+         * data. */
+        hsluv2rgbf_planar_n(hsluv, hsluv + 1, hsluv + 2, 3, out, out + 1, out + 2, 3, 7);
+        hsluv2rgbf_n(hsluv + 3*7, 3, out + 3*7, 3, snapshot_n - 7);
+        for(i = 0; i < snapshot_n; i++) {
+            TEST_CASE_("%s: hsluv2rgbf %s", hsluv_kernel_name(kernel), snapshot[i].hex_str);
+            TEST_CHANNEL_F("red", out[3*i + 0], snapshot[i].rgb_r, EPSILON_F_RGB);
+            TEST_CHANNEL_F("green", out[3*i + 1], snapshot[i].rgb_g, EPSILON_F_RGB);
+            TEST_CHANNEL_F("blue", out[3*i + 2], snapshot[i].rgb_b, EPSILON_F_RGB);
+        }
+
+        hpluv2rgbf_n(hpluv, 3, out, 3, snapshot_n);
+        for(i = 0; i < snapshot_n; i++) {
+            TEST_CASE_("%s: hpluv2rgbf %s", hsluv_kernel_name(kernel), snapshot[i].hex_str);
+            TEST_CHANNEL_F("red", out[3*i + 0], snapshot[i].rgb_r, EPSILON_F_RGB);
+            TEST_CHANNEL_F("green", out[3*i + 1], snapshot[i].rgb_g, EPSILON_F_RGB);
+            TEST_CHANNEL_F("blue", out[3*i + 2], snapshot[i].rgb_b, EPSILON_F_RGB);
+        }
+
+        rgb2hsluvf_n(rgb, 3, out, 3, snapshot_n);
+        for(i = 0; i < snapshot_n; i++) {
+            TEST_CASE_("%s: rgb2hsluvf %s", hsluv_kernel_name(kernel), snapshot[i].hex_str);
+            TEST_CHANNEL_F("hue", out[3*i + 0], snapshot[i].hsluv_h, EPSILON_F_HUE);
+            TEST_CHANNEL_F("saturation", out[3*i + 1], snapshot[i].hsluv_s, EPSILON_F_SAT);
+            TEST_CHANNEL_F("lightness", out[3*i + 2], snapshot[i].hsluv_l, EPSILON_F_L);
+        }
+
+        TEST_CASE_("%s: rgb2hpluvf", hsluv_kernel_name(kernel));
+        TEST_CHECK(rgb2hpluvf_n(rgb, 3, out, 3, snapshot_n) == -1);
+        for(i = 0; i < snapshot_n; i++) {
+            TEST_CASE_("%s: rgb2hpluvf %s", hsluv_kernel_name(kernel), snapshot[i].hex_str);
+            TEST_CHANNEL_F("hue", out[3*i + 0], snapshot[i].hpluv_h, EPSILON_F_HUE);
+            TEST_CHANNEL_F("saturation", out[3*i + 1], snapshot[i].hpluv_s, EPSILON_F_SAT_HPLUV);
+            TEST_CHANNEL_F("lightness", out[3*i + 2], snapshot[i].hpluv_l, EPSILON_F_L);
+        }
+    }
+
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+}
+
+
+static void
+test_bounds(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        HsluvBounds bounds;
+        double r, g, b;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        hsluv_bounds_init(&bounds, snapshot[i].hsluv_l);
+        hsluv2rgb_bounds(&bounds, snapshot[i].hsluv_h, snapshot[i].hsluv_s, &r, &g, &b);
+        TEST_CHANNEL("red", r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", b, snapshot[i].rgb_b);
+
+        /* The maximal chroma lies on the boundary of the RGB gamut. */
+        if(snapshot[i].hsluv_l > 0.001  &&  snapshot[i].hsluv_l < 99.999) {
+            double c = hsluv_bounds_max_chroma(&bounds, snapshot[i].hsluv_h);
+
+            TEST_CHECK(c > 0.0);
+            hsluv2rgb_bounds(&bounds, snapshot[i].hsluv_h, 100.0, &r, &g, &b);
+            TEST_CHECK(r < EPSILON || g < EPSILON || b < EPSILON ||
+                       r > 1.0 - EPSILON || g > 1.0 - EPSILON || b > 1.0 - EPSILON);
+        }
+
+        hsluv_bounds_init(&bounds, snapshot[i].hpluv_l);
+        hpluv2rgb_bounds(&bounds, snapshot[i].hpluv_h, snapshot[i].hpluv_s, &r, &g, &b);
+        TEST_CHANNEL("red", r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", b, snapshot[i].rgb_b);
+    }
+}
+
+static void
+test_bounds_runs(void)
+{
+    /* Runs of colors of the same lightness, as the batched functions may reuse
+     * the bounds for them. */
+    static const double lightness[] = { 0.0, 25.0, 25.0, 50.0, 100.0, 100.0, 50.0 };
+    double hsl[7 * 24 * 3];
+    double rgb[7 * 24 * 3];
+    double back[7 * 24 * 3];
+    int kernel;
+    int i, j;
+
+    for(i = 0; i < 7; i++) {
+        for(j = 0; j < 24; j++) {
+            double* c = &hsl[(i * 24 + j) * 3];
+            c[0] = j * 15.0;
+            c[1] = (j % 5) * 25.0;
+            c[2] = lightness[i];
+        }
+    }
+
+    FOR_EACH_KERNEL(kernel) {
+        TEST_CASE(hsluv_kernel_name((HsluvKernel) kernel));
+
+        hsluv2rgb_n(hsl, 3, rgb, 3, 7 * 24);
+        rgb2hsluv_n(rgb, 3, back, 3, 7 * 24);
+        for(i = 0; i < 7 * 24; i++) {
+            double r, g, b, h, s, l;
+
+            hsluv2rgb(hsl[i * 3], hsl[i * 3 + 1], hsl[i * 3 + 2], &r, &g, &b);
+            TEST_CHANNEL("red", rgb[i * 3], r);
+            TEST_CHANNEL("green", rgb[i * 3 + 1], g);
+            TEST_CHANNEL("blue", rgb[i * 3 + 2], b);
+
+            rgb2hsluv(r, g, b, &h, &s, &l);
+            TEST_CHANNEL("hue", back[i * 3], h);
+            TEST_CHANNEL("saturation", back[i * 3 + 1], s);
+            TEST_CHANNEL("lightness", back[i * 3 + 2], l);
+        }
+
+        hpluv2rgb_n(hsl, 3, rgb, 3, 7 * 24);
+        for(i = 0; i < 7 * 24; i++) {
+            double r, g, b;
+
+            hpluv2rgb(hsl[i * 3], hsl[i * 3 + 1], hsl[i * 3 + 2], &r, &g, &b);
+            TEST_CHANNEL("red", rgb[i * 3], r);
+            TEST_CHANNEL("green", rgb[i * 3 + 1], g);
+            TEST_CHANNEL("blue", rgb[i * 3 + 2], b);
+        }
+    }
+
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+}
+
+static void
+test_hue_sectors(void)
+{
+    /* Long runs of one lightness get the maximal chroma from the hue sectors
+     * of the gamut polygon. It must agree with trying all the bounding lines,
+     * also near the sector boundaries (hence the fine hue step) and for the
+     * tiny polygons close to black and white. */
+    static const double extreme_l[] = { 1e-6, 0.001, 0.01, 0.1, 99.9, 99.99, 99.999, 99.99999 };
+    static double lch[3600 * 3];
+    static double hsl[3600 * 3];
+    static double out[3600 * 3];
+    static double flat[3600 * 3];
+    int kernel;
+    int i, j;
+
+    for(i = 0; i < 199 + 8; i++) {
+        double l = (i < 199 ? 0.5 * (i + 1) : extreme_l[i - 199]);
+        HsluvBounds bounds;
+
+        TEST_CASE_("L = %g", l);
+        hsluv_bounds_init(&bounds, l);
+        for(j = 0; j < 3600; j++) {
+            double h = j * 0.1;
+            double max_c = hsluv_bounds_max_chroma(&bounds, h);
+
+            hsl[j * 3] = h;
+            hsl[j * 3 + 1] = 100.0;
+            hsl[j * 3 + 2] = l;
+            lch[j * 3] = l;
+            lch[j * 3 + 1] = 0.5 * max_c;
+            lch[j * 3 + 2] = h;
+        }
+
+        hsluv2lch_n(hsl, 3, out, 3, 3600);
+        for(j = 0; j < 3600; j++) {
+            double max_c = 2.0 * lch[j * 3 + 1];
+
+            if(!TEST_CHECK(fabs(out[j * 3 + 1] - max_c) <= 1e-10 * max_c))
+                TEST_MSG("h = %g: %.17g instead of %.17g", hsl[j * 3], out[j * 3 + 1], max_c);
+        }
+
+        lch2hsluv_n(lch, 3, out, 3, 3600);
+        for(j = 0; j < 3600; j++)
+            TEST_CHANNEL_F("saturation", out[j * 3 + 1], 50.0, 1e-8);
+
+        /* The vector kernels, the other way round also for flat runs of
+         * 100 copies of one color (the middle one of each hundred of hues,
+         * away from the ambiguous hue 0 = 360). Not for the tiniest polygon
+         * next to white, whose hues the polynomial approximations of the
+         * kernels cannot resolve to EPSILON. */
+        if(l > 99.9999)
+            continue;
+        FOR_EACH_KERNEL(kernel) {
+            hsluv2rgb_n(hsl, 3, out, 3, 3600);
+            for(j = 0; j < 3600; j++) {
+                double r, g, b;
+
+                hsluv2rgb(hsl[j * 3], hsl[j * 3 + 1], hsl[j * 3 + 2], &r, &g, &b);
+                TEST_CHANNEL("red", out[j * 3], r);
+                TEST_CHANNEL("green", out[j * 3 + 1], g);
+                TEST_CHANNEL("blue", out[j * 3 + 2], b);
+            }
+
+            for(j = 0; j < 3600; j++)
+                memcpy(&flat[j * 3], &out[(j / 100 * 100 + 50) * 3], 3 * sizeof(double));
+            rgb2hsluv_n(flat, 3, out, 3, 3600);
+            for(j = 0; j < 3600; j++) {
+                double h, s, l;
+
+                rgb2hsluv(flat[j * 3], flat[j * 3 + 1], flat[j * 3 + 2], &h, &s, &l);
+                TEST_CHANNEL("hue", out[j * 3], h);
+                TEST_CHANNEL("saturation", out[j * 3 + 1], s);
+                TEST_CHANNEL("lightness", out[j * 3 + 2], l);
+            }
+        }
+    }
+
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+}
+
+static void
+test_hpluv_lut(void)
+{
+    static HsluvHpluvLut lut;
+    int i;
+
+    hsluv_hpluv_lut_init(&lut);
+
+    for(i = 0; i < snapshot_n; i++) {
+        double r, g, b, h, s, l;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        /* The snapshot has saturations way above 100.0, which multiply
+         * the error. */
+        hpluv2rgb_lut(&lut, snapshot[i].hpluv_h, snapshot[i].hpluv_s, snapshot[i].hpluv_l, &r, &g, &b);
+        TEST_CHANNEL_F("red", r, snapshot[i].rgb_r, 1e-5);
+        TEST_CHANNEL_F("green", g, snapshot[i].rgb_g, 1e-5);
+        TEST_CHANNEL_F("blue", b, snapshot[i].rgb_b, 1e-5);
+
+        rgb2hpluv_lut(&lut, snapshot[i].rgb_r, snapshot[i].rgb_g, snapshot[i].rgb_b, &h, &s, &l);
+        TEST_CHANNEL("hue", h, snapshot[i].hpluv_h);
+        TEST_CHANNEL_F("saturation", s, snapshot[i].hpluv_s, 0.0025);
+        TEST_CHANNEL("lightness", l, snapshot[i].hpluv_l);
+
+        /* The plain functions are not affected by the table. */
+        hpluv2rgb(snapshot[i].hpluv_h, snapshot[i].hpluv_s, snapshot[i].hpluv_l, &r, &g, &b);
+        TEST_CHANNEL("red", r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", b, snapshot[i].rgb_b);
+    }
+
+    /* Fine sweep over the lightness, near white in particular, where the
+     * relative error is the worst. */
+    for(i = 1; i < 20000; i++) {
+        double l = (i < 10000) ? i * 0.01 : 100.0 - (20000 - i) * 0.00001;
+        double r_lut, g_lut, b_lut, r, g, b;
+
+        hpluv2rgb_lut(&lut, i * 0.7, 100.0, l, &r_lut, &g_lut, &b_lut);
+        hpluv2rgb(i * 0.7, 100.0, l, &r, &g, &b);
+
+        TEST_CHANNEL_F("red", r_lut, r, 1e-7);
+        TEST_CHANNEL_F("green", g_lut, g, 1e-7);
+        TEST_CHANNEL_F("blue", b_lut, b, 1e-7);
+    }
+}
+
+static unsigned char
+quantize8(double c)
+{
+    return (unsigned char) (c * 255.0 + 0.5);
+}
+
+static void
+test_rgb8_exhaustive(void)
+{
+    /* All the 2^24 colors, one row of 256 blues at a time. */
+    unsigned char pixels[256 * 3];
+    unsigned char back[256 * 3];
+    double hsl[256 * 3];
+    unsigned long mismatches = 0;
+    int r, g, b;
+
+    for(r = 0; r < 256; r++) {
+        for(g = 0; g < 256; g++) {
+            for(b = 0; b < 256; b++) {
+                pixels[b * 3] = (unsigned char) r;
+                pixels[b * 3 + 1] = (unsigned char) g;
+                pixels[b * 3 + 2] = (unsigned char) b;
+            }
+
+            rgb82hsluv_n(pixels, HSLUV_FORMAT_RGB8, hsl, 3, 256);
+            hsluv2rgb8_n(hsl, 3, back, HSLUV_FORMAT_RGB8, 256);
+
+            for(b = 0; b < 256; b++) {
+                double h, s, l, rr, gg, bb;
+                const double* c = &hsl[b * 3];
+
+                rgb2hsluv(r / 255.0, g / 255.0, b / 255.0, &h, &s, &l);
+                hsluv2rgb(c[0], c[1], c[2], &rr, &gg, &bb);
+
+                if(ABS(c[0] - h) >= EPSILON  ||  ABS(c[1] - s) >= EPSILON  ||  ABS(c[2] - l) >= EPSILON  ||
+                   back[b * 3] != quantize8(rr)  ||  back[b * 3 + 1] != quantize8(gg)  ||  back[b * 3 + 2] != quantize8(bb)  ||
+                   memcmp(&back[b * 3], &pixels[b * 3], 3) != 0)
+                {
+                    if(mismatches++ < 10) {
+                        TEST_MSG("Mismatch: #%02x%02x%02x -> (%f, %f, %f) -> #%02x%02x%02x",
+                                 r, g, b, c[0], c[1], c[2], back[b * 3], back[b * 3 + 1], back[b * 3 + 2]);
+                    }
+                }
+            }
+        }
+    }
+
+    TEST_CHECK(mismatches == 0);
+}
+
+static void
+test_rgb8_formats(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        unsigned char rgb[3] = { quantize8(snapshot[i].rgb_r), quantize8(snapshot[i].rgb_g), quantize8(snapshot[i].rgb_b) };
+        unsigned char rgba[4] = { rgb[0], rgb[1], rgb[2], 0x42 };
+        unsigned char bgra[4] = { rgb[2], rgb[1], rgb[0], 0x42 };
+        unsigned char out[4];
+        double hsl[3], hpl[3], tmp[3];
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        rgb82hsluv_n(rgb, HSLUV_FORMAT_RGB8, hsl, 3, 1);
+        TEST_CHANNEL("hue", hsl[0], snapshot[i].hsluv_h);
+        TEST_CHANNEL("saturation", hsl[1], snapshot[i].hsluv_s);
+        TEST_CHANNEL("lightness", hsl[2], snapshot[i].hsluv_l);
+
+        TEST_CHECK(rgb82hpluv_n(rgb, HSLUV_FORMAT_RGB8, hpl, 3, 1) == (snapshot[i].hpluv_s > 100.0 ? -1 : 0));
+        TEST_CHANNEL("hue", hpl[0], snapshot[i].hpluv_h);
+        TEST_CHANNEL("saturation", hpl[1], snapshot[i].hpluv_s);
+        TEST_CHANNEL("lightness", hpl[2], snapshot[i].hpluv_l);
+
+        rgb82hsluv_n(rgba, HSLUV_FORMAT_RGBA8, tmp, 3, 1);
+        TEST_CHECK(memcmp(tmp, hsl, sizeof(hsl)) == 0);
+        rgb82hsluv_n(bgra, HSLUV_FORMAT_BGRA8, tmp, 3, 1);
+        TEST_CHECK(memcmp(tmp, hsl, sizeof(hsl)) == 0);
+
+        out[3] = 0x99;
+        hsluv2rgb8_n(hsl, 3, out, HSLUV_FORMAT_RGBA8, 1);
+        TEST_CHECK(memcmp(out, rgba, 3) == 0  &&  out[3] == 0x99);
+        hsluv2rgb8_n(hsl, 3, out, HSLUV_FORMAT_BGRA8, 1);
+        TEST_CHECK(memcmp(out, bgra, 3) == 0  &&  out[3] == 0x99);
+        hpluv2rgb8_n(hpl, 3, out, HSLUV_FORMAT_BGRA8, 1);
+        TEST_CHECK(memcmp(out, bgra, 3) == 0  &&  out[3] == 0x99);
+        hpluv2rgb8_n(hpl, 3, out, HSLUV_FORMAT_RGB8, 1);
+        TEST_CHECK(memcmp(out, rgb, 3) == 0);
+    }
+}
+
+static void
+test_cache(void)
+{
+    static const char path[] = "test_hsluv_cache.bin";
+    HsluvCache* cache;
+    HsluvCache* loaded;
+    unsigned char pixels[4096 * 4];
+    double expected[4096 * 3];
+    double cached[4096 * 3];
+    uint16_t cached16[4096 * 3];
+    uint16_t loaded16[4096 * 3];
+    int i;
+
+    cache = hsluv_cache_build();
+    if(!TEST_CHECK(cache != NULL))
+        return;
+    TEST_CHECK(hsluv_cache_footprint(cache) == (size_t) 256 * 256 * 256 * 3 * sizeof(uint16_t));
+    TEST_CHECK(hsluv_cache_build_time(cache) > 0.0);
+
+    /* A sample of colors spread over the whole cube. */
+    for(i = 0; i < 4096; i++) {
+        unsigned long color = (unsigned long) i * 4099u;
+        pixels[i * 4] = (unsigned char) (color >> 16);
+        pixels[i * 4 + 1] = (unsigned char) (color >> 8);
+        pixels[i * 4 + 2] = (unsigned char) color;
+        pixels[i * 4 + 3] = 0xff;
+    }
+
+    rgb82hsluv_n(pixels, HSLUV_FORMAT_RGBA8, expected, 3, 4096);
+    hsluv_cache_rgb82hsluv_n(cache, pixels, HSLUV_FORMAT_RGBA8, cached, 3, 4096);
+    for(i = 0; i < 4096; i++) {
+        TEST_CHANNEL_F("hue", cached[i * 3], expected[i * 3], 0.0028);
+        TEST_CHANNEL_F("saturation", cached[i * 3 + 1], expected[i * 3 + 1], 0.00077);
+        TEST_CHANNEL_F("lightness", cached[i * 3 + 2], expected[i * 3 + 2], 0.00077);
+    }
+
+    hsluv_cache_rgb82hsluv16_n(cache, pixels, HSLUV_FORMAT_RGBA8, cached16, 3, 4096);
+    for(i = 0; i < 4096 * 3; i++)
+        TEST_CHECK(cached16[i] * ((i % 3 == 0) ? (360.0 / 65535.0) : (100.0 / 65535.0)) == cached[i]);
+
+    /* Round trip through a file. */
+    if(TEST_CHECK(hsluv_cache_save(cache, path) == 0)) {
+        loaded = hsluv_cache_load(path);
+        if(TEST_CHECK(loaded != NULL)) {
+            TEST_CHECK(hsluv_cache_footprint(loaded) >= hsluv_cache_footprint(cache));
+            TEST_CHECK(hsluv_cache_build_time(loaded) == 0.0);
+            hsluv_cache_rgb82hsluv16_n(loaded, pixels, HSLUV_FORMAT_RGBA8, loaded16, 3, 4096);
+            TEST_CHECK(memcmp(loaded16, cached16, sizeof(cached16)) == 0);
+            hsluv_cache_free(loaded);
+        }
+        remove(path);
+    }
+
+    TEST_CHECK(hsluv_cache_load(path) == NULL);
+    hsluv_cache_free(cache);
+}
+
+static void
+test_lut3d(void)
+{
+    enum { N = 4096 };
+    static double rgb[N * 3];
+    static double exact[N * 3];
+    static double ref[N * 3];
+    static double out[N * 3];
+    static float rgbf[N * 3];
+    static float outf[N * 3];
+    HsluvLut3d* lut;
+    HsluvLut3dAccuracy acc;
+    HsluvKernel kernel;
+    double h, s, l, eh, es, el;
+    int i;
+
+    TEST_CHECK(hsluv_lut3d_build(2) == NULL);
+    TEST_CHECK(hsluv_lut3d_build(257) == NULL);
+
+    lut = hsluv_lut3d_build(33);
+    if(!TEST_CHECK(lut != NULL))
+        return;
+    TEST_CHECK(hsluv_lut3d_size(lut) == 33);
+    TEST_CHECK(hsluv_lut3d_footprint(lut) == (size_t) 33 * 33 * 33 * 3 * sizeof(float));
+    TEST_CHECK(hsluv_lut3d_build_time(lut) > 0.0);
+
+    /* Colors off the nodes, in all the cells of a 16^3 grid. */
+    for(i = 0; i < N; i++) {
+        rgb[i * 3] = ((i & 0xf) + 0.37) / 16.0;
+        rgb[i * 3 + 1] = (((i >> 4) & 0xf) + 0.61) / 16.0;
+        rgb[i * 3 + 2] = (((i >> 8) & 0xf) + 0.13) / 16.0;
+    }
+    rgb2hsluv_n(rgb, 3, exact, 3, N);
+
+    /* The scalar kernel against the exact conversion. */
+    hsluv_set_kernel(HSLUV_KERNEL_SCALAR);
+    hsluv_lut3d_rgb2hsluv_n(lut, rgb, 3, ref, 3, N);
+    for(i = 0; i < N; i++) {
+        double dh = fabs(ref[i * 3] - exact[i * 3]);
+
+        if(dh > 180.0)
+            dh = 360.0 - dh;
+        if(exact[i * 3 + 1] >= 1.0)
+            TEST_CHANNEL_F("hue", dh, 0.0, 4.1);
+        TEST_CHANNEL_F("saturation", ref[i * 3 + 1], exact[i * 3 + 1], 2.0);
+        TEST_CHANNEL_F("lightness", ref[i * 3 + 2], exact[i * 3 + 2], 0.15);
+        if(exact[i * 3 + 2] < 3.9) {
+            /* The dark colors are converted exactly. */
+            TEST_CHANNEL("saturation", ref[i * 3 + 1], exact[i * 3 + 1]);
+            TEST_CHANNEL("lightness", ref[i * 3 + 2], exact[i * 3 + 2]);
+        }
+    }
+
+    /* The vectorized kernels against the scalar one. */
+    FOR_EACH_KERNEL(kernel) {
+        TEST_CASE(hsluv_kernel_name(kernel));
+        hsluv_lut3d_rgb2hsluv_n(lut, rgb, 3, out, 3, 13);
+        hsluv_lut3d_rgb2hsluv_n(lut, rgb + 3 * 13, 3, out + 3 * 13, 3, N - 13);
+        for(i = 0; i < N * 3; i++)
+            TEST_CHANNEL_F("hsl", out[i], ref[i], 1e-6);
+    }
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+
+    /* On the nodes, the table is exact but for the rounding of the nodes. */
+    hsluv_lut3d_rgb2hsluv(lut, 0.5, 0.25, 0.125, &h, &s, &l);
+    rgb2hsluv(0.5, 0.25, 0.125, &eh, &es, &el);
+    TEST_CHANNEL_F("hue", h, eh, EPSILON_F_HUE);
+    TEST_CHANNEL_F("saturation", s, es, EPSILON_F_SAT);
+    TEST_CHANNEL_F("lightness", l, el, EPSILON_F_L);
+
+    /* Grays stay gray, and the input is clamped. */
+    for(i = 0; i <= 100; i++) {
+        hsluv_lut3d_rgb2hsluv(lut, i / 100.0, i / 100.0, i / 100.0, &h, &s, &l);
+        TEST_CHECK_(s < 1e-4, "gray %d: saturation %f", i, s);
+    }
+    hsluv_lut3d_rgb2hsluv(lut, 1.5, 2.0, 1.0, &h, &s, &l);
+    TEST_CHANNEL_F("lightness", l, 100.0, EPSILON_F_L);
+    hsluv_lut3d_rgb2hsluv(lut, -0.5, 0.0, -1.0, &h, &s, &l);
+    TEST_CHECK(l == 0.0  &&  s == 0.0);
+
+    /* Single precision. */
+    for(i = 0; i < N * 3; i++)
+        rgbf[i] = (float) rgb[i];
+    FOR_EACH_KERNEL(kernel) {
+        TEST_CASE(hsluv_kernel_name(kernel));
+        hsluv_lut3d_rgb2hsluvf_n(lut, rgbf, 3, outf, 3, N);
+        for(i = 0; i < N; i++) {
+            TEST_CHANNEL_F("saturation", outf[i * 3 + 1], exact[i * 3 + 1], 2.0);
+            TEST_CHANNEL_F("lightness", outf[i * 3 + 2], exact[i * 3 + 2], 0.15);
+        }
+    }
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+
+    TEST_CHECK(hsluv_lut3d_accuracy(lut, 0, &acc) == -1);
+    if(TEST_CHECK(hsluv_lut3d_accuracy(lut, 20, &acc) == 0)) {
+        TEST_CHECK(acc.n == 20 * 20 * 20);
+        TEST_CHECK(acc.max_s < 2.0  &&  acc.rms_s < 0.1);
+        TEST_CHECK(acc.max_l < 0.15  &&  acc.rms_l < 0.01);
+        TEST_CHECK(acc.rms_h <= acc.max_h);
+    }
+
+    hsluv_lut3d_free(lut);
+}
+
+/* A trivial scheduler running the tasks backwards, to check the tiles do not
+ * depend on the order. */
+static void
+reverse_parallel(HsluvTaskFunc task, void* task_data, size_t n, void* user_data)
+{
+    size_t* n_calls = (size_t*) user_data;
+    size_t i;
+
+    for(i = n; i > 0; i--) {
+        task(task_data, i - 1);
+        (*n_calls)++;
+    }
+}
+
+static void
+test_image_size(HsluvThreadPool* pool, size_t width, size_t height)
+{
+    /* Rows padded on both sides. */
+    size_t rgb_stride = width * 4 + 13;
+    size_t hsl_stride = width * 3 + 5;
+    unsigned char* rgb = (unsigned char*) malloc(rgb_stride * height);
+    unsigned char* rgb_out = (unsigned char*) malloc(rgb_stride * height);
+    double* expected = (double*) malloc(hsl_stride * height * sizeof(double));
+    double* hsl = (double*) malloc(hsl_stride * height * sizeof(double));
+    size_t n_calls = 0;
+    size_t x, y;
+    int ret;
+
+    if(!TEST_CHECK(rgb != NULL  &&  rgb_out != NULL  &&  expected != NULL  &&  hsl != NULL))
+        goto out;
+
+    for(y = 0; y < height; y++) {
+        for(x = 0; x < width * 4; x++)
+            rgb[y * rgb_stride + x] = (unsigned char) ((x * 7 + y * 131) ^ (x >> 5));
+    }
+
+    for(y = 0; y < height; y++)
+        rgb82hsluv_n(rgb + y * rgb_stride, HSLUV_FORMAT_RGBA8, expected + y * hsl_stride, 3, width);
+
+    memset(hsl, 0, hsl_stride * height * sizeof(double));
+    rgb82hsluv_image(rgb, rgb_stride, HSLUV_FORMAT_RGBA8, hsl, hsl_stride, width, height, NULL, NULL);
+    for(y = 0; y < height; y++)
+        TEST_CHECK(memcmp(hsl + y * hsl_stride, expected + y * hsl_stride, width * 3 * sizeof(double)) == 0);
+
+    memset(hsl, 0, hsl_stride * height * sizeof(double));
+    rgb82hsluv_image(rgb, rgb_stride, HSLUV_FORMAT_RGBA8, hsl, hsl_stride, width, height,
+                     hsluv_thread_pool_run, pool);
+    for(y = 0; y < height; y++)
+        TEST_CHECK(memcmp(hsl + y * hsl_stride, expected + y * hsl_stride, width * 3 * sizeof(double)) == 0);
+
+    memset(hsl, 0, hsl_stride * height * sizeof(double));
+    rgb82hsluv_image(rgb, rgb_stride, HSLUV_FORMAT_RGBA8, hsl, hsl_stride, width, height,
+                     reverse_parallel, &n_calls);
+    TEST_CHECK(n_calls > 1);
+    for(y = 0; y < height; y++)
+        TEST_CHECK(memcmp(hsl + y * hsl_stride, expected + y * hsl_stride, width * 3 * sizeof(double)) == 0);
+
+    /* And back. The alpha and the padding are left untouched. */
+    memcpy(rgb_out, rgb, rgb_stride * height);
+    for(y = 0; y < height; y++) {
+        for(x = 0; x < width; x++)
+            rgb_out[y * rgb_stride + x * 4] ^= 0xff;
+    }
+    hsluv2rgb8_image(hsl, hsl_stride, rgb_out, rgb_stride, HSLUV_FORMAT_RGBA8, width, height,
+                     hsluv_thread_pool_run, pool);
+    TEST_CHECK(memcmp(rgb_out, rgb, rgb_stride * height) == 0);
+
+    /* HPLuv, with the out-of-gamut flag collected from all the tiles. */
+    for(y = 0; y < height; y++)
+        rgb82hpluv_n(rgb + y * rgb_stride, HSLUV_FORMAT_RGBA8, expected + y * hsl_stride, 3, width);
+    ret = rgb82hpluv_image(rgb, rgb_stride, HSLUV_FORMAT_RGBA8, hsl, hsl_stride, width, height,
+                           hsluv_thread_pool_run, pool);
+    TEST_CHECK(ret == -1);
+    for(y = 0; y < height; y++)
+        TEST_CHECK(memcmp(hsl + y * hsl_stride, expected + y * hsl_stride, width * 3 * sizeof(double)) == 0);
+    hpluv2rgb8_image(hsl, hsl_stride, rgb_out, rgb_stride, HSLUV_FORMAT_RGBA8, width, height, NULL, NULL);
+    TEST_CHECK(memcmp(rgb_out, rgb, rgb_stride * height) == 0);
+
+out:
+    free(rgb);
+    free(rgb_out);
+    free(expected);
+    free(hsl);
+}
+
+static void
+test_image(void)
+{
+    HsluvThreadPool* pool;
+    unsigned char gray[4 * 4 * 3];
+    double hsl[4 * 4 * 3];
+
+    pool = hsluv_thread_pool_create(4);
+    if(!TEST_CHECK(pool != NULL))
+        return;
+#ifdef HSLUV_NO_THREADS
+    TEST_CHECK(hsluv_thread_pool_size(pool) == 1);
+#else
+    TEST_CHECK(hsluv_thread_pool_size(pool) == 4);
+#endif
+
+    /* Tiles of whole rows, and tiles splitting the rows. */
+    TEST_CASE("1000x37");
+    test_image_size(pool, 1000, 37);
+    TEST_CASE("5000x3");
+    test_image_size(pool, 5000, 3);
+
+    /* Tightly packed grays are all in HPLuv. */
+    TEST_CASE("4x4 gray");
+    memset(gray, 0x80, sizeof(gray));
+    TEST_CHECK(rgb82hpluv_image(gray, 4 * 3, HSLUV_FORMAT_RGB8, hsl, 4 * 3, 4, 4,
+                                hsluv_thread_pool_run, pool) == 0);
+    TEST_CHECK(rgb82hpluv_image(gray, 4 * 3, HSLUV_FORMAT_RGB8, hsl, 4 * 3, 0, 4,
+                                hsluv_thread_pool_run, pool) == 0);
+
+    hsluv_thread_pool_destroy(pool);
+
+    pool = hsluv_thread_pool_create(0);
+    if(TEST_CHECK(pool != NULL))
+        TEST_CHECK(hsluv_thread_pool_size(pool) >= 1);
+    hsluv_thread_pool_destroy(pool);
+}
+
+/* Compare the statistics with those computed naively from the colors. */
+static void
+check_image_stats(const HsluvImageStats* stats, const double* hsl, size_t n)
+{
+    size_t hue_bins[36] = { 0 };
+    size_t saturation_bins[10] = { 0 };
+    size_t lightness_bins[7] = { 0 };
+    double sum_s = 0.0, sum_l = 0.0, var_s = 0.0, var_l = 0.0;
+    double sum_cos = 0.0, sum_sin = 0.0, mean_hue;
+    double deg = atan(1.0) / 45.0;
+    size_t n_chromatic = 0;
+    size_t i;
+
+    for(i = 0; i < n; i++) {
+        double h = hsl[i * 3], s = hsl[i * 3 + 1], l = hsl[i * 3 + 2];
+
+        saturation_bins[s >= 100.0 ? 9 : (int) (s / 10.0)]++;
+        lightness_bins[l >= 100.0 ? 6 : (int) (l * 7.0 / 100.0)]++;
+        if(s >= 5.0) {
+            hue_bins[h >= 360.0 ? 35 : (int) (h / 10.0)]++;
+            n_chromatic++;
+            sum_cos += cos(h * deg);
+            sum_sin += sin(h * deg);
+        }
+        sum_s += s;
+        sum_l += l;
+    }
+    for(i = 0; i < n; i++) {
+        var_s += (hsl[i * 3 + 1] - sum_s / n) * (hsl[i * 3 + 1] - sum_s / n);
+        var_l += (hsl[i * 3 + 2] - sum_l / n) * (hsl[i * 3 + 2] - sum_l / n);
+    }
+    mean_hue = fmod(atan2(sum_sin, sum_cos) / deg + 360.0, 360.0);
+
+    TEST_CHECK(stats->n == n);
+    TEST_CHECK(stats->n_chromatic == n_chromatic);
+    TEST_CHECK(memcmp(stats->hue_bins, hue_bins, sizeof(hue_bins)) == 0);
+    TEST_CHECK(memcmp(stats->saturation_bins, saturation_bins, sizeof(saturation_bins)) == 0);
+    TEST_CHECK(memcmp(stats->lightness_bins, lightness_bins, sizeof(lightness_bins)) == 0);
+    TEST_CHANNEL_F("mean saturation", stats->mean_saturation, sum_s / n, 1e-9);
+    TEST_CHANNEL_F("mean lightness", stats->mean_lightness, sum_l / n, 1e-9);
+    TEST_CHANNEL_F("var saturation", stats->var_saturation, var_s / n, 1e-7);
+    TEST_CHANNEL_F("var lightness", stats->var_lightness, var_l / n, 1e-7);
+    TEST_CHANNEL_F("mean hue", stats->mean_hue, mean_hue, 1e-7);
+    TEST_CHANNEL_F("hue concentration", stats->hue_concentration,
+                   sqrt(sum_cos * sum_cos + sum_sin * sum_sin) / n_chromatic, 1e-9);
+}
+
+static void
+test_image_stats(void)
+{
+    enum { W = 300, H = 70, STRIDE = W * 4 + 9 };
+    static unsigned char rgb[H * STRIDE];
+    static double hsl[W * H * 3];
+    static double rgbd[W * H * 3];
+    size_t hue_bins[36], saturation_bins[10], lightness_bins[7];
+    HsluvImageStats stats;
+    HsluvThreadPool* pool;
+    size_t n_calls = 0;
+    int x, y;
+
+    /* Noise, with a band of grays. */
+    for(y = 0; y < H; y++) {
+        for(x = 0; x < W * 4; x++)
+            rgb[y * STRIDE + x] = (unsigned char) ((x * 7 + y * 131) ^ (x >> 5));
+        if(y % 10 == 0) {
+            for(x = 0; x < W * 4; x++)
+                rgb[y * STRIDE + x] = rgb[y * STRIDE + x / 4 * 4];
+        }
+        rgb82hsluv_n(rgb + y * STRIDE, HSLUV_FORMAT_RGBA8, hsl + y * W * 3, 3, W);
+    }
+
+    memset(&stats, 0, sizeof(stats));
+    stats.hue_bins = hue_bins;
+    stats.n_hue_bins = 36;
+    stats.saturation_bins = saturation_bins;
+    stats.n_saturation_bins = 10;
+    stats.lightness_bins = lightness_bins;
+    stats.n_lightness_bins = 7;
+    stats.min_saturation = 5.0;
+
+    pool = hsluv_thread_pool_create(4);
+    if(!TEST_CHECK(pool != NULL))
+        return;
+
+    TEST_CASE("serial");
+    rgb82hsluv_image_stats(rgb, STRIDE, HSLUV_FORMAT_RGBA8, W, H, &stats, NULL, NULL);
+    check_image_stats(&stats, hsl, W * H);
+    TEST_CASE("pool");
+    rgb82hsluv_image_stats(rgb, STRIDE, HSLUV_FORMAT_RGBA8, W, H, &stats, hsluv_thread_pool_run, pool);
+    check_image_stats(&stats, hsl, W * H);
+    TEST_CASE("reverse");
+    rgb82hsluv_image_stats(rgb, STRIDE, HSLUV_FORMAT_RGBA8, W, H, &stats, reverse_parallel, &n_calls);
+    TEST_CHECK(n_calls == (W * H + 4095) / 4096);
+    check_image_stats(&stats, hsl, W * H);
+
+    /* Doubles. */
+    TEST_CASE("doubles");
+    for(y = 0; y < H; y++) {
+        for(x = 0; x < W * 3; x++)
+            rgbd[y * W * 3 + x] = rgb[y * STRIDE + x / 3 * 4 + x % 3] / 255.0;
+    }
+    rgb2hsluv_n(rgbd, 3, hsl, 3, W * H);
+    rgb2hsluv_stats_n(rgbd, 3, W * H, &stats);
+    check_image_stats(&stats, hsl, W * H);
+
+    /* Nothing but the moments of one gray. */
+    TEST_CASE("gray");
+    memset(rgb, 0x40, sizeof(rgb));
+    stats.hue_bins = NULL;
+    stats.saturation_bins = NULL;
+    stats.n_lightness_bins = 0;
+    rgb82hsluv_image_stats(rgb, STRIDE, HSLUV_FORMAT_RGB8, W, H, &stats, hsluv_thread_pool_run, pool);
+    TEST_CHECK(stats.lightness_bins == NULL);
+    TEST_CHECK(stats.n == W * H  &&  stats.n_chromatic == 0);
+    TEST_CHECK(stats.mean_hue == 0.0  &&  stats.hue_concentration == 0.0);
+    TEST_CHECK(stats.mean_saturation < 1e-8  &&  stats.var_saturation < 1e-12);
+    TEST_CHECK(stats.var_lightness < 1e-12);
+    rgb82hsluv_image_stats(rgb, STRIDE, HSLUV_FORMAT_RGB8, 0, H, &stats, hsluv_thread_pool_run, pool);
+    TEST_CHECK(stats.n == 0  &&  stats.mean_lightness == 0.0);
+
+    hsluv_thread_pool_destroy(pool);
+}
+
+typedef struct FrameCheck_tag FrameCheck;
+struct FrameCheck_tag {
+    const double* expected;
+    size_t size;
+    int* order;
+    int* n_done;
+    int index;
+    int ok;
+};
+
+/* Runs in the driver thread: record the results for the main thread. */
+static void
+frame_done(HsluvFrame* frame, void* user_data)
+{
+    FrameCheck* check = (FrameCheck*) user_data;
+
+    check->ok = (memcmp(hsluv_frame_data(frame, NULL), check->expected, check->size) == 0  &&
+                 hsluv_frame_status(frame) == 0);
+    check->order[(*check->n_done)++] = check->index;
+    hsluv_frame_release(frame);
+}
+
+static void
+test_frame_pipeline(void)
+{
+    enum { W = 300, H = 40, N_FRAMES = 8 };
+    static unsigned char rgb[N_FRAMES][H][W * 4];
+    static double expected[N_FRAMES][H * W * 3];
+    static unsigned char rgb_out[H * W * 4];
+    HsluvFrameConfig config;
+    HsluvFramePipeline* pipeline;
+    HsluvFrame* frames[3];
+    HsluvFrame* frame;
+    HsluvFrameTiming timing;
+    HsluvFramePipelineStats stats;
+    FrameCheck checks[N_FRAMES + 1];
+    int order[N_FRAMES + 1];
+    int n_done = 0;
+    size_t stride;
+    int f, x, y;
+
+    for(f = 0; f < N_FRAMES; f++) {
+        for(y = 0; y < H; y++) {
+            for(x = 0; x < W * 4; x++)
+                rgb[f][y][x] = (unsigned char) ((x * 7 + y * 131 + f * 37) ^ (x >> 5));
+        }
+        rgb82hsluv_n(&rgb[f][0][0], HSLUV_FORMAT_RGBA8, expected[f], 3, H * W);
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.op = HSLUV_FRAME_RGB82HSLUV;
+    config.format = HSLUV_FORMAT_RGBA8;
+    config.width = W;
+    config.height = H;
+    TEST_CHECK(hsluv_frame_pipeline_create(&config) == NULL);     /* No buffers. */
+    config.n_buffers = 3;
+    config.n_threads = 3;
+    config.pin_threads = 1;
+    config.height = 0;
+    TEST_CHECK(hsluv_frame_pipeline_create(&config) == NULL);
+    config.height = H;
+    config.op = (HsluvFrameOp) 42;
+    TEST_CHECK(hsluv_frame_pipeline_create(&config) == NULL);
+    config.op = HSLUV_FRAME_RGB82HSLUV;
+    config.format = (HsluvFormat) 3;
+    TEST_CHECK(hsluv_frame_pipeline_create(&config) == NULL);
+    config.format = HSLUV_FORMAT_RGBA8;
+
+#ifdef HSLUV_NO_THREADS
+    /* No driver thread. */
+    TEST_CHECK(hsluv_frame_pipeline_create(&config) == NULL);
+    return;
+#endif
+
+    pipeline = hsluv_frame_pipeline_create(&config);
+    if(!TEST_CHECK(pipeline != NULL))
+        return;
+
+    /* The pool is bounded. */
+    for(f = 0; f < 3; f++)
+        frames[f] = hsluv_frame_acquire(pipeline, 0);
+    TEST_CHECK(frames[0] != NULL  &&  frames[1] != NULL  &&  frames[2] != NULL);
+    TEST_CHECK(hsluv_frame_acquire(pipeline, 0) == NULL);
+    TEST_CHECK(hsluv_frame_data(frames[0], &stride) != hsluv_frame_data(frames[1], NULL));
+    TEST_CHECK(stride == W * 3);
+    for(f = 0; f < 3; f++)
+        TEST_CHECK(hsluv_frame_release(frames[f]) == 0);
+    TEST_CHECK(hsluv_frame_submit(frames[0], rgb[0], W * 4, NULL, NULL) == -1);
+
+    /* A stream of frames, more than the pool, released by the callbacks. */
+    for(f = 0; f < N_FRAMES; f++) {
+        checks[f].expected = expected[f];
+        checks[f].size = sizeof(expected[f]);
+        checks[f].order = order;
+        checks[f].n_done = &n_done;
+        checks[f].index = f;
+        checks[f].ok = 0;
+
+        frame = hsluv_frame_acquire(pipeline, 1);
+        if(!TEST_CHECK(frame != NULL))
+            break;
+        TEST_CHECK(hsluv_frame_submit(frame, rgb[f], W * 4, frame_done, &checks[f]) == 0);
+        TEST_CHECK(hsluv_frame_submit(frame, rgb[f], W * 4, frame_done, &checks[f]) == -1);
+    }
+
+    /* Waiting on a frame, with the frames before it still in flight. */
+    frame = hsluv_frame_acquire(pipeline, 1);
+    TEST_CHECK(hsluv_frame_submit(frame, rgb[1], W * 4, NULL, NULL) == 0);
+    TEST_CHECK(hsluv_frame_wait(frame) == 0);
+    TEST_CHECK(memcmp(hsluv_frame_data(frame, NULL), expected[1], sizeof(expected[1])) == 0);
+    hsluv_frame_timing(frame, &timing);
+    TEST_CHECK(timing.queue_time >= 0.0  &&  timing.convert_time > 0.0);
+    TEST_CHECK(timing.latency >= timing.convert_time);
+    TEST_CHECK(hsluv_frame_release(frame) == 0);
+    TEST_CHECK(hsluv_frame_release(frame) == -1);
+
+    /* Destroying the pipeline finishes the frames submitted. */
+    checks[N_FRAMES] = checks[0];
+    checks[N_FRAMES].index = N_FRAMES;
+    frame = hsluv_frame_acquire(pipeline, 1);
+    TEST_CHECK(hsluv_frame_submit(frame, rgb[0], W * 4, frame_done, &checks[N_FRAMES]) == 0);
+    hsluv_frame_pipeline_stats(pipeline, &stats);
+    TEST_CHECK(stats.n_frames >= N_FRAMES + 1  &&  stats.n_frames <= N_FRAMES + 2);
+    TEST_CHECK(stats.max_latency >= stats.mean_latency  &&  stats.mean_latency > 0.0);
+    hsluv_frame_pipeline_destroy(pipeline);
+
+    TEST_CHECK(n_done == N_FRAMES + 1);
+    for(f = 0; f <= N_FRAMES; f++) {
+        TEST_CHECK_(checks[f].ok, "frame %d", f);
+        TEST_CHECK_(order[f] == f, "order of frame %d", f);
+    }
+
+    /* The other way, and HPLuv with its out-of-gamut flag. */
+    config.op = HSLUV_FRAME_HSLUV2RGB8;
+    config.n_buffers = 1;
+    config.n_threads = 0;
+    config.pin_threads = 0;
+    pipeline = hsluv_frame_pipeline_create(&config);
+    if(TEST_CHECK(pipeline != NULL)) {
+        frame = hsluv_frame_acquire(pipeline, 1);
+        hsluv_frame_data(frame, &stride);
+        TEST_CHECK(stride == W * 4);
+        TEST_CHECK(hsluv_frame_submit(frame, expected[2], W * 3, NULL, NULL) == 0);
+        TEST_CHECK(hsluv_frame_wait(frame) == 0);
+        /* With opaque alpha. */
+        memset(rgb_out, 0xff, sizeof(rgb_out));
+        hsluv2rgb8_n(expected[2], 3, rgb_out, HSLUV_FORMAT_RGBA8, H * W);
+        TEST_CHECK(memcmp(hsluv_frame_data(frame, NULL), rgb_out, sizeof(rgb_out)) == 0);
+        hsluv_frame_release(frame);
+        hsluv_frame_pipeline_destroy(pipeline);
+    }
+
+    config.op = HSLUV_FRAME_RGB82HPLUV;
+    pipeline = hsluv_frame_pipeline_create(&config);
+    if(TEST_CHECK(pipeline != NULL)) {
+        frame = hsluv_frame_acquire(pipeline, 1);
+        TEST_CHECK(hsluv_frame_submit(frame, rgb[3], W * 4, NULL, NULL) == 0);
+        TEST_CHECK(hsluv_frame_wait(frame) == -1);
+        TEST_CHECK(hsluv_frame_status(frame) == -1);
+        hsluv_frame_release(frame);
+        hsluv_frame_pipeline_destroy(pipeline);
+    }
+}
+
+static double
+ref_to_linear(double c)
+{
+    return (c > 0.04045) ? pow((c + 0.055) / 1.055, 2.4) : c / 12.92;
+}
+
+static void
+test_stream(void)
+{
+    enum { N = 1000 };
+    unsigned char rgba[N * 4];
+    unsigned char rgba_out[N * 4];
+    uint16_t rgba16[N * 4];
+    float hsla[N * 4];
+    float hsla_chunks[N * 4];
+    double expected[N * 3];
+    HsluvStream* to_hsl;
+    HsluvStream* to_rgb;
+    HsluvStream* stream;
+    size_t i, j;
+
+    for(i = 0; i < N * 4; i++)
+        rgba[i] = (unsigned char) ((i * 7) ^ (i >> 5));
+
+    /* RGBA8 to HSLuv, in floats and in 16-bit integers. */
+    TEST_CASE("rgba8");
+    rgb82hsluv_n(rgba, HSLUV_FORMAT_RGBA8, expected, 3, N);
+    to_hsl = hsluv_stream_create(HSLUV_SPACE_RGB, HSLUV_PIXEL_RGBA8, HSLUV_SPACE_HSLUV, HSLUV_PIXEL_RGBA_F32, 0);
+    if(!TEST_CHECK(to_hsl != NULL))
+        return;
+    TEST_CHECK(hsluv_stream_convert(to_hsl, rgba, hsla, N) == 0);
+    for(i = 0; i < N; i++) {
+        TEST_CHECK(fabs(hsla[i * 4] * 360.0 - expected[i * 3]) < 1e-3);
+        TEST_CHECK(fabs(hsla[i * 4 + 1] * 100.0 - expected[i * 3 + 1]) < 1e-4);
+        TEST_CHECK(fabs(hsla[i * 4 + 2] * 100.0 - expected[i * 3 + 2]) < 1e-4);
+        TEST_CHECK(hsla[i * 4 + 3] == rgba[i * 4 + 3] / 255.0f);
+    }
+
+    /* Any chunks give the same result. */
+    for(i = 0; i < N; i += j) {
+        j = (N - i < 7 ? N - i : 7);
+        hsluv_stream_convert(to_hsl, rgba + i * 4, hsla_chunks + i * 4, j);
+    }
+    TEST_CHECK(memcmp(hsla_chunks, hsla, sizeof(hsla)) == 0);
+
+    stream = hsluv_stream_create(HSLUV_SPACE_RGB, HSLUV_PIXEL_BGRA8, HSLUV_SPACE_HSLUV, HSLUV_PIXEL_RGBA16, 0);
+    TEST_CHECK(stream != NULL);
+    rgb82hsluv_n(rgba, HSLUV_FORMAT_BGRA8, expected, 3, N);
+    hsluv_stream_convert(stream, rgba, rgba16, N);
+    for(i = 0; i < N; i++) {
+        TEST_CHECK(fabs(rgba16[i * 4] / 65535.0 * 360.0 - expected[i * 3]) < 0.5 * 360.0 / 65535.0 + 1e-9);
+        TEST_CHECK(fabs(rgba16[i * 4 + 1] / 65535.0 * 100.0 - expected[i * 3 + 1]) < 0.5 * 100.0 / 65535.0 + 1e-9);
+        TEST_CHECK(fabs(rgba16[i * 4 + 2] / 65535.0 * 100.0 - expected[i * 3 + 2]) < 0.5 * 100.0 / 65535.0 + 1e-9);
+        TEST_CHECK(rgba16[i * 4 + 3] == rgba[i * 4 + 3] * 257);
+    }
+    hsluv_stream_destroy(stream);
+
+    /* And back, with the alpha passing through. */
+    to_rgb = hsluv_stream_create(HSLUV_SPACE_HSLUV, HSLUV_PIXEL_RGBA_F32, HSLUV_SPACE_RGB, HSLUV_PIXEL_RGBA8, 0);
+    TEST_CHECK(to_rgb != NULL);
+    hsluv_stream_convert(to_rgb, hsla, rgba_out, N);
+    TEST_CHECK(memcmp(rgba_out, rgba, sizeof(rgba)) == 0);
+
+    /* In place. */
+    memcpy(hsla_chunks, hsla, sizeof(hsla));
+    hsluv_stream_convert(to_rgb, hsla_chunks, hsla_chunks, N);
+    TEST_CHECK(memcmp(hsla_chunks, rgba, sizeof(rgba)) == 0);
+
+    /* Premultiplied alpha on either side. */
+    TEST_CASE("premultiplied");
+    stream = hsluv_stream_create(HSLUV_SPACE_HSLUV, HSLUV_PIXEL_RGBA_F32, HSLUV_SPACE_RGB, HSLUV_PIXEL_RGBA_F32,
+                                 HSLUV_STREAM_PREMULTIPLIED_OUT);
+    TEST_CHECK(stream != NULL);
+    hsluv_stream_convert(stream, hsla, hsla_chunks, N);
+    for(i = 0; i < N * 4; i++) {
+        double a = rgba[(i | 3)] / 255.0;
+        double expected_c = ((i & 3) == 3 ? a : rgba[i] / 255.0 * a);
+
+        TEST_CHECK(fabs(hsla_chunks[i] - expected_c) < 1e-5);
+    }
+    hsluv_stream_destroy(stream);
+    stream = hsluv_stream_create(HSLUV_SPACE_RGB, HSLUV_PIXEL_RGBA_F32, HSLUV_SPACE_HSLUV, HSLUV_PIXEL_RGBA_F32,
+                                 HSLUV_STREAM_PREMULTIPLIED_IN);
+    TEST_CHECK(stream != NULL);
+    hsluv_stream_convert(stream, hsla_chunks, hsla_chunks, N);
+    for(i = 0; i < N; i++) {
+        if(rgba[i * 4 + 3] < 16)
+            continue;   /* Too imprecise. */
+        if(hsla[i * 4 + 1] > 0.001f)
+            TEST_CHECK(fabs(hsla_chunks[i * 4] - hsla[i * 4]) < 1e-3);
+        TEST_CHECK(fabs(hsla_chunks[i * 4 + 1] - hsla[i * 4 + 1]) < 1e-3);
+        TEST_CHECK(fabs(hsla_chunks[i * 4 + 2] - hsla[i * 4 + 2]) < 1e-3);
+    }
+    hsluv_stream_destroy(stream);
+
+    /* Transparent black stays black. */
+    stream = hsluv_stream_create(HSLUV_SPACE_RGB, HSLUV_PIXEL_RGBA8, HSLUV_SPACE_HSLUV, HSLUV_PIXEL_RGBA_F32,
+                                 HSLUV_STREAM_PREMULTIPLIED_IN);
+    memset(rgba_out, 0, 4);
+    hsluv_stream_convert(stream, rgba_out, hsla_chunks, 1);
+    TEST_CHECK(hsla_chunks[1] == 0.0f  &&  hsla_chunks[2] == 0.0f  &&  hsla_chunks[3] == 0.0f);
+    hsluv_stream_destroy(stream);
+
+    /* HSLuv to HPLuv, through LCh. */
+    TEST_CASE("hpluv");
+    stream = hsluv_stream_create(HSLUV_SPACE_HSLUV, HSLUV_PIXEL_RGBA_F32, HSLUV_SPACE_HPLUV, HSLUV_PIXEL_RGB_F32, 0);
+    TEST_CHECK(stream != NULL);
+    rgb82hpluv_n(rgba, HSLUV_FORMAT_RGBA8, expected, 3, N);
+    TEST_CHECK(hsluv_stream_convert(stream, hsla, hsla_chunks, N) == -1);
+    for(i = 0; i < N; i++) {
+        if(expected[i * 3 + 1] > 0.1)
+            TEST_CHECK(fabs(hsla_chunks[i * 3] * 360.0 - expected[i * 3]) < 1e-2);
+        TEST_CHECK(fabs(hsla_chunks[i * 3 + 1] * 100.0 - expected[i * 3 + 1]) < 1e-2);
+        TEST_CHECK(fabs(hsla_chunks[i * 3 + 2] * 100.0 - expected[i * 3 + 2]) < 1e-3);
+    }
+    hsluv_stream_destroy(stream);
+
+    /* Invalid setups. */
+    TEST_CASE("invalid");
+    TEST_CHECK(hsluv_stream_create(HSLUV_SPACE_HSLUV, HSLUV_PIXEL_RGBA8, HSLUV_SPACE_RGB, HSLUV_PIXEL_RGBA8,
+                                   HSLUV_STREAM_PREMULTIPLIED_IN) == NULL);
+    TEST_CHECK(hsluv_stream_create(HSLUV_SPACE_RGB, HSLUV_PIXEL_RGB8, HSLUV_SPACE_HSLUV, HSLUV_PIXEL_RGBA8,
+                                   HSLUV_STREAM_PREMULTIPLIED_IN) == NULL);
+    TEST_CHECK(hsluv_stream_create(HSLUV_SPACE_RGB, (HsluvPixelFormat) 100, HSLUV_SPACE_HSLUV,
+                                   HSLUV_PIXEL_RGBA8, 0) == NULL);
+    TEST_CHECK(hsluv_stream_create((HsluvSpace) 3, HSLUV_PIXEL_RGBA8, HSLUV_SPACE_HSLUV,
+                                   HSLUV_PIXEL_RGBA8, 0) == NULL);
+
+    hsluv_stream_destroy(to_hsl);
+    hsluv_stream_destroy(to_rgb);
+}
+
+static void
+test_stream_half(void)
+{
+    static const struct {
+        float f;
+        uint16_t h;
+    } vectors[] = {
+        { 0.0f, 0x0000 },
+        { -0.0f, 0x8000 },
+        { 1.0f, 0x3c00 },
+        { 0.5f, 0x3800 },
+        { -2.0f, 0xc000 },
+        { 65504.0f, 0x7bff },
+        { 65519.0f, 0x7bff },       /* Below the midpoint to infinity. */
+        { 65520.0f, 0x7c00 },
+        { 6.103515625e-05f, 0x0400 },   /* Smallest normal. */
+        { 5.9604645e-08f, 0x0001 },     /* Smallest subnormal. */
+        { 2.9802322e-08f, 0x0000 },     /* Its half, tie to even. */
+        { 1e-7f, 0x0002 },
+        { 1.0009765625f, 0x3c01 },
+        { 1.00048828125f, 0x3c00 },     /* Tie to even. */
+        { 1.00146484375f, 0x3c02 }      /* Tie to even. */
+    };
+    HsluvStream* to_half;
+    HsluvStream* from_half;
+    uint16_t h[3];
+    float f[3];
+    uint32_t i;
+
+    to_half = hsluv_stream_create(HSLUV_SPACE_RGB, HSLUV_PIXEL_RGB_F32, HSLUV_SPACE_RGB, HSLUV_PIXEL_RGB_F16, 0);
+    from_half = hsluv_stream_create(HSLUV_SPACE_RGB, HSLUV_PIXEL_RGB_F16, HSLUV_SPACE_RGB, HSLUV_PIXEL_RGB_F32, 0);
+    if(!TEST_CHECK(to_half != NULL  &&  from_half != NULL))
+        return;
+
+    for(i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+        f[0] = f[1] = f[2] = vectors[i].f;
+        hsluv_stream_convert(to_half, f, h, 1);
+        TEST_CHECK_(h[0] == vectors[i].h, "%g -> 0x%04x", (double) vectors[i].f, (unsigned) h[0]);
+    }
+
+    /* Every half but NaN survives the way to a float and back. */
+    for(i = 0; i < 0x10000; i++) {
+        h[0] = h[1] = h[2] = (uint16_t) i;
+        hsluv_stream_convert(from_half, h, f, 1);
+        hsluv_stream_convert(to_half, f, h, 1);
+        if((i & 0x7c00) == 0x7c00  &&  (i & 0x3ff) != 0)
+            TEST_CHECK(f[0] != f[0]  &&  (h[0] & 0x7fff) == 0x7e00);
+        else
+            TEST_CHECK(h[0] == i);
+    }
+
+    hsluv_stream_destroy(to_half);
+    hsluv_stream_destroy(from_half);
+}
+
+/* Coordinates of the palette spaces, computed with the single-color functions. */
+static void
+palette_point(HsluvPaletteSpace space, const double* rgb, double* p)
+{
+    double h, s, l, c;
+
+    if(space == HSLUV_PALETTE_HPLUV)
+        rgb2hpluv(rgb[0], rgb[1], rgb[2], &h, &s, &l);
+    else
+        rgb2hsluv(rgb[0], rgb[1], rgb[2], &h, &s, &l);
+    if(space == HSLUV_PALETTE_LUV) {
+        hsluv2lch(h, s, l, &l, &c, &h);
+        s = c;
+    }
+
+    p[0] = l;
+    p[1] = s * cos(h * 0.01745329251994329577);
+    p[2] = s * sin(h * 0.01745329251994329577);
+}
+
+static double
+palette_dist(const double* p, const double* q)
+{
+    return (p[0] - q[0]) * (p[0] - q[0]) + (p[1] - q[1]) * (p[1] - q[1]) + (p[2] - q[2]) * (p[2] - q[2]);
+}
+
+static void
+test_palette_space(HsluvPaletteSpace space, size_t n_colors)
+{
+    enum { N = 2000 };
+    double* colors = (double*) malloc(n_colors * 3 * sizeof(double));
+    double* points = (double*) malloc(n_colors * 3 * sizeof(double));
+    double queries[N * 3];
+    uint16_t nearest[N];
+    HsluvPalette* palette;
+    size_t i, j;
+
+    if(!TEST_CHECK(colors != NULL  &&  points != NULL))
+        goto out;
+
+    srand(42);
+    for(i = 0; i < n_colors * 3; i++)
+        colors[i] = rand() / (double) RAND_MAX;
+    /* Some duplicates, and grays of various hues in the HSLuv cylinder. */
+    if(n_colors > 10) {
+        memcpy(colors + 9, colors, 3 * sizeof(double));
+        colors[6] = colors[7] = colors[8] = 0.5;
+    }
+    for(i = 0; i < n_colors; i++)
+        palette_point(space, colors + 3 * i, points + 3 * i);
+    for(i = 0; i < N * 3; i++)
+        queries[i] = rand() / (double) RAND_MAX;
+    memcpy(queries, colors, 3 * (n_colors < 10 ? n_colors : 10) * sizeof(double));
+
+    palette = hsluv_palette_create(colors, 3, n_colors, space);
+    if(!TEST_CHECK(palette != NULL))
+        goto out;
+    TEST_CHECK(hsluv_palette_size(palette) == n_colors);
+
+    hsluv_palette_nearest_n(palette, queries, 3, nearest, N);
+    for(i = 0; i < N; i++) {
+        double q[3];
+        double best = HUGE_VAL;
+
+        palette_point(space, queries + 3 * i, q);
+        for(j = 0; j < n_colors; j++) {
+            double d = palette_dist(points + 3 * j, q);
+            if(d < best)
+                best = d;
+        }
+
+        if(!TEST_CHECK(nearest[i] < n_colors))
+            break;
+        TEST_CHECK_(palette_dist(points + 3 * nearest[i], q) <= best + 1e-9,
+                    "query %u: %g vs. %g", (unsigned) i, palette_dist(points + 3 * nearest[i], q), best);
+        if((size_t) nearest[i] != hsluv_palette_nearest(palette, queries[3 * i], queries[3 * i + 1],
+                                                       queries[3 * i + 2]))
+            TEST_CHECK(0);
+    }
+
+    /* The palette colors find themselves; a duplicate finds the first one. */
+    for(i = 0; i < 10  &&  i < n_colors; i++)
+        TEST_CHECK(palette_dist(points + 3 * nearest[i], points + 3 * i) < 1e-18);
+    if(n_colors > 10)
+        TEST_CHECK(nearest[3] == 0);
+
+    hsluv_palette_destroy(palette);
+
+out:
+    free(colors);
+    free(points);
+}
+
+static void
+test_palette(void)
+{
+    static const HsluvPaletteSpace spaces[] = { HSLUV_PALETTE_LUV, HSLUV_PALETTE_HSLUV, HSLUV_PALETTE_HPLUV };
+    static const size_t sizes[] = { 1, 2, 16, 300 };
+    size_t i, j;
+
+    for(i = 0; i < sizeof(spaces) / sizeof(spaces[0]); i++) {
+        for(j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++) {
+            TEST_CASE_("space %u, %u colors", (unsigned) spaces[i], (unsigned) sizes[j]);
+            test_palette_space(spaces[i], sizes[j]);
+        }
+    }
+
+    TEST_CASE("invalid");
+    TEST_CHECK(hsluv_palette_create(NULL, 3, 0, HSLUV_PALETTE_LUV) == NULL);
+    TEST_CHECK(hsluv_palette_create(NULL, 3, 65537, HSLUV_PALETTE_LUV) == NULL);
+}
+
+static void
+test_palette_cache(void)
+{
+    static const double colors[] = {
+        0.0, 0.0, 0.0,  1.0, 1.0, 1.0,  1.0, 0.0, 0.0,  0.0, 1.0, 0.0,
+        0.0, 0.0, 1.0,  1.0, 1.0, 0.0,  0.2, 0.4, 0.6,  0.9, 0.5, 0.1
+    };
+    enum { N = 5000 };
+    unsigned char rgba[N * 4];
+    uint16_t expected[N];
+    uint16_t nearest[N];
+    HsluvPalette* palette;
+    HsluvThreadPool* pool;
+    size_t i;
+
+    palette = hsluv_palette_create(colors, 3, 8, HSLUV_PALETTE_HSLUV);
+    pool = hsluv_thread_pool_create(0);
+    if(!TEST_CHECK(palette != NULL  &&  pool != NULL))
+        goto out;
+
+    for(i = 0; i < N * 4; i++)
+        rgba[i] = (unsigned char) ((i * 7) ^ (i >> 5));
+    hsluv_palette_nearest_rgb8_n(palette, rgba, HSLUV_FORMAT_BGRA8, expected, N);
+    for(i = 0; i < N; i++) {
+        TEST_CHECK(expected[i] == hsluv_palette_nearest(palette, rgba[i * 4 + 2] / 255.0,
+                                                        rgba[i * 4 + 1] / 255.0, rgba[i * 4] / 255.0));
+    }
+
+    TEST_CHECK(hsluv_palette_build_cache(palette, hsluv_thread_pool_run, pool) == 0);
+    TEST_CHECK(hsluv_palette_build_cache(palette, NULL, NULL) == 0);
+    hsluv_palette_nearest_rgb8_n(palette, rgba, HSLUV_FORMAT_BGRA8, nearest, N);
+    TEST_CHECK(memcmp(nearest, expected, sizeof(expected)) == 0);
+
+out:
+    hsluv_palette_destroy(palette);
+    hsluv_thread_pool_destroy(pool);
+}
+
+static void
+test_stages(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        const TestVector* t = &snapshot[i];
+        double lin[3] = { ref_to_linear(t->rgb_r), ref_to_linear(t->rgb_g), ref_to_linear(t->rgb_b) };
+        double x, y, z;
+        int expected_ret = (t->hpluv_s > 100.0 ? -1 : 0);
+
+        TEST_CASE(t->hex_str);
+
+        /* The snapshot has no hue for grays. */
+        hsluv2lch(t->hsluv_h, t->hsluv_s, t->hsluv_l, &x, &y, &z);
+        TEST_CHANNEL("lch_l", x, t->lch_l);
+        TEST_CHANNEL("lch_c", y, t->lch_c);
+        if(t->lch_c > EPSILON)
+            TEST_CHANNEL("lch_h", z, t->lch_h);
+        hpluv2lch(t->hpluv_h, t->hpluv_s, t->hpluv_l, &x, &y, &z);
+        TEST_CHANNEL("lch_l", x, t->lch_l);
+        TEST_CHANNEL("lch_c", y, t->lch_c);
+        if(t->lch_c > EPSILON)
+            TEST_CHANNEL("lch_h", z, t->lch_h);
+
+        lch2hsluv(t->lch_l, t->lch_c, t->lch_h, &x, &y, &z);
+        TEST_CHANNEL("hue", x, t->hsluv_h);
+        TEST_CHANNEL("saturation", y, t->hsluv_s);
+        TEST_CHANNEL("lightness", z, t->hsluv_l);
+        TEST_CHECK(lch2hpluv(t->lch_l, t->lch_c, t->lch_h, &x, &y, &z) == expected_ret);
+        TEST_CHANNEL("hue", x, t->hpluv_h);
+        TEST_CHANNEL("saturation", y, t->hpluv_s);
+        TEST_CHANNEL("lightness", z, t->hpluv_l);
+
+        hsluv2xyz(t->hsluv_h, t->hsluv_s, t->hsluv_l, &x, &y, &z);
+        TEST_CHANNEL("x", x, t->xyz_x);
+        TEST_CHANNEL("y", y, t->xyz_y);
+        TEST_CHANNEL("z", z, t->xyz_z);
+        hpluv2xyz(t->hpluv_h, t->hpluv_s, t->hpluv_l, &x, &y, &z);
+        TEST_CHANNEL("x", x, t->xyz_x);
+        TEST_CHANNEL("y", y, t->xyz_y);
+        TEST_CHANNEL("z", z, t->xyz_z);
+
+        xyz2hsluv(t->xyz_x, t->xyz_y, t->xyz_z, &x, &y, &z);
+        TEST_CHANNEL("hue", x, t->hsluv_h);
+        TEST_CHANNEL("saturation", y, t->hsluv_s);
+        TEST_CHANNEL("lightness", z, t->hsluv_l);
+        TEST_CHECK(xyz2hpluv(t->xyz_x, t->xyz_y, t->xyz_z, &x, &y, &z) == expected_ret);
+        TEST_CHANNEL("hue", x, t->hpluv_h);
+        TEST_CHANNEL("saturation", y, t->hpluv_s);
+        TEST_CHANNEL("lightness", z, t->hpluv_l);
+
+        hsluv2linrgb(t->hsluv_h, t->hsluv_s, t->hsluv_l, &x, &y, &z);
+        TEST_CHANNEL("red", x, lin[0]);
+        TEST_CHANNEL("green", y, lin[1]);
+        TEST_CHANNEL("blue", z, lin[2]);
+        hpluv2linrgb(t->hpluv_h, t->hpluv_s, t->hpluv_l, &x, &y, &z);
+        TEST_CHANNEL("red", x, lin[0]);
+        TEST_CHANNEL("green", y, lin[1]);
+        TEST_CHANNEL("blue", z, lin[2]);
+
+        linrgb2hsluv(lin[0], lin[1], lin[2], &x, &y, &z);
+        TEST_CHANNEL("hue", x, t->hsluv_h);
+        TEST_CHANNEL("saturation", y, t->hsluv_s);
+        TEST_CHANNEL("lightness", z, t->hsluv_l);
+        TEST_CHECK(linrgb2hpluv(lin[0], lin[1], lin[2], &x, &y, &z) == expected_ret);
+        TEST_CHANNEL("hue", x, t->hpluv_h);
+        TEST_CHANNEL("saturation", y, t->hpluv_s);
+        TEST_CHANNEL("lightness", z, t->hpluv_l);
+    }
+}
+
+static void
+test_stages_n(void)
+{
+    static struct {
+        void (*single)(double, double, double, double*, double*, double*);
+        int (*single_ret)(double, double, double, double*, double*, double*);
+        void (*batched)(const double*, size_t, double*, size_t, size_t);
+        int (*batched_ret)(const double*, size_t, double*, size_t, size_t);
+        size_t offset;      /* Of the input in TestVector. */
+    } stages[] = {
+        { hsluv2lch, NULL, hsluv2lch_n, NULL, offsetof(TestVector, hsluv_h) },
+        { lch2hsluv, NULL, lch2hsluv_n, NULL, offsetof(TestVector, lch_l) },
+        { hpluv2lch, NULL, hpluv2lch_n, NULL, offsetof(TestVector, hpluv_h) },
+        { NULL, lch2hpluv, NULL, lch2hpluv_n, offsetof(TestVector, lch_l) },
+        { hsluv2xyz, NULL, hsluv2xyz_n, NULL, offsetof(TestVector, hsluv_h) },
+        { xyz2hsluv, NULL, xyz2hsluv_n, NULL, offsetof(TestVector, xyz_x) },
+        { hpluv2xyz, NULL, hpluv2xyz_n, NULL, offsetof(TestVector, hpluv_h) },
+        { NULL, xyz2hpluv, NULL, xyz2hpluv_n, offsetof(TestVector, xyz_x) },
+        { hsluv2linrgb, NULL, hsluv2linrgb_n, NULL, offsetof(TestVector, hsluv_h) },
+        { linrgb2hsluv, NULL, linrgb2hsluv_n, NULL, offsetof(TestVector, rgb_r) },
+        { hpluv2linrgb, NULL, hpluv2linrgb_n, NULL, offsetof(TestVector, hpluv_h) },
+        { NULL, linrgb2hpluv, NULL, linrgb2hpluv_n, offsetof(TestVector, rgb_r) }
+    };
+    static double in[4096 * 4];
+    static double out[4096 * 3];
+    size_t i, j;
+
+    TEST_ASSERT(snapshot_n <= 4096);
+
+    for(i = 0; i < sizeof(stages) / sizeof(stages[0]); i++) {
+        int ret = 0;
+        int ret_n;
+
+        for(j = 0; j < (size_t) snapshot_n; j++) {
+            const double* v = (const double*) ((const char*) &snapshot[j] + stages[i].offset);
+            in[j * 4] = v[0];
+            in[j * 4 + 1] = v[1];
+            in[j * 4 + 2] = v[2];
+        }
+
+        if(stages[i].batched != NULL) {
+            stages[i].batched(in, 4, out, 3, snapshot_n);
+            ret_n = 0;
+        } else {
+            ret_n = stages[i].batched_ret(in, 4, out, 3, snapshot_n);
+        }
+
+        for(j = 0; j < (size_t) snapshot_n; j++) {
+            double x, y, z;
+
+            if(stages[i].single != NULL)
+                stages[i].single(in[j * 4], in[j * 4 + 1], in[j * 4 + 2], &x, &y, &z);
+            else if(stages[i].single_ret(in[j * 4], in[j * 4 + 1], in[j * 4 + 2], &x, &y, &z) != 0)
+                ret = -1;
+            TEST_CHECK(out[j * 3] == x  &&  out[j * 3 + 1] == y  &&  out[j * 3 + 2] == z);
+        }
+        TEST_CHECK(ret_n == ret);
+
+        /* In place. */
+        if(stages[i].batched != NULL)
+            stages[i].batched(in, 4, in, 4, snapshot_n);
+        else
+            stages[i].batched_ret(in, 4, in, 4, snapshot_n);
+        for(j = 0; j < (size_t) snapshot_n; j++)
+            TEST_CHECK(memcmp(&in[j * 4], &out[j * 3], 3 * sizeof(double)) == 0);
+    }
+}
+
+static void
+test_lch_clip_gamut(void)
+{
+    enum { N = 3000 };
+    static double lch[N * 3];
+    static double clipped[N * 3];
+    double l, c, h;
+    size_t i;
+    int ret;
+
+    /* Colors in the gamut stay as they are. */
+    TEST_CASE("in gamut");
+    for(i = 0; i < (size_t) snapshot_n; i++) {
+        double rl, rc, rh;
+        const TestVector* e = &snapshot[i];
+
+        hsluv2lch(e->hsluv_h, e->hsluv_s, e->hsluv_l, &rl, &rc, &rh);
+        rc *= 0.999999;
+        ret = lch_clip_gamut(rl, rc, rh, &l, &c, &h);
+        TEST_CHECK(ret == 0  &&  l == rl  &&  c == rc  &&  h == rh);
+    }
+
+    /* Colors out of it get the maximal chroma of their lightness and hue,
+     * i.e. HSLuv saturation 100.0. In batches, a few lightnesses coming in
+     * no particular order share the bounds. */
+    TEST_CASE("out of gamut");
+    srand(23);
+    for(i = 0; i < N; i++) {
+        lch[i * 3] = (i % 2 ? 100.0 * rand() / RAND_MAX : 10.0 + 10.0 * (rand() % 8));
+        lch[i * 3 + 1] = 200.0 + 100.0 * rand() / RAND_MAX;
+        lch[i * 3 + 2] = 360.0 * rand() / RAND_MAX;
+    }
+    TEST_CHECK(lch_clip_gamut_n(lch, 3, clipped, 3, N) == -1);
+    for(i = 0; i < N; i++) {
+        double hh, ss, ll;
+
+        ret = lch_clip_gamut(lch[i * 3], lch[i * 3 + 1], lch[i * 3 + 2], &l, &c, &h);
+        TEST_CHECK(l == clipped[i * 3]  &&  c == clipped[i * 3 + 1]  &&  h == clipped[i * 3 + 2]);
+        if(l < 0.00000001  ||  l > 99.9999999)
+            continue;
+        TEST_CHECK(ret == -1);
+        TEST_CHECK(l == lch[i * 3]  &&  h == lch[i * 3 + 2]  &&  c < lch[i * 3 + 1]);
+        lch2hsluv(l, c, h, &hh, &ss, &ll);
+        TEST_CHECK_(fabs(ss - 100.0) < 1e-9, "saturation %.12f", ss);
+    }
+
+    /* In place. */
+    TEST_CHECK(lch_clip_gamut_n(lch, 3, lch, 3, N) == -1);
+    TEST_CHECK(memcmp(lch, clipped, sizeof(lch)) == 0);
+    TEST_CHECK(lch_clip_gamut_n(lch, 3, lch, 3, N) == 0);
+
+    /* Lightness out of range, white and black. */
+    TEST_CASE("extremes");
+    TEST_CHECK(lch_clip_gamut(120.0, 30.0, 40.0, &l, &c, &h) == -1);
+    TEST_CHECK(l == 100.0  &&  c == 0.0  &&  h == 40.0);
+    TEST_CHECK(lch_clip_gamut(-5.0, 0.0, 40.0, &l, &c, &h) == -1);
+    TEST_CHECK(l == 0.0  &&  c == 0.0);
+    TEST_CHECK(lch_clip_gamut(100.0, 0.0, 40.0, &l, &c, &h) == 0);
+    TEST_CHECK(lch_clip_gamut(0.0, 5.0, 40.0, &l, &c, &h) == -1);
+    TEST_CHECK(l == 0.0  &&  c == 0.0);
+
+    /* Negative and NaN chroma are not valid and become gray. */
+    TEST_CASE("invalid chroma");
+    TEST_CHECK(lch_clip_gamut(50.0, -150.0, 12.0, &l, &c, &h) == -1);
+    TEST_CHECK(l == 50.0  &&  c == 0.0  &&  h == 12.0);
+    TEST_CHECK(lch_clip_gamut(50.0, NAN, 12.0, &l, &c, &h) == -1);
+    TEST_CHECK(l == 50.0  &&  c == 0.0  &&  h == 12.0);
+    TEST_CHECK(lch_clip_gamut(100.0, -1.0, 12.0, &l, &c, &h) == -1);
+    TEST_CHECK(l == 100.0  &&  c == 0.0);
+    TEST_CHECK(lch_clip_gamut(0.0, NAN, 12.0, &l, &c, &h) == -1);
+    TEST_CHECK(l == 0.0  &&  c == 0.0);
+    lch[0] = 50.0;  lch[1] = 10.0;   lch[2] = 12.0;
+    lch[3] = 50.0;  lch[4] = -10.0;  lch[5] = 12.0;
+    lch[6] = 70.0;  lch[7] = NAN;    lch[8] = 200.0;
+    TEST_CHECK(lch_clip_gamut_n(lch, 3, clipped, 3, 3) == -1);
+    TEST_CHECK(clipped[1] == 10.0  &&  clipped[4] == 0.0  &&  clipped[7] == 0.0);
+    TEST_CHECK(lch_clip_gamut_n(clipped, 3, clipped, 3, 3) == 0);
+}
+
+static void
+test_rgb_space(void)
+{
+    static const double srgb_primaries[6] = { 0.64, 0.33, 0.30, 0.60, 0.15, 0.06 };
+    static const double d65[2] = { 0.3127, 0.3290 };
+    static const double collinear[6] = { 0.6, 0.3, 0.4, 0.3, 0.2, 0.3 };
+    static const double outside[2] = { 0.7, 0.25 };
+    static const HsluvRgbSpaceId ids[] = {
+        HSLUV_RGB_SPACE_SRGB, HSLUV_RGB_SPACE_DISPLAY_P3, HSLUV_RGB_SPACE_REC2020
+    };
+    enum { N = 4096 };
+    static double rgb[N * 3];
+    static double hsl[N * 3];
+    static double back[N * 3];
+    static float rgbf[N * 3];
+    static float hslf[N * 3];
+    HsluvRgbSpace space;
+    HsluvKernel kernel;
+    double h, s, l, r, g, b;
+    size_t i, j;
+
+    /* sRGB gets the very same results as the plain functions. */
+    TEST_CASE("srgb");
+    TEST_CHECK(hsluv_rgb_space_init_std(&space, HSLUV_RGB_SPACE_SRGB) == 0);
+    for(i = 0; i < (size_t) snapshot_n; i++) {
+        const TestVector* e = &snapshot[i];
+        double h2, s2, l2, r2, g2, b2;
+
+        rgb2hsluv(e->rgb_r, e->rgb_g, e->rgb_b, &h, &s, &l);
+        rgb2hsluv_space(&space, e->rgb_r, e->rgb_g, e->rgb_b, &h2, &s2, &l2);
+        TEST_CHECK(h == h2  &&  s == s2  &&  l == l2);
+        rgb2hpluv(e->rgb_r, e->rgb_g, e->rgb_b, &h, &s, &l);
+        rgb2hpluv_space(NULL, e->rgb_r, e->rgb_g, e->rgb_b, &h2, &s2, &l2);
+        TEST_CHECK(h == h2  &&  s == s2  &&  l == l2);
+        hsluv2rgb(e->hsluv_h, e->hsluv_s, e->hsluv_l, &r, &g, &b);
+        hsluv2rgb_space(&space, e->hsluv_h, e->hsluv_s, e->hsluv_l, &r2, &g2, &b2);
+        TEST_CHECK(r == r2  &&  g == g2  &&  b == b2);
+        hpluv2rgb(e->hpluv_h, e->hpluv_s, e->hpluv_l, &r, &g, &b);
+        hpluv2rgb_space(&space, e->hpluv_h, e->hpluv_s, e->hpluv_l, &r2, &g2, &b2);
+        TEST_CHECK(r == r2  &&  g == g2  &&  b == b2);
+    }
+
+    /* Built from the sRGB chromaticities, it agrees up to the rounding of the
+     * original constants. */
+    TEST_CASE("srgb from primaries");
+    TEST_CHECK(hsluv_rgb_space_init(&space, srgb_primaries, d65, HSLUV_TRANSFER_SRGB) == 0);
+    for(i = 0; i < (size_t) snapshot_n; i++) {
+        const TestVector* e = &snapshot[i];
+
+        rgb2hsluv_space(&space, e->rgb_r, e->rgb_g, e->rgb_b, &h, &s, &l);
+        if(e->hsluv_s > 0.001)
+            TEST_CHECK(fabs(h - e->hsluv_h) < 1e-6);
+        TEST_CHECK(fabs(s - e->hsluv_s) < 1e-4);
+        TEST_CHECK(fabs(l - e->hsluv_l) < 1e-6);
+    }
+
+    for(j = 0; j < sizeof(ids) / sizeof(ids[0]); j++) {
+        TEST_CASE_("space %d", (int) ids[j]);
+        TEST_CHECK(hsluv_rgb_space_init_std(&space, ids[j]) == 0);
+
+        /* White is white, and the colors with a channel at 0.0 or 1.0 are on
+         * the surface of the gamut. */
+        rgb2hsluv_space(&space, 1.0, 1.0, 1.0, &h, &s, &l);
+        TEST_CHECK(fabs(l - 100.0) < 1e-8  &&  s == 0.0);
+        rgb2hsluv_space(&space, 1.0, 0.0, 0.0, &h, &s, &l);
+        TEST_CHECK_(fabs(s - 100.0) < 1e-8, "red saturation %.12f", s);
+        rgb2hsluv_space(&space, 0.0, 1.0, 0.5, &h, &s, &l);
+        TEST_CHECK_(fabs(s - 100.0) < 1e-8, "green saturation %.12f", s);
+        rgb2hsluv_space(&space, 0.3, 0.6, 1.0, &h, &s, &l);
+        TEST_CHECK_(fabs(s - 100.0) < 1e-8, "blue saturation %.12f", s);
+
+        /* Round trips, in all the kernels. */
+        for(i = 0; i < N; i++) {
+            rgb[i * 3] = (i & 0xf) / 15.0;
+            rgb[i * 3 + 1] = ((i >> 4) & 0xf) / 15.0;
+            rgb[i * 3 + 2] = ((i >> 8) & 0xf) / 15.0;
+        }
+        FOR_EACH_KERNEL(kernel) {
+            rgb2hsluv_space_n(&space, rgb, 3, hsl, 3, N);
+            hsluv2rgb_space_n(&space, hsl, 3, back, 3, N);
+            for(i = 0; i < N * 3; i++)
+                TEST_CHANNEL("rgb", back[i], rgb[i]);
+            for(i = 0; i < N; i++) {
+                rgb2hsluv_space(&space, rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2], &h, &s, &l);
+                TEST_CHANNEL("saturation", hsl[i * 3 + 1], s);
+                TEST_CHANNEL("lightness", hsl[i * 3 + 2], l);
+            }
+
+            rgb2hpluv_space_n(&space, rgb, 3, hsl, 3, N);
+            hpluv2rgb_space_n(&space, hsl, 3, back, 3, N);
+            for(i = 0; i < N * 3; i++)
+                TEST_CHANNEL("rgb", back[i], rgb[i]);
+
+            for(i = 0; i < N * 3; i++)
+                rgbf[i] = (float) rgb[i];
+            rgb2hsluvf_space_n(&space, rgbf, 3, hslf, 3, N);
+            rgb2hsluv_space_n(&space, rgb, 3, hsl, 3, N);
+            for(i = 0; i < N; i++) {
+                TEST_CHANNEL_F("saturation", hslf[i * 3 + 1], hsl[i * 3 + 1], EPSILON_F_SAT);
+                TEST_CHANNEL_F("lightness", hslf[i * 3 + 2], hsl[i * 3 + 2], EPSILON_F_L);
+            }
+            hsluv2rgbf_space_n(&space, hslf, 3, rgbf, 3, N);
+            for(i = 0; i < N * 3; i++)
+                TEST_CHANNEL_F("rgb", rgbf[i], rgb[i], 10 * EPSILON_F_RGB);
+        }
+        hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+    }
+
+    TEST_CASE("invalid");
+    TEST_CHECK(hsluv_rgb_space_init(&space, collinear, d65, HSLUV_TRANSFER_SRGB) == -1);
+    TEST_CHECK(hsluv_rgb_space_init(&space, srgb_primaries, outside, HSLUV_TRANSFER_SRGB) == -1);
+    TEST_CHECK(hsluv_rgb_space_init(&space, srgb_primaries, d65, (HsluvTransfer) 42) == -1);
+    TEST_CHECK(hsluv_rgb_space_init_std(&space, (HsluvRgbSpaceId) 42) == -1);
+}
+
+static void
+test_edit_rgb(void)
+{
+    static const double params[3][4] = {
+        { 0.0, 37.5, -200.0, 720.0 },   /* hue rotation */
+        { 0.0, 35.0, 77.7, 100.0 },     /* lightness */
+        { 0.0, 0.5, 1.0, 1.5 }          /* saturation factor */
+    };
+    static double rgb[4096 * 3];
+    static double expected[4096 * 3];
+    static double out[4096 * 3];
+    HsluvKernel kernel;
+    int op, k, i;
+
+    TEST_ASSERT(snapshot_n <= 4096);
+    for(i = 0; i < snapshot_n; i++) {
+        rgb[i * 3] = snapshot[i].rgb_r;
+        rgb[i * 3 + 1] = snapshot[i].rgb_g;
+        rgb[i * 3 + 2] = snapshot[i].rgb_b;
+    }
+
+    for(op = 0; op < 3; op++) {
+        for(k = 0; k < 4; k++) {
+            double param = params[op][k];
+
+            /* The reference: a round trip through HSLuv. */
+            for(i = 0; i < snapshot_n; i++) {
+                double h, s, l;
+
+                rgb2hsluv(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2], &h, &s, &l);
+                if(op == 0) {
+                    h = fmod(h + param, 360.0);
+                    if(h < 0.0)
+                        h += 360.0;
+                } else if(op == 1) {
+                    l = param;
+                } else {
+                    s *= param;
+                    if(s > 100.0)
+                        s = 100.0;
+                }
+                hsluv2rgb(h, s, l, &expected[i * 3], &expected[i * 3 + 1], &expected[i * 3 + 2]);
+            }
+
+            FOR_EACH_KERNEL(kernel) {
+                TEST_CASE_("%s, op %d, %g", hsluv_kernel_name(kernel), op, param);
+
+                if(op == 0)
+                    hsluv_rotate_hue_rgb_n(rgb, 3, out, 3, snapshot_n, param);
+                else if(op == 1)
+                    hsluv_set_lightness_rgb_n(rgb, 3, out, 3, snapshot_n, param);
+                else
+                    hsluv_scale_saturation_rgb_n(rgb, 3, out, 3, snapshot_n, param);
+
+                for(i = 0; i < snapshot_n * 3; i++)
+                    TEST_CHANNEL_F("rgb", out[i], expected[i], 1e-9);
+            }
+        }
+    }
+
+    /* In place, and with a stride. */
+    memcpy(out, rgb, sizeof(out));
+    hsluv_set_lightness_rgb_n(out, 3, out, 3, snapshot_n, 35.0);
+    hsluv_set_lightness_rgb_n(rgb, 6, expected, 6, snapshot_n / 2, 35.0);
+    for(i = 0; i < snapshot_n / 2; i++)
+        TEST_CHECK(memcmp(&out[i * 6], &expected[i * 6], 3 * sizeof(double)) == 0);
+
+    hsluv_set_kernel(HSLUV_KERNEL_AUTO);
+}
+
+static void
+test_gradient(void)
+{
+    static const double ends[][6] = {
+        { 10.0, 90.0, 50.0, 350.0, 20.0, 50.0 },    /* across 0, the same lightness */
+        { 300.0, 100.0, 0.0, 30.0, 0.0, 100.0 },    /* from black to white */
+        { 120.0, 50.0, 60.0, 120.0, 50.0, 60.0 }    /* no change at all */
+    };
+    double out[1000 * 4];
+    size_t n, i, k;
+
+    for(k = 0; k < sizeof(ends) / sizeof(ends[0]); k++) {
+        const double* e = ends[k];
+
+        for(n = 1; n <= 1000; n = n * 10 - 1) {
+            double dh = e[3] - e[0];
+
+            TEST_CASE_("gradient %u, n = %u", (unsigned) k, (unsigned) n);
+
+            if(dh > 180.0)
+                dh -= 360.0;
+            else if(dh < -180.0)
+                dh += 360.0;
+
+            hsluv_gradient(e[0], e[1], e[2], e[3], e[4], e[5], out, 4, n);
+            for(i = 0; i < n; i++) {
+                double t = (n > 1 ? (double) i / (double) (n - 1) : 0.0);
+                double h = fmod(e[0] + dh * t + 360.0, 360.0);
+                double r, g, b;
+
+                hsluv2rgb(h, e[1] + (e[4] - e[1]) * t, e[2] + (e[5] - e[2]) * t, &r, &g, &b);
+                TEST_CHANNEL_F("red", out[i * 4], r, 1e-9);
+                TEST_CHANNEL_F("green", out[i * 4 + 1], g, 1e-9);
+                TEST_CHANNEL_F("blue", out[i * 4 + 2], b, 1e-9);
+            }
+        }
+    }
+
+    /* A categorical palette, and a sweep going around more than once. */
+    hsluv_hue_sweep(15.0, 360.0 / 7.0, 80.0, 65.0, out, 3, 7);
+    hsluv_hue_sweep(15.0, -7.3, 80.0, 65.0, out + 7 * 3, 3, 700);
+    for(i = 0; i < 707; i++) {
+        double h = (i < 7 ? 15.0 + i * (360.0 / 7.0) : 15.0 - (i - 7) * 7.3);
+        double r, g, b;
+
+        TEST_CASE_("sweep %u", (unsigned) i);
+        h = fmod(h, 360.0);
+        if(h < 0.0)
+            h += 360.0;
+        hsluv2rgb(h, 80.0, 65.0, &r, &g, &b);
+        TEST_CHANNEL_F("red", out[i * 3], r, 1e-9);
+        TEST_CHANNEL_F("green", out[i * 3 + 1], g, 1e-9);
+        TEST_CHANNEL_F("blue", out[i * 3 + 2], b, 1e-9);
+    }
+}
+
+static void
+test_fast_trig(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        double r, g, b, h, s, l;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        hsluv2rgb_fast(snapshot[i].hsluv_h, snapshot[i].hsluv_s, snapshot[i].hsluv_l, &r, &g, &b);
+        TEST_CHANNEL_F("red", r, snapshot[i].rgb_r, 1e-7);
+        TEST_CHANNEL_F("green", g, snapshot[i].rgb_g, 1e-7);
+        TEST_CHANNEL_F("blue", b, snapshot[i].rgb_b, 1e-7);
+
+        hpluv2rgb_fast(snapshot[i].hpluv_h, snapshot[i].hpluv_s, snapshot[i].hpluv_l, &r, &g, &b);
+        TEST_CHANNEL_F("red", r, snapshot[i].rgb_r, 1e-7);
+        TEST_CHANNEL_F("green", g, snapshot[i].rgb_g, 1e-7);
+        TEST_CHANNEL_F("blue", b, snapshot[i].rgb_b, 1e-7);
+
+        rgb2hsluv_fast(snapshot[i].rgb_r, snapshot[i].rgb_g, snapshot[i].rgb_b, &h, &s, &l);
+        TEST_CHANNEL_F("hue", h, snapshot[i].hsluv_h, 1e-6);
+        TEST_CHANNEL("saturation", s, snapshot[i].hsluv_s);
+        TEST_CHANNEL("lightness", l, snapshot[i].hsluv_l);
+
+        rgb2hpluv_fast(snapshot[i].rgb_r, snapshot[i].rgb_g, snapshot[i].rgb_b, &h, &s, &l);
+        TEST_CHANNEL_F("hue", h, snapshot[i].hpluv_h, 1e-6);
+        TEST_CHANNEL("saturation", s, snapshot[i].hpluv_s);
+        TEST_CHANNEL("lightness", l, snapshot[i].hpluv_l);
+    }
+
+    /* Hues all around the circle, across the quadrant boundaries. */
+    for(i = 0; i <= 3600; i++) {
+        double r, g, b, h, s, l;
+        double r_ref, g_ref, b_ref;
+
+        hsluv2rgb(i * 0.1, 80.0, 60.0, &r_ref, &g_ref, &b_ref);
+        hsluv2rgb_fast(i * 0.1, 80.0, 60.0, &r, &g, &b);
+        TEST_CHANNEL_F("red", r, r_ref, 5e-8);
+        TEST_CHANNEL_F("green", g, g_ref, 5e-8);
+        TEST_CHANNEL_F("blue", b, b_ref, 5e-8);
+
+        rgb2hsluv_fast(r_ref, g_ref, b_ref, &h, &s, &l);
+        if(i == 3600  &&  h < 1.0)
+            h += 360.0;
+        TEST_CHANNEL_F("hue", h, i * 0.1, 1e-6);
+    }
+}
+
+static void
+test_stats(void)
+{
+    static const double rgb[4 * 3] = {
+        0.5, 0.5, 0.5,      /* gray */
+        1.0, 1.0, 1.0,      /* white */
+        0.0, 0.0, 0.0,      /* black */
+        1.0, 0.0, 0.0       /* out of the HPLuv range */
+    };
+    double out[4 * 3];
+    double h, s, l;
+    HsluvStats stats;
+    int i;
+
+    hsluv_stats_reset();
+    for(i = 0; i < 4; i++) {
+        rgb2hsluv(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2], &h, &s, &l);
+        rgb2hpluv(rgb[i * 3], rgb[i * 3 + 1], rgb[i * 3 + 2], &h, &s, &l);
+    }
+    hsluv2rgb(120.0, 50.0, 50.0, &h, &s, &l);
+    hsluv2rgb_n(rgb, 3, out, 3, 4);
+    hsluv_stats_get(&stats);
+
+    if(!hsluv_stats_enabled()) {
+        for(i = 0; i < HSLUV_STATS_STAGE_COUNT; i++)
+            TEST_CHECK(stats.stage_calls[i] == 0);
+        for(i = 0; i < HSLUV_STATS_EVENT_COUNT; i++)
+            TEST_CHECK(stats.events[i] == 0);
+        TEST_CHECK(stats.kernel_colors[hsluv_get_kernel()] == 0);
+        return;
+    }
+
+    /* Each of the 8 conversions from RGB expands 3 channels, and the black,
+     * white and gray ones hit their special cases (white and black with zero
+     * chroma count as grays too). */
+    TEST_CHECK(stats.stage_calls[HSLUV_STATS_TO_LINEAR] == 8 * 3);
+    TEST_CHECK(stats.stage_calls[HSLUV_STATS_FROM_LINEAR] >= 3);
+    TEST_CHECK(stats.stage_calls[HSLUV_STATS_GET_BOUNDS] >= 1);
+    TEST_CHECK(stats.stage_calls[HSLUV_STATS_TRIG] >= 1);
+    TEST_CHECK(stats.events[HSLUV_STATS_WHITE] >= 2);
+    TEST_CHECK(stats.events[HSLUV_STATS_BLACK] >= 2);
+    TEST_CHECK(stats.events[HSLUV_STATS_GRAY] >= 6);
+    TEST_CHECK(stats.events[HSLUV_STATS_HPLUV_OUT_OF_RANGE] == 1);
+    TEST_CHECK(stats.kernel_calls[hsluv_get_kernel()] == 1);
+    TEST_CHECK(stats.kernel_colors[hsluv_get_kernel()] == 4);
+
+    hsluv_stats_reset();
+    hsluv_stats_get(&stats);
+    TEST_CHECK(stats.stage_calls[HSLUV_STATS_TO_LINEAR] == 0);
+    TEST_CHECK(stats.kernel_colors[hsluv_get_kernel()] == 0);
+}
 
 TEST_LIST = {
     { "hsluv2rgb", test_hsluv2rgb },
     { "rgb2hsluv", test_rgb2hsluv },
     { "hpluv2rgb", test_hpluv2rgb },
     { "rgb2hpluv", test_rgb2hpluv },
+    { "by_value", test_by_value },
+    { "hsluv2rgb_n", test_hsluv2rgb_n },
+    { "rgb2hsluv_n", test_rgb2hsluv_n },
+    { "hpluv2rgb_planar_n", test_hpluv2rgb_planar_n },
+    { "rgb2hpluv_planar_n", test_rgb2hpluv_planar_n },
+    { "kernel_dispatch", test_kernel_dispatch },
+    { "hsluv2rgbf", test_hsluv2rgbf },
+    { "rgb2hsluvf", test_rgb2hsluvf },
+    { "hpluv2rgbf", test_hpluv2rgbf },
+    { "rgb2hpluvf", test_rgb2hpluvf },
+    { "float_n", test_float_n },
+    { "bounds", test_bounds },
+    { "bounds_runs", test_bounds_runs },
+    { "hue_sectors", test_hue_sectors },
+    { "hpluv_lut", test_hpluv_lut },
+    { "fast_trig", test_fast_trig },
+    { "rgb8_formats", test_rgb8_formats },
+    { "rgb8_exhaustive", test_rgb8_exhaustive },
+    { "cache", test_cache },
+    { "lut3d", test_lut3d },
+    { "image", test_image },
+    { "image_stats", test_image_stats },
+    { "frame_pipeline", test_frame_pipeline },
+    { "stream", test_stream },
+    { "stream_half", test_stream_half },
+    { "palette", test_palette },
+    { "palette_cache", test_palette_cache },
+    { "stages", test_stages },
+    { "stages_n", test_stages_n },
+    { "lch_clip_gamut", test_lch_clip_gamut },
+    { "rgb_space", test_rgb_space },
+    { "edit_rgb", test_edit_rgb },
+    { "gradient", test_gradient },
+    { "stats", test_stats },
     { NULL, NULL }
 };
@@ -0,0 +1,206 @@
+#include "acutest.h"
+#include "hsluv.hpp"
+#include "snapshot.h"
+
+#include <cmath>
+#include <limits>
+
+
+#define EPSILON             0.00000001
+
+/* Error bounds of the single precision functions (see hsluv.h). */
+#define EPSILON_F_RGB       0.00002
+#define EPSILON_F_L         0.00005
+
+#define ABS(x)              ((x) >= 0 ? (x) : -(x))
+
+#define TEST_CHANNEL_F(name, produced, expected, eps)                       \
+    do {                                                                    \
+        if(!TEST_CHECK_(ABS((double)(produced) - (expected)) < (eps),       \
+                        "%s channel", name))                                \
+        {                                                                   \
+            TEST_MSG("Produced: %f", (double)(produced));                   \
+            TEST_MSG("Expected: %f", expected);                             \
+        }                                                                   \
+    } while(0)
+
+#define TEST_CHANNEL(name, produced, expected)                              \
+    TEST_CHANNEL_F(name, produced, expected, EPSILON)
+
+
+/* A palette baked at compile time. */
+struct Palette {
+    hsluv::Rgb<double> colors[12];
+};
+
+static constexpr Palette
+make_palette()
+{
+    Palette palette = {};
+
+    for(int i = 0; i < 12; i++)
+        palette.colors[i] = hsluv::ct::hsluv2rgb(hsluv::Hsl<double>{ i * 30.0, 80.0, 60.0 });
+    return palette;
+}
+
+static constexpr Palette palette = make_palette();
+
+/* Pure red, white and black. */
+static constexpr hsluv::Hsl<double> red = hsluv::ct::rgb2hsluv(hsluv::Rgb<double>{ 1.0, 0.0, 0.0 });
+static constexpr hsluv::Rgb<double> white = hsluv::ct::hsluv2rgb(hsluv::Hsl<double>{ 0.0, 0.0, 100.0 });
+static constexpr hsluv::Hsl<double> black = hsluv::ct::rgb2hpluv(hsluv::Rgb<double>{ 0.0, 0.0, 0.0 });
+
+static_assert(red.h > 12.17  &&  red.h < 12.18, "hue of red");
+static_assert(red.s > 99.99  &&  red.l > 53.23  &&  red.l < 53.24, "red");
+static_assert(white.r > 0.99999999  &&  white.g > 0.99999999  &&  white.b > 0.99999999, "white");
+/* The range reductions of the math replacements handle any magnitude. */
+static_assert(hsluv::detail::sqrt(1e300) > 0.99999999e150  &&  hsluv::detail::sqrt(1e300) < 1.00000001e150, "sqrt");
+static_assert(hsluv::detail::cbrt(-1e-300) < -0.99999999e-100  &&  hsluv::detail::cbrt(-1e-300) > -1.00000001e-100, "cbrt");
+static_assert(hsluv::detail::log(1e300) > 690.7755278  &&  hsluv::detail::log(1e300) < 690.7755279, "log");
+static_assert(hsluv::detail::exp(1e6) == std::numeric_limits<double>::infinity()  &&  hsluv::detail::exp(-1e6) == 0.0, "exp");
+static_assert(hsluv::detail::mod360(1e300) >= 0.0  &&  hsluv::detail::mod360(-725.0) == 355.0, "mod360");
+
+static_assert(black.h == 0.0  &&  black.s == 0.0  &&  black.l == 0.0, "black");
+
+
+static void
+test_constexpr(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        hsluv::Rgb<double> rgb = { snapshot[i].rgb_r, snapshot[i].rgb_g, snapshot[i].rgb_b };
+        hsluv::Rgb<double> out_rgb;
+        hsluv::Hsl<double> out_hsl;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        out_rgb = hsluv::ct::hsluv2rgb(hsluv::Hsl<double>{ snapshot[i].hsluv_h, snapshot[i].hsluv_s, snapshot[i].hsluv_l });
+        TEST_CHANNEL("red", out_rgb.r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", out_rgb.g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", out_rgb.b, snapshot[i].rgb_b);
+
+        out_rgb = hsluv::ct::hpluv2rgb(hsluv::Hsl<double>{ snapshot[i].hpluv_h, snapshot[i].hpluv_s, snapshot[i].hpluv_l });
+        TEST_CHANNEL("red", out_rgb.r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", out_rgb.g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", out_rgb.b, snapshot[i].rgb_b);
+
+        out_hsl = hsluv::ct::rgb2hsluv(rgb);
+        TEST_CHANNEL("hue", out_hsl.h, snapshot[i].hsluv_h);
+        TEST_CHANNEL("saturation", out_hsl.s, snapshot[i].hsluv_s);
+        TEST_CHANNEL("lightness", out_hsl.l, snapshot[i].hsluv_l);
+
+        out_hsl = hsluv::ct::rgb2hpluv(rgb);
+        TEST_CHANNEL("hue", out_hsl.h, snapshot[i].hpluv_h);
+        TEST_CHANNEL("saturation", out_hsl.s, snapshot[i].hpluv_s);
+        TEST_CHANNEL("lightness", out_hsl.l, snapshot[i].hpluv_l);
+    }
+}
+
+static void
+test_constexpr_palette(void)
+{
+    int i;
+
+    for(i = 0; i < 12; i++) {
+        double r, g, b;
+
+        hsluv2rgb(i * 30.0, 80.0, 60.0, &r, &g, &b);
+        TEST_CHANNEL("red", palette.colors[i].r, r);
+        TEST_CHANNEL("green", palette.colors[i].g, g);
+        TEST_CHANNEL("blue", palette.colors[i].b, b);
+    }
+}
+
+static void
+test_runtime(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        hsluv::Hsl<double> hsl = { snapshot[i].hsluv_h, snapshot[i].hsluv_s, snapshot[i].hsluv_l };
+        hsluv::Hsl<float> hsl_f = { (float) hsl.h, (float) hsl.s, (float) hsl.l };
+        hsluv::Rgb<double> rgb = { snapshot[i].rgb_r, snapshot[i].rgb_g, snapshot[i].rgb_b };
+        hsluv::Rgb<float> rgb_f = { (float) rgb.r, (float) rgb.g, (float) rgb.b };
+        hsluv::Rgb<double> out_rgb;
+        hsluv::Rgb<float> out_rgb_f;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        out_rgb = hsluv::hsluv2rgb(hsl);
+        TEST_CHANNEL("red", out_rgb.r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", out_rgb.g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", out_rgb.b, snapshot[i].rgb_b);
+        TEST_CHANNEL("lightness", hsluv::rgb2hpluv(rgb).l, snapshot[i].hpluv_l);
+
+        out_rgb_f = hsluv::hsluv2rgb(hsl_f);
+        TEST_CHANNEL_F("red", out_rgb_f.r, snapshot[i].rgb_r, EPSILON_F_RGB);
+        TEST_CHANNEL_F("green", out_rgb_f.g, snapshot[i].rgb_g, EPSILON_F_RGB);
+        TEST_CHANNEL_F("blue", out_rgb_f.b, snapshot[i].rgb_b, EPSILON_F_RGB);
+        TEST_CHANNEL_F("lightness", hsluv::rgb2hsluv(rgb_f).l, snapshot[i].hsluv_l, EPSILON_F_L);
+    }
+}
+
+/* Compare with the C library where either is finite, else both must be
+ * non-finite too (mainly, the conversions must return at all). */
+static void
+check_like_c(const char* name, double produced, double expected)
+{
+    if(std::isfinite(expected)  ||  std::isfinite(produced)) {
+        TEST_CHANNEL_F(name, produced, expected, 1e-9 * (1.0 + ABS(expected)));
+    } else {
+        TEST_CHECK_(std::isnan(produced) == std::isnan(expected), "%s channel: %f vs %f",
+                    name, produced, expected);
+    }
+}
+
+static void
+test_non_finite(void)
+{
+    static const double values[] = {
+        std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+        std::numeric_limits<double>::quiet_NaN(), 1e300, -1e300, 1e-300
+    };
+    size_t i;
+
+    for(i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        double x = values[i];
+        double h, s, l, r, g, b;
+        hsluv::Hsl<double> hsl;
+        hsluv::Rgb<double> rgb;
+
+        TEST_CASE_("%g", x);
+
+        rgb2hsluv(x, 0.0, 0.0, &h, &s, &l);
+        hsl = hsluv::ct::rgb2hsluv(hsluv::Rgb<double>{ x, 0.0, 0.0 });
+        check_like_c("lightness", hsl.l, l);
+        rgb2hpluv(0.5, x, 0.5, &h, &s, &l);
+        hsl = hsluv::ct::rgb2hpluv(hsluv::Rgb<double>{ 0.5, x, 0.5 });
+        check_like_c("lightness", hsl.l, l);
+
+        /* A huge hue is reduced exactly modulo 360 degrees; the libm is more
+         * accurate on the reduced hues only. */
+        hsluv2rgb(x, 80.0, 60.0, &r, &g, &b);
+        rgb = hsluv::ct::hsluv2rgb(hsluv::Hsl<double>{ x, 80.0, 60.0 });
+        TEST_CHECK(std::isnan(rgb.r) == std::isnan(r));
+        if(std::isfinite(x)) {
+            double reduced = std::fmod(x, 360.0);
+
+            hsluv2rgb(reduced < 0.0 ? reduced + 360.0 : reduced, 80.0, 60.0, &r, &g, &b);
+            check_like_c("red", rgb.r, r);
+            check_like_c("green", rgb.g, g);
+            check_like_c("blue", rgb.b, b);
+        }
+        hpluv2rgb(0.0, 50.0, x, &r, &g, &b);
+        rgb = hsluv::ct::hpluv2rgb(hsluv::Hsl<double>{ 0.0, 50.0, x });
+        check_like_c("red", rgb.r, r);
+    }
+}
+
+TEST_LIST = {
+    { "constexpr", test_constexpr },
+    { "constexpr_palette", test_constexpr_palette },
+    { "runtime", test_runtime },
+    { "non_finite", test_non_finite },
+    { NULL, NULL }
+};
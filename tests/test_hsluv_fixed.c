@@ -0,0 +1,164 @@
+#include "acutest.h"
+#include "hsluv-fixed.h"
+#include "snapshot.h"
+
+
+/* Error bounds of the fixed-point functions (see hsluv-fixed.h). */
+#define EPSILON_RGB         0.00005
+#define EPSILON_HUE         0.006
+#define EPSILON_SAT         0.005
+#define EPSILON_SAT_HPLUV   0.02
+#define EPSILON_L           0.001
+
+/* The hue is checked only for colors with chroma above this. */
+#define MIN_CHROMA          0.01
+
+#define ABS(x)              ((x) >= 0 ? (x) : -(x))
+
+/* All the snapshot values are non-negative. */
+#define TO_FIXED(x)         ((int32_t) ((x) * HSLUV_FIXED_ONE + 0.5))
+#define FROM_FIXED(x)       ((double) (x) / HSLUV_FIXED_ONE)
+
+#define TEST_CHANNEL(name, produced, expected, eps)                         \
+    do {                                                                    \
+        if(!TEST_CHECK_(ABS(FROM_FIXED(produced) - (expected)) < (eps),     \
+                        "%s channel", name))                                \
+        {                                                                   \
+            TEST_MSG("Produced: %f", FROM_FIXED(produced));                 \
+            TEST_MSG("Expected: %f", expected);                             \
+        }                                                                   \
+    } while(0)
+
+#define TEST_HUE(produced, expected, chroma)                                \
+    do {                                                                    \
+        double diff_ = ABS(FROM_FIXED(produced) - (expected));              \
+        if(diff_ > 180.0)                                                   \
+            diff_ = 360.0 - diff_;                                          \
+        if((chroma) > MIN_CHROMA  &&  !TEST_CHECK_(diff_ < EPSILON_HUE, "hue channel")) { \
+            TEST_MSG("Produced: %f", FROM_FIXED(produced));                 \
+            TEST_MSG("Expected: %f", expected);                             \
+        }                                                                   \
+    } while(0)
+
+
+static void
+test_hsluv2rgb_fixed(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        int32_t r, g, b;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        hsluv2rgb_fixed(TO_FIXED(snapshot[i].hsluv_h), TO_FIXED(snapshot[i].hsluv_s),
+                        TO_FIXED(snapshot[i].hsluv_l), &r, &g, &b);
+
+        TEST_CHANNEL("red", r, snapshot[i].rgb_r, EPSILON_RGB);
+        TEST_CHANNEL("green", g, snapshot[i].rgb_g, EPSILON_RGB);
+        TEST_CHANNEL("blue", b, snapshot[i].rgb_b, EPSILON_RGB);
+    }
+}
+
+static void
+test_rgb2hsluv_fixed(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        int32_t h, s, l;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        rgb2hsluv_fixed(TO_FIXED(snapshot[i].rgb_r), TO_FIXED(snapshot[i].rgb_g),
+                        TO_FIXED(snapshot[i].rgb_b), &h, &s, &l);
+
+        TEST_HUE(h, snapshot[i].hsluv_h, snapshot[i].lch_c);
+        TEST_CHANNEL("saturation", s, snapshot[i].hsluv_s, EPSILON_SAT);
+        TEST_CHANNEL("lightness", l, snapshot[i].hsluv_l, EPSILON_L);
+    }
+}
+
+static void
+test_hpluv2rgb_fixed(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        int32_t r, g, b;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        hpluv2rgb_fixed(TO_FIXED(snapshot[i].hpluv_h), TO_FIXED(snapshot[i].hpluv_s),
+                        TO_FIXED(snapshot[i].hpluv_l), &r, &g, &b);
+
+        TEST_CHANNEL("red", r, snapshot[i].rgb_r, EPSILON_RGB);
+        TEST_CHANNEL("green", g, snapshot[i].rgb_g, EPSILON_RGB);
+        TEST_CHANNEL("blue", b, snapshot[i].rgb_b, EPSILON_RGB);
+    }
+}
+
+static void
+test_rgb2hpluv_fixed(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        int32_t h, s, l;
+        int ret;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        ret = rgb2hpluv_fixed(TO_FIXED(snapshot[i].rgb_r), TO_FIXED(snapshot[i].rgb_g),
+                              TO_FIXED(snapshot[i].rgb_b), &h, &s, &l);
+
+        TEST_HUE(h, snapshot[i].hpluv_h, snapshot[i].lch_c);
+        TEST_CHANNEL("saturation", s, snapshot[i].hpluv_s, EPSILON_SAT_HPLUV);
+        TEST_CHANNEL("lightness", l, snapshot[i].hpluv_l, EPSILON_L);
+
+        /* Colors close to the edge of HPLuv may land on either side. */
+        if(snapshot[i].hpluv_s < 100.0 - EPSILON_SAT_HPLUV)
+            TEST_CHECK(ret == 0);
+        else if(snapshot[i].hpluv_s > 100.0 + EPSILON_SAT_HPLUV)
+            TEST_CHECK(ret == -1);
+    }
+}
+
+static void
+test_fixed_ranges(void)
+{
+    int32_t r, g, b, h, s, l;
+    int32_t i;
+
+    /* White and black. */
+    hsluv2rgb_fixed(0, 0, 100 * HSLUV_FIXED_ONE, &r, &g, &b);
+    TEST_CHECK(r == HSLUV_FIXED_ONE  &&  g == HSLUV_FIXED_ONE  &&  b == HSLUV_FIXED_ONE);
+    hsluv2rgb_fixed(0, 0, 0, &r, &g, &b);
+    TEST_CHECK(r == 0  &&  g == 0  &&  b == 0);
+    rgb2hsluv_fixed(HSLUV_FIXED_ONE, HSLUV_FIXED_ONE, HSLUV_FIXED_ONE, &h, &s, &l);
+    TEST_CHECK(s == 0  &&  l == 100 * HSLUV_FIXED_ONE);
+    rgb2hsluv_fixed(0, 0, 0, &h, &s, &l);
+    TEST_CHECK(h == 0  &&  s == 0  &&  l == 0);
+
+    /* Out of range inputs and extreme hues stay in range. */
+    for(i = -720; i <= 720; i += 15) {
+        hsluv2rgb_fixed(i * HSLUV_FIXED_ONE, 100 * HSLUV_FIXED_ONE, 50 * HSLUV_FIXED_ONE, &r, &g, &b);
+        TEST_CHECK(0 <= r  &&  r <= HSLUV_FIXED_ONE);
+        TEST_CHECK(0 <= g  &&  g <= HSLUV_FIXED_ONE);
+        TEST_CHECK(0 <= b  &&  b <= HSLUV_FIXED_ONE);
+    }
+    rgb2hsluv_fixed(-HSLUV_FIXED_ONE, 2 * HSLUV_FIXED_ONE, HSLUV_FIXED_ONE / 2, &h, &s, &l);
+    TEST_CHECK(0 <= h  &&  h <= 360 * HSLUV_FIXED_ONE);
+    TEST_CHECK(0 <= s  &&  s <= 100 * HSLUV_FIXED_ONE);
+    TEST_CHECK(0 <= l  &&  l <= 100 * HSLUV_FIXED_ONE);
+}
+
+
+TEST_LIST = {
+    { "hsluv2rgb_fixed", test_hsluv2rgb_fixed },
+    { "rgb2hsluv_fixed", test_rgb2hsluv_fixed },
+    { "hpluv2rgb_fixed", test_hpluv2rgb_fixed },
+    { "rgb2hpluv_fixed", test_rgb2hpluv_fixed },
+    { "fixed_ranges", test_fixed_ranges },
+    { NULL, NULL }
+};
@@ -0,0 +1,184 @@
+/* The generated GPU code (see hsluv-shader.h). Its C variant, written by
+ * gen_hsluv_shader at build time, is compiled right into this file and
+ * checked against the snapshot; the other variants are only checked for
+ * their shape, as there is no GPU compiler to build them with. */
+#include "hsluv_shader_c.h"
+
+#include "acutest.h"
+#include "hsluv-shader.h"
+#include "snapshot.h"
+
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/* Error bounds of the single precision functions (see hsluv.h). */
+#define EPSILON_F_RGB       0.00002
+#define EPSILON_F_HUE       0.001
+#define EPSILON_F_SAT       0.005
+#define EPSILON_F_SAT_HPLUV 0.05
+#define EPSILON_F_L         0.00005
+
+#define ABS(x)              ((x) >= 0 ? (x) : -(x))
+
+#define TEST_CHANNEL_F(name, produced, expected, eps)                       \
+    do {                                                                    \
+        if(!TEST_CHECK_(ABS((double)(produced) - (expected)) < (eps),       \
+                        "%s channel", name))                                \
+        {                                                                   \
+            TEST_MSG("Produced: %f", (double)(produced));                   \
+            TEST_MSG("Expected: %f", expected);                             \
+        }                                                                   \
+    } while(0)
+
+
+static void
+test_shader_snapshot(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        hsluv_vec3 hsluv = { (float) snapshot[i].hsluv_h, (float) snapshot[i].hsluv_s, (float) snapshot[i].hsluv_l };
+        hsluv_vec3 hpluv = { (float) snapshot[i].hpluv_h, (float) snapshot[i].hpluv_s, (float) snapshot[i].hpluv_l };
+        hsluv_vec3 rgb = { (float) snapshot[i].rgb_r, (float) snapshot[i].rgb_g, (float) snapshot[i].rgb_b };
+        hsluv_vec3 out;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        out = hsluv_hsluv2rgb(hsluv);
+        TEST_CHANNEL_F("red", out.x, snapshot[i].rgb_r, EPSILON_F_RGB);
+        TEST_CHANNEL_F("green", out.y, snapshot[i].rgb_g, EPSILON_F_RGB);
+        TEST_CHANNEL_F("blue", out.z, snapshot[i].rgb_b, EPSILON_F_RGB);
+
+        out = hsluv_hpluv2rgb(hpluv);
+        TEST_CHANNEL_F("red", out.x, snapshot[i].rgb_r, EPSILON_F_RGB);
+        TEST_CHANNEL_F("green", out.y, snapshot[i].rgb_g, EPSILON_F_RGB);
+        TEST_CHANNEL_F("blue", out.z, snapshot[i].rgb_b, EPSILON_F_RGB);
+
+        out = hsluv_rgb2hsluv(rgb);
+        TEST_CHANNEL_F("hue", out.x, snapshot[i].hsluv_h, EPSILON_F_HUE);
+        TEST_CHANNEL_F("saturation", out.y, snapshot[i].hsluv_s, EPSILON_F_SAT);
+        TEST_CHANNEL_F("lightness", out.z, snapshot[i].hsluv_l, EPSILON_F_L);
+
+        out = hsluv_rgb2hpluv(rgb);
+        TEST_CHANNEL_F("hue", out.x, snapshot[i].hpluv_h, EPSILON_F_HUE);
+        TEST_CHANNEL_F("saturation", out.y, snapshot[i].hpluv_s, EPSILON_F_SAT_HPLUV);
+        TEST_CHANNEL_F("lightness", out.z, snapshot[i].hpluv_l, EPSILON_F_L);
+    }
+}
+
+static void
+test_shader_kernels(void)
+{
+    static float rgb[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    static float hsl[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    static float out[3 * (sizeof(snapshot) / sizeof(TestVector))];
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        rgb[3 * i] = (float) snapshot[i].rgb_r;
+        rgb[3 * i + 1] = (float) snapshot[i].rgb_g;
+        rgb[3 * i + 2] = (float) snapshot[i].rgb_b;
+    }
+
+    hsluv_rgb2hsluv_kernel(rgb, hsl, (size_t) snapshot_n);
+    hsluv_hsluv2rgb_kernel(hsl, out, (size_t) snapshot_n);
+    for(i = 0; i < snapshot_n * 3; i++)
+        TEST_CHANNEL_F("rgb", out[i], rgb[i], EPSILON_F_RGB);
+
+    hsluv_rgb2hpluv_kernel(rgb, hsl, (size_t) snapshot_n);
+    hsluv_hpluv2rgb_kernel(hsl, out, (size_t) snapshot_n);
+    for(i = 0; i < snapshot_n * 3; i++)
+        TEST_CHANNEL_F("rgb", out[i], rgb[i], EPSILON_F_RGB);
+}
+
+static void
+test_shader_languages(void)
+{
+    static const char* const kernel_languages[] = { "Metal", "CUDA", "OpenCL", "C" };
+    HsluvShaderLanguage lang;
+
+    for(lang = HSLUV_SHADER_GLSL; lang <= HSLUV_SHADER_C; lang++) {
+        size_t len = hsluv_shader_source(lang, NULL, 0);
+        char* src = (char*) malloc(len + 1);
+        char small[16];
+        size_t open = 0, close = 0;
+        size_t i;
+
+        TEST_CASE_("language %d", (int) lang);
+        if(!TEST_CHECK(len > 0  &&  src != NULL))
+            continue;
+
+        TEST_CHECK(hsluv_shader_source(lang, src, len + 1) == len);
+        TEST_CHECK(strlen(src) == len);
+        TEST_CHECK(strstr(src, "hsluv_hsluv2rgb(") != NULL);
+        TEST_CHECK(strstr(src, "hsluv_rgb2hpluv(") != NULL);
+        TEST_CHECK(strchr(src, '%') == NULL);
+        if(lang >= HSLUV_SHADER_METAL)
+            TEST_CHECK_(strstr(src, "hsluv_rgb2hsluv_kernel(") != NULL, "kernels in %s",
+                        kernel_languages[lang - HSLUV_SHADER_METAL]);
+        else
+            TEST_CHECK(strstr(src, "_kernel(") == NULL);
+        /* GLSL has no float suffix; the others all use it. */
+        if(lang == HSLUV_SHADER_GLSL)
+            TEST_CHECK(strstr(src, "0f") == NULL);
+        else
+            TEST_CHECK(strstr(src, "100.0f") != NULL);
+
+        for(i = 0; i < len; i++) {
+            open += (src[i] == '{' || src[i] == '(');
+            close += (src[i] == '}' || src[i] == ')');
+        }
+        TEST_CHECK(open == close);
+
+        /* Truncated output. */
+        TEST_CHECK(hsluv_shader_source(lang, small, sizeof(small)) == len);
+        TEST_CHECK(strlen(small) == sizeof(small) - 1  &&  memcmp(small, src, sizeof(small) - 1) == 0);
+
+        free(src);
+    }
+
+    TEST_CHECK(hsluv_shader_source((HsluvShaderLanguage) 100, NULL, 0) == 0);
+}
+
+/* The literals do not depend on the decimal separator of the locale. The
+ * test needs a locale using ',', and passes trivially without one. */
+static void
+test_shader_locale(void)
+{
+    static const char* const comma_locales[] = {
+        "de_DE.UTF-8", "de_DE.utf8", "fr_FR.UTF-8", "fr_FR.utf8", "German", "French"
+    };
+    size_t len = hsluv_shader_source(HSLUV_SHADER_GLSL, NULL, 0);
+    char* expected = (char*) malloc(len + 1);
+    char* src = (char*) malloc(len + 1);
+    size_t i;
+
+    if(!TEST_CHECK(expected != NULL  &&  src != NULL))
+        goto out;
+
+    hsluv_shader_source(HSLUV_SHADER_GLSL, expected, len + 1);
+    for(i = 0; i < sizeof(comma_locales) / sizeof(comma_locales[0]); i++) {
+        if(setlocale(LC_NUMERIC, comma_locales[i]) == NULL)
+            continue;
+        TEST_CASE(comma_locales[i]);
+        TEST_CHECK(hsluv_shader_source(HSLUV_SHADER_GLSL, src, len + 1) == len);
+        TEST_CHECK(strcmp(src, expected) == 0);
+        break;
+    }
+    setlocale(LC_NUMERIC, "C");
+
+out:
+    free(expected);
+    free(src);
+}
+
+
+TEST_LIST = {
+    { "shader_snapshot", test_shader_snapshot },
+    { "shader_kernels", test_shader_kernels },
+    { "shader_languages", test_shader_languages },
+    { "shader_locale", test_shader_locale },
+    { NULL, NULL }
+};
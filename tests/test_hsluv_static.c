@@ -0,0 +1,91 @@
+/* The header-only build (see HSLUV_IMPLEMENTATION in hsluv.h): this file is
+ * not linked with the library. */
+#define HSLUV_IMPLEMENTATION
+#define HSLUV_STATIC
+#include "hsluv.h"
+
+#include "acutest.h"
+#include "snapshot.h"
+
+
+#define EPSILON             0.00000001
+
+#define ABS(x)              ((x) >= 0 ? (x) : -(x))
+
+#define TEST_CHANNEL(name, produced, expected)                              \
+    do {                                                                    \
+        if(!TEST_CHECK_(ABS((produced) - (expected)) < EPSILON,             \
+                        "%s channel", name))                                \
+        {                                                                   \
+            TEST_MSG("Produced: %f", produced);                             \
+            TEST_MSG("Expected: %f", expected);                             \
+        }                                                                   \
+    } while(0)
+
+
+static void
+test_static_single(void)
+{
+    int i;
+
+    for(i = 0; i < snapshot_n; i++) {
+        double r, g, b, h, s, l;
+
+        TEST_CASE(snapshot[i].hex_str);
+
+        hsluv2rgb(snapshot[i].hsluv_h, snapshot[i].hsluv_s, snapshot[i].hsluv_l, &r, &g, &b);
+        TEST_CHANNEL("red", r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", b, snapshot[i].rgb_b);
+
+        hpluv2rgb(snapshot[i].hpluv_h, snapshot[i].hpluv_s, snapshot[i].hpluv_l, &r, &g, &b);
+        TEST_CHANNEL("red", r, snapshot[i].rgb_r);
+        TEST_CHANNEL("green", g, snapshot[i].rgb_g);
+        TEST_CHANNEL("blue", b, snapshot[i].rgb_b);
+
+        rgb2hsluv(snapshot[i].rgb_r, snapshot[i].rgb_g, snapshot[i].rgb_b, &h, &s, &l);
+        TEST_CHANNEL("hue", h, snapshot[i].hsluv_h);
+        TEST_CHANNEL("saturation", s, snapshot[i].hsluv_s);
+        TEST_CHANNEL("lightness", l, snapshot[i].hsluv_l);
+
+        rgb2hpluv(snapshot[i].rgb_r, snapshot[i].rgb_g, snapshot[i].rgb_b, &h, &s, &l);
+        TEST_CHANNEL("hue", h, snapshot[i].hpluv_h);
+        TEST_CHANNEL("saturation", s, snapshot[i].hpluv_s);
+        TEST_CHANNEL("lightness", l, snapshot[i].hpluv_l);
+    }
+}
+
+static void
+test_static_batched(void)
+{
+    double in[3], out[3];
+    float in_f[3], out_f[3];
+    int i;
+
+    /* Only the portable kernel is in this build. */
+    TEST_CHECK(hsluv_get_kernel() == HSLUV_KERNEL_SCALAR);
+
+    for(i = 0; i < snapshot_n; i++) {
+        TEST_CASE(snapshot[i].hex_str);
+
+        in[0] = snapshot[i].rgb_r;
+        in[1] = snapshot[i].rgb_g;
+        in[2] = snapshot[i].rgb_b;
+        rgb2hsluv_n(in, 3, out, 3, 1);
+        TEST_CHANNEL("hue", out[0], snapshot[i].hsluv_h);
+        TEST_CHANNEL("saturation", out[1], snapshot[i].hsluv_s);
+        TEST_CHANNEL("lightness", out[2], snapshot[i].hsluv_l);
+
+        in_f[0] = (float) snapshot[i].rgb_r;
+        in_f[1] = (float) snapshot[i].rgb_g;
+        in_f[2] = (float) snapshot[i].rgb_b;
+        rgb2hsluvf_n(in_f, 3, out_f, 3, 1);
+        TEST_CHECK(ABS(out_f[2] - snapshot[i].hsluv_l) < 0.0001);
+    }
+}
+
+TEST_LIST = {
+    { "static_single", test_static_single },
+    { "static_batched", test_static_batched },
+    { NULL, NULL }
+};